@@ -0,0 +1,327 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Audio/Audio.h>
+#include <Urho3D/Audio/AudioMixing.h>
+#include <Urho3D/Audio/Sound.h>
+#include <Urho3D/Audio/SoundSource.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+const int mixRate = 44100;
+
+SharedPtr<Sound> CreateSineSound(Context* context, unsigned frequency, float toneFrequency, bool stereo)
+{
+    const unsigned numChannels = stereo ? 2 : 1;
+    ea::vector<short> data(frequency * numChannels);
+    for (unsigned i = 0; i < frequency; ++i)
+    {
+        const auto value = static_cast<short>(16384.0f * Sin(360.0f * toneFrequency * i / frequency));
+        for (unsigned channel = 0; channel < numChannels; ++channel)
+            data[i * numChannels + channel] = value;
+    }
+
+    auto sound = MakeShared<Sound>(context);
+    sound->SetData(data.data(), data.size() * sizeof(short));
+    sound->SetFormat(frequency, true, stereo);
+    sound->SetLooped(true);
+    return sound;
+}
+
+ea::vector<SharedPtr<SoundSource>> CreateSoundSources(Scene* scene, unsigned numSources)
+{
+    SharedPtr<Sound> sounds[] = {
+        CreateSineSound(scene->GetContext(), mixRate, 440.0f, false),
+        CreateSineSound(scene->GetContext(), 22050, 220.0f, false),
+        CreateSineSound(scene->GetContext(), 48000, 330.0f, true),
+    };
+
+    ea::vector<SharedPtr<SoundSource>> sources;
+    for (unsigned i = 0; i < numSources; ++i)
+    {
+        auto source = scene->CreateChild()->CreateComponent<SoundSource>();
+        source->Play(sounds[i % URHO3D_ARRAYSIZE(sounds)]);
+        source->SetGain(1.0f / numSources);
+        source->SetPanning(static_cast<float>(i % 5) / 2.0f - 1.0f);
+        sources.emplace_back(source);
+    }
+    return sources;
+}
+
+}
+
+TEST_CASE("Float mixing kernels match scalar reference")
+{
+    const unsigned numSamples = 37;
+
+    ea::vector<short> source(numSamples * 2);
+    for (unsigned i = 0; i < source.size(); ++i)
+        source[i] = static_cast<short>(i * 1777 % 65536 - 32768);
+
+    ea::vector<float> left(numSamples);
+    ea::vector<float> right(numSamples);
+    ConvertSamples(left.data(), right.data(), source.data(), numSamples, 1.0f / 32768.0f);
+    for (unsigned i = 0; i < numSamples; ++i)
+    {
+        REQUIRE(left[i] == source[i * 2] / 32768.0f);
+        REQUIRE(right[i] == source[i * 2 + 1] / 32768.0f);
+    }
+
+    AudioMixBuffer buffer;
+    buffer.Allocate(2, numSamples);
+    buffer.Clear(numSamples);
+    MixSamples(buffer.GetChannel(0), left.data(), numSamples, 1.0f, 0.0f);
+    MixSamples(buffer.GetChannel(1), right.data(), numSamples, 0.0f, 1.0f / numSamples);
+    MixSamples(buffer.GetChannel(1), right.data(), numSamples, 1.0f, -1.0f / numSamples);
+
+    ea::vector<short> output(numSamples * 2);
+    ConvertMixBuffer(output.data(), buffer, numSamples);
+    for (unsigned i = 0; i < numSamples * 2; ++i)
+        REQUIRE(Abs(output[i] - source[i]) <= 1);
+}
+
+TEST_CASE("Offline audio mixing is deterministic")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto audio = context->GetSubsystem<Audio>();
+
+    auto render = [&](SpeakerMode mode, bool interpolation)
+    {
+        REQUIRE(audio->SetOfflineMode(mixRate, mode, interpolation));
+
+        auto scene = MakeShared<Scene>(context);
+        const auto sources = CreateSoundSources(scene, 7);
+
+        ea::vector<short> output(mixRate / 10 * GetNumAudioChannels(mode));
+        audio->MixOutput(output.data(), mixRate / 10);
+        return output;
+    };
+
+    for (SpeakerMode mode : {SPK_MONO, SPK_STEREO, SPK_QUADROPHONIC, SPK_SURROUND_5_1})
+    {
+        const auto first = render(mode, true);
+        const auto second = render(mode, true);
+        REQUIRE(first == second);
+        REQUIRE(ea::any_of(first.begin(), first.end(), [](short value) { return value != 0; }));
+    }
+
+    audio->Close();
+}
+
+TEST_CASE("Offline audio mixing passes through unscaled mono sound")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto audio = context->GetSubsystem<Audio>();
+    REQUIRE(audio->SetOfflineMode(mixRate, SPK_STEREO));
+
+    auto scene = MakeShared<Scene>(context);
+    auto sound = CreateSineSound(context, mixRate, 440.0f, false);
+    auto source = scene->CreateComponent<SoundSource>();
+    source->Play(sound);
+
+    const unsigned numSamples = 1000;
+    ea::vector<short> output(numSamples * 2);
+    audio->MixOutput(output.data(), numSamples);
+
+    const auto* data = reinterpret_cast<const short*>(sound->GetStart());
+    for (unsigned i = 0; i < numSamples; ++i)
+    {
+        REQUIRE(output[i * 2] == data[i]);
+        REQUIRE(output[i * 2 + 1] == data[i]);
+    }
+
+    audio->Close();
+}
+
+TEST_CASE("Offline audio mixing matches scalar reference mix")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto audio = context->GetSubsystem<Audio>();
+    REQUIRE(audio->SetOfflineMode(mixRate, SPK_STEREO));
+
+    auto scene = MakeShared<Scene>(context);
+    auto sound = CreateSineSound(context, mixRate, 440.0f, false);
+    auto source = scene->CreateComponent<SoundSource>();
+    source->SetPanning(0.5f);
+    source->SetGain(0.25f);
+    source->Play(sound);
+
+    // Plain scalar mix of single mono source: the same float operations as the engine without SIMD
+    const auto* data = reinterpret_cast<const short*>(sound->GetStart());
+    const auto mixReference = [&](unsigned offset, unsigned numSamples, float previousGain, float gain)
+    {
+        const float panGains[] = {1.0f - 0.5f, 1.0f + 0.5f};
+        ea::vector<short> output(numSamples * 2);
+        for (unsigned channel = 0; channel < 2; ++channel)
+        {
+            const float channelPreviousGain = panGains[channel] * previousGain;
+            const float gainStep = (panGains[channel] * gain - channelPreviousGain) / numSamples;
+            for (unsigned i = 0; i < numSamples; ++i)
+            {
+                const float sample = data[offset + i] * (1.0f / 32768.0f);
+                const float value = 0.0f + sample * (channelPreviousGain + static_cast<float>(i) * gainStep);
+                output[i * 2 + channel] = static_cast<short>(lrintf(Clamp(value * 32768.0f, -32768.0f, 32767.0f)));
+            }
+        }
+        return output;
+    };
+
+    // Less than one mix fragment, so gain is ramped over the whole call
+    const unsigned numSamples = 1000;
+    ea::vector<short> output(numSamples * 2);
+
+    audio->MixOutput(output.data(), numSamples);
+    REQUIRE(output == mixReference(0, numSamples, 0.25f, 0.25f));
+
+    source->SetGain(0.75f);
+    audio->MixOutput(output.data(), numSamples);
+    REQUIRE(output == mixReference(numSamples, numSamples, 0.25f, 0.75f));
+
+    audio->Close();
+}
+
+TEST_CASE("Audio keeps only most important sound sources real")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto audio = context->GetSubsystem<Audio>();
+    REQUIRE(audio->SetOfflineMode(mixRate, SPK_STEREO));
+    audio->SetMaxRealVoices(3);
+    audio->SetSoundTypePriority(SOUND_VOICE, 1);
+
+    auto scene = MakeShared<Scene>(context);
+    auto sound = CreateSineSound(context, mixRate, 440.0f, false);
+
+    ea::vector<SharedPtr<SoundSource>> sources;
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        auto source = scene->CreateChild()->CreateComponent<SoundSource>();
+        source->Play(sound);
+        source->SetGain(0.05f * (i + 1));
+        sources.emplace_back(source);
+    }
+    sources[0]->SetSoundType(SOUND_VOICE);
+    sources[1]->SetGain(0.0f);
+
+    audio->Update(0.0f);
+    REQUIRE(audio->GetNumRealVoices() == 3);
+    REQUIRE(audio->GetNumVirtualVoices() == 7);
+    for (unsigned i = 0; i < 10; ++i)
+        REQUIRE(sources[i]->IsVirtual() == !(i == 0 || i == 8 || i == 9));
+
+    // Virtual sound sources keep playing
+    const auto* position = sources[5]->GetPlayPosition();
+    ea::vector<short> output(1000 * 2);
+    audio->MixOutput(output.data(), 1000);
+    REQUIRE(sources[5]->GetPlayPosition() == position + 1000 * sizeof(short));
+
+    // Virtual sound source becomes real when it is more important
+    sources[5]->SetGain(1.0f);
+    audio->Update(0.0f);
+    REQUIRE(!sources[5]->IsVirtual());
+    REQUIRE(sources[8]->IsVirtual());
+
+    audio->SetMaxRealVoices(0);
+    audio->SetSoundTypePriority(SOUND_VOICE, 0);
+    audio->Close();
+}
+
+TEST_CASE("Audio does not count sound sources in paused scenes as voices")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto audio = context->GetSubsystem<Audio>();
+    REQUIRE(audio->SetOfflineMode(mixRate, SPK_STEREO));
+    audio->SetMaxRealVoices(2);
+
+    auto activeScene = MakeShared<Scene>(context);
+    auto pausedScene = MakeShared<Scene>(context);
+    pausedScene->SetUpdateEnabled(false);
+    auto sound = CreateSineSound(context, mixRate, 440.0f, false);
+
+    ea::vector<SharedPtr<SoundSource>> activeSources;
+    ea::vector<SharedPtr<SoundSource>> pausedSources;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        auto activeSource = activeScene->CreateChild()->CreateComponent<SoundSource>();
+        activeSource->Play(sound);
+        activeSource->SetGain(0.1f);
+        activeSources.emplace_back(activeSource);
+
+        // Louder sources in paused scene must not steal voice slots
+        auto pausedSource = pausedScene->CreateChild()->CreateComponent<SoundSource>();
+        pausedSource->Play(sound);
+        pausedSource->SetGain(1.0f);
+        pausedSources.emplace_back(pausedSource);
+    }
+
+    audio->Update(0.0f);
+    REQUIRE(audio->GetNumRealVoices() == 2);
+    REQUIRE(audio->GetNumVirtualVoices() == 0);
+    for (SoundSource* source : activeSources)
+        REQUIRE(!source->IsVirtual());
+
+    // Sound source that ignores scene time scale is counted even in paused scene
+    pausedSources[0]->SetIgnoreSceneTimeScale(true);
+    audio->Update(0.0f);
+    REQUIRE(audio->GetNumRealVoices() == 2);
+    REQUIRE(audio->GetNumVirtualVoices() == 1);
+    REQUIRE(!pausedSources[0]->IsVirtual());
+
+    // Sound sources are counted again when scene is resumed
+    pausedScene->SetUpdateEnabled(true);
+    audio->Update(0.0f);
+    REQUIRE(audio->GetNumRealVoices() == 2);
+    REQUIRE(audio->GetNumVirtualVoices() == 2);
+    for (SoundSource* source : pausedSources)
+        REQUIRE(!source->IsVirtual());
+    for (SoundSource* source : activeSources)
+        REQUIRE(source->IsVirtual());
+
+    audio->SetMaxRealVoices(0);
+    audio->Close();
+}
+
+TEST_CASE("Offline audio mixing benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto audio = context->GetSubsystem<Audio>();
+    REQUIRE(audio->SetOfflineMode(mixRate, SPK_STEREO));
+
+    const unsigned numSamples = 4096;
+    ea::vector<short> output(numSamples * 2);
+    for (unsigned numSources : {50u, 200u, 500u})
+    {
+        auto scene = MakeShared<Scene>(context);
+        const auto sources = CreateSoundSources(scene, numSources);
+
+        BENCHMARK(Format("Mix {} sources", numSources).c_str())
+        {
+            audio->MixOutput(output.data(), numSamples);
+            return output[0];
+        };
+    }
+
+    audio->Close();
+}
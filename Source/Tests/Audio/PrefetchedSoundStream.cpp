@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Audio/PrefetchedSoundStream.h>
+#include <Urho3D/Core/Timer.h>
+
+namespace
+{
+
+/// Stream of 16-bit mono samples 1, 2, 3... up to the specified count.
+class CountingSoundStream : public SoundStream
+{
+public:
+    explicit CountingSoundStream(unsigned numSamples)
+        : numSamples_(numSamples)
+    {
+        SetFormat(44100, true, false);
+        SetStopAtEnd(true);
+    }
+
+    bool Seek(unsigned sampleNumber) override
+    {
+        nextSample_ = Min(sampleNumber, numSamples_);
+        return true;
+    }
+
+    unsigned GetData(signed char* dest, unsigned numBytes) override
+    {
+        auto* samples = reinterpret_cast<short*>(dest);
+        const unsigned count = Min(numBytes / 2, numSamples_ - nextSample_);
+        for (unsigned i = 0; i < count; ++i)
+            samples[i] = static_cast<short>(++nextSample_ % 30000);
+        return count * 2;
+    }
+
+    bool IsPrefetchable() const override { return true; }
+
+private:
+    unsigned numSamples_{};
+    unsigned nextSample_{};
+};
+
+ea::vector<short> ReadSamples(SoundStream* stream, unsigned numSamples)
+{
+    ea::vector<short> result(numSamples);
+    const unsigned numBytes = stream->GetData(reinterpret_cast<signed char*>(result.data()), numSamples * 2);
+    result.resize(numBytes / 2);
+    return result;
+}
+
+}
+
+TEST_CASE("Prefetched sound stream returns source data in order")
+{
+    auto stream = MakeShared<PrefetchedSoundStream>(new CountingSoundStream(10000), 4096);
+    stream->Decode();
+    REQUIRE(stream->GetNumBufferedBytes() == 4096);
+
+    unsigned expectedSample = 1;
+    while (true)
+    {
+        const auto samples = ReadSamples(stream, 700);
+        if (samples.empty())
+            break;
+
+        for (short sample : samples)
+            REQUIRE(sample == static_cast<short>(expectedSample++));
+        stream->Decode();
+    }
+
+    REQUIRE(expectedSample == 10001);
+    REQUIRE(stream->IsFinished());
+    REQUIRE(stream->GetNumUnderruns() == 0);
+}
+
+TEST_CASE("Prefetched sound stream plays silence on underrun and discards data on seek")
+{
+    auto stream = MakeShared<PrefetchedSoundStream>(new CountingSoundStream(10000), 1024);
+    stream->Decode();
+
+    const auto samples = ReadSamples(stream, 1000);
+    REQUIRE(samples.size() == 1000);
+    REQUIRE(samples[511] == 512);
+    REQUIRE(samples[512] == 0);
+    REQUIRE(stream->GetNumUnderruns() == 1);
+
+    stream->Decode();
+    REQUIRE(stream->Seek(5000));
+    stream->Decode();
+    REQUIRE(ReadSamples(stream, 1)[0] == 5001);
+}
+
+#ifdef URHO3D_THREADING
+TEST_CASE("Sound stream decoder thread fills prefetched streams")
+{
+    auto stream = MakeShared<PrefetchedSoundStream>(new CountingSoundStream(20000), 2048);
+
+    SoundStreamDecoder decoder(1);
+    decoder.AddStream(stream);
+    decoder.Run();
+
+    unsigned expectedSample = 1;
+    while (expectedSample <= 20000)
+    {
+        const auto samples = ReadSamples(stream, 256);
+        if (samples.empty())
+            break;
+
+        for (short sample : samples)
+        {
+            // Silence is produced on underrun
+            if (sample != 0)
+                REQUIRE(sample == static_cast<short>(expectedSample++));
+        }
+        Time::Sleep(0);
+    }
+
+    decoder.Stop();
+    REQUIRE(expectedSample == 20001);
+}
+#endif
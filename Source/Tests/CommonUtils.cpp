@@ -105,6 +105,15 @@ void RunFrame(Context* context, float timeStep, float maxTimeStep)
     while (timeStep > 0.0f);
 }
 
+ea::vector<unsigned> GetThreadCountsUpTo(unsigned maxThreads)
+{
+    ea::vector<unsigned> result;
+    for (unsigned numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+        result.push_back(numThreads);
+    result.push_back(ea::max(1u, maxThreads));
+    return result;
+}
+
 Resource* GetOrCreateResource(
     Context* context, StringHash type, const ea::string& name, ea::function<SharedPtr<Resource>(Context*)> factory)
 {
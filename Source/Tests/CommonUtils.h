@@ -61,6 +61,9 @@ SharedPtr<Context> CreateCompleteContext();
 /// Run frame with given time step.
 void RunFrame(Context* context, float timeStep, float maxTimeStep = M_LARGE_VALUE);
 
+/// Return powers of two below given number of threads followed by the number itself.
+ea::vector<unsigned> GetThreadCountsUpTo(unsigned maxThreads);
+
 /// Return resource by name. Creates and adds manual resource if missing.
 Resource* GetOrCreateResource(
     Context* context, StringHash type, const ea::string& name, ea::function<SharedPtr<Resource>(Context*)> factory);
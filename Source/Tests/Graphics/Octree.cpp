@@ -0,0 +1,525 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+/// Drawable with fixed world bounding box and no node.
+class BoxDrawable : public Drawable
+{
+public:
+    BoxDrawable(Context* context, const BoundingBox& box, unsigned viewMask)
+        : Drawable(context, DRAWABLE_GEOMETRY)
+        , box_(box)
+    {
+        worldBoundingBox_ = box;
+        worldBoundingBoxDirty_ = false;
+        viewMask_ = viewMask;
+    }
+
+    /// Change bounding box and queue octree update.
+    void SetBox(const BoundingBox& box)
+    {
+        box_ = box;
+        worldBoundingBoxDirty_ = true;
+        MarkForUpdate();
+    }
+
+protected:
+    void OnWorldBoundingBoxUpdate() override { worldBoundingBox_ = box_; }
+
+private:
+    BoundingBox box_;
+};
+
+struct BoxDrawableArray
+{
+    ea::vector<SharedPtr<BoxDrawable>> owners_;
+    ea::vector<Drawable*> drawables_;
+    DrawableBoundsArray bounds_;
+};
+
+BoxDrawableArray CreateBoxDrawables(Context* context, unsigned numBoxes, float range)
+{
+    BoxDrawableArray result;
+    for (unsigned i = 0; i < numBoxes; ++i)
+    {
+        const Vector3 center{Random(-range, range), Random(-range, range), Random(-range, range)};
+        const Vector3 halfSize = Vector3::ONE * Random(0.05f, 2.0f);
+        const unsigned viewMask = i % 7 == 0 ? 0x2 : 0x1;
+        auto drawable = MakeShared<BoxDrawable>(context, BoundingBox(center - halfSize, center + halfSize), viewMask);
+
+        result.owners_.push_back(drawable);
+        result.drawables_.push_back(drawable);
+        result.bounds_.Add(drawable);
+    }
+    return result;
+}
+
+Frustum CreateTestFrustum(float farZ)
+{
+    Frustum frustum;
+    frustum.Define(60.0f, 1.5f, 1.0f, 0.1f, farZ, Matrix3x4(Vector3::ZERO, Quaternion(20.0f, 30.0f, 0.0f), 1.0f));
+    return frustum;
+}
+
+SharedPtr<Model> CreateBoxModel(Context* context)
+{
+    auto model = MakeShared<Model>(context);
+    model->SetBoundingBox(BoundingBox(-0.5f, 0.5f));
+    return model;
+}
+
+ea::vector<Node*> CreateBoxes(Scene* scene, Model* model, unsigned numBoxes, float range)
+{
+    ea::vector<Node*> nodes;
+    for (unsigned i = 0; i < numBoxes; ++i)
+    {
+        Node* node = scene->CreateChild("Box");
+        node->SetPosition(Vector3{Random(-range, range), Random(-range, range), Random(-range, range)});
+        node->SetScale(Random(0.1f, 4.0f));
+        auto staticModel = node->CreateComponent<StaticModel>();
+        staticModel->SetModel(model);
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+void MoveBoxes(const ea::vector<Node*>& nodes, float distance, float range)
+{
+    for (Node* node : nodes)
+    {
+        const Vector3 offset{Random(-distance, distance), Random(-distance, distance), Random(-distance, distance)};
+        node->SetPosition(VectorMin(VectorMax(node->GetPosition() + offset, Vector3::ONE * -range), Vector3::ONE * range));
+    }
+}
+
+ea::vector<Drawable*> QueryBox(Octree* octree, const BoundingBox& box)
+{
+    ea::vector<Drawable*> result;
+    BoxOctreeQuery query(result, box);
+    octree->GetDrawables(query);
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+ea::vector<Drawable*> QueryBoxBruteForce(Octree* octree, const BoundingBox& box)
+{
+    ea::vector<Drawable*> result;
+    for (Drawable* drawable : octree->GetAllDrawables())
+    {
+        if (box.IsInsideFast(drawable->GetWorldBoundingBox()) != OUTSIDE)
+            result.push_back(drawable);
+    }
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+ea::vector<Drawable*> QueryFrustum(Octree* octree, const Frustum& frustum)
+{
+    ea::vector<Drawable*> result;
+    FrustumOctreeQuery query(result, frustum);
+    octree->GetDrawables(query);
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+ea::vector<Drawable*> QueryFrustumBruteForce(Octree* octree, const Frustum& frustum)
+{
+    ea::vector<Drawable*> result;
+    for (Drawable* drawable : octree->GetAllDrawables())
+    {
+        if (frustum.IsInsideFast(drawable->GetWorldBoundingBox()) != OUTSIDE)
+            result.push_back(drawable);
+    }
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+ea::vector<Drawable*> QueryRay(Octree* octree, const Ray& ray, float maxDistance)
+{
+    ea::vector<RayQueryResult> queryResult;
+    RayOctreeQuery query(queryResult, ray, RAY_AABB, maxDistance);
+    octree->Raycast(query);
+
+    ea::vector<Drawable*> result;
+    for (const RayQueryResult& item : queryResult)
+        result.push_back(item.drawable_);
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+ea::vector<Drawable*> QueryRayBruteForce(Octree* octree, const Ray& ray, float maxDistance)
+{
+    ea::vector<Drawable*> result;
+    for (Drawable* drawable : octree->GetAllDrawables())
+    {
+        if (ray.HitDistance(drawable->GetWorldBoundingBox()) < maxDistance)
+            result.push_back(drawable);
+    }
+    ea::sort(result.begin(), result.end());
+    return result;
+}
+
+Ray CreateRandomRay(float range)
+{
+    const Vector3 origin{Random(-range, range), Random(-range, range), Random(-range, range)};
+    const Vector3 direction{Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f)};
+    return Ray(origin, direction.Normalized());
+}
+
+void CheckQueries(Octree* octree, float range)
+{
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        const Vector3 center{Random(-range, range), Random(-range, range), Random(-range, range)};
+        const BoundingBox box{center - Vector3::ONE * 20.0f, center + Vector3::ONE * 20.0f};
+        REQUIRE(QueryBox(octree, box) == QueryBoxBruteForce(octree, box));
+
+        const Ray ray = CreateRandomRay(range);
+        REQUIRE(QueryRay(octree, ray, 100.0f) == QueryRayBruteForce(octree, ray, 100.0f));
+    }
+
+    const Frustum frustum = CreateTestFrustum(range);
+    REQUIRE(QueryFrustum(octree, frustum) == QueryFrustumBruteForce(octree, frustum));
+}
+
+}
+
+TEST_CASE("Octree keeps drawables in correct octants after batched reinsertion")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SetRandomSeed(1);
+
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->CreateComponent<Octree>();
+    octree->SetSize(BoundingBox(-100.0f, 100.0f), 8);
+
+    auto model = CreateBoxModel(context);
+    const auto nodes = CreateBoxes(scene, model, 2000, 90.0f);
+
+    FrameInfo frameInfo;
+    octree->Update(frameInfo);
+    REQUIRE(octree->GetRootOctant()->GetNumDrawables() == nodes.size());
+
+    for (unsigned frame = 0; frame < 10; ++frame)
+    {
+        // Move boxes both a little and far away to move them between octants of different levels
+        MoveBoxes(nodes, frame % 2 == 0 ? 1.0f : 50.0f, 95.0f);
+        octree->Update(frameInfo);
+        REQUIRE(octree->GetRootOctant()->GetNumDrawables() == nodes.size());
+
+        for (Drawable* drawable : octree->GetAllDrawables())
+        {
+            const Octant* octant = drawable->GetOctant();
+            REQUIRE(octant);
+            REQUIRE(octant->GetOctree() == octree);
+            if (octant != octree->GetRootOctant())
+                REQUIRE(octant->GetCullingBox().IsInside(drawable->GetWorldBoundingBox()) == INSIDE);
+        }
+
+        for (unsigned i = 0; i < 10; ++i)
+        {
+            const Vector3 center{Random(-100.0f, 100.0f), Random(-100.0f, 100.0f), Random(-100.0f, 100.0f)};
+            const BoundingBox box{center - Vector3::ONE * 20.0f, center + Vector3::ONE * 20.0f};
+            REQUIRE(QueryBox(octree, box) == QueryBoxBruteForce(octree, box));
+        }
+    }
+}
+
+TEST_CASE("Octree reinsertion benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SetRandomSeed(1);
+
+    auto model = CreateBoxModel(context);
+    for (unsigned numBoxes : {10000u, 100000u})
+    {
+        auto scene = MakeShared<Scene>(context);
+        auto octree = scene->CreateComponent<Octree>();
+        octree->SetSize(BoundingBox(-1000.0f, 1000.0f), 8);
+
+        const auto nodes = CreateBoxes(scene, model, numBoxes, 900.0f);
+
+        FrameInfo frameInfo;
+        octree->Update(frameInfo);
+
+        BENCHMARK(Format("Move {} drawables per frame", numBoxes).c_str())
+        {
+            MoveBoxes(nodes, 20.0f, 950.0f);
+            octree->Update(frameInfo);
+            return octree->GetRootOctant()->GetNumDrawables();
+        };
+    }
+}
+
+TEST_CASE("Octree batch culling matches per-drawable culling")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SetRandomSeed(1);
+
+    auto boxes = CreateBoxDrawables(context, 1003, 50.0f);
+    Drawable** start = boxes.drawables_.data();
+    Drawable** end = start + boxes.drawables_.size();
+
+    for (unsigned viewMask : {0x1u, 0x2u, 0x3u})
+    {
+        ea::vector<Drawable*> expected;
+        ea::vector<Drawable*> actual;
+
+        FrustumOctreeQuery expectedFrustumQuery(expected, CreateTestFrustum(40.0f), DRAWABLE_GEOMETRY, viewMask);
+        FrustumOctreeQuery actualFrustumQuery(actual, CreateTestFrustum(40.0f), DRAWABLE_GEOMETRY, viewMask);
+        expectedFrustumQuery.TestDrawables(start, end, false);
+        actualFrustumQuery.TestDrawableBounds(start, boxes.bounds_, false);
+        REQUIRE(!expected.empty());
+        REQUIRE(actual == expected);
+
+        expected.clear();
+        actual.clear();
+
+        const BoundingBox box{Vector3(-10.0f, -20.0f, -30.0f), Vector3(30.0f, 20.0f, 10.0f)};
+        BoxOctreeQuery expectedBoxQuery(expected, box, DRAWABLE_GEOMETRY, viewMask);
+        BoxOctreeQuery actualBoxQuery(actual, box, DRAWABLE_GEOMETRY, viewMask);
+        expectedBoxQuery.TestDrawables(start, end, false);
+        actualBoxQuery.TestDrawableBounds(start, boxes.bounds_, false);
+        REQUIRE(!expected.empty());
+        REQUIRE(actual == expected);
+    }
+}
+
+TEST_CASE("Octree batch culling sees bounds changed before and after octree update")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SetRandomSeed(1);
+
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->CreateComponent<Octree>();
+
+    auto boxes = CreateBoxDrawables(context, 1000, 50.0f);
+    for (BoxDrawable* drawable : boxes.owners_)
+        octree->AddManualDrawable(drawable);
+    CheckQueries(octree, 50.0f);
+
+    FrameInfo frameInfo;
+    octree->Update(frameInfo);
+    REQUIRE_FALSE(octree->HasPendingUpdates());
+    CheckQueries(octree, 50.0f);
+
+    // Shrink boxes and recalculate them before octree update, copy of bounds in octants is stale now
+    for (unsigned i = 0; i < boxes.owners_.size(); i += 2)
+    {
+        BoxDrawable* drawable = boxes.owners_[i];
+        const BoundingBox box = drawable->GetWorldBoundingBox();
+        drawable->SetBox(BoundingBox(box.Center() - box.HalfSize() * 0.25f, box.Center() + box.HalfSize() * 0.25f));
+        drawable->GetWorldBoundingBox();
+    }
+    REQUIRE(octree->HasPendingUpdates());
+    CheckQueries(octree, 50.0f);
+
+    octree->Update(frameInfo);
+    REQUIRE_FALSE(octree->HasPendingUpdates());
+    CheckQueries(octree, 50.0f);
+
+    // Remove drawables from the middle of octants
+    for (unsigned i = 0; i < boxes.owners_.size(); i += 3)
+        octree->RemoveManualDrawable(boxes.owners_[i]);
+    REQUIRE(octree->GetRootOctant()->GetNumDrawables() == octree->GetAllDrawables().size());
+    CheckQueries(octree, 50.0f);
+}
+
+TEST_CASE("Octree batch culling benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SetRandomSeed(1);
+
+    const Frustum frustum = CreateTestFrustum(500.0f);
+    for (unsigned numBoxes : {10000u, 100000u, 1000000u})
+    {
+        auto boxes = CreateBoxDrawables(context, numBoxes, 1000.0f);
+        Drawable** start = boxes.drawables_.data();
+        Drawable** end = start + boxes.drawables_.size();
+
+        ea::vector<Drawable*> result;
+        result.reserve(numBoxes);
+
+        BENCHMARK(Format("Cull {} drawables one by one", numBoxes).c_str())
+        {
+            result.clear();
+            FrustumOctreeQuery query(result, frustum);
+            query.TestDrawables(start, end, false);
+            return result.size();
+        };
+
+        BENCHMARK(Format("Cull {} drawables in batches", numBoxes).c_str())
+        {
+            result.clear();
+            FrustumOctreeQuery query(result, frustum);
+            query.TestDrawableBounds(start, boxes.bounds_, false);
+            return result.size();
+        };
+    }
+}
+
+TEST_CASE("Octree with dynamic tree spatial index returns same drawables as brute force search")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SetRandomSeed(1);
+
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->CreateComponent<Octree>();
+    octree->SetSpatialIndexType(SpatialIndexType::DynamicTree);
+
+    auto model = CreateBoxModel(context);
+    auto nodes = CreateBoxes(scene, model, 2000, 90.0f);
+
+    FrameInfo frameInfo;
+    octree->Update(frameInfo);
+    REQUIRE(octree->GetDrawableTree().GetNumDrawables() == nodes.size());
+    CheckQueries(octree, 100.0f);
+
+    for (unsigned frame = 0; frame < 10; ++frame)
+    {
+        MoveBoxes(nodes, frame % 2 == 0 ? 0.1f : 50.0f, 95.0f);
+        octree->Update(frameInfo);
+        CheckQueries(octree, 100.0f);
+    }
+
+    // Balanced tree for 2000 drawables should be much shallower than this
+    REQUIRE(octree->GetDrawableTree().GetHeight() < 32);
+
+    // Remove some drawables
+    for (unsigned i = 0; i < 500; ++i)
+        nodes[i]->Remove();
+    nodes.erase(nodes.begin(), nodes.begin() + 500);
+    octree->Update(frameInfo);
+    REQUIRE(octree->GetDrawableTree().GetNumDrawables() == nodes.size());
+    CheckQueries(octree, 100.0f);
+
+    // Switch back and forth
+    octree->SetSpatialIndexType(SpatialIndexType::Octree);
+    octree->Update(frameInfo);
+    REQUIRE(octree->GetDrawableTree().GetNumDrawables() == 0);
+    REQUIRE(octree->GetRootOctant()->GetNumDrawables() == nodes.size());
+    CheckQueries(octree, 100.0f);
+
+    octree->SetSpatialIndexType(SpatialIndexType::DynamicTree);
+    octree->Update(frameInfo);
+    REQUIRE(octree->GetDrawableTree().GetNumDrawables() == nodes.size());
+    REQUIRE(octree->GetRootOctant()->GetNumDrawables() == 0);
+    CheckQueries(octree, 100.0f);
+}
+
+TEST_CASE("Dynamic tree keeps leaf while drawable moves within margin")
+{
+    DrawableTree tree;
+    tree.SetMargin(1.0f);
+
+    const BoundingBox box{Vector3::ZERO, Vector3::ONE};
+    const unsigned leaf = tree.AddDrawable(nullptr, box);
+    const BoundingBox leafBox = tree.GetLeafBoundingBox(leaf);
+    REQUIRE(leafBox.min_ == Vector3::ONE * -1.0f);
+    REQUIRE(leafBox.max_ == Vector3::ONE * 2.0f);
+
+    // Small moves stay inside the enlarged leaf box
+    for (const Vector3& offset : {Vector3{0.5f, 0, 0}, Vector3{-0.9f, 0.9f, 0}, Vector3{0, 0, 1.0f}})
+    {
+        const BoundingBox movedBox{box.min_ + offset, box.max_ + offset};
+        CHECK_FALSE(tree.IsMoveNeeded(leaf, movedBox));
+    }
+    REQUIRE(tree.GetLeafBoundingBox(leaf).min_ == leafBox.min_);
+
+    // Move past the margin requires reinsertion
+    const BoundingBox farBox{box.min_ + Vector3{1.5f, 0, 0}, box.max_ + Vector3{1.5f, 0, 0}};
+    REQUIRE(tree.IsMoveNeeded(leaf, farBox));
+    const unsigned newLeaf = tree.MoveDrawable(leaf, farBox);
+    CHECK(tree.GetLeafBoundingBox(newLeaf).min_ == Vector3{0.5f, -1.0f, -1.0f});
+    CHECK_FALSE(tree.IsMoveNeeded(newLeaf, farBox));
+
+    // Leaf box that is too loose for shrunk drawable requires reinsertion too
+    const BoundingBox smallBox{Vector3{1.5f, 0, 0}, Vector3{1.6f, 0.1f, 0.1f}};
+    CHECK_FALSE(tree.IsMoveNeeded(newLeaf, smallBox));
+    tree.SetMargin(0.1f);
+    CHECK(tree.IsMoveNeeded(newLeaf, smallBox));
+}
+
+TEST_CASE("Octree spatial index benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto model = CreateBoxModel(context);
+
+    for (SpatialIndexType type : {SpatialIndexType::Octree, SpatialIndexType::DynamicTree})
+    {
+        const char* typeName = type == SpatialIndexType::Octree ? "octree" : "dynamic tree";
+        for (unsigned numBoxes : {10000u, 100000u})
+        {
+            SetRandomSeed(1);
+
+            auto scene = MakeShared<Scene>(context);
+            auto octree = scene->CreateComponent<Octree>();
+            octree->SetSize(BoundingBox(-1000.0f, 1000.0f), 8);
+            octree->SetSpatialIndexType(type);
+
+            FrameInfo frameInfo;
+            ea::vector<Node*> nodes;
+            BENCHMARK(Format("Insert {} drawables into {}", numBoxes, typeName).c_str())
+            {
+                scene->RemoveAllChildren();
+                nodes = CreateBoxes(scene, model, numBoxes, 900.0f);
+                octree->Update(frameInfo);
+                return octree->GetAllDrawables().size();
+            };
+
+            BENCHMARK(Format("Move {} drawables in {}", numBoxes, typeName).c_str())
+            {
+                MoveBoxes(nodes, 1.0f, 950.0f);
+                octree->Update(frameInfo);
+                return octree->GetAllDrawables().size();
+            };
+
+            const Frustum frustum = CreateTestFrustum(500.0f);
+            ea::vector<Drawable*> result;
+            BENCHMARK(Format("Query frustum of {} drawables in {}", numBoxes, typeName).c_str())
+            {
+                FrustumOctreeQuery query(result, frustum);
+                octree->GetDrawables(query);
+                return result.size();
+            };
+
+            const Ray ray = CreateRandomRay(900.0f);
+            ea::vector<RayQueryResult> rayResult;
+            BENCHMARK(Format("Raycast {} drawables in {}", numBoxes, typeName).c_str())
+            {
+                RayOctreeQuery query(rayResult, ray, RAY_AABB);
+                octree->Raycast(query);
+                return rayResult.size();
+            };
+        }
+    }
+}
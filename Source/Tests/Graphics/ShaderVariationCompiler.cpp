@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/Shader.h>
+#include <Urho3D/Graphics/ShaderVariationCompiler.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/VirtualFileSystem.h>
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+namespace
+{
+
+/// Create minimal context without Graphics, like the one used by ShaderCacheTool.
+SharedPtr<Context> CreateShaderCacheToolContext()
+{
+    auto context = MakeShared<Context>();
+    context->RegisterSubsystem(new FileSystem(context));
+    context->RegisterSubsystem(new VirtualFileSystem(context));
+    context->RegisterSubsystem(new ResourceCache(context));
+    Shader::RegisterObject(context);
+
+    auto fs = context->GetSubsystem<FileSystem>();
+    auto vfs = context->GetSubsystem<VirtualFileSystem>();
+    const ea::string exeDir = GetParentPath(fs->GetProgramFileName());
+    for (const ea::string& prefixPath : {exeDir, GetParentPath(exeDir)})
+    {
+        const ea::string coreDataDir = AddTrailingSlash(prefixPath) + "CoreData";
+        if (fs->DirExists(coreDataDir))
+            vfs->MountDir(coreDataDir);
+    }
+    return context;
+}
+
+}
+
+TEST_CASE("Shader variation cache key depends on source and compilation settings")
+{
+    const ShaderVariationCompiler compiler{RenderBackend::OpenGL, ShaderTranslationPolicy::Verbatim};
+    const ea::string source = "void main() {}\n";
+
+    const ea::string preparedSource = compiler.PrepareSource(VS, "A B", source);
+    const ea::string preparedSourceOtherDefines = compiler.PrepareSource(VS, "A", source);
+    const ea::string preparedSourceOtherType = compiler.PrepareSource(PS, "A B", source);
+
+    REQUIRE(preparedSource.find(source) != ea::string::npos);
+    REQUIRE(preparedSource != preparedSourceOtherDefines);
+    REQUIRE(preparedSource != preparedSourceOtherType);
+
+    const unsigned long long hash = compiler.GetContentHash(preparedSource);
+    REQUIRE(hash == compiler.GetContentHash(compiler.PrepareSource(VS, "A B", source)));
+    REQUIRE(hash != compiler.GetContentHash(preparedSourceOtherDefines));
+    REQUIRE(hash != compiler.GetContentHash(preparedSourceOtherType));
+
+    const ShaderVariationCompiler otherCompiler{RenderBackend::Vulkan, ShaderTranslationPolicy::Translate};
+    REQUIRE(hash != otherCompiler.GetContentHash(preparedSource));
+
+    const ea::string fileName = compiler.GetCachedFileName("/v2/M_Litsolid", VS, hash, "bytecode");
+    REQUIRE(fileName.starts_with("/v2/M_Litsolid_"));
+    REQUIRE(fileName.ends_with(".bytecode"));
+    REQUIRE(fileName != compiler.GetCachedFileName("/v2/M_Litsolid", VS, hash + 1, "bytecode"));
+}
+
+TEST_CASE("Shader warmup list is serialized")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const ea::vector<ShaderVariationDesc> shaders{
+        {VS, "Shaders/GLSL/v2/M_LitSolid.glsl", "OBJECTSPACE PIXEL_LIGHTING"},
+        {PS, "Shaders/GLSL/v2/M_LitSolid.glsl", "PIXEL_LIGHTING"},
+    };
+
+    auto jsonFile = MakeShared<JSONFile>(context);
+    REQUIRE(jsonFile->SaveObject("shaders", shaders));
+
+    ea::vector<ShaderVariationDesc> loadedShaders;
+    REQUIRE(jsonFile->LoadObject("shaders", loadedShaders));
+    REQUIRE(loadedShaders == shaders);
+}
+
+TEST_CASE("Shader variation prepared by ShaderCacheTool matches runtime")
+{
+    const ShaderVariationDesc desc{VS, "Shaders/GLSL/v2/LitSolid.glsl", "PIXEL_LIGHTING"};
+    const ShaderVariationCompiler compiler{RenderBackend::Vulkan, ShaderTranslationPolicy::Translate};
+
+    // Same steps as both ShaderVariation and ShaderCacheTool use to locate cached bytecode
+    const auto prepareSource = [&](Context* context)
+    {
+        auto cache = context->GetSubsystem<ResourceCache>();
+        auto shader = cache->GetResource<Shader>(desc.shaderName_);
+        REQUIRE(shader);
+        return compiler.PrepareSource(desc.type_, desc.defines_, shader->GetSourceCode());
+    };
+
+    const ea::string runtimeSource = prepareSource(Tests::GetOrCreateContext(Tests::CreateCompleteContext));
+    const ea::string offlineSource = prepareSource(Tests::GetOrCreateContext(CreateShaderCacheToolContext));
+    REQUIRE(offlineSource == runtimeSource);
+    REQUIRE(compiler.GetContentHash(offlineSource) == compiler.GetContentHash(runtimeSource));
+
+    // Comment lines are trimmed regardless of Graphics settings, only file markers remain
+    for (const ea::string& line : offlineSource.split('\n'))
+    {
+        const ea::string trimmedLine = line.trimmed();
+        if (trimmedLine.starts_with("//"))
+            REQUIRE(trimmedLine.starts_with("/// #include "));
+    }
+
+    Tests::ResetContext();
+}
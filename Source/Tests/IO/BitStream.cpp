@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/IO/BitStream.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+
+TEST_CASE("BitWriter and BitReader round trip values of arbitrary width")
+{
+    VectorBuffer buffer;
+    {
+        BitWriter writer{buffer};
+        writer.WriteBool(true);
+        writer.WriteBits(5, 3);
+        writer.WriteBits(0xdeadbeef, 32);
+        writer.WriteSignedBits(-7, 5);
+        writer.WriteBits(0, 0);
+        writer.WriteBool(false);
+        writer.Flush();
+
+        REQUIRE(writer.GetNumBitsWritten() == 1 + 3 + 32 + 5 + 1);
+    }
+    REQUIRE(buffer.GetSize() == 6);
+
+    // Trailing data is not consumed by the reader
+    buffer.WriteUByte(0x42);
+
+    MemoryBuffer src{buffer.GetBuffer()};
+    BitReader reader{src};
+    REQUIRE(reader.ReadBool() == true);
+    REQUIRE(reader.ReadBits(3) == 5);
+    REQUIRE(reader.ReadBits(32) == 0xdeadbeef);
+    REQUIRE(reader.ReadSignedBits(5) == -7);
+    REQUIRE(reader.ReadBits(0) == 0);
+    REQUIRE(reader.ReadBool() == false);
+    REQUIRE(src.ReadUByte() == 0x42);
+}
+
+TEST_CASE("BitWriter stores small values with variable width")
+{
+    const unsigned unsignedValues[] = {0, 1, 2, 3, 100, 65535, 0x7fffffff, 0xffffffff};
+    const int signedValues[] = {0, -1, 1, -2, 1000, -1000, M_MAX_INT, M_MIN_INT};
+
+    VectorBuffer buffer;
+    {
+        BitWriter writer{buffer};
+        for (unsigned value : unsignedValues)
+            writer.WriteVarBits(value);
+        for (int value : signedValues)
+            writer.WriteSignedVarBits(value);
+        writer.Flush();
+    }
+
+    MemoryBuffer src{buffer.GetBuffer()};
+    BitReader reader{src};
+    for (unsigned value : unsignedValues)
+        REQUIRE(reader.ReadVarBits() == value);
+    for (int value : signedValues)
+        REQUIRE(reader.ReadSignedVarBits() == value);
+
+    // Zero takes 6 bits, small deltas take few bits
+    VectorBuffer smallBuffer;
+    BitWriter smallWriter{smallBuffer};
+    smallWriter.WriteVarBits(0);
+    REQUIRE(smallWriter.GetNumBitsWritten() == 6);
+    smallWriter.WriteSignedVarBits(-3);
+    REQUIRE(smallWriter.GetNumBitsWritten() == 6 + 5 + 2);
+    smallWriter.Flush();
+}
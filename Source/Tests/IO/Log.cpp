@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/IOEvents.h>
+#include <Urho3D/IO/Log.h>
+
+#include <thread>
+
+TEST_CASE("Log messages from all threads are delivered as events")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto log = context->GetSubsystem<Log>();
+    const Logger logger = Log::GetLogger("LogTest");
+
+    unsigned numMainThreadMessages = 0;
+    unsigned numWorkerThreadMessages = 0;
+    log->SubscribeToEvent(E_LOGMESSAGE, [&](VariantMap& eventData)
+    {
+        if (eventData[LogMessage::P_LOGGER].GetString() != "LogTest")
+            return;
+
+        if (eventData[LogMessage::P_MESSAGE].GetString().starts_with("Main"))
+            ++numMainThreadMessages;
+        else
+            ++numWorkerThreadMessages;
+    });
+
+    // Messages from the main thread are delivered immediately
+    logger.Info("Main thread message");
+    REQUIRE(numMainThreadMessages == 1);
+
+    // All messages fit into the queue even if the writer thread doesn't run, so nothing is dropped
+    const unsigned numThreads = 4;
+    const unsigned numMessagesPerThread = 1000;
+    const unsigned numDroppedMessages = log->GetNumDroppedMessages();
+    ea::vector<std::thread> threads;
+    for (unsigned i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back([&]
+        {
+            for (unsigned j = 0; j < numMessagesPerThread; ++j)
+                logger.Info("Worker thread message {}", j);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // Messages from other threads are delivered at the end of the frame
+    REQUIRE(numWorkerThreadMessages == 0);
+    log->Flush();
+    log->PumpThreadMessages();
+    REQUIRE(log->GetNumDroppedMessages() == numDroppedMessages);
+    REQUIRE(numWorkerThreadMessages == numThreads * numMessagesPerThread);
+
+    log->UnsubscribeFromEvent(E_LOGMESSAGE);
+}
+
+TEST_CASE("Long log messages are delivered intact")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto log = context->GetSubsystem<Log>();
+    const Logger logger = Log::GetLogger("LogTest");
+
+    ea::vector<ea::string> messages;
+    log->SubscribeToEvent(E_LOGMESSAGE, [&](VariantMap& eventData)
+    {
+        if (eventData[LogMessage::P_LOGGER].GetString() == "LogTest")
+            messages.push_back(eventData[LogMessage::P_MESSAGE].GetString());
+    });
+
+    // Long message is written synchronously, but after the messages queued before it
+    const ea::string longMessage(256 * 1024, 'x');
+    std::thread thread([&]
+    {
+        logger.Info("Short message");
+        logger.Info("{}", longMessage);
+        logger.Info("Another short message");
+    });
+    thread.join();
+
+    log->Flush();
+    log->PumpThreadMessages();
+    REQUIRE(messages.size() == 3);
+    CHECK(messages[0].ends_with("Short message"));
+    CHECK(messages[1].ends_with(longMessage));
+    CHECK(messages[2].ends_with("Another short message"));
+
+    log->UnsubscribeFromEvent(E_LOGMESSAGE);
+}
+
+TEST_CASE("Log errors are written to file before returning")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto log = context->GetSubsystem<Log>();
+    auto fileSystem = context->GetSubsystem<FileSystem>();
+    const Logger logger = Log::GetLogger("LogTest");
+
+    const ea::string fileName = fileSystem->GetTemporaryDir() + "LogTest.log";
+    log->Open(fileName);
+
+    const auto readLogFile = [&]
+    {
+        File file(context, fileName, FILE_READ);
+        return file.ReadText();
+    };
+
+    logger.Info("Queued message");
+    logger.Error("Fatal error message");
+    {
+        const ea::string text = readLogFile();
+        CHECK(text.contains("Queued message"));
+        CHECK(text.contains("Fatal error message"));
+    }
+
+    // Messages queued before closing are written too
+    for (unsigned i = 0; i < 100; ++i)
+        logger.Info("Message before close {}", i);
+    log->Close();
+    CHECK(readLogFile().contains("Message before close 99"));
+
+    fileSystem->Delete(fileName);
+}
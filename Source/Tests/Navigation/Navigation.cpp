@@ -29,9 +29,11 @@
 
 #include <Urho3D/Scene/Scene.h>
 #include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/Navigation/CrowdAgent.h>
 #include <Urho3D/Navigation/DynamicNavigationMesh.h>
 #include <Urho3D/Navigation/Navigable.h>
+#include <Urho3D/Navigation/Obstacle.h>
 #include <Urho3D/Physics/CollisionShape.h>
 #include <Urho3D/Physics/RigidBody.h>
 #include <Urho3D/Graphics/Octree.h>
@@ -102,6 +104,30 @@ CrowdAgentTest SpawnCrowdAgent(Vector3 pos, Node* agentsSceneNode, bool isValid)
     return return_agent;
 }
 
+DynamicNavigationMesh* CreateNavigationMeshWithObstacles(Scene* scene, unsigned numObstacles, float updateBudget)
+{
+    auto* navMesh = scene->CreateComponent<DynamicNavigationMesh>();
+    navMesh->SetTileSize(16);
+    navMesh->SetAgentHeight(10.0f);
+    navMesh->SetCellHeight(0.05f);
+    navMesh->SetPadding(Vector3(0.0f, 10.0f, 0.0f));
+    navMesh->SetObstacleUpdateBudget(updateBudget);
+    scene->CreateComponent<Navigable>();
+    navMesh->Rebuild();
+
+    Node* obstacleGroup = scene->CreateChild("Obstacles");
+    for (unsigned i = 0; i < numObstacles; ++i)
+    {
+        Node* obstacleNode = obstacleGroup->CreateChild("Obstacle");
+        obstacleNode->SetPosition(Vector3(Random(60.0f) - 30.0f, 0.0f, Random(60.0f) - 30.0f));
+        auto* obstacle = obstacleNode->CreateComponent<Obstacle>();
+        obstacle->SetRadius(1.0f + Random(2.0f));
+        obstacle->SetHeight(2.0f);
+    }
+
+    return navMesh;
+}
+
 }
 
 
@@ -185,5 +211,200 @@ TEST_CASE("Recast/Detour Crowdmanager test with DynamicNavigationMesh")
 
 }
 
+TEST_CASE("DynamicNavigationMesh tiles built in parallel match tiles built one by one")
+{
+    SetRandomSeed(1);
+
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto scene = CreateTestScene(context, 40);
+
+    auto* navMesh = scene->CreateComponent<DynamicNavigationMesh>();
+    navMesh->SetTileSize(16);
+    navMesh->SetAgentHeight(10.0f);
+    navMesh->SetCellHeight(0.05f);
+    navMesh->SetPadding(Vector3(0.0f, 10.0f, 0.0f));
+    scene->CreateComponent<Navigable>();
+    navMesh->Rebuild();
+
+    const ea::vector<IntVector2> tileIndices = navMesh->GetAllTileIndices();
+    REQUIRE(tileIndices.size() > 1);
+
+    ea::unordered_map<IntVector2, ea::vector<unsigned char>> parallelTileData;
+    for (const IntVector2& tileIndex : tileIndices)
+        parallelTileData[tileIndex] = navMesh->GetTileData(tileIndex);
+
+    // Single tile is always built in the main thread
+    for (const IntVector2& tileIndex : tileIndices)
+        navMesh->BuildTiles(tileIndex, tileIndex);
+
+    for (const IntVector2& tileIndex : tileIndices)
+        CHECK(navMesh->GetTileData(tileIndex) == parallelTileData[tileIndex]);
+}
+
+TEST_CASE("DynamicNavigationMesh applies obstacle changes over several frames with small budget")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    static constexpr unsigned numObstacles = 30;
+
+    SetRandomSeed(1);
+    auto referenceScene = CreateTestScene(context, 20);
+    auto* referenceNavMesh = CreateNavigationMeshWithObstacles(referenceScene, numObstacles, 0.0f);
+
+    SetRandomSeed(1);
+    auto scene = CreateTestScene(context, 20);
+    auto* navMesh = CreateNavigationMeshWithObstacles(scene, numObstacles, 0.001f);
+
+    REQUIRE_FALSE(referenceNavMesh->IsObstacleUpdateComplete());
+    REQUIRE_FALSE(navMesh->IsObstacleUpdateComplete());
+
+    // Unlimited budget applies all changes at once.
+    // Budget smaller than one tile rebuild still rebuilds one batch of tiles per frame.
+    const unsigned batchSize = context->GetSubsystem<WorkQueue>()->GetNumProcessingThreads();
+    Tests::RunFrame(context, 0.02f, 0.02f);
+    CHECK(referenceNavMesh->IsObstacleUpdateComplete());
+    CHECK(referenceNavMesh->GetObstacleUpdateStats().numPendingTiles_ == 0);
+    CHECK(navMesh->GetObstacleUpdateStats().numRebuiltTiles_ > 0);
+    CHECK(navMesh->GetObstacleUpdateStats().numRebuiltTiles_ <= batchSize);
+
+    unsigned numPendingTiles = M_MAX_UNSIGNED;
+    for (unsigned frame = 0; frame < 1000 && !navMesh->IsObstacleUpdateComplete(); ++frame)
+    {
+        const TileCacheUpdateStats& stats = navMesh->GetObstacleUpdateStats();
+        CHECK(stats.numRebuiltTiles_ > 0);
+        CHECK(stats.numRebuiltTiles_ <= batchSize);
+        CHECK(stats.numPendingTiles_ < numPendingTiles);
+        numPendingTiles = stats.numPendingTiles_;
+
+        Tests::RunFrame(context, 0.02f, 0.02f);
+    }
+    REQUIRE(navMesh->IsObstacleUpdateComplete());
+    CHECK(navMesh->GetObstacleUpdateStats().rebuildLatency_ > 0.0f);
+
+    // Resulting navigation meshes should be identical
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const Vector3 start{Random(80.0f) - 40.0f, 0.0f, Random(80.0f) - 40.0f};
+        const Vector3 end{Random(80.0f) - 40.0f, 0.0f, Random(80.0f) - 40.0f};
+
+        ea::vector<Vector3> referencePath;
+        ea::vector<Vector3> path;
+        referenceNavMesh->FindPath(referencePath, start, end);
+        navMesh->FindPath(path, start, end);
+        CHECK(path == referencePath);
+    }
+}
+
+TEST_CASE("DynamicNavigationMesh applies obstacle changes synchronously without update budget")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto isPathStraight = [](DynamicNavigationMesh* navMesh)
+    {
+        ea::vector<Vector3> path;
+        navMesh->FindPath(path, Vector3(-10.0f, 0.0f, 0.0f), Vector3(10.0f, 0.0f, 0.0f));
+        REQUIRE(path.size() >= 2);
+        return path.size() == 2;
+    };
+
+    for (const float updateBudget : {0.0f, 1.0f})
+    {
+        auto scene = CreateTestScene(context, 0);
+        auto* navMesh = CreateNavigationMeshWithObstacles(scene, 0, updateBudget);
+        REQUIRE(navMesh->IsObstacleUpdateComplete());
+        REQUIRE(isPathStraight(navMesh));
+
+        // Change is queued until the next obstacle change or update
+        Node* obstacleNode = scene->CreateChild("Obstacle");
+        auto* obstacle = obstacleNode->CreateComponent<Obstacle>();
+        obstacle->SetRadius(3.0f);
+        obstacle->SetHeight(2.0f);
+        CHECK(isPathStraight(navMesh));
+
+        Node* otherObstacleNode = scene->CreateChild("Obstacle");
+        otherObstacleNode->SetPosition(Vector3(25.0f, 0.0f, 25.0f));
+        otherObstacleNode->CreateComponent<Obstacle>();
+        CHECK(isPathStraight(navMesh) == (updateBudget > 0.0f));
+
+        for (unsigned frame = 0; frame < 100 && !navMesh->IsObstacleUpdateComplete(); ++frame)
+            Tests::RunFrame(context, 0.02f, 0.02f);
+        REQUIRE(navMesh->IsObstacleUpdateComplete());
+        CHECK_FALSE(isPathStraight(navMesh));
+    }
+}
+
+TEST_CASE("NavigationMesh asynchronous path requests match synchronous path search")
+{
+    SetRandomSeed(1);
+
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto scene = CreateTestScene(context, 20);
+
+    auto* navMesh = scene->CreateComponent<DynamicNavigationMesh>();
+    navMesh->SetTileSize(32);
+    navMesh->SetAgentHeight(10.0f);
+    navMesh->SetCellHeight(0.05f);
+    navMesh->SetPadding(Vector3(0.0f, 10.0f, 0.0f));
+    scene->CreateComponent<Navigable>();
+    navMesh->Rebuild();
+
+    // Use small budget so that paths take several updates
+    navMesh->SetPathIterationBudget(8);
+    navMesh->SetMaxActivePathRequests(4);
+
+    static constexpr unsigned numPaths = 16;
+    ea::vector<ea::pair<Vector3, Vector3>> endpoints;
+    for (unsigned i = 0; i < numPaths; ++i)
+    {
+        const Vector3 start{Random(80.0f) - 40.0f, 0.0f, Random(80.0f) - 40.0f};
+        const Vector3 end{Random(80.0f) - 40.0f, 0.0f, Random(80.0f) - 40.0f};
+        endpoints.emplace_back(start, end);
+    }
+
+    ea::unordered_map<unsigned, ea::vector<NavigationPathPoint>> asyncPaths;
+    ea::vector<unsigned> requestIds;
+    for (unsigned i = 0; i < numPaths; ++i)
+    {
+        const auto callback = [&](unsigned requestId, const ea::vector<NavigationPathPoint>& path)
+        {
+            CHECK(asyncPaths.find(requestId) == asyncPaths.end());
+            asyncPaths[requestId] = path;
+        };
+        requestIds.push_back(navMesh->FindPathAsync(endpoints[i].first, endpoints[i].second, callback, i % 3));
+        REQUIRE(requestIds.back() != 0);
+    }
+
+    // Cancelled request should never be reported
+    const unsigned cancelledId = requestIds[5];
+    navMesh->CancelPathRequest(cancelledId);
+    REQUIRE(navMesh->GetNumPathRequests() == numPaths - 1);
+
+    for (unsigned frame = 0; frame < 10000 && navMesh->GetNumPathRequests() > 0; ++frame)
+        navMesh->UpdatePathRequests();
+    REQUIRE(navMesh->GetNumPathRequests() == 0);
+    REQUIRE(asyncPaths.size() == numPaths - 1);
+    CHECK(asyncPaths.find(cancelledId) == asyncPaths.end());
+
+    for (unsigned i = 0; i < numPaths; ++i)
+    {
+        if (requestIds[i] == cancelledId)
+            continue;
+
+        ea::vector<NavigationPathPoint> syncPath;
+        navMesh->FindPath(syncPath, endpoints[i].first, endpoints[i].second);
+
+        const ea::vector<NavigationPathPoint>& asyncPath = asyncPaths[requestIds[i]];
+        REQUIRE(asyncPath.size() == syncPath.size());
+        for (unsigned j = 0; j < syncPath.size(); ++j)
+        {
+            CHECK(asyncPath[j].position_.Equals(syncPath[j].position_));
+            CHECK(asyncPath[j].flag_ == syncPath[j].flag_);
+            CHECK(asyncPath[j].areaID_ == syncPath[j].areaID_);
+        }
+    }
+}
+
 #endif
 #endif
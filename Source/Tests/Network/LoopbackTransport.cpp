@@ -0,0 +1,164 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/Transport/Loopback/LoopbackConnection.h>
+#include <Urho3D/Network/Transport/Loopback/LoopbackServer.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+URHO3D_EVENT(E_LOOPBACKTESTEVENT, LoopbackTestEvent)
+{
+}
+
+}
+
+TEST_CASE("Loopback link parameters are parsed from URL query")
+{
+    const URL url("loopback://localhost:2345?latency=50&jitter=10&loss=0.25&bandwidth=65536&seed=7");
+    const auto parameters = LoopbackLinkParameters::FromQuery(url.query_);
+
+    REQUIRE(url.scheme_ == "loopback");
+    REQUIRE(parameters.latency_ == 50);
+    REQUIRE(parameters.jitter_ == 10);
+    REQUIRE(parameters.loss_ == 0.25f);
+    REQUIRE(parameters.bandwidth_ == 65536);
+    REQUIRE(parameters.seed_ == 7);
+}
+
+TEST_CASE("Loopback connection passes messages to server in the same process")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    // Connection fails without server
+    auto client = MakeShared<LoopbackConnection>(context);
+    bool clientFailed = false;
+    client->onError_ = [&] { clientFailed = true; };
+    REQUIRE_FALSE(client->Connect(URL("loopback://localhost:2345")));
+    REQUIRE(clientFailed);
+
+    // Start server
+    auto server = MakeShared<LoopbackServer>(context);
+    REQUIRE(server->Listen(URL("loopback://localhost:2345")));
+    REQUIRE_FALSE(MakeShared<LoopbackServer>(context)->Listen(URL("loopback://localhost:2345")));
+
+    ea::vector<ea::string> serverMessages;
+    SharedPtr<NetworkConnection> serverConnection;
+    server->onConnected_ = [&](NetworkConnection* connection)
+    {
+        serverConnection = connection;
+        connection->onMessage_ = [&](ea::string_view message) { serverMessages.emplace_back(message); };
+    };
+
+    bool serverDisconnected = false;
+    server->onDisconnected_ = [&](NetworkConnection* connection)
+    {
+        REQUIRE(connection == serverConnection);
+        serverDisconnected = true;
+    };
+
+    // Connect and send messages, unreliable messages are lost
+    bool clientConnected = false;
+    client->onConnected_ = [&] { clientConnected = true; };
+    REQUIRE(client->Connect(URL("loopback://localhost:2345?loss=1")));
+    REQUIRE(clientConnected);
+    REQUIRE(serverConnection);
+    REQUIRE(server->GetConnections().size() == 1);
+
+    client->SendMessage("first", PacketType::ReliableOrdered);
+    client->SendMessage("lost", PacketType::UnreliableUnordered);
+    client->SendMessage("second", PacketType::ReliableOrdered);
+    REQUIRE(serverMessages.empty());
+
+    client->DeliverMessages();
+    REQUIRE(serverMessages == ea::vector<ea::string>{"first", "second"});
+    REQUIRE(client->GetNumMessagesSent() == 3);
+    REQUIRE(client->GetNumMessagesLost() == 1);
+    REQUIRE(client->GetNumBytesSent() == 15);
+
+    // Disconnect is observed by both sides
+    bool clientDisconnected = false;
+    client->onDisconnected_ = [&] { clientDisconnected = true; };
+    client->Disconnect();
+    REQUIRE(clientDisconnected);
+    REQUIRE(serverDisconnected);
+    REQUIRE(serverConnection->GetState() == NetworkConnection::State::Disconnected);
+    REQUIRE(server->GetConnections().empty());
+
+    server->Stop();
+    REQUIRE_FALSE(LoopbackServer::FindServer(URL("loopback://localhost:2345")));
+}
+
+TEST_CASE("Loopback connection does not allocate packets in steady state")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto network = context->GetSubsystem<Network>();
+    network->SetUpdateFps(30);
+    network->RegisterRemoteEvent(E_LOOPBACKTESTEVENT);
+
+    const URL url("loopback://localhost:2346");
+    REQUIRE(network->StartServer(url, 1));
+
+    auto clientScene = MakeShared<Scene>(context);
+    REQUIRE(network->Connect(url, clientScene));
+
+    unsigned numEventsReceived = 0;
+    network->SubscribeToEvent(E_LOOPBACKTESTEVENT, [&] { ++numEventsReceived; });
+
+    const auto runFrames = [&](unsigned numFrames, unsigned& maxAllocations)
+    {
+        for (unsigned i = 0; i < numFrames; ++i)
+        {
+            if (Connection* serverConnection = network->GetServerConnection())
+                serverConnection->SendRemoteEvent(E_LOOPBACKTESTEVENT, true);
+            network->BroadcastRemoteEvent(E_LOOPBACKTESTEVENT, false);
+
+            Tests::RunFrame(context, 1.0f / 30.0f);
+            maxAllocations = ea::max(maxAllocations, network->GetNumPacketAllocations());
+        }
+    };
+
+    // Pool grows while the connection is established
+    unsigned maxWarmupAllocations = 0;
+    runFrames(30, maxWarmupAllocations);
+    REQUIRE(network->GetServerConnection());
+    REQUIRE(network->GetServerConnection()->IsConnected());
+    REQUIRE(network->GetClientConnections().size() == 1);
+    REQUIRE(maxWarmupAllocations > 0);
+
+    // Packets are recycled afterwards
+    const unsigned numEventsBefore = numEventsReceived;
+    unsigned maxSteadyAllocations = 0;
+    runFrames(60, maxSteadyAllocations);
+    CHECK(numEventsReceived >= numEventsBefore + 60);
+    CHECK(maxSteadyAllocations == 0);
+
+    network->UnsubscribeFromEvent(E_LOOPBACKTESTEVENT);
+    network->UnregisterRemoteEvent(E_LOOPBACKTESTEVENT);
+    network->Disconnect();
+    network->StopServer();
+    Tests::RunFrame(context, 1.0f / 30.0f);
+}
@@ -64,6 +64,10 @@ void ManualConnection::SendMessageInternal(NetworkMessageId messageId, const uns
     const bool reliable = packetType & PacketType::Reliable;
     const bool inOrder = packetType & PacketType::Ordered;
 
+    // Unreliable messages may be split to fit the limit, reliable messages are not limited
+    if (!reliable && numBytes > maxMessageSize_)
+        ++oversizedMessages_;
+
     ++totalMessages_;
     if (!reliable)
         ++totalUnreliableMessages_;
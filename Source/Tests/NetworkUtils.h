@@ -62,6 +62,7 @@ public:
 
     void SetSinkConnection(AbstractConnection* sinkConnection) { sinkConnection_ = sinkConnection; }
     void SetQuality(const ConnectionQuality& quality) { quality_ = quality; }
+    void SetMaxMessageSize(unsigned maxMessageSize) { maxMessageSize_ = maxMessageSize; }
 
     void SendMessageInternal(NetworkMessageId messageId, const unsigned char* data, unsigned numBytes, PacketTypeFlags packetType = PacketType::ReliableOrdered) override;
     ea::string ToString() const override { return "Manual Connection"; }
@@ -71,9 +72,12 @@ public:
     unsigned GetLocalTime() const override { return systemTime; }
     unsigned GetLocalTimeOfLatestRoundtrip() const override { return systemTime; }
     unsigned GetPing() const override { return RoundToInt(1000 * (quality_.minPing_ + quality_.maxPing_) / 2); }
+    unsigned GetMaxMessageSize() const override { return maxMessageSize_; }
 
     void IncrementTime(unsigned delta);
 
+    unsigned GetNumOversizedMessages() const { return oversizedMessages_; }
+
 private:
     struct InternalMessage
     {
@@ -101,6 +105,9 @@ private:
     unsigned totalUnreliableMessages_{};
     unsigned droppedMessages_{};
     unsigned shuffledMessages_{};
+
+    unsigned maxMessageSize_{M_MAX_UNSIGNED};
+    unsigned oversizedMessages_{};
 };
 
 /// Network simulator for tests.
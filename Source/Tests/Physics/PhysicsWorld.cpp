@@ -0,0 +1,239 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#if URHO3D_PHYSICS
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
+
+namespace
+{
+
+SharedPtr<Scene> CreateFallingBoxesScene(Context* context, bool multiThreaded, unsigned numBoxes)
+{
+    PhysicsWorld::config.multiThreaded_ = multiThreaded;
+    auto scene = MakeShared<Scene>(context);
+    auto physicsWorld = scene->CreateComponent<PhysicsWorld>();
+    PhysicsWorld::config.multiThreaded_ = false;
+    physicsWorld->SetInterpolation(false);
+
+    Node* floorNode = scene->CreateChild("Floor");
+    floorNode->SetScale(Vector3(1000.0f, 1.0f, 1000.0f));
+    floorNode->CreateComponent<RigidBody>();
+    floorNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    // Boxes are slightly shifted so they topple and collide with each other
+    const auto side = static_cast<unsigned>(Ceil(Pow(static_cast<float>(numBoxes), 1.0f / 3.0f)));
+    for (unsigned i = 0; i < numBoxes; ++i)
+    {
+        const unsigned x = i % side;
+        const unsigned y = i / (side * side);
+        const unsigned z = i / side % side;
+
+        Node* boxNode = scene->CreateChild("Box");
+        boxNode->SetPosition(Vector3(x * 1.1f + (i % 7) * 0.05f, y * 1.1f + 1.0f, z * 1.1f));
+        auto body = boxNode->CreateComponent<RigidBody>();
+        body->SetMass(1.0f);
+        boxNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+    }
+
+    return scene;
+}
+
+ea::vector<Vector3> SimulateFallingBoxes(Context* context, bool multiThreaded, unsigned numThreads)
+{
+    auto scene = CreateFallingBoxesScene(context, multiThreaded, 1000);
+#ifdef URHO3D_THREADING
+    REQUIRE(scene->GetComponent<PhysicsWorld>()->IsMultiThreaded() == multiThreaded);
+#endif
+    auto physicsWorld = scene->GetComponent<PhysicsWorld>();
+    physicsWorld->SetNumThreads(numThreads);
+
+    // Fast bodies with continuous collision detection create predictive contacts
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        Node* bulletNode = scene->CreateChild("Bullet");
+        bulletNode->SetPosition(Vector3(i * 0.7f, 30.0f, (i % 4) * 2.5f));
+        auto body = bulletNode->CreateComponent<RigidBody>();
+        body->SetMass(0.1f);
+        body->SetCcdRadius(0.1f);
+        body->SetCcdMotionThreshold(0.1f);
+        body->SetLinearVelocity(Vector3(0.0f, -100.0f, 0.0f));
+        bulletNode->CreateComponent<CollisionShape>()->SetSphere(0.2f);
+    }
+
+    for (unsigned i = 0; i < 120; ++i)
+        physicsWorld->Update(1.0f / 60.0f);
+
+    ea::vector<Vector3> positions;
+    for (Node* node : scene->GetChildren())
+        positions.push_back(node->GetWorldPosition());
+    return positions;
+}
+
+ea::vector<PhysicsRaycastQuery> CreateRaycastQueries(unsigned numQueries)
+{
+    ea::vector<PhysicsRaycastQuery> queries(numQueries);
+    for (unsigned i = 0; i < numQueries; ++i)
+    {
+        const Vector3 origin{(i % 23) * 0.5f, 20.0f, (i % 19) * 0.5f};
+        const Vector3 direction{(i % 5) * 0.1f - 0.2f, -1.0f, (i % 3) * 0.1f - 0.1f};
+        queries[i].ray_ = Ray(origin, direction);
+        queries[i].maxDistance_ = 50.0f;
+    }
+    return queries;
+}
+
+}
+
+TEST_CASE("Multi-threaded physics simulation is deterministic")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const unsigned maxThreads = context->GetSubsystem<WorkQueue>()->GetNumProcessingThreads();
+
+    const auto positions = SimulateFallingBoxes(context, true, maxThreads);
+    for (unsigned numThreads : Tests::GetThreadCountsUpTo(maxThreads))
+        REQUIRE(positions == SimulateFallingBoxes(context, true, numThreads));
+}
+
+TEST_CASE("Physics world synchronizes only active rigid bodies")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = CreateFallingBoxesScene(context, false, 8);
+    auto physicsWorld = scene->GetComponent<PhysicsWorld>();
+
+    // Parented rigid body is synchronized after its parent
+    Node* parentNode = scene->GetChild("Box");
+    parentNode->SetRotation(Quaternion(30.0f, Vector3::UP));
+    Node* childNode = parentNode->CreateChild("Child");
+    childNode->SetPosition(Vector3(-5.0f, 0.0f, 0.0f));
+    auto childBody = childNode->CreateComponent<RigidBody>();
+    childBody->SetMass(1.0f);
+    childNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    physicsWorld->Update(1.0f / 60.0f);
+    REQUIRE(physicsWorld->GetNumSyncedBodies() == 9);
+    REQUIRE(childNode->GetWorldPosition().Equals(childBody->GetPosition()));
+
+    for (unsigned i = 0; i < 600 && physicsWorld->GetNumSyncedBodies() > 0; ++i)
+        physicsWorld->Update(1.0f / 60.0f);
+    REQUIRE(physicsWorld->GetNumSyncedBodies() == 0);
+}
+
+TEST_CASE("Batched physics queries return same results as single queries")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = CreateFallingBoxesScene(context, false, 1000);
+    auto physicsWorld = scene->GetComponent<PhysicsWorld>();
+    physicsWorld->Update(1.0f / 60.0f);
+
+    const auto raycastQueries = CreateRaycastQueries(1000);
+    ea::vector<PhysicsSphereCastQuery> sphereCastQueries;
+    ea::vector<PhysicsConvexCastQuery> convexCastQueries;
+    btSphereShape shape(0.25f);
+    for (const PhysicsRaycastQuery& query : raycastQueries)
+    {
+        sphereCastQueries.push_back({query.ray_, 0.25f, query.maxDistance_});
+        convexCastQueries.push_back({&shape, query.ray_.origin_, Quaternion::IDENTITY,
+            query.ray_.origin_ + query.ray_.direction_ * query.maxDistance_, Quaternion::IDENTITY});
+    }
+
+    ea::vector<PhysicsRaycastResult> raycastResults;
+    ea::vector<PhysicsRaycastResult> sphereCastResults;
+    ea::vector<PhysicsRaycastResult> convexCastResults;
+    physicsWorld->RaycastSingleBatch(raycastResults, raycastQueries);
+    physicsWorld->SphereCastBatch(sphereCastResults, sphereCastQueries);
+    physicsWorld->ConvexCastBatch(convexCastResults, convexCastQueries);
+    REQUIRE(raycastResults.size() == raycastQueries.size());
+    REQUIRE(sphereCastResults.size() == raycastQueries.size());
+    REQUIRE(convexCastResults.size() == raycastQueries.size());
+
+    unsigned numHits = 0;
+    for (unsigned i = 0; i < raycastQueries.size(); ++i)
+    {
+        const PhysicsRaycastQuery& query = raycastQueries[i];
+        PhysicsRaycastResult result;
+
+        physicsWorld->RaycastSingle(result, query.ray_, query.maxDistance_, query.collisionMask_);
+        REQUIRE_FALSE(result != raycastResults[i]);
+
+        physicsWorld->SphereCast(result, query.ray_, 0.25f, query.maxDistance_, query.collisionMask_);
+        REQUIRE_FALSE(result != sphereCastResults[i]);
+        REQUIRE_FALSE(result != convexCastResults[i]);
+
+        if (result.body_)
+            ++numHits;
+    }
+    REQUIRE(numHits > 0);
+}
+
+TEST_CASE("Batched physics raycast benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = CreateFallingBoxesScene(context, false, 10000);
+    auto physicsWorld = scene->GetComponent<PhysicsWorld>();
+    physicsWorld->Update(1.0f / 60.0f);
+
+    const auto queries = CreateRaycastQueries(10000);
+    ea::vector<PhysicsRaycastResult> results(queries.size());
+
+    BENCHMARK("Raycast 10000 rays one by one")
+    {
+        for (unsigned i = 0; i < queries.size(); ++i)
+            physicsWorld->RaycastSingle(results[i], queries[i].ray_, queries[i].maxDistance_, queries[i].collisionMask_);
+        return results[0].distance_;
+    };
+
+    BENCHMARK("Raycast 10000 rays in batch")
+    {
+        physicsWorld->RaycastSingleBatch(results, queries);
+        return results[0].distance_;
+    };
+}
+
+TEST_CASE("Multi-threaded physics simulation benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const unsigned maxThreads = context->GetSubsystem<WorkQueue>()->GetNumProcessingThreads();
+
+    for (unsigned numThreads : Tests::GetThreadCountsUpTo(maxThreads))
+    {
+        // Every thread count starts from the same initial state
+        auto scene = CreateFallingBoxesScene(context, true, 10000);
+        auto physicsWorld = scene->GetComponent<PhysicsWorld>();
+        physicsWorld->SetNumThreads(numThreads);
+        BENCHMARK(Format("Step 10000 bodies on {} threads", numThreads).c_str())
+        {
+            physicsWorld->Update(1.0f / 60.0f);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,267 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/Geometry.h>
+#include <Urho3D/Graphics/IndexBuffer.h>
+#include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/RenderSurface.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+#include <Urho3D/Graphics/Viewport.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/RenderAPI/RenderDevice.h>
+#include <Urho3D/RenderPipeline/BatchRenderer.h>
+#include <Urho3D/RenderPipeline/RenderPipeline.h>
+#include <Urho3D/Resource/Image.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+/// Create context with render device if there is GPU and display available.
+SharedPtr<Context> CreateRenderingContext()
+{
+    auto context = MakeShared<Context>();
+    auto engine = new Engine(context);
+    auto fs = context->GetSubsystem<FileSystem>();
+    auto exeDir = GetParentPath(fs->GetProgramFileName());
+    StringVariantMap parameters;
+    parameters[EP_HEADLESS] = false;
+    parameters[EP_LOG_QUIET] = true;
+    parameters[EP_WINDOW_WIDTH] = 64;
+    parameters[EP_WINDOW_HEIGHT] = 64;
+    parameters[EP_RESOURCE_PATHS] = "CoreData;Data";
+    parameters[EP_RESOURCE_PREFIX_PATHS] = Format("{};{}", exeDir, GetParentPath(exeDir));
+    engine->Initialize(parameters, {});
+    return context;
+}
+
+struct RenderedFrame
+{
+    unsigned numDraws_{};
+    unsigned numPrimitives_{};
+    ea::vector<unsigned char> image_;
+};
+
+/// Draw call as emitted by DrawCommandCompositor: first batch and first instance, and number of instances.
+struct RecordedDrawCall
+{
+    unsigned batchIndex_{};
+    unsigned startInstance_{};
+    unsigned numInstances_{};
+
+    bool operator==(const RecordedDrawCall& rhs) const
+    {
+        return batchIndex_ == rhs.batchIndex_ && startInstance_ == rhs.startInstance_
+            && numInstances_ == rhs.numInstances_;
+    }
+};
+
+/// Record draw calls for range of batches the same way DrawCommandCompositor groups instanced batches.
+void RecordDrawCalls(ea::span<const PipelineBatchByState> batches, unsigned beginBatch, unsigned endBatch,
+    unsigned startInstance, ea::vector<RecordedDrawCall>& drawCalls)
+{
+    const PipelineBatch* previousBatch = nullptr;
+    bool isGroupOpen = false;
+    unsigned instanceIndex = startInstance;
+    for (unsigned i = beginBatch; i < endBatch; ++i)
+    {
+        const PipelineBatch& batch = *batches[i].pipelineBatch_;
+        const bool isInstanced = batch.geometry_->IsInstanced(batch.geometryType_);
+        const bool isStateChanged = !previousBatch || previousBatch->pipelineState_ != batch.pipelineState_
+            || previousBatch->material_ != batch.material_ || previousBatch->geometry_ != batch.geometry_;
+        previousBatch = &batch;
+
+        if (isGroupOpen && !isStateChanged)
+        {
+            ++drawCalls.back().numInstances_;
+            ++instanceIndex;
+        }
+        else if (isInstanced)
+        {
+            drawCalls.push_back(RecordedDrawCall{i, instanceIndex, 1});
+            isGroupOpen = true;
+            ++instanceIndex;
+        }
+        else
+        {
+            drawCalls.push_back(RecordedDrawCall{i, 0, 1});
+            isGroupOpen = false;
+        }
+    }
+}
+
+}
+
+TEST_CASE("Batch group is split into recording chunks only at instancing group boundaries")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto createGeometry = [&]()
+    {
+        auto vertexBuffer = MakeShared<VertexBuffer>(context);
+        vertexBuffer->SetShadowed(true);
+        vertexBuffer->SetSize(0, 0);
+        auto indexBuffer = MakeShared<IndexBuffer>(context);
+        indexBuffer->SetShadowed(true);
+        indexBuffer->SetSize(3, false);
+
+        auto geometry = MakeShared<Geometry>(context);
+        REQUIRE(geometry->SetVertexBuffer(0, vertexBuffer));
+        geometry->SetIndexBuffer(indexBuffer);
+        REQUIRE(geometry->SetDrawRange(TRIANGLE_LIST, 0, 3));
+        return geometry;
+    };
+
+    const SharedPtr<Geometry> geometries[] = {createGeometry(), createGeometry()};
+    const SharedPtr<Material> materials[] = {MakeShared<Material>(context), MakeShared<Material>(context)};
+
+    // Runs of batches with the same state, some of them are longer than chunk and some are not instanced
+    const ea::vector<unsigned> runLengths{3, 700, 1, 1, 250, 90, 300, 2, 513, 40, 256, 1};
+    ea::vector<PipelineBatch> pipelineBatches;
+    for (unsigned runIndex = 0; runIndex < runLengths.size(); ++runIndex)
+    {
+        for (unsigned i = 0; i < runLengths[runIndex]; ++i)
+        {
+            PipelineBatch batch;
+            batch.sourceBatchIndex_ = M_MAX_UNSIGNED;
+            batch.geometry_ = geometries[runIndex % 2];
+            batch.material_ = materials[runIndex / 2 % 2];
+            batch.geometryType_ = runIndex % 5 == 3 ? GEOM_SKINNED : GEOM_STATIC;
+            pipelineBatches.push_back(batch);
+        }
+    }
+
+    ea::vector<PipelineBatchByState> sortedBatches(pipelineBatches.size());
+    for (unsigned i = 0; i < pipelineBatches.size(); ++i)
+        sortedBatches[i].pipelineBatch_ = &pipelineBatches[i];
+
+    PipelineBatchGroup<PipelineBatchByState> batchGroup;
+    batchGroup.batches_ = sortedBatches;
+    batchGroup.flags_ = BatchRenderFlag::EnableInstancingForStaticGeometry;
+    batchGroup.startInstance_ = 10;
+
+    const unsigned minChunkSize = BatchRenderer::ParallelRecordingBucketSize;
+    ea::vector<BatchRecordingChunk> chunks;
+    BatchRenderer::SplitIntoRecordingChunks(batchGroup, minChunkSize, chunks);
+    REQUIRE(chunks.size() > 2);
+
+    // Chunks shall cover the whole group
+    CHECK(chunks.front().beginBatch_ == 0);
+    CHECK(chunks.back().endBatch_ == sortedBatches.size());
+    for (unsigned i = 0; i + 1 < chunks.size(); ++i)
+    {
+        CHECK(chunks[i].endBatch_ == chunks[i + 1].beginBatch_);
+        CHECK(chunks[i].endBatch_ - chunks[i].beginBatch_ >= minChunkSize);
+    }
+
+    // Chunks recorded separately shall produce the same draw calls as serial recording
+    ea::vector<RecordedDrawCall> serialDrawCalls;
+    RecordDrawCalls(sortedBatches, 0, sortedBatches.size(), batchGroup.startInstance_, serialDrawCalls);
+
+    ea::vector<RecordedDrawCall> chunkedDrawCalls;
+    for (const BatchRecordingChunk& chunk : chunks)
+        RecordDrawCalls(sortedBatches, chunk.beginBatch_, chunk.endBatch_, chunk.startInstance_, chunkedDrawCalls);
+
+    CHECK(chunkedDrawCalls == serialDrawCalls);
+}
+
+TEST_CASE("Batch group recorded in multiple threads is rendered like serially recorded one")
+{
+    auto context = Tests::GetOrCreateContext(CreateRenderingContext);
+    auto renderDevice = context->GetSubsystem<RenderDevice>();
+    if (!renderDevice)
+    {
+        WARN("Render device is not available, draw commands cannot be recorded");
+        return;
+    }
+
+    auto cache = context->GetSubsystem<ResourceCache>();
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+    auto renderPipeline = scene->CreateComponent<RenderPipeline>();
+
+    // Enough batches with different instance data to be recorded in several chunks
+    auto model = cache->GetResource<Model>("Models/Box.mdl");
+    auto material = cache->GetResource<Material>("Materials/DefaultWhite.xml");
+    const int gridSize = 32;
+    for (int x = 0; x < gridSize; ++x)
+    {
+        for (int y = 0; y < gridSize; ++y)
+        {
+            Node* node = scene->CreateChild("Box");
+            node->SetPosition(Vector3(x - gridSize * 0.5f, y - gridSize * 0.5f, 0.0f));
+            node->SetRotation(Quaternion(x * 7.0f, y * 11.0f, 0.0f));
+            node->SetScale(0.5f + (x + y) % 4 * 0.1f);
+            auto staticModel = node->CreateComponent<StaticModel>();
+            staticModel->SetModel(model);
+            staticModel->SetMaterial(material);
+        }
+    }
+    REQUIRE(gridSize * gridSize > BatchRenderer::ParallelRecordingBucketSize * 2);
+
+    Node* cameraNode = scene->CreateChild("Camera");
+    cameraNode->SetPosition(Vector3(0.0f, 0.0f, -40.0f));
+    auto camera = cameraNode->CreateComponent<Camera>();
+
+    auto texture = MakeShared<Texture2D>(context);
+    REQUIRE(texture->SetSize(256, 256, TextureFormat::TEX_FORMAT_RGBA8_UNORM, TextureFlag::BindRenderTarget));
+    RenderSurface* surface = texture->GetRenderSurface();
+    surface->SetViewport(0, MakeShared<Viewport>(context, scene, camera, IntRect::ZERO, renderPipeline));
+    surface->SetUpdateMode(SURFACE_UPDATEALWAYS);
+
+    const auto renderFrame = [&](bool parallelRecording)
+    {
+        renderPipeline->SetAttribute("Parallel Batch Recording", parallelRecording);
+
+        // Pipeline states are created on the first frames, render until stable
+        for (unsigned i = 0; i < 3; ++i)
+            Tests::RunFrame(context, 0.0f);
+
+        RenderedFrame frame;
+        frame.numDraws_ = renderDevice->GetStats().numDraws_;
+        frame.numPrimitives_ = renderDevice->GetStats().numPrimitives_;
+
+        const SharedPtr<Image> image = texture->GetImage();
+        REQUIRE(image);
+        const unsigned dataSize = image->GetWidth() * image->GetHeight() * image->GetComponents();
+        frame.image_.assign(image->GetData(), image->GetData() + dataSize);
+        return frame;
+    };
+
+    const RenderedFrame serialFrame = renderFrame(false);
+    const RenderedFrame parallelFrame = renderFrame(true);
+
+    REQUIRE(serialFrame.numDraws_ > 0);
+    CHECK(parallelFrame.numDraws_ == serialFrame.numDraws_);
+    CHECK(parallelFrame.numPrimitives_ == serialFrame.numPrimitives_);
+    CHECK(parallelFrame.image_ == serialFrame.image_);
+}
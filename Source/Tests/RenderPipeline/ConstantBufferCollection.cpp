@@ -0,0 +1,87 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/RenderAPI/ConstantBufferCollection.h>
+
+namespace
+{
+
+/// Add block filled with the value and return reference to it.
+ConstantBufferCollectionRef AddFilledBlock(ConstantBufferCollection& collection, unsigned size, unsigned char value)
+{
+    const auto [ref, data] = collection.AddBlock(size);
+    memset(data, value, size);
+    return ref;
+}
+
+bool IsBlockFilled(const ConstantBufferCollection& collection, const ConstantBufferCollectionRef& ref, unsigned char value)
+{
+    const auto data = static_cast<const unsigned char*>(collection.GetBufferData(ref.index_)) + ref.offset_;
+    for (unsigned i = 0; i < ref.size_; ++i)
+    {
+        if (data[i] != value)
+            return false;
+    }
+    return ref.offset_ + ref.size_ <= collection.GetBufferSize(ref.index_);
+}
+
+}
+
+TEST_CASE("ConstantBufferCollection blocks are preserved when collections are appended")
+{
+    ConstantBufferCollection collection;
+    collection.ClearAndInitialize(256);
+
+    ea::vector<ea::pair<ConstantBufferCollectionRef, unsigned char>> blocks;
+    for (unsigned i = 0; i < 20; ++i)
+        blocks.emplace_back(AddFilledBlock(collection, 1000, static_cast<unsigned char>(i)), static_cast<unsigned char>(i));
+
+    for (unsigned chunkIndex = 0; chunkIndex < 3; ++chunkIndex)
+    {
+        ConstantBufferCollection chunk;
+        chunk.ClearAndInitialize(256);
+
+        ea::vector<ea::pair<ConstantBufferCollectionRef, unsigned char>> chunkBlocks;
+        for (unsigned i = 0; i < 30 * chunkIndex; ++i)
+        {
+            const auto value = static_cast<unsigned char>(100 + chunkIndex * 30 + i);
+            chunkBlocks.emplace_back(AddFilledBlock(chunk, 700, value), value);
+        }
+
+        const unsigned baseIndex = collection.AppendBuffers(chunk);
+        REQUIRE(collection.GetNumBuffers() == baseIndex + chunk.GetNumBuffers());
+
+        for (auto [ref, value] : chunkBlocks)
+        {
+            ref.index_ += baseIndex;
+            blocks.emplace_back(ref, value);
+        }
+
+        // Blocks added after append should not overwrite appended data
+        blocks.emplace_back(AddFilledBlock(collection, 500, 255 - chunkIndex), 255 - chunkIndex);
+    }
+
+    for (const auto& [ref, value] : blocks)
+        REQUIRE(IsBlockFilled(collection, ref, value));
+}
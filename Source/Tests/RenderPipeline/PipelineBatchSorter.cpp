@@ -0,0 +1,228 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/RenderPipeline/PipelineBatchSortKey.h>
+#include <Urho3D/RenderPipeline/PipelineBatchSorter.h>
+
+#include <EASTL/sort.h>
+
+namespace
+{
+
+/// Create batches sorted by state with keys distributed like in a typical scene.
+ea::vector<PipelineBatchByState> CreateBatchesByState(const ea::vector<PipelineBatch>& pipelineBatches)
+{
+    ea::vector<PipelineBatchByState> result;
+    for (const PipelineBatch& pipelineBatch : pipelineBatches)
+    {
+        PipelineBatchByState batch;
+        batch.pipelineBatch_ = &pipelineBatch;
+        batch.primaryKey_ = (static_cast<unsigned long long>(Rand() % 4) << PipelineBatchByState::RenderOrderOffset)
+            | (static_cast<unsigned long long>(Rand() % 200) << PipelineBatchByState::PipelineStateOffset)
+            | (static_cast<unsigned long long>(Rand() % 500) << PipelineBatchByState::MaterialOffset)
+            | (static_cast<unsigned long long>(Rand() % 8) << PipelineBatchByState::PixelLightOffset);
+        batch.secondaryKey_ = static_cast<unsigned long long>(Rand() % 1000) << PipelineBatchByState::GeometryOffset;
+        result.push_back(batch);
+    }
+    return result;
+}
+
+ea::vector<PipelineBatchBackToFront> CreateBatchesBackToFront(const ea::vector<PipelineBatch>& pipelineBatches)
+{
+    ea::vector<PipelineBatchBackToFront> result;
+    for (const PipelineBatch& pipelineBatch : pipelineBatches)
+    {
+        PipelineBatchBackToFront batch;
+        batch.pipelineBatch_ = &pipelineBatch;
+        batch.renderOrder_ = static_cast<unsigned char>(Rand() % 3);
+        batch.distance_ = Random(-10.0f, 1000.0f);
+        result.push_back(batch);
+    }
+    return result;
+}
+
+/// Create pairs of batches with the same order: with keys that fit into 64 bits together, and with keys that don't.
+ea::pair<ea::vector<PipelineBatchByState>, ea::vector<PipelineBatchByState>> CreateBatchesWithNarrowAndWideKeys(
+    const ea::vector<PipelineBatch>& pipelineBatches)
+{
+    ea::vector<PipelineBatchByState> narrowBatches;
+    ea::vector<PipelineBatchByState> wideBatches;
+    for (const PipelineBatch& pipelineBatch : pipelineBatches)
+    {
+        const auto primaryValue = static_cast<unsigned long long>(Rand() % 4);
+        const auto secondaryValue = static_cast<unsigned long long>(Rand() % 100);
+
+        PipelineBatchByState narrowBatch;
+        narrowBatch.pipelineBatch_ = &pipelineBatch;
+        narrowBatch.primaryKey_ = primaryValue;
+        narrowBatch.secondaryKey_ = secondaryValue;
+        narrowBatches.push_back(narrowBatch);
+
+        // Multiplication preserves the order but spreads the values over all bits
+        PipelineBatchByState wideBatch = narrowBatch;
+        wideBatch.primaryKey_ = primaryValue * 0x5555555555555555ull;
+        wideBatch.secondaryKey_ = secondaryValue * 0x0101010101010101ull;
+        wideBatches.push_back(wideBatch);
+    }
+    return {narrowBatches, wideBatches};
+}
+
+template <class T>
+bool IsSameOrder(const ea::vector<T>& lhs, const ea::vector<T>& rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+
+    for (unsigned i = 0; i < lhs.size(); ++i)
+    {
+        if (lhs[i].pipelineBatch_ != rhs[i].pipelineBatch_)
+            return false;
+    }
+    return true;
+}
+
+template <class T>
+void CheckSort(PipelineBatchSorter<T>& sorter, ea::vector<T> batches, WorkQueue* workQueue)
+{
+    ea::vector<T> expected = batches;
+    ea::stable_sort(expected.begin(), expected.end());
+
+    sorter.Sort(batches, workQueue);
+    REQUIRE(IsSameOrder(batches, expected));
+}
+
+}
+
+TEST_CASE("PipelineBatchSorter sorts batches like comparison sort")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+    SetRandomSeed(1);
+
+    for (unsigned numBatches : {0u, 1u, 100u, 1000u, 50000u})
+    {
+        ea::vector<PipelineBatch> pipelineBatches(numBatches);
+
+        PipelineBatchSorter<PipelineBatchByState> stateSorter;
+        auto batchesByState = CreateBatchesByState(pipelineBatches);
+        CheckSort(stateSorter, batchesByState, workQueue);
+
+        // Same batches reuse the previous order
+        CheckSort(stateSorter, batchesByState, workQueue);
+        if (numBatches > 0)
+            REQUIRE(stateSorter.IsPreviousOrderReused());
+
+        // Slightly changed batches reuse the previous order too
+        if (numBatches >= 1000)
+        {
+            batchesByState[numBatches / 2].primaryKey_ = 0;
+            CheckSort(stateSorter, batchesByState, workQueue);
+            REQUIRE(stateSorter.IsPreviousOrderReused());
+        }
+
+        // Different batches are sorted from scratch
+        CheckSort(stateSorter, CreateBatchesByState(pipelineBatches), workQueue);
+        if (numBatches >= 1000)
+            REQUIRE(!stateSorter.IsPreviousOrderReused());
+
+        PipelineBatchSorter<PipelineBatchBackToFront> backToFrontSorter;
+        CheckSort(backToFrontSorter, CreateBatchesBackToFront(pipelineBatches), workQueue);
+        CheckSort(backToFrontSorter, CreateBatchesBackToFront(pipelineBatches), nullptr);
+    }
+}
+
+TEST_CASE("PipelineBatchSorter sorts batches with unpacked secondary keys like packed ones")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+    SetRandomSeed(1);
+
+    for (unsigned numBatches : {100u, 1000u, 50000u})
+    {
+        ea::vector<PipelineBatch> pipelineBatches(numBatches);
+        auto [narrowBatches, wideBatches] = CreateBatchesWithNarrowAndWideKeys(pipelineBatches);
+
+        PipelineBatchSorter<PipelineBatchByState> narrowSorter;
+        CheckSort(narrowSorter, narrowBatches, workQueue);
+        REQUIRE(narrowSorter.IsSecondaryKeyPacked());
+
+        PipelineBatchSorter<PipelineBatchByState> wideSorter;
+        CheckSort(wideSorter, wideBatches, workQueue);
+        REQUIRE(!wideSorter.IsSecondaryKeyPacked());
+
+        narrowSorter.Sort(narrowBatches, workQueue);
+        wideSorter.Sort(wideBatches, workQueue);
+        REQUIRE(IsSameOrder(narrowBatches, wideBatches));
+
+        // Reused order is compared by unpacked secondary keys too
+        wideBatches[numBatches / 2].secondaryKey_ = 0;
+        CheckSort(wideSorter, wideBatches, workQueue);
+    }
+}
+
+TEST_CASE("PipelineBatchSorter benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+    SetRandomSeed(1);
+
+    for (unsigned numBatches : {5000u, 50000u, 200000u})
+    {
+        ea::vector<PipelineBatch> pipelineBatches(numBatches);
+        const auto sourceBatches = CreateBatchesByState(pipelineBatches);
+        ea::vector<PipelineBatchByState> batches;
+
+        BENCHMARK(Format("Comparison sort of {} batches", numBatches).c_str())
+        {
+            batches = sourceBatches;
+            ea::sort(batches.begin(), batches.end());
+            return batches.size();
+        };
+
+        PipelineBatchSorter<PipelineBatchByState> sorter;
+        BENCHMARK(Format("Radix sort of {} batches", numBatches).c_str())
+        {
+            batches = sourceBatches;
+            sorter.Reset();
+            sorter.Sort(batches);
+            return batches.size();
+        };
+
+        BENCHMARK(Format("Parallel radix sort of {} batches", numBatches).c_str())
+        {
+            batches = sourceBatches;
+            sorter.Reset();
+            sorter.Sort(batches, workQueue);
+            return batches.size();
+        };
+
+        PipelineBatchSorter<PipelineBatchByState> coherentSorter;
+        BENCHMARK(Format("Coherent sort of {} unchanged batches", numBatches).c_str())
+        {
+            batches = sourceBatches;
+            coherentSorter.Sort(batches, workQueue);
+            return batches.size();
+        };
+    }
+}
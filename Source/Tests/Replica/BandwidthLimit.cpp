@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/NetworkSettingsConsts.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ServerReplicator.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+namespace
+{
+
+SharedPtr<PrefabResource> CreateTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+}
+
+TEST_CASE("Unreliable updates are split into messages and limited by bandwidth")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/BandwidthLimit/Test.prefab", CreateTestPrefab);
+
+    // Create scenes
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0, 0};
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+
+    auto serverToClient = static_cast<Tests::ManualConnection*>(sim.GetServerToClientConnection(clientScene));
+    serverToClient->SetMaxMessageSize(512);
+
+    ServerReplicator* serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    sim.SimulateTime(5.0f);
+
+    // Spawn objects that are always moving
+    const unsigned numObjects = 100;
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        const ea::string name = Format("Node {}", i);
+        serverNodes.push_back(Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, name));
+    }
+
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](VariantMap& eventData)
+    {
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        for (Node* node : serverNodes)
+            node->Translate(timeStep * Vector3::FORWARD, TS_WORLD);
+    });
+
+    // Expect all updates to be sent in multiple messages without bandwidth limit
+    sim.SimulateTime(4.0f);
+    {
+        const ClientReplicationStats stats = serverReplicator->GetReplicationStats(serverToClient);
+        REQUIRE(serverToClient->GetNumOversizedMessages() == 0);
+        REQUIRE(stats.unreliableUpdateBytes_ > 0);
+        REQUIRE(stats.numUnreliableUpdatesDeferred_ == 0);
+        REQUIRE(stats.maxStarvationFrames_ == 0);
+    }
+
+    // Expect bandwidth to be limited without starving any object
+    const unsigned bandwidthLimit = 10000;
+    serverReplicator->SetSetting(NetworkSettings::BandwidthLimit, bandwidthLimit);
+    sim.SimulateTime(1.0f);
+
+    const ClientReplicationStats statsBegin = serverReplicator->GetReplicationStats(serverToClient);
+    const float measureDuration = 4.0f;
+    unsigned maxStarvationFrames = 0;
+    for (unsigned i = 0; i < measureDuration * Tests::NetworkSimulator::FramesInSecond; ++i)
+    {
+        sim.SimulateTime(1.0f / Tests::NetworkSimulator::FramesInSecond);
+        maxStarvationFrames = ea::max(maxStarvationFrames, serverReplicator->GetReplicationStats(serverToClient).maxStarvationFrames_);
+    }
+    const ClientReplicationStats statsEnd = serverReplicator->GetReplicationStats(serverToClient);
+
+    const auto bytesSent = static_cast<float>(statsEnd.unreliableUpdateBytes_ - statsBegin.unreliableUpdateBytes_);
+    const auto updatesSent = statsEnd.numUnreliableUpdatesSent_ - statsBegin.numUnreliableUpdatesSent_;
+    const auto updatesDeferred = statsEnd.numUnreliableUpdatesDeferred_ - statsBegin.numUnreliableUpdatesDeferred_;
+
+    REQUIRE(serverToClient->GetNumOversizedMessages() == 0);
+    REQUIRE(bytesSent / measureDuration < bandwidthLimit * 1.1f);
+    REQUIRE(updatesSent > 0);
+    REQUIRE(updatesDeferred > 0);
+
+    // Each object should wait roughly for its turn in round-robin order
+    const float updatesPerFrame = updatesSent / (measureDuration * Tests::NetworkSimulator::FramesInSecond);
+    REQUIRE(maxStarvationFrames > 0);
+    REQUIRE(maxStarvationFrames <= CeilToInt(2 * numObjects / updatesPerFrame));
+}
@@ -0,0 +1,208 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/FilteredByDistance.h>
+#include <Urho3D/Replica/NetworkSettingsConsts.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+SharedPtr<PrefabResource> CreateTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+SharedPtr<PrefabResource> CreateFilteredTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    auto filter = node->CreateComponent<FilteredByDistance>();
+    filter->SetRelevant(false);
+    filter->SetDistance(50.0f);
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+ServerReplicator* GetServerReplicator(Scene* serverScene)
+{
+    return serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+}
+
+}
+
+TEST_CASE("Interest grid replicates only objects near client-owned objects")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/InterestGrid/Test.prefab", CreateTestPrefab);
+
+    // Create scenes
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0.02f, 0.02f};
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+
+    ServerReplicator* serverReplicator = GetServerReplicator(serverScene);
+    serverReplicator->SetSetting(NetworkSettings::InterestGridCellSize, 10.0f);
+    serverReplicator->SetSetting(NetworkSettings::InterestGridRadius, 1u);
+    serverReplicator->SetSetting(NetworkSettings::InterestGridHysteresis, 1u);
+    sim.SimulateTime(5.0f);
+
+    // Spawn objects
+    {
+        auto clientNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Client Node");
+        clientNode->GetComponent<BehaviorNetworkObject>()->SetOwner(sim.GetServerToClientConnection(clientScene));
+        clientNode->SetWorldPosition(Vector3{5.0f, 0.0f, 5.0f});
+
+        auto nearNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Near Node");
+        nearNode->SetWorldPosition(Vector3{15.0f, 0.0f, -5.0f});
+
+        auto nearChildNode = Tests::SpawnOnServer<BehaviorNetworkObject>(nearNode, prefab, "Near Child Node");
+        nearChildNode->SetWorldPosition(Vector3{100.0f, 0.0f, 100.0f});
+
+        auto farNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Far Node");
+        farNode->SetWorldPosition(Vector3{25.0f, 0.0f, 5.0f});
+
+        auto globalNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Global Node");
+        globalNode->GetComponent<BehaviorNetworkObject>()->SetAlwaysRelevant(true);
+        globalNode->SetWorldPosition(Vector3{1000.0f, 0.0f, 1000.0f});
+    }
+
+    // Expect near and global objects on the client, children follow their root objects
+    sim.SimulateTime(8.0f);
+    {
+        REQUIRE(clientScene->GetChild("Client Node", true));
+        REQUIRE(clientScene->GetChild("Near Node", true));
+        REQUIRE(clientScene->GetChild("Near Child Node", true));
+        REQUIRE_FALSE(clientScene->GetChild("Far Node", true));
+        REQUIRE(clientScene->GetChild("Global Node", true));
+    }
+
+    // Move far object closer
+    serverScene->GetChild("Far Node", true)->SetWorldPosition(Vector3{15.0f, 0.0f, 5.0f});
+    sim.SimulateTime(8.0f);
+    {
+        REQUIRE(clientScene->GetChild("Far Node", true));
+    }
+
+    // Move near objects slightly away, expect them to stay due to hysteresis
+    serverScene->GetChild("Near Node", true)->SetWorldPosition(Vector3{25.0f, 0.0f, -5.0f});
+    serverScene->GetChild("Far Node", true)->SetWorldPosition(Vector3{25.0f, 0.0f, 5.0f});
+    sim.SimulateTime(8.0f);
+    {
+        REQUIRE(clientScene->GetChild("Near Node", true));
+        REQUIRE(clientScene->GetChild("Near Child Node", true));
+        REQUIRE(clientScene->GetChild("Far Node", true));
+        REQUIRE(clientScene->GetChild("Far Node", true)->GetWorldPosition().ToXZ() == Vector2{25.0f, 5.0f});
+    }
+
+    // Move near objects far away, expect whole trees gone
+    serverScene->GetChild("Near Node", true)->SetWorldPosition(Vector3{35.0f, 0.0f, -5.0f});
+    serverScene->GetChild("Far Node", true)->SetWorldPosition(Vector3{-25.0f, 0.0f, 5.0f});
+    sim.SimulateTime(8.0f);
+    {
+        REQUIRE(clientScene->GetChild("Client Node", true));
+        REQUIRE_FALSE(clientScene->GetChild("Near Node", true));
+        REQUIRE_FALSE(clientScene->GetChild("Near Child Node", true));
+        REQUIRE_FALSE(clientScene->GetChild("Far Node", true));
+        REQUIRE(clientScene->GetChild("Global Node", true));
+    }
+
+    // Move client-owned object to the objects
+    serverScene->GetChild("Client Node", true)->SetWorldPosition(Vector3{35.0f, 0.0f, -5.0f});
+    sim.SimulateTime(8.0f);
+    {
+        REQUIRE(clientScene->GetChild("Near Node", true));
+        REQUIRE(clientScene->GetChild("Near Child Node", true));
+        REQUIRE_FALSE(clientScene->GetChild("Far Node", true));
+    }
+}
+
+TEST_CASE("Interest grid benchmark", "[.benchmark]")
+{
+    static constexpr unsigned numConnections = 200;
+    static constexpr unsigned numObjects = 20000;
+    static constexpr float worldSize = 2000.0f;
+    static constexpr float timeStep = 1.0f / Tests::NetworkSimulator::FramesInSecond;
+
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(
+        context, "@/InterestGrid/FilteredTest.prefab", CreateFilteredTestPrefab);
+
+    for (const bool useGrid : {false, true})
+    {
+        auto serverScene = MakeShared<Scene>(context);
+        Tests::NetworkSimulator sim(serverScene);
+        RandomEngine& random = sim.GetRandom();
+
+        if (useGrid)
+            GetServerReplicator(serverScene)->SetSetting(NetworkSettings::InterestGridCellSize, 50.0f);
+
+        ea::vector<SharedPtr<Scene>> clientScenes;
+        for (unsigned i = 0; i < numConnections; ++i)
+        {
+            auto clientScene = MakeShared<Scene>(context);
+            sim.AddClient(clientScene, Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0.0f, 0.0f});
+            clientScenes.push_back(clientScene);
+        }
+        sim.SimulateTime(2.0f);
+
+        const auto getRandomPosition = [&]()
+        { return Vector3{random.GetFloat(0.0f, worldSize), 0.0f, random.GetFloat(0.0f, worldSize)}; };
+
+        for (unsigned i = 0; i < numConnections; ++i)
+        {
+            auto node = Tests::SpawnOnServer<BehaviorNetworkObject>(
+                serverScene, prefab, Format("Player {}", i), getRandomPosition());
+            node->GetComponent<BehaviorNetworkObject>()->SetOwner(
+                sim.GetServerToClientConnection(clientScenes[i]));
+        }
+        for (unsigned i = numConnections; i < numObjects; ++i)
+            Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Object", getRandomPosition());
+        sim.SimulateTime(1.0f);
+
+        BENCHMARK(Format("Replicate {} objects to {} connections, {}", numObjects, numConnections,
+            useGrid ? "interest grid" : "no interest grid").c_str())
+        {
+            sim.SimulateEngineFrame(timeStep);
+        };
+    }
+}
@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Core/Thread.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+/// Behavior that must be cooked in the main thread.
+class MainThreadBehavior : public NetworkBehavior
+{
+    URHO3D_OBJECT(MainThreadBehavior, NetworkBehavior);
+
+public:
+    static constexpr NetworkCallbackFlags CallbackMask =
+        NetworkCallbackMask::UnreliableDelta | NetworkCallbackMask::ThreadUnsafeDelta;
+
+    explicit MainThreadBehavior(Context* context) : NetworkBehavior(context, CallbackMask) {}
+
+    bool PrepareUnreliableDelta(NetworkFrame frame) override { return true; }
+
+    void WriteUnreliableDelta(NetworkFrame frame, Serializer& dest) override
+    {
+        if (!Thread::IsMainThread())
+            ++numCallsFromWorkerThreads_;
+        dest.WriteInt64(static_cast<long long>(frame));
+    }
+
+    void ReadUnreliableDelta(NetworkFrame frame, Deserializer& src) override
+    {
+        if (static_cast<long long>(frame) == src.ReadInt64())
+            ++numValidUpdates_;
+    }
+
+    unsigned numCallsFromWorkerThreads_{};
+    unsigned numValidUpdates_{};
+};
+
+SharedPtr<PrefabResource> CreateThreadSafeTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+SharedPtr<PrefabResource> CreateThreadUnsafeTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+    node->CreateComponent<MainThreadBehavior>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+}
+
+TEST_CASE("Delta updates are cooked in worker threads except for thread-unsafe objects")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<MainThreadBehavior>(context);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto threadSafePrefab = Tests::GetOrCreateResource<PrefabResource>(
+        context, "@/ParallelDeltaCooking/ThreadSafeTest.prefab", CreateThreadSafeTestPrefab);
+    auto threadUnsafePrefab = Tests::GetOrCreateResource<PrefabResource>(
+        context, "@/ParallelDeltaCooking/ThreadUnsafeTest.prefab", CreateThreadUnsafeTestPrefab);
+
+    // Create scenes
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0, 0};
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    // Spawn enough objects to be cooked in multiple threads
+    const unsigned numObjects = 8 * SharedReplicationState::ParallelCookingBucketSize;
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        const ea::string name = Format("Node {}", i);
+        serverNodes.push_back(Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, threadSafePrefab, name));
+    }
+
+    Node* serverUnsafeNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, threadUnsafePrefab, "Unsafe Node");
+    auto serverBehavior = serverUnsafeNode->GetComponent<MainThreadBehavior>();
+    sim.SimulateTime(5.0f);
+
+    // Move all objects
+    for (unsigned i = 0; i < numObjects; ++i)
+        serverNodes[i]->SetWorldPosition(Vector3{static_cast<float>(i), 0.0f, 1.0f});
+    serverUnsafeNode->SetWorldPosition(Vector3{-1.0f, 0.0f, 1.0f});
+    sim.SimulateTime(5.0f);
+
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        Node* clientNode = clientScene->GetChild(Format("Node {}", i), true);
+        REQUIRE(clientNode);
+        REQUIRE(clientNode->GetWorldPosition() == serverNodes[i]->GetWorldPosition());
+    }
+
+    Node* clientUnsafeNode = clientScene->GetChild("Unsafe Node", true);
+    REQUIRE(clientUnsafeNode);
+    REQUIRE(clientUnsafeNode->GetWorldPosition() == serverUnsafeNode->GetWorldPosition());
+
+    auto clientBehavior = clientUnsafeNode->GetComponent<MainThreadBehavior>();
+    REQUIRE(serverBehavior->numCallsFromWorkerThreads_ == 0);
+    REQUIRE(clientBehavior->numValidUpdates_ > 0);
+}
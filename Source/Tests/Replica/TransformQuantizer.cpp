@@ -0,0 +1,264 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/NetworkSettingsConsts.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ServerReplicator.h>
+#include <Urho3D/Replica/TransformQuantizer.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+namespace
+{
+
+/// Behavior that makes the object updated every other frame for all clients.
+class EveryOtherFrameRelevance : public NetworkBehavior
+{
+    URHO3D_OBJECT(EveryOtherFrameRelevance, NetworkBehavior);
+
+public:
+    explicit EveryOtherFrameRelevance(Context* context) : NetworkBehavior(context, NetworkCallbackMask::None) {}
+
+    ea::optional<NetworkObjectRelevance> GetRelevanceForClient(AbstractConnection* connection) override
+    {
+        return static_cast<NetworkObjectRelevance>(2);
+    }
+};
+
+SharedPtr<PrefabResource> CreateTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+SharedPtr<PrefabResource> CreateEveryOtherFrameTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+    node->CreateComponent<EveryOtherFrameRelevance>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+struct TransformSyncResult
+{
+    float averageUpdateSize_{};
+    float positionError_{};
+    bool isRotationEquivalent_{};
+};
+
+TransformSyncResult SimulateMovingObjects(
+    Context* context, ReplicatedTransformEncoding encoding, unsigned keyframeInterval, const Tests::ConnectionQuality& quality)
+{
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/TransformQuantizer/Test.prefab", CreateTestPrefab);
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    // Common settings should be set before the client is connected
+    Tests::NetworkSimulator sim(serverScene);
+    ServerReplicator* serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    serverReplicator->SetSetting(NetworkSettings::TransformEncoding, static_cast<unsigned>(encoding));
+    serverReplicator->SetSetting(NetworkSettings::TransformKeyframeInterval, keyframeInterval);
+    serverReplicator->SetSetting(NetworkSettings::TransformQuantizationOrigin, Vector3{100.0f, 0.0f, 100.0f});
+
+    Node* serverNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Node", {100.0f, 10.0f, 50.0f});
+    auto serverTransform = serverNode->GetComponent<ReplicatedTransform>();
+
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](VariantMap& eventData)
+    {
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        serverNode->Translate(timeStep * 2.0f * Vector3::LEFT, TS_WORLD);
+        serverNode->Rotate({timeStep * 10.0f, Vector3::UP}, TS_PARENT);
+    });
+
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(9.0f);
+
+    const auto& clientReplica = *clientScene->GetComponent<ReplicationManager>()->GetClientReplica();
+    const NetworkTime replicaTime = clientReplica.GetReplicaTime();
+    Node* clientNode = clientScene->GetChild("Node", true);
+    REQUIRE(clientNode);
+
+    TransformSyncResult result;
+    result.averageUpdateSize_ = serverTransform->GetAverageUpdateSize();
+    result.positionError_ =
+        (serverTransform->SampleTemporalPosition(replicaTime).value_ - clientNode->GetWorldPosition()).Length();
+    result.isRotationEquivalent_ =
+        serverTransform->SampleTemporalRotation(replicaTime).value_.Equivalent(clientNode->GetWorldRotation(), 0.002f);
+    return result;
+}
+
+}
+
+TEST_CASE("TransformQuantizer preserves transforms within precision")
+{
+    TransformQuantizer quantizer;
+    quantizer.origin_ = Vector3{1000.0f, 0.0f, -1000.0f};
+
+    const Vector3 positions[] = {
+        {1000.0f, 0.0f, -1000.0f},
+        {1234.5678f, -12.3456f, -2000.0f},
+        {-2000.0f, 4000.0f, 1000.0f},
+    };
+    const Quaternion rotations[] = {
+        Quaternion::IDENTITY,
+        Quaternion{90.0f, Vector3::UP},
+        Quaternion{-179.0f, Vector3{1.0f, 2.0f, 3.0f}.Normalized()},
+        Quaternion{45.0f, 30.0f, -60.0f},
+    };
+    const Vector3 velocity{0.1234f, -15.0f, 20.0f};
+    const Vector3 angularVelocity{0.01f, -0.2f, 0.0f};
+
+    VectorBuffer buffer;
+    {
+        BitWriter writer{buffer};
+        for (const Vector3& position : positions)
+            quantizer.WritePosition(writer, quantizer.QuantizePosition(position));
+        for (const Quaternion& rotation : rotations)
+            quantizer.WriteRotation(writer, rotation);
+        quantizer.WriteVelocity(writer, velocity);
+        quantizer.WriteVelocity(writer, Vector3::ZERO);
+        quantizer.WriteAngularVelocity(writer, angularVelocity);
+        writer.Flush();
+    }
+
+    MemoryBuffer src{buffer.GetBuffer()};
+    BitReader reader{src};
+    for (const Vector3& position : positions)
+    {
+        const Vector3 decodedPosition = quantizer.DequantizePosition(quantizer.ReadPosition(reader));
+        REQUIRE(decodedPosition.Equals(position, quantizer.positionStep_));
+    }
+    for (const Quaternion& rotation : rotations)
+        REQUIRE(quantizer.ReadRotation(reader).Equivalent(rotation, 0.002f));
+
+    // Velocity is clamped to the range
+    REQUIRE(quantizer.ReadVelocity(reader).Equals(Vector3{0.1234f, -15.0f, 16.0f}, quantizer.positionStep_));
+    REQUIRE(quantizer.ReadVelocity(reader) == Vector3::ZERO);
+    REQUIRE(quantizer.ReadAngularVelocity(reader).Equals(angularVelocity, 0.001f));
+}
+
+TEST_CASE("Quantized transforms are replicated with less bandwidth than raw transforms")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0, 0};
+    const auto lossyQuality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0.02f, 0.02f};
+
+    const auto raw = SimulateMovingObjects(context, ReplicatedTransformEncoding::Raw, 0, quality);
+    const auto quantized = SimulateMovingObjects(context, ReplicatedTransformEncoding::Quantized, 0, quality);
+    const auto delta = SimulateMovingObjects(context, ReplicatedTransformEncoding::Quantized, 10, quality);
+    const auto lossyDelta = SimulateMovingObjects(context, ReplicatedTransformEncoding::Quantized, 10, lossyQuality);
+
+    REQUIRE(raw.averageUpdateSize_ == 52.0f);
+    REQUIRE(quantized.averageUpdateSize_ < raw.averageUpdateSize_ / 2);
+    REQUIRE(delta.averageUpdateSize_ < quantized.averageUpdateSize_);
+
+    REQUIRE(raw.positionError_ < ReplicatedTransform::DefaultMovementThreshold);
+    REQUIRE(quantized.positionError_ < 0.005f);
+    REQUIRE(delta.positionError_ < 0.005f);
+    REQUIRE(lossyDelta.positionError_ < 0.05f);
+
+    REQUIRE(raw.isRotationEquivalent_);
+    REQUIRE(quantized.isRotationEquivalent_);
+    REQUIRE(delta.isRotationEquivalent_);
+}
+
+TEST_CASE("Quantized delta transforms are decoded by clients that skip keyframes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<EveryOtherFrameRelevance>(context);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(
+        context, "@/TransformQuantizer/EveryOtherFrameTest.prefab", CreateEveryOtherFrameTestPrefab);
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    // Even keyframe interval makes all keyframes land either on sent or on skipped frames of the client
+    Tests::NetworkSimulator sim(serverScene);
+    ServerReplicator* serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    serverReplicator->SetSetting(
+        NetworkSettings::TransformEncoding, static_cast<unsigned>(ReplicatedTransformEncoding::Quantized));
+    serverReplicator->SetSetting(NetworkSettings::TransformKeyframeInterval, 10);
+
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0, 0};
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(1.0f);
+
+    for (unsigned spawnFrame = 0; spawnFrame < 2; ++spawnFrame)
+    {
+        const ea::string name = Format("Node {}", spawnFrame);
+        Node* serverNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, name);
+        auto serverTransform = serverNode->GetComponent<ReplicatedTransform>();
+
+        serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+            [=](VariantMap& eventData)
+        {
+            const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+            serverNode->Translate(timeStep * 2.0f * Vector3::LEFT, TS_WORLD);
+        });
+
+        // Keyframes of the next object are shifted by one frame
+        sim.SimulateTime(1.0f / Tests::NetworkSimulator::FramesInSecond);
+        sim.SimulateTime(4.0f);
+
+        Node* clientNode = clientScene->GetChild(name, true);
+        REQUIRE(clientNode);
+        auto clientTransform = clientNode->GetComponent<ReplicatedTransform>();
+
+        // Every other frame of the last second should be received, skip the frames that may still be in flight
+        const auto latestFrame = *serverTransform->GetLatestFrame();
+        unsigned numReceivedFrames = 0;
+        for (unsigned i = 10; i < 10 + Tests::NetworkSimulator::FramesInSecond; ++i)
+        {
+            const NetworkFrame frame = latestFrame - i;
+            const auto clientPosition = clientTransform->GetTemporalPosition(frame);
+            if (!clientPosition)
+                continue;
+
+            const auto serverPosition = serverTransform->GetTemporalPosition(frame);
+            REQUIRE(serverPosition);
+            REQUIRE(clientPosition->value_.Equals(serverPosition->value_, 0.005f));
+            ++numReceivedFrames;
+        }
+        REQUIRE(numReceivedFrames >= Tests::NetworkSimulator::FramesInSecond / 2);
+
+        serverScene->UnsubscribeFromEvent(serverScene, E_SCENEUPDATE);
+    }
+}
@@ -0,0 +1,245 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/MountedExternalMemory.h>
+#include <Urho3D/IO/VirtualFileSystem.h>
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+namespace Tests
+{
+
+namespace
+{
+
+/// Names of TestDependentResource-s in order of finishing.
+ea::vector<ea::string> finishedDependentResources;
+
+/// Resource that background loads resources listed in its file and stores dependencies on them.
+/// Loading fails if any of dependencies is not finished before this resource.
+class TestDependentResource : public Resource
+{
+    URHO3D_OBJECT(TestDependentResource, Resource);
+
+public:
+    using Resource::Resource;
+
+    bool BeginLoad(Deserializer& source) override
+    {
+        ++numLoads_;
+        dependencies_.clear();
+
+        auto cache = GetSubsystem<ResourceCache>();
+        while (!source.IsEof())
+        {
+            const ea::string dependency = source.ReadLine().trimmed();
+            if (dependency.empty())
+                continue;
+
+            dependencies_.push_back(dependency);
+            cache->StoreResourceDependency(this, dependency);
+            cache->BackgroundLoadResource(GetDependencyType(dependency), dependency, true, this);
+        }
+        return true;
+    }
+
+    bool EndLoad() override
+    {
+        auto cache = GetSubsystem<ResourceCache>();
+        for (const ea::string& dependency : dependencies_)
+        {
+            Resource* resource = cache->GetExistingResource(GetDependencyType(dependency), dependency);
+            if (!resource || resource->GetAsyncLoadState() != ASYNC_DONE)
+                return false;
+        }
+
+        finishedDependentResources.push_back(GetName());
+        return true;
+    }
+
+    static StringHash GetDependencyType(const ea::string& name)
+    {
+        return name.ends_with(".dep") ? GetTypeStatic() : XMLFile::GetTypeStatic();
+    }
+
+    unsigned numLoads_{};
+    ea::vector<ea::string> dependencies_;
+};
+
+/// Link synthetic XML and JSON resources into memory mount point. Return list of resource names.
+ea::vector<ea::pair<StringHash, ea::string>> CreateSyntheticResources(MountedExternalMemory* mountPoint,
+    ea::vector<ea::string>& contents, unsigned numResources, unsigned numElements)
+{
+    ea::vector<ea::pair<StringHash, ea::string>> resources;
+    contents.clear();
+    contents.reserve(numResources);
+    for (unsigned i = 0; i < numResources; ++i)
+    {
+        const bool isXml = i % 2 == 0;
+        ea::string content = isXml ? "<root>" : "{\"items\":[";
+        for (unsigned j = 0; j < numElements; ++j)
+        {
+            if (isXml)
+                content += Format("<item index=\"{}\" value=\"{}\" />", j, i * j);
+            else
+                content += Format("{}{{\"index\":{},\"value\":{}}}", j != 0 ? "," : "", j, i * j);
+        }
+        content += isXml ? "</root>" : "]}";
+        contents.push_back(ea::move(content));
+
+        const ea::string fileName = Format("BackgroundLoader/Resource{}.{}", i, isXml ? "xml" : "json");
+        mountPoint->LinkMemory(fileName, contents.back());
+        resources.emplace_back(isXml ? XMLFile::GetTypeStatic() : JSONFile::GetTypeStatic(), "memory://" + fileName);
+    }
+    return resources;
+}
+
+/// Queue all resources for background loading and run frames until they are finished.
+void BackgroundLoadAll(Context* context, const ea::vector<ea::pair<StringHash, ea::string>>& resources)
+{
+    const auto cache = context->GetSubsystem<ResourceCache>();
+    for (const auto& [type, name] : resources)
+        cache->BackgroundLoadResource(type, name);
+
+    while (cache->GetNumBackgroundLoadResources() != 0)
+        Tests::RunFrame(context, 0.01f);
+}
+
+} // namespace
+
+TEST_CASE("ResourceCache loads resources in background")
+{
+    const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto cache = context->GetSubsystem<ResourceCache>();
+    auto mountPoint = MakeShared<MountedExternalMemory>(context, "memory");
+    const MountPointGuard mountPointGuard(mountPoint);
+
+    ea::vector<ea::string> contents;
+    const auto resources = CreateSyntheticResources(mountPoint, contents, 64, 16);
+
+    const unsigned maxThreads = cache->GetMaxBackgroundLoadThreads();
+    for (unsigned numThreads : {1u, 0u})
+    {
+        cache->SetMaxBackgroundLoadThreads(numThreads);
+        BackgroundLoadAll(context, resources);
+
+        for (const auto& [type, name] : resources)
+        {
+            Resource* resource = cache->GetExistingResource(type, name);
+            REQUIRE(resource);
+            CHECK(resource->GetAsyncLoadState() == ASYNC_DONE);
+        }
+
+        // Resource requested synchronously should be finished immediately
+        cache->ReleaseAllResources(true);
+        for (const auto& [type, name] : resources)
+            cache->BackgroundLoadResource(type, name);
+
+        const auto& [lastType, lastName] = resources.back();
+        CHECK(cache->GetResource(lastType, lastName));
+
+        BackgroundLoadAll(context, {});
+        cache->ReleaseAllResources(true);
+    }
+    cache->SetMaxBackgroundLoadThreads(maxThreads);
+}
+
+TEST_CASE("ResourceCache finishes background loaded resources after their dependencies")
+{
+    const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto cache = context->GetSubsystem<ResourceCache>();
+    auto guard = Tests::MakeScopedReflection<TestDependentResource>(context);
+    auto mountPoint = MakeShared<MountedExternalMemory>(context, "memory");
+    const MountPointGuard mountPointGuard(mountPoint);
+
+    // Parent.dep -> Child.dep -> Leaf.xml, Parent.dep -> Other.xml
+    mountPoint->LinkMemory("BackgroundLoader/Parent.dep",
+        "memory://BackgroundLoader/Child.dep\nmemory://BackgroundLoader/Other.xml\n");
+    mountPoint->LinkMemory("BackgroundLoader/Child.dep", "memory://BackgroundLoader/Leaf.xml\n");
+    mountPoint->LinkMemory("BackgroundLoader/Leaf.xml", "<leaf />");
+    mountPoint->LinkMemory("BackgroundLoader/Other.xml", "<other />");
+
+    ea::vector<ea::string> contents;
+    const auto resources = CreateSyntheticResources(mountPoint, contents, 64, 16);
+
+    const unsigned maxThreads = cache->GetMaxBackgroundLoadThreads();
+    for (unsigned numThreads : {1u, 0u})
+    {
+        cache->SetMaxBackgroundLoadThreads(numThreads);
+        finishedDependentResources.clear();
+
+        cache->BackgroundLoadResource<TestDependentResource>("memory://BackgroundLoader/Parent.dep");
+        BackgroundLoadAll(context, resources);
+
+        auto parent = cache->GetExistingResource<TestDependentResource>("memory://BackgroundLoader/Parent.dep");
+        auto child = cache->GetExistingResource<TestDependentResource>("memory://BackgroundLoader/Child.dep");
+        REQUIRE(parent);
+        REQUIRE(child);
+        REQUIRE(finishedDependentResources
+            == ea::vector<ea::string>{"memory://BackgroundLoader/Child.dep", "memory://BackgroundLoader/Parent.dep"});
+
+        // Dependencies stored during background loading are used to reload dependent resources
+        cache->ReloadResourceWithDependencies("memory://BackgroundLoader/Leaf.xml");
+        CHECK(child->numLoads_ == 2);
+        CHECK(parent->numLoads_ == 1);
+
+        cache->ReloadResourceWithDependencies("memory://BackgroundLoader/Other.xml");
+        CHECK(child->numLoads_ == 2);
+        CHECK(parent->numLoads_ == 2);
+
+        cache->ReleaseAllResources(true);
+    }
+    cache->SetMaxBackgroundLoadThreads(maxThreads);
+}
+
+TEST_CASE("ResourceCache background loading benchmark", "[.benchmark]")
+{
+    const auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    const auto cache = context->GetSubsystem<ResourceCache>();
+    const auto workQueue = context->GetSubsystem<WorkQueue>();
+    auto mountPoint = MakeShared<MountedExternalMemory>(context, "memory");
+    const MountPointGuard mountPointGuard(mountPoint);
+
+    ea::vector<ea::string> contents;
+    const auto resources = CreateSyntheticResources(mountPoint, contents, 5000, 64);
+
+    const unsigned maxThreads = cache->GetMaxBackgroundLoadThreads();
+    const unsigned numWorkerThreads = ea::max(1u, workQueue->GetNumProcessingThreads() - 1);
+    for (unsigned numThreads : Tests::GetThreadCountsUpTo(numWorkerThreads))
+    {
+        cache->SetMaxBackgroundLoadThreads(numThreads);
+        BENCHMARK(Format("5000 resources, {} of {} worker threads", numThreads, numWorkerThreads).c_str())
+        {
+            cache->ReleaseAllResources(true);
+            BackgroundLoadAll(context, resources);
+            return cache->GetNumBackgroundLoadResources();
+        };
+    }
+    cache->SetMaxBackgroundLoadThreads(maxThreads);
+    cache->ReleaseAllResources(true);
+}
+
+} // namespace Tests
@@ -33,6 +33,7 @@
 #include <Urho3D/Physics/Constraint.h>
 #include <Urho3D/Physics/RigidBody.h>
 
+#include <Urho3D/Scene/NodePool.h>
 #include <Urho3D/Scene/PrefabReference.h>
 #include <Urho3D/Scene/PrefabReader.h>
 #include <Urho3D/Scene/PrefabResource.h>
@@ -73,6 +74,23 @@ public:
     ea::string unchangedString_{"default"};
 };
 
+class TestLinkComponent : public Component
+{
+    URHO3D_OBJECT(TestLinkComponent, Component);
+
+public:
+    explicit TestLinkComponent(Context* context) : Component(context) {}
+
+    static void RegisterObject(Context* context)
+    {
+        context->RegisterFactory<TestLinkComponent>();
+
+        URHO3D_ATTRIBUTE("Target NodeID", unsigned, targetId_, 0, AM_DEFAULT | AM_NODEID);
+    }
+
+    unsigned targetId_{};
+};
+
 NodePrefab MakeTestPrefab()
 {
     NodePrefab source;
@@ -933,3 +951,247 @@ TEST_CASE("Prefab reference is reloaded")
     REQUIRE(node->GetChild(2u)->GetNumComponents() == 0);
     REQUIRE(node->GetChild(2u)->GetNumChildren() == 1);
 }
+
+TEST_CASE("Compiled prefab is instantiated like generic prefab")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TestComponent>>(context);
+
+    auto prefabResource = MakeShared<PrefabResource>(context);
+    prefabResource->GetMutableNodePrefab() = MakeTestPrefab();
+    REQUIRE(prefabResource->GetCompiledNodePrefab().IsValid());
+    REQUIRE(prefabResource->GetCompiledNodePrefab().GetNumNodes() == 7);
+
+    auto scene = MakeShared<Scene>(context);
+    const Quaternion rotation{90.0f, Vector3::UP};
+    Node* expected = scene->InstantiatePrefab(prefabResource, Vector3{5, 0, 0}, rotation);
+
+    const Vector3 positions[] = {{5, 0, 0}, {0, 5, 0}, {0, 0, 5}};
+    const Quaternion rotations[] = {rotation, rotation, rotation};
+    const auto nodes = scene->InstantiatePrefabMany(prefabResource, positions, rotations);
+    REQUIRE(nodes.size() == 3);
+
+    const auto compareNodes = [](const Node* lhs, const Node* rhs, const auto& self) -> void
+    {
+        CHECK(lhs->GetName() == rhs->GetName());
+        CHECK(lhs->IsTemporary() == rhs->IsTemporary());
+        CHECK(lhs->GetWorldTransform().Equals(rhs->GetWorldTransform()));
+        REQUIRE(lhs->GetNumComponents() == rhs->GetNumComponents());
+        for (unsigned i = 0; i < lhs->GetNumComponents(); ++i)
+        {
+            const auto lhsComponent = dynamic_cast<const TestComponent*>(lhs->GetComponents()[i].Get());
+            const auto rhsComponent = dynamic_cast<const TestComponent*>(rhs->GetComponents()[i].Get());
+            REQUIRE(lhsComponent);
+            REQUIRE(rhsComponent);
+            CHECK(lhsComponent->enum_ == rhsComponent->enum_);
+            CHECK(lhsComponent->unchangedString_ == rhsComponent->unchangedString_);
+        }
+        REQUIRE(lhs->GetNumChildren() == rhs->GetNumChildren());
+        for (unsigned i = 0; i < lhs->GetNumChildren(); ++i)
+            self(lhs->GetChildren()[i], rhs->GetChildren()[i], self);
+    };
+
+    compareNodes(nodes[0], expected, compareNodes);
+    CHECK(nodes[1]->GetPosition() == Vector3{0, 5, 0});
+    CHECK(nodes[2]->GetPosition() == Vector3{0, 0, 5});
+    CHECK(nodes[2]->GetComponent<TestComponent>()->enum_ == TestEnum::Blue);
+
+    // Compiled prefab is invalidated on change
+    prefabResource->GetMutableNodePrefab().GetMutableChildren().clear();
+    REQUIRE(prefabResource->GetCompiledNodePrefab().GetNumNodes() == 1);
+}
+
+TEST_CASE("Compiled prefab is discarded when reflection is removed")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto prefabResource = MakeShared<PrefabResource>(context);
+    {
+        auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TestComponent>>(context);
+        prefabResource->GetMutableNodePrefab() = MakeTestPrefab();
+        REQUIRE(prefabResource->GetCompiledNodePrefab().IsValid());
+    }
+
+    // Component type is unknown now, so the prefab cannot be compiled
+    REQUIRE_FALSE(prefabResource->GetCompiledNodePrefab().IsValid());
+}
+
+TEST_CASE("Node pool reuses recycled and removed instances")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TestComponent>>(context);
+
+    auto prefabResource = MakeShared<PrefabResource>(context);
+    prefabResource->GetMutableNodePrefab() = MakeTestPrefab();
+
+    auto scene = MakeShared<Scene>(context);
+    auto pool = MakeShared<NodePool>(scene, prefabResource);
+
+    Node* first = pool->Spawn(scene, Vector3{1, 0, 0});
+    Node* second = pool->Spawn(scene, Vector3{2, 0, 0});
+    REQUIRE(pool->GetNumActive() == 2);
+    CHECK(pool->GetFrameStats().numAllocatedNodes_ == 14);
+    CHECK(pool->GetFrameStats().numAllocatedComponents_ == 12);
+
+    // Modify instance and recycle it
+    const unsigned firstId = first->GetID();
+    first->SetName("Modified");
+    first->GetComponent<TestComponent>()->unchangedString_ = "modified";
+    first->GetChildren()[0]->SetVar("Key", 1);
+    REQUIRE(pool->Recycle(first));
+    CHECK_FALSE(first->IsEnabled());
+    CHECK(first->GetScene() == scene);
+    CHECK(pool->GetNumParked() == 1);
+    CHECK_FALSE(pool->Recycle(scene));
+
+    // Recycled instance is reset and keeps its ID
+    Node* reused = pool->Spawn(scene, Vector3{3, 0, 0});
+    REQUIRE(reused == first);
+    CHECK(reused->GetParent() == scene);
+    CHECK(reused->GetID() == firstId);
+    CHECK(reused->IsEnabled());
+    CHECK(reused->GetName() == "Apple");
+    CHECK(reused->GetPosition() == Vector3{3, 0, 0});
+    CHECK(reused->GetComponent<TestComponent>()->unchangedString_ == "default");
+    CHECK(reused->GetChildren()[0]->GetVar("Key").IsEmpty());
+
+    // Removed instance is recycled if nothing else references it
+    second->Remove();
+    Node* reusedRemoved = pool->Spawn(scene);
+    CHECK(reusedRemoved == second);
+    CHECK(reusedRemoved->GetScene() == scene);
+    CHECK(reusedRemoved->GetNumChildren() == 4);
+
+    // Instance with changed hierarchy is discarded
+    REQUIRE(pool->Recycle(reused));
+    reused->GetChildren()[0]->Remove();
+    Node* third = pool->Spawn(scene);
+    CHECK(third->GetNumChildren() == 4);
+    CHECK(pool->GetNumParked() == 0);
+
+    const NodePoolStats& stats = pool->GetFrameStats();
+    CHECK(stats.numSpawned_ == 5);
+    CHECK(stats.numReused_ == 2);
+    CHECK(stats.numRecycled_ == 3);
+    CHECK(stats.numAllocatedNodes_ == 21);
+}
+
+TEST_CASE("Node pool resolves references between nodes of reused instances")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TestLinkComponent>>(context);
+
+    auto prefabResource = MakeShared<PrefabResource>(context);
+    {
+        NodePrefab& prefab = prefabResource->GetMutableNodePrefab();
+        prefab.GetMutableNode().SetId(SerializableId{101});
+        prefab.GetMutableChildren().emplace_back().GetMutableNode().SetId(SerializableId{102});
+
+        auto& component = prefab.GetMutableComponents().emplace_back();
+        component.SetId(SerializableId{201});
+        component.SetType(TestLinkComponent::GetTypeNameStatic());
+        component.GetMutableAttributes().emplace_back("Target NodeID").SetValue(102u);
+    }
+
+    auto scene = MakeShared<Scene>(context);
+    auto pool = MakeShared<NodePool>(scene, prefabResource);
+
+    const auto checkLink = [](Node* node)
+    {
+        REQUIRE(node->GetNumChildren() == 1);
+        const unsigned childId = node->GetChildren()[0]->GetID();
+        CHECK(childId != 0);
+        CHECK(node->GetComponent<TestLinkComponent>()->targetId_ == childId);
+    };
+
+    Node* node = pool->Spawn(scene);
+    checkLink(node);
+
+    // IDs of removed instance are reset and assigned again on reuse
+    node->Remove();
+    Node* reused = pool->Spawn(scene);
+    REQUIRE(reused == node);
+    checkLink(reused);
+
+    REQUIRE(pool->Recycle(reused));
+    reused = pool->Spawn(scene);
+    REQUIRE(reused == node);
+    checkLink(reused);
+}
+
+TEST_CASE("Node pool recycles instances in any order")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TestComponent>>(context);
+
+    auto prefabResource = MakeShared<PrefabResource>(context);
+    prefabResource->GetMutableNodePrefab() = MakeTestPrefab();
+
+    auto scene = MakeShared<Scene>(context);
+    auto pool = MakeShared<NodePool>(scene, prefabResource);
+
+    ea::vector<Node*> nodes;
+    for (unsigned i = 0; i < 30; ++i)
+        nodes.push_back(pool->Spawn(scene));
+
+    // Remove some instances from the scene, they are collected on the next spawn
+    for (unsigned i = 0; i < nodes.size(); i += 5)
+        nodes[i]->Remove();
+    REQUIRE(pool->Spawn(scene) == nodes[25]);
+    REQUIRE(pool->GetNumActive() == 25);
+    REQUIRE(pool->GetNumParked() == 5);
+
+    // Recycle instances in order different from spawn order, removed instances are not active anymore
+    for (unsigned i = 0; i < nodes.size(); ++i)
+    {
+        Node* node = nodes[(i * 7) % nodes.size()];
+        const bool isActive = node->GetParent() != nullptr;
+        CHECK(pool->Recycle(node) == isActive);
+    }
+    CHECK(pool->GetNumActive() == 0);
+    CHECK(pool->GetNumParked() == 30);
+
+    for (Node* node : nodes)
+        CHECK_FALSE(pool->Recycle(node));
+}
+
+TEST_CASE("Prefab instantiation benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto guard = Tests::MakeScopedReflection<Tests::RegisterObject<TestComponent>>(context);
+
+    auto prefabResource = MakeShared<PrefabResource>(context);
+    prefabResource->GetMutableNodePrefab() = MakeTestPrefab();
+
+    const unsigned numInstances = 1000;
+    ea::vector<Vector3> positions(numInstances);
+    for (unsigned i = 0; i < numInstances; ++i)
+        positions[i] = Vector3{static_cast<float>(i), 0, 0};
+
+    BENCHMARK("Instantiate generic prefab")
+    {
+        auto scene = MakeShared<Scene>(context);
+        for (const Vector3& position : positions)
+            scene->InstantiatePrefab(prefabResource, position);
+        return scene->GetNumChildren();
+    };
+
+    BENCHMARK("Instantiate compiled prefab")
+    {
+        auto scene = MakeShared<Scene>(context);
+        return scene->InstantiatePrefabMany(prefabResource, positions).size();
+    };
+
+    auto scene = MakeShared<Scene>(context);
+    auto pool = MakeShared<NodePool>(scene, prefabResource);
+    pool->Reserve(numInstances);
+
+    BENCHMARK("Spawn and recycle pooled prefab")
+    {
+        ea::vector<Node*> nodes;
+        for (const Vector3& position : positions)
+            nodes.push_back(pool->Spawn(scene, position));
+        for (Node* node : nodes)
+            pool->Recycle(node);
+        return nodes.size();
+    };
+}
@@ -243,21 +243,11 @@ void btDbvtBroadphase::rayTest(const btVector3& rayFrom, const btVector3& rayTo,
 	btAlignedObjectArray<const btDbvtNode*>* stack = &m_rayTestStacks[0];
 #if BT_THREADSAFE
 	// for this function to be threadsafe, each thread must have a separate copy
-	// of this stack.  This could be thread-local static to avoid dynamic allocations,
-	// instead of just a local.
-	int threadIndex = btGetCurrentThreadIndex();
-	btAlignedObjectArray<const btDbvtNode*> localStack;
-	//todo(erwincoumans, "why do we get tsan issue here?")
-	if (0)//threadIndex < m_rayTestStacks.size())
-	//if (threadIndex < m_rayTestStacks.size())
-	{
-		// use per-thread preallocated stack if possible to avoid dynamic allocations
-		stack = &m_rayTestStacks[threadIndex];
-	}
-	else
-	{
-		stack = &localStack;
-	}
+	// of this stack.
+	// Urho3D: use thread-local stack instead of the local one to avoid dynamic allocation on every ray test.
+	// Thread indices from btGetCurrentThreadIndex wrap around and may be shared, so m_rayTestStacks is not used.
+	static thread_local btAlignedObjectArray<const btDbvtNode*> threadStack;
+	stack = &threadStack;
 #endif
 
 	m_sets[0].rayTestInternal(m_sets[0].m_root,
@@ -168,6 +168,17 @@ public:
 	// Urho3D: added function to know when we have too many obstacle requests without update
 	bool isObstacleQueueFull() const { return m_nreqs >= MAX_REQUESTS; }
 	
+	// Urho3D: added functions to rebuild tiles touched by obstacles outside of update().
+	// Pending tiles are built by buildTilePolyMesh, which does not modify the tile cache and may be called
+	// from multiple threads concurrently as long as each thread uses its own allocator.
+	// Results are applied to the navmesh by commitTilePolyMesh in the same order as returned by getPendingTiles.
+	bool isUpToDate() const { return m_nupdate == 0 && m_nreqs == 0; }
+	int getPendingTileCount() const { return m_nupdate; }
+	int getPendingTiles(dtCompressedTileRef* tiles, const int maxTiles);
+	dtStatus buildTilePolyMesh(const dtCompressedTileRef ref, struct dtTileCacheAlloc* talloc,
+							   struct dtTileCachePolyMesh** result) const;
+	dtStatus commitTilePolyMesh(const dtCompressedTileRef ref, struct dtTileCachePolyMesh* lmesh, class dtNavMesh* navmesh);
+	
 	/// Encodes a tile id.
 	inline dtCompressedTileRef encodeTileId(unsigned int salt, unsigned int it) const
 	{
@@ -214,6 +225,12 @@ private:
 	dtTileCache(const dtTileCache&);
 	dtTileCache& operator=(const dtTileCache&);
 
+	// Urho3D: helpers shared by update() and external tile rebuild
+	void processObstacleRequests();
+	void finishTileUpdate(const dtCompressedTileRef ref);
+	dtStatus buildTileLayerMesh(const dtCompressedTileRef ref, struct NavMeshTileBuildContext& bc) const;
+	dtStatus addNavMeshTile(const dtCompressedTile* tile, struct dtTileCachePolyMesh* lmesh, class dtNavMesh* navmesh);
+
 	enum ObstacleRequestAction
 	{
 		REQUEST_ADD,
@@ -533,116 +533,169 @@ dtStatus dtTileCache::update(const float /*dt*/, dtNavMesh* navmesh,
 							 bool* upToDate)
 {
 	if (m_nupdate == 0)
+		processObstacleRequests();
+	
+	dtStatus status = DT_SUCCESS;
+	// Process updates
+	if (m_nupdate)
 	{
-		// Process requests.
-		for (int i = 0; i < m_nreqs; ++i)
+		// Build mesh
+		const dtCompressedTileRef ref = m_update[0];
+		status = buildNavMeshTile(ref, navmesh);
+		finishTileUpdate(ref);
+	}
+	
+	if (upToDate)
+		*upToDate = m_nupdate == 0 && m_nreqs == 0;
+
+	return status;
+}
+
+void dtTileCache::processObstacleRequests()
+{
+	for (int i = 0; i < m_nreqs; ++i)
+	{
+		ObstacleRequest* req = &m_reqs[i];
+		
+		unsigned int idx = decodeObstacleIdObstacle(req->ref);
+		if ((int)idx >= m_params.maxObstacles)
+			continue;
+		dtTileCacheObstacle* ob = &m_obstacles[idx];
+		unsigned int salt = decodeObstacleIdSalt(req->ref);
+		if (ob->salt != salt)
+			continue;
+		
+		if (req->action == REQUEST_ADD)
 		{
-			ObstacleRequest* req = &m_reqs[i];
-			
-			unsigned int idx = decodeObstacleIdObstacle(req->ref);
-			if ((int)idx >= m_params.maxObstacles)
-				continue;
-			dtTileCacheObstacle* ob = &m_obstacles[idx];
-			unsigned int salt = decodeObstacleIdSalt(req->ref);
-			if (ob->salt != salt)
-				continue;
-			
-			if (req->action == REQUEST_ADD)
+			// Find touched tiles.
+			float bmin[3], bmax[3];
+			getObstacleBounds(ob, bmin, bmax);
+
+			int ntouched = 0;
+			queryTiles(bmin, bmax, ob->touched, &ntouched, DT_MAX_TOUCHED_TILES);
+			ob->ntouched = (unsigned char)ntouched;
+			// Add tiles to update list.
+			ob->npending = 0;
+			for (int j = 0; j < ob->ntouched; ++j)
 			{
-				// Find touched tiles.
-				float bmin[3], bmax[3];
-				getObstacleBounds(ob, bmin, bmax);
-
-				int ntouched = 0;
-				queryTiles(bmin, bmax, ob->touched, &ntouched, DT_MAX_TOUCHED_TILES);
-				ob->ntouched = (unsigned char)ntouched;
-				// Add tiles to update list.
-				ob->npending = 0;
-				for (int j = 0; j < ob->ntouched; ++j)
+				if (m_nupdate < MAX_UPDATE)
 				{
-					if (m_nupdate < MAX_UPDATE)
-					{
-						if (!contains(m_update, m_nupdate, ob->touched[j]))
-							m_update[m_nupdate++] = ob->touched[j];
-						ob->pending[ob->npending++] = ob->touched[j];
-					}
+					if (!contains(m_update, m_nupdate, ob->touched[j]))
+						m_update[m_nupdate++] = ob->touched[j];
+					ob->pending[ob->npending++] = ob->touched[j];
 				}
 			}
-			else if (req->action == REQUEST_REMOVE)
+		}
+		else if (req->action == REQUEST_REMOVE)
+		{
+			// Prepare to remove obstacle.
+			ob->state = DT_OBSTACLE_REMOVING;
+			// Add tiles to update list.
+			ob->npending = 0;
+			for (int j = 0; j < ob->ntouched; ++j)
 			{
-				// Prepare to remove obstacle.
-				ob->state = DT_OBSTACLE_REMOVING;
-				// Add tiles to update list.
-				ob->npending = 0;
-				for (int j = 0; j < ob->ntouched; ++j)
+				if (m_nupdate < MAX_UPDATE)
 				{
-					if (m_nupdate < MAX_UPDATE)
-					{
-						if (!contains(m_update, m_nupdate, ob->touched[j]))
-							m_update[m_nupdate++] = ob->touched[j];
-						ob->pending[ob->npending++] = ob->touched[j];
-					}
+					if (!contains(m_update, m_nupdate, ob->touched[j]))
+						m_update[m_nupdate++] = ob->touched[j];
+					ob->pending[ob->npending++] = ob->touched[j];
 				}
 			}
 		}
-		
-		m_nreqs = 0;
 	}
 	
-	dtStatus status = DT_SUCCESS;
-	// Process updates
-	if (m_nupdate)
+	m_nreqs = 0;
+}
+
+void dtTileCache::finishTileUpdate(const dtCompressedTileRef ref)
+{
+	// Remove handled tile from update list.
+	for (int i = 0; i < m_nupdate; ++i)
 	{
-		// Build mesh
-		const dtCompressedTileRef ref = m_update[0];
-		status = buildNavMeshTile(ref, navmesh);
-		m_nupdate--;
-		if (m_nupdate > 0)
-			memmove(m_update, m_update+1, m_nupdate*sizeof(dtCompressedTileRef));
+		if (m_update[i] == ref)
+		{
+			m_nupdate--;
+			if (m_nupdate > i)
+				memmove(m_update+i, m_update+i+1, (m_nupdate-i)*sizeof(dtCompressedTileRef));
+			break;
+		}
+	}
 
-		// Update obstacle states.
-		for (int i = 0; i < m_params.maxObstacles; ++i)
+	// Update obstacle states.
+	for (int i = 0; i < m_params.maxObstacles; ++i)
+	{
+		dtTileCacheObstacle* ob = &m_obstacles[i];
+		if (ob->state == DT_OBSTACLE_PROCESSING || ob->state == DT_OBSTACLE_REMOVING)
 		{
-			dtTileCacheObstacle* ob = &m_obstacles[i];
-			if (ob->state == DT_OBSTACLE_PROCESSING || ob->state == DT_OBSTACLE_REMOVING)
+			// Remove handled tile from pending list.
+			for (int j = 0; j < (int)ob->npending; j++)
 			{
-				// Remove handled tile from pending list.
-				for (int j = 0; j < (int)ob->npending; j++)
+				if (ob->pending[j] == ref)
 				{
-					if (ob->pending[j] == ref)
-					{
-						ob->pending[j] = ob->pending[(int)ob->npending-1];
-						ob->npending--;
-						break;
-					}
+					ob->pending[j] = ob->pending[(int)ob->npending-1];
+					ob->npending--;
+					break;
 				}
-				
-				// If all pending tiles processed, change state.
-				if (ob->npending == 0)
+			}
+			
+			// If all pending tiles processed, change state.
+			if (ob->npending == 0)
+			{
+				if (ob->state == DT_OBSTACLE_PROCESSING)
 				{
-					if (ob->state == DT_OBSTACLE_PROCESSING)
-					{
-						ob->state = DT_OBSTACLE_PROCESSED;
-					}
-					else if (ob->state == DT_OBSTACLE_REMOVING)
-					{
-						ob->state = DT_OBSTACLE_EMPTY;
-						// Update salt, salt should never be zero.
-						ob->salt = (ob->salt+1) & ((1<<16)-1);
-						if (ob->salt == 0)
-							ob->salt++;
-						// Return obstacle to free list.
-						ob->next = m_nextFreeObstacle;
-						m_nextFreeObstacle = ob;
-					}
+					ob->state = DT_OBSTACLE_PROCESSED;
+				}
+				else if (ob->state == DT_OBSTACLE_REMOVING)
+				{
+					ob->state = DT_OBSTACLE_EMPTY;
+					// Update salt, salt should never be zero.
+					ob->salt = (ob->salt+1) & ((1<<16)-1);
+					if (ob->salt == 0)
+						ob->salt++;
+					// Return obstacle to free list.
+					ob->next = m_nextFreeObstacle;
+					m_nextFreeObstacle = ob;
 				}
 			}
 		}
 	}
-	
-	if (upToDate)
-		*upToDate = m_nupdate == 0 && m_nreqs == 0;
+}
+
+// Urho3D: rebuild of pending tiles split into thread-safe build and commit steps
+int dtTileCache::getPendingTiles(dtCompressedTileRef* tiles, const int maxTiles)
+{
+	if (m_nupdate == 0)
+		processObstacleRequests();
+
+	const int n = dtMin(m_nupdate, maxTiles);
+	memcpy(tiles, m_update, n*sizeof(dtCompressedTileRef));
+	return n;
+}
 
+dtStatus dtTileCache::buildTilePolyMesh(const dtCompressedTileRef ref, dtTileCacheAlloc* talloc,
+										dtTileCachePolyMesh** result) const
+{
+	dtAssert(talloc);
+	*result = 0;
+
+	NavMeshTileBuildContext bc(talloc);
+	dtStatus status = buildTileLayerMesh(ref, bc);
+	if (dtStatusFailed(status))
+		return status;
+
+	*result = bc.lmesh;
+	bc.lmesh = 0;
+	return DT_SUCCESS;
+}
+
+dtStatus dtTileCache::commitTilePolyMesh(const dtCompressedTileRef ref, dtTileCachePolyMesh* lmesh, dtNavMesh* navmesh)
+{
+	dtStatus status = DT_FAILURE | DT_INVALID_PARAM;
+	const dtCompressedTile* tile = getTileByRef(ref);
+	if (tile && lmesh)
+		status = addNavMeshTile(tile, lmesh, navmesh);
+
+	finishTileUpdate(ref);
 	return status;
 }
 
@@ -668,6 +721,24 @@ dtStatus dtTileCache::buildNavMeshTile(const dtCompressedTileRef ref, dtNavMesh*
 	dtAssert(m_talloc);
 	dtAssert(m_tcomp);
 	
+	const dtCompressedTile* tile = getTileByRef(ref);
+	if (!tile)
+		return DT_FAILURE | DT_INVALID_PARAM;
+	
+	m_talloc->reset();
+	
+	NavMeshTileBuildContext bc(m_talloc);
+	dtStatus status = buildTileLayerMesh(ref, bc);
+	if (dtStatusFailed(status))
+		return status;
+	
+	return addNavMeshTile(tile, bc.lmesh, navmesh);
+}
+
+dtStatus dtTileCache::buildTileLayerMesh(const dtCompressedTileRef ref, NavMeshTileBuildContext& bc) const
+{
+	dtAssert(m_tcomp);
+	
 	unsigned int idx = decodeTileIdTile(ref);
 	if (idx > (unsigned int)m_params.maxTiles)
 		return DT_FAILURE | DT_INVALID_PARAM;
@@ -676,17 +747,14 @@ dtStatus dtTileCache::buildNavMeshTile(const dtCompressedTileRef ref, dtNavMesh*
 	if (tile->salt != salt)
 		return DT_FAILURE | DT_INVALID_PARAM;
 	
-	m_talloc->reset();
-	
-	NavMeshTileBuildContext bc(m_talloc);
+	dtTileCacheAlloc* talloc = bc.alloc;
 	const int walkableClimbVx = (int)(m_params.walkableClimb / m_params.ch);
 	dtStatus status;
 	
 	// Decompress tile layer data. 
-	status = dtDecompressTileCacheLayer(m_talloc, m_tcomp, tile->data, tile->dataSize, &bc.layer);
+	status = dtDecompressTileCacheLayer(talloc, m_tcomp, tile->data, tile->dataSize, &bc.layer);
 	if (dtStatusFailed(status))
 		return status;
-	
 	// Rasterize obstacles.
 	for (int i = 0; i < m_params.maxObstacles; ++i)
 	{
@@ -714,27 +782,34 @@ dtStatus dtTileCache::buildNavMeshTile(const dtCompressedTileRef ref, dtNavMesh*
 	}
 	
 	// Build navmesh
-	status = dtBuildTileCacheRegions(m_talloc, *bc.layer, walkableClimbVx);
+	status = dtBuildTileCacheRegions(talloc, *bc.layer, walkableClimbVx);
 	if (dtStatusFailed(status))
 		return status;
 	
-	bc.lcset = dtAllocTileCacheContourSet(m_talloc);
+	bc.lcset = dtAllocTileCacheContourSet(talloc);
 	if (!bc.lcset)
 		return DT_FAILURE | DT_OUT_OF_MEMORY;
-	status = dtBuildTileCacheContours(m_talloc, *bc.layer, walkableClimbVx,
+	status = dtBuildTileCacheContours(talloc, *bc.layer, walkableClimbVx,
 									  m_params.maxSimplificationError, *bc.lcset);
 	if (dtStatusFailed(status))
 		return status;
 	
-	bc.lmesh = dtAllocTileCachePolyMesh(m_talloc);
+	bc.lmesh = dtAllocTileCachePolyMesh(talloc);
 	if (!bc.lmesh)
 		return DT_FAILURE | DT_OUT_OF_MEMORY;
-	status = dtBuildTileCachePolyMesh(m_talloc, *bc.lcset, *bc.lmesh);
+	status = dtBuildTileCachePolyMesh(talloc, *bc.lcset, *bc.lmesh);
 	if (dtStatusFailed(status))
 		return status;
 	
+	return DT_SUCCESS;
+}
+
+dtStatus dtTileCache::addNavMeshTile(const dtCompressedTile* tile, dtTileCachePolyMesh* lmesh, dtNavMesh* navmesh)
+{
+	dtStatus status;
+	
 	// Early out if the mesh tile is empty.
-	if (!bc.lmesh->npolys)
+	if (!lmesh->npolys)
 	{
 		// Remove existing tile.
 		navmesh->removeTile(navmesh->getTileRefAt(tile->header->tx,tile->header->ty,tile->header->tlayer),0,0);
@@ -743,12 +818,12 @@ dtStatus dtTileCache::buildNavMeshTile(const dtCompressedTileRef ref, dtNavMesh*
 	
 	dtNavMeshCreateParams params;
 	memset(&params, 0, sizeof(params));
-	params.verts = bc.lmesh->verts;
-	params.vertCount = bc.lmesh->nverts;
-	params.polys = bc.lmesh->polys;
-	params.polyAreas = bc.lmesh->areas;
-	params.polyFlags = bc.lmesh->flags;
-	params.polyCount = bc.lmesh->npolys;
+	params.verts = lmesh->verts;
+	params.vertCount = lmesh->nverts;
+	params.polys = lmesh->polys;
+	params.polyAreas = lmesh->areas;
+	params.polyFlags = lmesh->flags;
+	params.polyCount = lmesh->npolys;
 	params.nvp = DT_VERTS_PER_POLYGON;
 	params.walkableHeight = m_params.walkableHeight;
 	params.walkableRadius = m_params.walkableRadius;
@@ -764,7 +839,7 @@ dtStatus dtTileCache::buildNavMeshTile(const dtCompressedTileRef ref, dtNavMesh*
 	
 	if (m_tmproc)
 	{
-		m_tmproc->process(&params, bc.lmesh->areas, bc.lmesh->flags);
+		m_tmproc->process(&params, lmesh->areas, lmesh->flags);
 	}
 	
 	unsigned char* navData = 0;
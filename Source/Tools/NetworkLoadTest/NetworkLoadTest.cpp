@@ -0,0 +1,443 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Network/Connection.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/NetworkEvents.h>
+#include <Urho3D/Network/Protocol.h>
+#include <Urho3D/Network/Transport/Loopback/LoopbackConnection.h>
+#include <Urho3D/Network/Transport/Loopback/LoopbackServer.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/ClientReplica.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ServerReplicator.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+#include <EASTL/sort.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+const ea::string prefabName = "@/NetworkLoadTest/Object.prefab";
+const float warmupDuration = 2.0f;
+
+struct LoadTestParameters
+{
+    unsigned numClients_{16};
+    unsigned numObjects_{256};
+    float duration_{10.0f};
+    unsigned updateFps_{30};
+    ea::string linkParameters_;
+};
+
+ea::string FormatPercentiles(ea::vector<float> values, const char* units)
+{
+    if (values.empty())
+        return "no samples";
+
+    ea::sort(values.begin(), values.end());
+    const auto getPercentile = [&](float percentile)
+    { return values[static_cast<unsigned>(RoundToInt(percentile * (values.size() - 1)))]; };
+
+    float sum = 0.0f;
+    for (float value : values)
+        sum += value;
+
+    return Format("avg {:.2f}{}, p50 {:.2f}{}, p90 {:.2f}{}, p99 {:.2f}{}, max {:.2f}{}", sum / values.size(), units,
+        getPercentile(0.5f), units, getPercentile(0.9f), units, getPercentile(0.99f), units, values.back(), units);
+}
+
+/// Server scene and multiple client scenes connected via loopback transport in the same process.
+class LoadTest : public Object
+{
+    URHO3D_OBJECT(LoadTest, Object);
+
+public:
+    LoadTest(Context* context, const LoadTestParameters& parameters);
+    ~LoadTest() override;
+
+    void Run();
+
+private:
+    struct ClientState
+    {
+        SharedPtr<Scene> scene_;
+        SharedPtr<Connection> connection_;
+        ea::optional<NetworkFrame> latestFrame_;
+    };
+
+    SharedPtr<PrefabResource> CreatePrefab() const;
+    void StartServer();
+    void ConnectClient();
+    void RunFor(float duration);
+    void StartMeasurement();
+    void PrintReport();
+    unsigned long long GetReplicationBytes(Connection* connection) const;
+
+    void OnServerUpdateBegin();
+    void OnServerUpdateEnd();
+    void OnClientUpdateEnd();
+
+    const LoadTestParameters parameters_;
+    const URL url_;
+
+    SharedPtr<Scene> serverScene_;
+    ea::vector<Node*> serverNodes_;
+    ea::vector<ClientState> clients_;
+
+    HiresTimer timer_;
+    long long serverUpdateBeginTime_{};
+    ea::unordered_map<NetworkFrame, long long> serverFrameTimes_;
+
+    bool isShuttingDown_{};
+    bool isMeasuring_{};
+    long long measurementBeginTime_{};
+    ea::unordered_map<Connection*, unsigned long long> replicationBytesBegin_;
+    ea::unordered_map<LoopbackConnection*, unsigned long long> transportBytesBegin_;
+    ea::vector<float> serverUpdateTimes_;
+    ea::vector<float> replicationLatencies_;
+};
+
+LoadTest::LoadTest(Context* context, const LoadTestParameters& parameters)
+    : Object(context)
+    , parameters_(parameters)
+    , url_(Format("loopback://localhost:2345?{}", parameters.linkParameters_))
+{
+    auto network = GetSubsystem<Network>();
+    network->SetUpdateFps(parameters_.updateFps_);
+
+    // Subscribe before replication is started so handlers are called before and after ServerReplicator updates
+    SubscribeToEvent(network, E_NETWORKUPDATE, [this](VariantMap& eventData)
+    {
+        if (eventData[NetworkUpdate::P_ISSERVER].GetBool())
+            OnServerUpdateBegin();
+    });
+    SubscribeToEvent(network, E_NETWORKUPDATESENT, [this](VariantMap& eventData)
+    {
+        if (eventData[NetworkUpdateSent::P_ISSERVER].GetBool())
+            OnServerUpdateEnd();
+        else
+            OnClientUpdateEnd();
+    });
+    SubscribeToEvent(E_CLIENTCONNECTED, [this](VariantMap& eventData)
+    {
+        auto connection = static_cast<Connection*>(eventData[ClientConnected::P_CONNECTION].GetPtr());
+        connection->SetScene(serverScene_);
+    });
+}
+
+LoadTest::~LoadTest()
+{
+    isShuttingDown_ = true;
+    for (ClientState& client : clients_)
+        client.connection_->Disconnect();
+    clients_.clear();
+
+    GetSubsystem<Network>()->StopServer();
+}
+
+void LoadTest::Run()
+{
+    auto cache = GetSubsystem<ResourceCache>();
+    SharedPtr<PrefabResource> prefab = CreatePrefab();
+    cache->AddManualResource(prefab);
+
+    StartServer();
+    for (unsigned i = 0; i < parameters_.numClients_; ++i)
+        ConnectClient();
+
+    for (unsigned i = 0; i < parameters_.numObjects_; ++i)
+    {
+        const float angle = 360.0f * i / parameters_.numObjects_;
+        const Vector3 position = Quaternion{angle, Vector3::UP} * Vector3::FORWARD * 10.0f;
+
+        Node* node = serverScene_->InstantiatePrefab(prefab->GetNodePrefab(), position, Quaternion::IDENTITY);
+        node->SetName(Format("Object {}", i));
+
+        auto networkObject = node->CreateComponent<BehaviorNetworkObject>();
+        networkObject->SetClientPrefab(prefab);
+        serverNodes_.push_back(node);
+    }
+
+    // Keep all objects moving so every object is updated every frame
+    SubscribeToEvent(serverScene_, E_SCENEUPDATE, [this](VariantMap& eventData)
+    {
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        for (Node* node : serverNodes_)
+            node->RotateAround(Vector3::ZERO, Quaternion{timeStep * 30.0f, Vector3::UP}, TS_WORLD);
+    });
+
+    RunFor(warmupDuration);
+    StartMeasurement();
+    RunFor(parameters_.duration_);
+    PrintReport();
+}
+
+SharedPtr<PrefabResource> LoadTest::CreatePrefab() const
+{
+    auto node = MakeShared<Node>(context_);
+    node->CreateComponent<ReplicatedTransform>();
+
+    auto prefab = MakeShared<PrefabResource>(context_);
+    prefab->SetName(prefabName);
+    prefab->GetMutableNodePrefab() = node->GeneratePrefab();
+    prefab->NormalizeIds();
+    return prefab;
+}
+
+void LoadTest::StartServer()
+{
+    serverScene_ = MakeShared<Scene>(context_);
+    serverScene_->CreateComponent<ReplicationManager>()->StartServer();
+
+    if (!GetSubsystem<Network>()->StartServer(url_, parameters_.numClients_))
+        ErrorExit("Failed to start loopback server");
+}
+
+void LoadTest::ConnectClient()
+{
+    ClientState& client = clients_.emplace_back();
+    client.scene_ = MakeShared<Scene>(context_);
+
+    // Connection is initialized the same way as Network does it for the connection to server
+    auto transportConnection = MakeShared<LoopbackConnection>(context_);
+    client.connection_ = MakeShared<Connection>(context_, transportConnection);
+    client.connection_->SetScene(client.scene_);
+    client.connection_->SetConnectPending(true);
+    client.connection_->SetIsClient(false);
+
+    WeakPtr<Connection> weakConnection{client.connection_};
+    transportConnection->onConnected_ = [weakConnection]
+    {
+        if (!weakConnection)
+            return;
+
+        weakConnection->Initialize();
+        weakConnection->SetConnectPending(false);
+
+        VectorBuffer msg;
+        msg.WriteVariantMap(weakConnection->GetIdentity());
+        weakConnection->SendMessage(MSG_IDENTITY, msg);
+    };
+    transportConnection->onDisconnected_ = transportConnection->onError_ = [this]
+    {
+        if (!isShuttingDown_)
+            ErrorExit("Client is unexpectedly disconnected");
+    };
+
+    if (!transportConnection->Connect(url_))
+        ErrorExit("Failed to connect client to loopback server");
+}
+
+void LoadTest::RunFor(float duration)
+{
+    auto engine = GetSubsystem<Engine>();
+    const long long endTime = timer_.GetUSec(false) + static_cast<long long>(duration * 1000000.0f);
+    while (timer_.GetUSec(false) < endTime && !engine->IsExiting())
+        engine->RunFrame();
+}
+
+void LoadTest::StartMeasurement()
+{
+    LoopbackServer* transportServer = LoopbackServer::FindServer(url_);
+
+    for (ClientState& client : clients_)
+    {
+        ReplicationManager* replicationManager = client.scene_->GetComponent<ReplicationManager>();
+        if (!replicationManager || !replicationManager->GetClientReplica())
+            ErrorExit("Client is not synchronized after warmup");
+    }
+
+    for (Connection* connection : GetSubsystem<Network>()->GetClientConnections())
+        replicationBytesBegin_[connection] = GetReplicationBytes(connection);
+    for (LoopbackConnection* connection : transportServer->GetConnections())
+        transportBytesBegin_[connection] = connection->GetNumBytesSent();
+
+    isMeasuring_ = true;
+    measurementBeginTime_ = timer_.GetUSec(false);
+}
+
+void LoadTest::PrintReport()
+{
+    LoopbackServer* transportServer = LoopbackServer::FindServer(url_);
+    const float duration = (timer_.GetUSec(false) - measurementBeginTime_) / 1000000.0f;
+
+    ea::vector<float> replicationBytesPerClient;
+    for (Connection* connection : GetSubsystem<Network>()->GetClientConnections())
+    {
+        const auto iter = replicationBytesBegin_.find(connection);
+        if (iter != replicationBytesBegin_.end())
+            replicationBytesPerClient.push_back((GetReplicationBytes(connection) - iter->second) / duration);
+    }
+
+    ea::vector<float> transportBytesPerClient;
+    for (LoopbackConnection* connection : transportServer->GetConnections())
+    {
+        const auto iter = transportBytesBegin_.find(connection);
+        if (iter != transportBytesBegin_.end())
+            transportBytesPerClient.push_back((connection->GetNumBytesSent() - iter->second) / duration);
+    }
+
+    PrintLine(Format("Clients: {}, objects: {}, update rate: {} fps, link: '{}', duration: {:.1f} s",
+        parameters_.numClients_, parameters_.numObjects_, parameters_.updateFps_, parameters_.linkParameters_, duration));
+    PrintLine(Format("Server update time:  {}", FormatPercentiles(serverUpdateTimes_, "ms")));
+    PrintLine(Format("Replication latency: {}", FormatPercentiles(replicationLatencies_, "ms")));
+    PrintLine(Format("Replication traffic: {}", FormatPercentiles(replicationBytesPerClient, "B/s")));
+    PrintLine(Format("Transport traffic:   {}", FormatPercentiles(transportBytesPerClient, "B/s")));
+}
+
+unsigned long long LoadTest::GetReplicationBytes(Connection* connection) const
+{
+    ServerReplicator* serverReplicator = serverScene_->GetComponent<ReplicationManager>()->GetServerReplicator();
+    const ClientReplicationStats stats = serverReplicator->GetReplicationStats(connection);
+    return stats.removeObjectsBytes_ + stats.addObjectsBytes_ + stats.reliableUpdateBytes_ + stats.unreliableUpdateBytes_;
+}
+
+void LoadTest::OnServerUpdateBegin()
+{
+    serverUpdateBeginTime_ = timer_.GetUSec(false);
+}
+
+void LoadTest::OnServerUpdateEnd()
+{
+    const long long currentTime = timer_.GetUSec(false);
+    if (isMeasuring_)
+        serverUpdateTimes_.push_back((currentTime - serverUpdateBeginTime_) / 1000.0f);
+
+    if (ReplicationManager* replicationManager = serverScene_->GetComponent<ReplicationManager>())
+    {
+        if (ServerReplicator* serverReplicator = replicationManager->GetServerReplicator())
+            serverFrameTimes_[serverReplicator->GetCurrentFrame()] = currentTime;
+    }
+}
+
+void LoadTest::OnClientUpdateEnd()
+{
+    // Client connections are not managed by Network, pump them the same way
+    for (ClientState& client : clients_)
+    {
+        client.connection_->SendRemoteEvents();
+        client.connection_->SendAllBuffers();
+        client.connection_->ProcessPackets();
+    }
+
+    // Latency is measured from the moment the server frame is sent until it is received by the client
+    const long long currentTime = timer_.GetUSec(false);
+    for (ClientState& client : clients_)
+    {
+        ReplicationManager* replicationManager = client.scene_->GetComponent<ReplicationManager>();
+        ClientReplica* replica = replicationManager ? replicationManager->GetClientReplica() : nullptr;
+        const ea::optional<NetworkFrame> latestFrame = replica ? replica->GetLatestUpdateFrame() : ea::nullopt;
+        if (!latestFrame || latestFrame == client.latestFrame_)
+            continue;
+
+        client.latestFrame_ = latestFrame;
+        const auto iter = serverFrameTimes_.find(*latestFrame);
+        if (isMeasuring_ && iter != serverFrameTimes_.end())
+            replicationLatencies_.push_back((currentTime - iter->second) / 1000.0f);
+    }
+}
+
+void Run(Context* context, const ea::vector<ea::string>& arguments)
+{
+    LoadTestParameters parameters;
+    for (unsigned i = 0; i < arguments.size(); i += 2)
+    {
+        const ea::string& option = arguments[i];
+        if (option == "-h" || option == "--help" || i + 1 >= arguments.size())
+        {
+            ErrorExit(
+                "Usage: NetworkLoadTest [options]\n"
+                "\n"
+                "Runs one server scene and multiple client scenes in the same process connected via loopback transport.\n"
+                "Reports server update time, replication latency and traffic per client.\n"
+                "\n"
+                "Options:\n"
+                "-c <number>      Number of clients, default 16\n"
+                "-o <number>      Number of moving replicated objects, default 256\n"
+                "-d <seconds>     Duration of measurement, default 10\n"
+                "-f <number>      Network update rate, default 30\n"
+                "-l <parameters>  Link parameters, e.g. 'latency=50&jitter=10&loss=0.05&bandwidth=65536'\n");
+        }
+
+        const ea::string& value = arguments[i + 1];
+        if (option == "-c")
+            parameters.numClients_ = ToUInt(value);
+        else if (option == "-o")
+            parameters.numObjects_ = ToUInt(value);
+        else if (option == "-d")
+            parameters.duration_ = ToFloat(value);
+        else if (option == "-f")
+            parameters.updateFps_ = ToUInt(value);
+        else if (option == "-l")
+            parameters.linkParameters_ = value;
+        else
+            ErrorExit(Format("Unrecognized option '{}'", option));
+    }
+
+    auto loadTest = MakeShared<LoadTest>(context, parameters);
+    loadTest->Run();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    auto context = MakeShared<Context>();
+    auto engine = new Engine(context);
+
+    StringVariantMap engineParameters;
+    engineParameters[EP_HEADLESS] = true;
+    engineParameters[EP_LOG_LEVEL] = LOG_WARNING;
+    engineParameters[EP_RESOURCE_PATHS] = "";
+    engineParameters[EP_RESOURCE_PREFIX_PATHS] = "";
+    if (!engine->Initialize(engineParameters, {}))
+        ErrorExit("Failed to initialize engine");
+
+#ifdef WIN32
+    const ea::vector<ea::string>& arguments = ParseArguments(GetCommandLineW());
+#else
+    const ea::vector<ea::string>& arguments = ParseArguments(argc, argv);
+#endif
+
+    Run(context, arguments);
+    return 0;
+}
@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <atomic>
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Shader.h>
+#include <Urho3D/Graphics/ShaderVariationCompiler.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/VirtualFileSystem.h>
+#include <Urho3D/RenderAPI/RenderAPIUtils.h>
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+namespace
+{
+
+struct CompileTask
+{
+    const ShaderVariationDesc* desc_{};
+    ea::string sourceCode_;
+    ea::string outputFileName_;
+};
+
+ea::optional<RenderBackend> ParseRenderBackend(const ea::string& name)
+{
+    for (int i = 0; i < static_cast<int>(RenderBackend::Count); ++i)
+    {
+        const auto backend = static_cast<RenderBackend>(i);
+        if (ToString(backend).comparei(name) == 0)
+            return backend;
+    }
+    return ea::nullopt;
+}
+
+void Run(Context* context, const ea::vector<ea::string>& arguments)
+{
+    if (arguments.size() < 3)
+    {
+        ErrorExit(
+            "Usage: ShaderCacheTool <shader warmup list> <output directory> <backend> [options]\n"
+            "\n"
+            "Compiles shader variations from the warmup list saved by the engine (see ShaderWarmupList engine parameter)\n"
+            "and writes bytecode in the format of the engine shader cache (see ShaderCacheDir engine parameter).\n"
+            "\n"
+            "Backend is one of: D3D11, D3D12, OpenGL, Vulkan.\n"
+            "\n"
+            "Options:\n"
+            "-r <directory>  Add resource directory, may be repeated\n"
+            "-p <policy>     Shader translation policy: 0 - verbatim, 1 - translate, 2 - optimize\n");
+    }
+
+    const ea::string& warmupListName = arguments[0];
+    const ea::string outputDir = AddTrailingSlash(arguments[1]);
+    const ea::optional<RenderBackend> backend = ParseRenderBackend(arguments[2]);
+    if (!backend)
+        ErrorExit(Format("Unknown render backend '{}'", arguments[2]));
+
+    ea::optional<ShaderTranslationPolicy> requestedPolicy;
+    StringVector resourceDirs;
+    for (unsigned i = 3; i + 1 < arguments.size(); i += 2)
+    {
+        const ea::string& option = arguments[i];
+        const ea::string& value = arguments[i + 1];
+        if (option == "-r")
+            resourceDirs.push_back(value);
+        else if (option == "-p")
+            requestedPolicy = static_cast<ShaderTranslationPolicy>(ToInt(value));
+        else
+            ErrorExit(Format("Unrecognized option '{}'", option));
+    }
+
+    auto fileSystem = context->GetSubsystem<FileSystem>();
+    auto vfs = context->GetSubsystem<VirtualFileSystem>();
+    auto cache = context->GetSubsystem<ResourceCache>();
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+
+    for (const ea::string& dir : resourceDirs)
+        vfs->MountDir(AddTrailingSlash(dir));
+
+    ea::vector<ShaderVariationDesc> shaders;
+    auto jsonFile = MakeShared<JSONFile>(context);
+    File warmupListFile(context, warmupListName);
+    if (!warmupListFile.IsOpen() || !jsonFile->Load(warmupListFile) || !jsonFile->LoadObject("shaders", shaders))
+        ErrorExit(Format("Failed to load shader warmup list '{}'", warmupListName));
+
+    const ShaderVariationCompiler compiler{*backend, SelectShaderTranslationPolicy(*backend, requestedPolicy)};
+
+    // Resources are not thread-safe, so load all shaders in main thread
+    ea::vector<CompileTask> tasks;
+    for (const ShaderVariationDesc& desc : shaders)
+    {
+        auto shader = cache->GetResource<Shader>(desc.shaderName_);
+        if (!shader)
+        {
+            PrintLine(Format("Shader '{}' is not found", desc.shaderName_), true);
+            continue;
+        }
+
+        ea::string sourceCode = compiler.PrepareSource(desc.type_, desc.defines_, shader->GetSourceCode());
+        const unsigned long long contentHash = compiler.GetContentHash(sourceCode);
+        ea::string outputFileName =
+            outputDir + compiler.GetCachedFileName(shader->GetShaderName(), desc.type_, contentHash, "bytecode");
+        tasks.push_back(CompileTask{&desc, ea::move(sourceCode), ea::move(outputFileName)});
+    }
+
+    for (const CompileTask& task : tasks)
+        fileSystem->CreateDirsRecursive(GetPath(task.outputFileName_));
+
+    std::atomic<unsigned> numFailed{};
+    ForEachParallel(workQueue, tasks,
+        [&](unsigned /*index*/, const CompileTask& task)
+    {
+        const ShaderVariationDesc& desc = *task.desc_;
+        const ea::string debugName = Format("{}({})", desc.shaderName_, desc.defines_);
+
+        ShaderBytecode bytecode;
+        ea::string translatedSource;
+        if (!compiler.Compile(bytecode, translatedSource, desc.type_, task.sourceCode_, debugName))
+        {
+            ++numFailed;
+            return;
+        }
+
+        File outputFile(context, task.outputFileName_, FILE_WRITE);
+        if (!outputFile.IsOpen() || !bytecode.SaveToFile(outputFile))
+            ++numFailed;
+    });
+
+    PrintLine(Format("{} of {} shader variations are compiled for {}", tasks.size() - numFailed.load(), shaders.size(),
+        ToString(*backend)));
+
+    if (numFailed != 0)
+        ErrorExit();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    auto context = MakeShared<Context>();
+    context->RegisterSubsystem(new FileSystem(context));
+    context->RegisterSubsystem(new VirtualFileSystem(context));
+    context->RegisterSubsystem(new Log(context));
+    context->RegisterSubsystem(new ResourceCache(context));
+    context->RegisterSubsystem(new WorkQueue(context));
+    Shader::RegisterObject(context);
+
+    context->GetSubsystem<Log>()->SetLevel(LOG_WARNING);
+    context->GetSubsystem<WorkQueue>()->Initialize(GetNumLogicalCPUs() - 1);
+
+#ifdef WIN32
+    const ea::vector<ea::string>& arguments = ParseArguments(GetCommandLineW());
+#else
+    const ea::vector<ea::string>& arguments = ParseArguments(argc, argv);
+#endif
+
+    Run(context, arguments);
+    return 0;
+}
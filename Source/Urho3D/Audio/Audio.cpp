@@ -23,7 +23,9 @@
 #include "../Precompiled.h"
 
 #include "../Audio/Audio.h"
+#include "../Audio/AudioMixing.h"
 #include "../Audio/Microphone.h"
+#include "../Audio/PrefetchedSoundStream.h"
 #include "../Audio/Sound.h"
 #include "../Audio/SoundListener.h"
 #include "../Audio/SoundSource3D.h"
@@ -35,6 +37,8 @@
 
 #include <SDL.h>
 
+#include <EASTL/sort.h>
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -47,18 +51,11 @@ namespace Urho3D
 static const int MIN_BUFFERLENGTH = 20;
 static const int MIN_MIXRATE = 11025;
 static const int MAX_MIXRATE = 48000;
+static const unsigned MIN_STREAM_DECODE_INTERVAL = 5;
 static const StringHash SOUND_MASTER_HASH("Master");
 
 static void SDLAudioCallback(void* userdata, Uint8* stream, int len);
 
-static const int AUDIO_NUM_CHANNELS[] = {
-    6, // Auto, just aim for 5.1
-    1, // mono
-    2, // stereo
-    4, // quadrophonic
-    6, // 5.1
-};
-
 // SM_AUTO is BAD!
 static const SpeakerMode CHANNELS_TO_MODE[] = {
     SPK_AUTO, // invalid actually,
@@ -157,7 +154,7 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, SpeakerMode speakerMode,
         for (;;)
         {
             memset(&obtained, 0, sizeof(obtained));
-            desired.channels = (Uint8)AUDIO_NUM_CHANNELS[speakerMode];
+            desired.channels = (Uint8)GetNumAudioChannels(speakerMode);
             deviceID_ = TryOpenAudioDevice(desired, obtained, false);
 
             if (deviceID_ != 0)
@@ -178,7 +175,7 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, SpeakerMode speakerMode,
     else
     {
         memset(&obtained, 0, sizeof(obtained));
-        desired.channels = (Uint8)AUDIO_NUM_CHANNELS[speakerMode];
+        desired.channels = (Uint8)GetNumAudioChannels(speakerMode);
         deviceID_ = TryOpenAudioDevice(desired, obtained, false);
         if (deviceID_ == 0)
         {
@@ -196,12 +193,12 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, SpeakerMode speakerMode,
         return false;
     }
 
-    sampleSize_ = sizeof(short) * AUDIO_NUM_CHANNELS[speakerMode_];
+    sampleSize_ = sizeof(short) * GetNumAudioChannels(speakerMode_);
     // Guarantee a fragment size that is low enough so that Vorbis decoding buffers do not wrap
     fragmentSize_ = Min(NextPowerOfTwo((unsigned)mixRate >> 6u), (unsigned)obtained.samples);
     mixRate_ = obtained.freq;
     interpolation_ = interpolation;
-    clipBuffer_.reset(new int[fragmentSize_ * AUDIO_NUM_CHANNELS[speakerMode_]]);
+    AllocateMixBuffers();
 
     URHO3D_LOGINFO("Set audio mode " + ea::to_string(mixRate_) + " Hz " + SPEAKER_MODE_NAMES[speakerMode_] + " " +
             (interpolation_ ? "interpolated" : ""));
@@ -209,8 +206,31 @@ bool Audio::SetMode(int bufferLengthMSec, int mixRate, SpeakerMode speakerMode,
     return Play();
 }
 
+bool Audio::SetOfflineMode(int mixRate, SpeakerMode speakerMode, bool interpolation)
+{
+    Release();
+
+    if (speakerMode == SPK_AUTO)
+        speakerMode = SPK_STEREO;
+
+    speakerMode_ = speakerMode;
+    sampleSize_ = sizeof(short) * GetNumAudioChannels(speakerMode_);
+    mixRate_ = Clamp(mixRate, MIN_MIXRATE, MAX_MIXRATE);
+    fragmentSize_ = NextPowerOfTwo((unsigned)mixRate_ >> 6u);
+    interpolation_ = interpolation;
+    AllocateMixBuffers();
+    offline_ = true;
+
+    URHO3D_LOGINFO("Set offline audio mode " + ea::to_string(mixRate_) + " Hz " + SPEAKER_MODE_NAMES[speakerMode_] + " " +
+            (interpolation_ ? "interpolated" : ""));
+
+    return Play();
+}
+
 bool Audio::RefreshMode()
 {
+    if (offline_)
+        return SetOfflineMode(mixRate_, speakerMode_, interpolation_);
     return SetMode(bufferLengthMSec_, mixRate_, speakerMode_, interpolation_);
 }
 
@@ -245,13 +265,14 @@ bool Audio::Play()
     if (playing_)
         return true;
 
-    if (!deviceID_)
+    if (!deviceID_ && !offline_)
     {
         URHO3D_LOGERROR("No audio mode set, can not start playback");
         return false;
     }
 
-    SDL_PauseAudioDevice(deviceID_, 0);
+    if (deviceID_)
+        SDL_PauseAudioDevice(deviceID_, 0);
 
     // Update sound sources before resuming playback to make sure 3D positions are up to date
     UpdateInternal(0.0f);
@@ -273,6 +294,41 @@ void Audio::SetMasterGain(const ea::string& type, float gain)
         (*i)->UpdateMasterGain();
 }
 
+void Audio::SetStreamLookahead(unsigned lookaheadMSec)
+{
+    streamLookaheadMSec_ = lookaheadMSec;
+    if (streamDecoder_)
+        streamDecoder_->SetInterval(Max(lookaheadMSec / 4, MIN_STREAM_DECODE_INTERVAL));
+}
+
+SharedPtr<SoundStream> Audio::PrefetchSoundStream(SoundStream* stream)
+{
+#ifndef URHO3D_THREADING
+    // Nothing would decode the stream in background
+    return SharedPtr<SoundStream>(stream);
+#else
+    if (!stream || !streamLookaheadMSec_ || !stream->IsPrefetchable())
+        return SharedPtr<SoundStream>(stream);
+
+    const unsigned bufferSize = stream->GetSampleSize() * stream->GetIntFrequency() * streamLookaheadMSec_ / 1000;
+    auto prefetchedStream = MakeShared<PrefetchedSoundStream>(stream, bufferSize);
+    prefetchedStream->Decode();
+
+    if (!streamDecoder_)
+    {
+        streamDecoder_ = ea::make_unique<SoundStreamDecoder>(Max(streamLookaheadMSec_ / 4, MIN_STREAM_DECODE_INTERVAL));
+        streamDecoder_->Run();
+    }
+    streamDecoder_->AddStream(prefetchedStream);
+    return prefetchedStream;
+#endif
+}
+
+void Audio::SetSoundTypePriority(const ea::string& type, int priority)
+{
+    soundTypePriority_[type] = priority;
+}
+
 void Audio::PauseSoundType(const ea::string& type)
 {
     MutexLock lock(audioMutex_);
@@ -319,6 +375,12 @@ float Audio::GetMasterGain(const ea::string& type) const
     return findIt->second.GetFloat();
 }
 
+int Audio::GetSoundTypePriority(const ea::string& type) const
+{
+    auto findIt = soundTypePriority_.find(type);
+    return findIt != soundTypePriority_.end() ? findIt->second : 0;
+}
+
 bool Audio::IsSoundTypePaused(const ea::string& type) const
 {
     return pausedSoundTypes_.contains(type);
@@ -371,7 +433,7 @@ void SDLAudioCallback(void* userdata, Uint8* stream, int len)
 
 void Audio::MixOutput(void* dest, unsigned samples)
 {
-    if (!playing_ || !clipBuffer_)
+    if (!playing_ || !mixBuffer_.GetNumSamples())
     {
         memset(dest, 0, samples * (size_t)sampleSize_);
         return;
@@ -379,17 +441,12 @@ void Audio::MixOutput(void* dest, unsigned samples)
 
     while (samples)
     {
-        // If sample count exceeds the fragment (clip buffer) size, split the work
+        // If sample count exceeds the fragment (mix buffer) size, split the work
         unsigned workSamples = Min(samples, fragmentSize_);
-        unsigned clipSamples = workSamples;
-        if (speakerMode_ != SPK_MONO)
-            clipSamples = AUDIO_NUM_CHANNELS[speakerMode_] * fragmentSize_;
 
-        // Clear clip buffer
-        int* clipPtr = clipBuffer_.get();
-        memset(clipPtr, 0, clipSamples * sizeof(int));
+        mixBuffer_.Clear(workSamples);
 
-        // Mix samples to clip buffer
+        // Mix samples to mix buffer
         for (auto i = soundSources_.begin(); i != soundSources_.end(); ++i)
         {
             SoundSource* source = *i;
@@ -401,12 +458,11 @@ void Audio::MixOutput(void* dest, unsigned samples)
                     continue;
             }
 
-            source->Mix(clipPtr, workSamples, mixRate_, speakerMode_, interpolation_);
+            source->Mix(mixBuffer_, sourceBuffer_, workSamples, mixRate_, speakerMode_, interpolation_);
         }
-        // Copy output from clip buffer to destination
-        auto* destPtr = (short*)dest;
-        while (clipSamples--)
-            *destPtr++ = (short)Clamp(*clipPtr++, -32768, 32767);
+
+        // Convert output from mix buffer to destination
+        ConvertMixBuffer(static_cast<short*>(dest), mixBuffer_, workSamples);
         samples -= workSamples;
         ((unsigned char*&)dest) += sampleSize_ * workSamples;
     }
@@ -427,8 +483,17 @@ void Audio::Release()
     {
         SDL_CloseAudioDevice(deviceID_);
         deviceID_ = 0;
-        clipBuffer_.reset();
     }
+
+    offline_ = false;
+    mixBuffer_ = {};
+    sourceBuffer_ = {};
+}
+
+void Audio::AllocateMixBuffers()
+{
+    mixBuffer_.Allocate(GetNumAudioChannels(speakerMode_), fragmentSize_);
+    sourceBuffer_.Allocate(2, fragmentSize_);
 }
 
 void Audio::UpdateInternal(float timeStep)
@@ -449,6 +514,57 @@ void Audio::UpdateInternal(float timeStep)
 
         source->Update(timeStep);
     }
+
+    UpdateVoices();
+}
+
+void Audio::UpdateVoices()
+{
+    voices_.clear();
+    numVirtualVoices_ = 0;
+
+    {
+        MutexLock lock(audioMutex_);
+        for (SoundSource* source : soundSources_)
+        {
+            if (!source->IsPlaying() || pausedSoundTypes_.contains(source->GetSoundType()))
+                continue;
+
+            // Sound sources in paused scenes are not mixed and do not take voice slots
+            if (source->GetEffectiveTimeScale() == 0.0f)
+                continue;
+
+            // Inaudible sound sources do not take voice slots
+            const float audibility = source->GetAudibility();
+            if (audibility <= 0.0f)
+            {
+                source->SetVirtual(true);
+                ++numVirtualVoices_;
+                continue;
+            }
+
+            const auto priorityIt = soundTypePriority_.find(StringHash(source->GetSoundType()));
+            const int priority = priorityIt != soundTypePriority_.end() ? priorityIt->second : 0;
+            voices_.push_back({{priority, audibility}, source});
+        }
+
+        unsigned numRealVoices = voices_.size();
+        if (maxRealVoices_ != 0 && numRealVoices > maxRealVoices_)
+        {
+            numRealVoices = maxRealVoices_;
+            const auto isMoreImportant = [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; };
+            ea::nth_element(voices_.begin(), voices_.begin() + numRealVoices, voices_.end(), isMoreImportant);
+        }
+
+        for (unsigned i = 0; i < voices_.size(); ++i)
+            voices_[i].second->SetVirtual(i >= numRealVoices);
+
+        numRealVoices_ = numRealVoices;
+        numVirtualVoices_ += voices_.size() - numRealVoices;
+    }
+
+    URHO3D_PROFILE_VALUE("Audio Real Voices", static_cast<int64_t>(numRealVoices_));
+    URHO3D_PROFILE_VALUE("Audio Virtual Voices", static_cast<int64_t>(numVirtualVoices_));
 }
 
 StringVector Audio::EnumerateMicrophones() const
@@ -26,6 +26,7 @@
 #include <EASTL/hash_set.h>
 
 #include "../Audio/AudioDefs.h"
+#include "../Audio/AudioMixing.h"
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
@@ -37,6 +38,8 @@ class Microphone;
 class Sound;
 class SoundListener;
 class SoundSource;
+class SoundStream;
+class SoundStreamDecoder;
 
 /// %Audio subsystem.
 class URHO3D_API Audio : public Object
@@ -51,6 +54,9 @@ public:
 
     /// Initialize sound output with specified buffer length and output mode.
     bool SetMode(int bufferLengthMSec, int mixRate, SpeakerMode mode, bool interpolation = true);
+    /// Initialize mixing with specified output mode without opening audio device.
+    /// Output should be rendered manually via %MixOutput. Used for testing and benchmarking.
+    bool SetOfflineMode(int mixRate, SpeakerMode mode, bool interpolation = true);
     /// Re-initialize sound output with same parameters.
     bool RefreshMode();
     /// Shutdown this audio device, likely because we've lost it.
@@ -70,6 +76,19 @@ public:
     void ResumeSoundType(const ea::string& type);
     /// Resume playback of all sound types.
     void ResumeAll();
+    /// Set maximum number of sound sources that are actually mixed, or 0 for unlimited.
+    /// The rest of playing sound sources become virtual: their play position is advanced without mixing.
+    /// @property
+    void SetMaxRealVoices(unsigned maxRealVoices) { maxRealVoices_ = maxRealVoices; }
+    /// Set priority of specific sound type. Sound sources with higher priority become virtual last.
+    void SetSoundTypePriority(const ea::string& type, int priority);
+    /// Set how far ahead of playback prefetchable sound streams are decoded on a background thread, in milliseconds.
+    /// If 0, streams are decoded on the mixing thread. Affects streams started after this call.
+    /// @property
+    void SetStreamLookahead(unsigned lookaheadMSec);
+    /// Wrap the stream into the stream that is decoded ahead of playback and pre-buffer it.
+    /// Return the stream itself if it should not be prefetched.
+    SharedPtr<SoundStream> PrefetchSoundStream(SoundStream* stream);
     /// Set active sound listener for 3D sounds.
     /// @property
     void SetListener(SoundListener* listener);
@@ -104,10 +123,26 @@ public:
     /// @property
     bool IsInitialized() const { return deviceID_ != 0; }
 
+    /// Return whether mixing is initialized without audio device.
+    bool IsOffline() const { return offline_; }
+
     /// Return master gain for a specific sound source type. Unknown sound types will return full gain (1).
     /// @property
     float GetMasterGain(const ea::string& type) const;
 
+    /// Return maximum number of sound sources that are actually mixed.
+    /// @property
+    unsigned GetMaxRealVoices() const { return maxRealVoices_; }
+    /// Return priority of specific sound type. Unknown sound types have priority 0.
+    int GetSoundTypePriority(const ea::string& type) const;
+    /// Return how far ahead of playback sound streams are decoded, in milliseconds.
+    /// @property
+    unsigned GetStreamLookahead() const { return streamLookaheadMSec_; }
+    /// Return number of sound sources that were mixed during last update.
+    unsigned GetNumRealVoices() const { return numRealVoices_; }
+    /// Return number of playing sound sources that were virtual during last update.
+    unsigned GetNumVirtualVoices() const { return numVirtualVoices_; }
+
     /// Return whether specific sound type has been paused.
     bool IsSoundTypePaused(const ea::string& type) const;
 
@@ -132,7 +167,7 @@ public:
     /// Return sound type specific gain multiplied by master gain.
     float GetSoundSourceMasterGain(StringHash typeHash) const;
 
-    /// Mix sound sources into the buffer.
+    /// Mix sound sources into the buffer of interleaved signed 16-bit samples.
     void MixOutput(void* dest, unsigned samples);
 
     /// Returns a pretty-name list of all attached microphones.
@@ -149,9 +184,15 @@ private:
     void Release();
     /// Actually update sound sources with the specific timestep. Called internally.
     void UpdateInternal(float timeStep);
-
-    /// Clipping buffer for mixing.
-    ea::unique_ptr<int[]> clipBuffer_;
+    /// Allocate mix buffers for current mode.
+    void AllocateMixBuffers();
+    /// Select sound sources to be mixed and make the rest virtual.
+    void UpdateVoices();
+
+    /// Float buffer for mixing sound sources, converted to output format at the end.
+    AudioMixBuffer mixBuffer_;
+    /// Float buffer for resampled data of single sound source.
+    AudioMixBuffer sourceBuffer_;
     /// Audio thread mutex.
     Mutex audioMutex_;
     /// SDL audio device ID.
@@ -170,8 +211,26 @@ private:
     SpeakerMode speakerMode_{SpeakerMode::SPK_AUTO};
     /// Playing flag.
     bool playing_{};
+    /// Whether the mixing is initialized without audio device.
+    bool offline_{};
     /// Master gain by sound source type.
     ea::unordered_map<StringHash, Variant> masterGain_;
+    /// Priority by sound source type.
+    ea::unordered_map<StringHash, int> soundTypePriority_;
+    /// Max number of mixed sound sources.
+    unsigned maxRealVoices_{};
+    /// Audible sound sources with their priority and audibility, partitioned so the most important ones go first.
+    /// Order within each part is unspecified. Reused between updates.
+    ea::vector<ea::pair<ea::pair<int, float>, SoundSource*>> voices_;
+    /// Sound stream lookahead in milliseconds.
+    unsigned streamLookaheadMSec_{250};
+    /// Background decoder of prefetched sound streams. Created on demand.
+    ea::unique_ptr<SoundStreamDecoder> streamDecoder_;
+    /// Number of real and virtual voices during last update.
+    /// @{
+    unsigned numRealVoices_{};
+    unsigned numVirtualVoices_{};
+    /// @}
     /// Paused sound types.
     ea::hash_set<StringHash> pausedSoundTypes_;
     /// Sound sources.
@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Audio/AudioMixing.h"
+#include "../Math/MathDefs.h"
+
+#include <cmath>
+#include <cstring>
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned AUDIO_NUM_CHANNELS[] = {
+    6, // Auto, just aim for 5.1
+    1, // mono
+    2, // stereo
+    4, // quadrophonic
+    6, // 5.1
+};
+
+/// Scale of float sample in 16-bit output.
+static const float OUTPUT_SCALE = 32768.0f;
+
+static inline short ConvertSampleToS16(float value)
+{
+    // lrintf rounds to nearest even, same as SSE conversion
+    return static_cast<short>(lrintf(Clamp(value * OUTPUT_SCALE, -32768.0f, 32767.0f)));
+}
+
+#ifdef URHO3D_SSE
+static inline __m128i ConvertSamplesToS32(__m128 value)
+{
+    const __m128 scale = _mm_set1_ps(OUTPUT_SCALE);
+    const __m128 minValue = _mm_set1_ps(-32768.0f);
+    const __m128 maxValue = _mm_set1_ps(32767.0f);
+    return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(value, scale), minValue), maxValue));
+}
+
+static inline void LoadSamplesS16(const short* source, __m128i& lo, __m128i& hi)
+{
+    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+    lo = _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+    hi = _mm_srai_epi32(_mm_unpackhi_epi16(value, value), 16);
+}
+#endif
+
+unsigned GetNumAudioChannels(SpeakerMode mode)
+{
+    return AUDIO_NUM_CHANNELS[mode];
+}
+
+void AudioMixBuffer::Allocate(unsigned numChannels, unsigned numSamples)
+{
+    numChannels_ = numChannels;
+    numSamples_ = numSamples;
+    data_.resize(numChannels * numSamples);
+}
+
+void AudioMixBuffer::Clear(unsigned numSamples)
+{
+    for (unsigned channel = 0; channel < numChannels_; ++channel)
+        memset(GetChannel(channel), 0, numSamples * sizeof(float));
+}
+
+void MixSamples(float* dest, const float* source, unsigned numSamples, float gain, float gainStep)
+{
+    unsigned i = 0;
+
+#ifdef URHO3D_SSE
+    // Gain is evaluated per sample exactly as in scalar code, accumulating the step would drift from it
+    const __m128 gain4 = _mm_set1_ps(gain);
+    const __m128 gainStep4 = _mm_set1_ps(gainStep);
+    const __m128 indexStep4 = _mm_set1_ps(4.0f);
+    __m128 index4 = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        const __m128 sampleGain = _mm_add_ps(gain4, _mm_mul_ps(index4, gainStep4));
+        const __m128 value = _mm_mul_ps(_mm_loadu_ps(source + i), sampleGain);
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), value));
+        index4 = _mm_add_ps(index4, indexStep4);
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+        dest[i] += source[i] * (gain + static_cast<float>(i) * gainStep);
+}
+
+void ConvertSamples(float* dest, const short* source, unsigned numSamples, float scale)
+{
+    unsigned i = 0;
+
+#ifdef URHO3D_SSE
+    const __m128 scale4 = _mm_set1_ps(scale);
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        __m128i lo, hi;
+        LoadSamplesS16(source + i, lo, hi);
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale4));
+        _mm_storeu_ps(dest + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale4));
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+        dest[i] = source[i] * scale;
+}
+
+void ConvertSamples(float* destLeft, float* destRight, const short* source, unsigned numSamples, float scale)
+{
+    unsigned i = 0;
+
+#ifdef URHO3D_SSE
+    const __m128 scale4 = _mm_set1_ps(scale);
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        __m128i lo, hi;
+        LoadSamplesS16(source + i * 2, lo, hi);
+        const __m128 first = _mm_cvtepi32_ps(lo);
+        const __m128 second = _mm_cvtepi32_ps(hi);
+        _mm_storeu_ps(destLeft + i, _mm_mul_ps(_mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)), scale4));
+        _mm_storeu_ps(destRight + i, _mm_mul_ps(_mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)), scale4));
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+    {
+        destLeft[i] = source[i * 2] * scale;
+        destRight[i] = source[i * 2 + 1] * scale;
+    }
+}
+
+void ConvertMixBuffer(short* dest, const AudioMixBuffer& source, unsigned numSamples)
+{
+    const unsigned numChannels = source.GetNumChannels();
+    unsigned i = 0;
+
+#ifdef URHO3D_SSE
+    if (numChannels == 1)
+    {
+        const float* mono = source.GetChannel(0);
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            const __m128i lo = ConvertSamplesToS32(_mm_loadu_ps(mono + i));
+            const __m128i hi = ConvertSamplesToS32(_mm_loadu_ps(mono + i + 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packs_epi32(lo, hi));
+        }
+    }
+    else if (numChannels == 2)
+    {
+        const float* left = source.GetChannel(0);
+        const float* right = source.GetChannel(1);
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const __m128 leftValue = _mm_loadu_ps(left + i);
+            const __m128 rightValue = _mm_loadu_ps(right + i);
+            const __m128i lo = ConvertSamplesToS32(_mm_unpacklo_ps(leftValue, rightValue));
+            const __m128i hi = ConvertSamplesToS32(_mm_unpackhi_ps(leftValue, rightValue));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 2), _mm_packs_epi32(lo, hi));
+        }
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+    {
+        for (unsigned channel = 0; channel < numChannels; ++channel)
+            dest[i * numChannels + channel] = ConvertSampleToS16(source.GetChannel(channel)[i]);
+    }
+}
+
+}
@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Audio/AudioDefs.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Maximum number of channels in the mix buffer.
+static constexpr unsigned MAX_AUDIO_CHANNELS = 6;
+
+/// Return number of output channels for speaker mode.
+URHO3D_API unsigned GetNumAudioChannels(SpeakerMode mode);
+
+/// Planar float32 audio buffer. Samples are normalized to [-1, 1] range.
+class URHO3D_API AudioMixBuffer
+{
+public:
+    /// Allocate buffer. Contents are undefined.
+    void Allocate(unsigned numChannels, unsigned numSamples);
+    /// Zero first samples of each channel.
+    void Clear(unsigned numSamples);
+
+    /// Return samples of the channel.
+    /// @{
+    float* GetChannel(unsigned channel) { return data_.data() + channel * numSamples_; }
+    const float* GetChannel(unsigned channel) const { return data_.data() + channel * numSamples_; }
+    /// @}
+    /// Return number of channels.
+    unsigned GetNumChannels() const { return numChannels_; }
+    /// Return capacity of each channel in samples.
+    unsigned GetNumSamples() const { return numSamples_; }
+
+private:
+    ea::vector<float> data_;
+    unsigned numChannels_{};
+    unsigned numSamples_{};
+};
+
+/// SIMD kernels of the audio mixing pipeline.
+/// @{
+
+/// Add source multiplied by linearly changing gain to destination: dest[i] += source[i] * (gain + i * gainStep).
+URHO3D_API void MixSamples(float* dest, const float* source, unsigned numSamples, float gain, float gainStep);
+/// Convert signed 16-bit samples to float. Stereo source is deinterleaved into two destination channels.
+URHO3D_API void ConvertSamples(float* dest, const short* source, unsigned numSamples, float scale);
+URHO3D_API void ConvertSamples(float* destLeft, float* destRight, const short* source, unsigned numSamples, float scale);
+/// Convert mixed channels to interleaved signed 16-bit samples with clipping.
+URHO3D_API void ConvertMixBuffer(short* dest, const AudioMixBuffer& source, unsigned numSamples);
+
+/// @}
+
+}
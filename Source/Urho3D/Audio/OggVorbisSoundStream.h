@@ -45,6 +45,8 @@ public:
 
     /// Produce sound data into destination. Return number of bytes produced. Called by SoundSource from the mixing thread.
     unsigned GetData(signed char* dest, unsigned numBytes) override;
+    /// Return true, decoding is expensive.
+    bool IsPrefetchable() const override { return true; }
 
 protected:
     /// Decoder state.
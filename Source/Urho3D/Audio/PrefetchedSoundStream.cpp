@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Audio/PrefetchedSoundStream.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Math/MathDefs.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+PrefetchedSoundStream::PrefetchedSoundStream(SoundStream* source, unsigned bufferSize)
+    : source_(source)
+{
+    SetFormat(source_->GetIntFrequency(), source_->IsSixteenBit(), source_->IsStereo());
+    SetStopAtEnd(source_->GetStopAtEnd());
+
+    buffer_.resize(NextPowerOfTwo(Max(bufferSize, 1024u)));
+    bufferMask_ = buffer_.size() - 1;
+}
+
+bool PrefetchedSoundStream::Seek(unsigned sampleNumber)
+{
+    MutexLock lock(decodeMutex_);
+    if (!source_->Seek(sampleNumber))
+        return false;
+
+    // Discard everything decoded so far
+    readPosition_.store(writePosition_.load(std::memory_order_relaxed), std::memory_order_release);
+    finished_.store(false, std::memory_order_release);
+    return true;
+}
+
+unsigned PrefetchedSoundStream::GetData(signed char* dest, unsigned numBytes)
+{
+    // Check finished flag before write position, so all data written before the end is visible
+    const bool finished = finished_.load(std::memory_order_acquire);
+    const unsigned writePosition = writePosition_.load(std::memory_order_acquire);
+    const unsigned readPosition = readPosition_.load(std::memory_order_relaxed);
+
+    const unsigned numBytesRead = Min(numBytes, writePosition - readPosition);
+    const unsigned offset = readPosition & bufferMask_;
+    const unsigned firstChunk = Min(numBytesRead, static_cast<unsigned>(buffer_.size()) - offset);
+    memcpy(dest, buffer_.data() + offset, firstChunk);
+    memcpy(dest + firstChunk, buffer_.data(), numBytesRead - firstChunk);
+
+    readPosition_.store(readPosition + numBytesRead, std::memory_order_release);
+
+    // Play silence instead of stopping if the decoder is late
+    if (numBytesRead < numBytes && !finished)
+    {
+        numUnderruns_.fetch_add(1, std::memory_order_relaxed);
+        memset(dest + numBytesRead, 0, numBytes - numBytesRead);
+        return numBytes;
+    }
+
+    return numBytesRead;
+}
+
+void PrefetchedSoundStream::Decode()
+{
+    MutexLock lock(decodeMutex_);
+    if (finished_.load(std::memory_order_relaxed))
+        return;
+
+    // Data is written in whole samples, buffer size is multiple of sample size
+    const unsigned sampleSize = GetSampleSize();
+    const unsigned bufferSize = buffer_.size();
+    const unsigned readPosition = readPosition_.load(std::memory_order_acquire);
+    unsigned writePosition = writePosition_.load(std::memory_order_relaxed);
+    unsigned numFreeBytes = bufferSize - (writePosition - readPosition);
+    numFreeBytes -= numFreeBytes % sampleSize;
+
+    bool finished = false;
+    while (numFreeBytes > 0)
+    {
+        const unsigned offset = writePosition & bufferMask_;
+        const unsigned numBytesRequested = Min(numFreeBytes, bufferSize - offset);
+        const unsigned numBytesDecoded = source_->GetData(buffer_.data() + offset, numBytesRequested);
+
+        writePosition += numBytesDecoded;
+        numFreeBytes -= numBytesDecoded;
+        if (numBytesDecoded < numBytesRequested)
+        {
+            finished = source_->GetStopAtEnd();
+            break;
+        }
+    }
+
+    writePosition_.store(writePosition, std::memory_order_release);
+    if (finished)
+        finished_.store(true, std::memory_order_release);
+}
+
+unsigned PrefetchedSoundStream::GetNumBufferedBytes() const
+{
+    return writePosition_.load(std::memory_order_acquire) - readPosition_.load(std::memory_order_acquire);
+}
+
+SoundStreamDecoder::SoundStreamDecoder(unsigned intervalMSec)
+    : Thread("SoundStreamDecoder")
+    , intervalMSec_(intervalMSec)
+{
+}
+
+SoundStreamDecoder::~SoundStreamDecoder()
+{
+    Stop();
+}
+
+void SoundStreamDecoder::AddStream(PrefetchedSoundStream* stream)
+{
+    MutexLock lock(newStreamsMutex_);
+    newStreams_.emplace_back(stream);
+}
+
+void SoundStreamDecoder::ThreadFunction()
+{
+    URHO3D_PROFILE_THREAD("SoundStreamDecoder");
+
+    while (shouldRun_)
+    {
+        DecodeStreams();
+        Time::Sleep(intervalMSec_.load(std::memory_order_relaxed));
+    }
+}
+
+void SoundStreamDecoder::DecodeStreams()
+{
+    URHO3D_PROFILE("DecodeSoundStreams");
+
+    {
+        MutexLock lock(newStreamsMutex_);
+        streams_.insert(streams_.end(), newStreams_.begin(), newStreams_.end());
+        newStreams_.clear();
+    }
+
+    // Stream may be restarted by seek after it has finished, so keep it while it is referenced
+    ea::erase_if(streams_, [](const SharedPtr<PrefetchedSoundStream>& stream) { return stream->Refs() == 1; });
+
+    for (PrefetchedSoundStream* stream : streams_)
+        stream->Decode();
+}
+
+}
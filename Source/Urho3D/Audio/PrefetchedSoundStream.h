@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Audio/SoundStream.h"
+#include "../Container/Ptr.h"
+#include "../Core/Mutex.h"
+#include "../Core/Thread.h"
+
+#include <EASTL/vector.h>
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+/// Sound stream that is decoded ahead of playback into a ring buffer.
+/// Data is produced by SoundStreamDecoder thread and consumed by the mixing thread without locking.
+class URHO3D_API PrefetchedSoundStream : public SoundStream
+{
+public:
+    /// Construct with source stream and size of the ring buffer in bytes, rounded up to power of two.
+    PrefetchedSoundStream(SoundStream* source, unsigned bufferSize);
+
+    /// Seek source stream and discard decoded data. Should not be called concurrently with GetData.
+    bool Seek(unsigned sampleNumber) override;
+    /// Consume decoded data. Produces silence if the decoder is behind playback.
+    unsigned GetData(signed char* dest, unsigned numBytes) override;
+
+    /// Decode source stream until the ring buffer is full. Called by SoundStreamDecoder, or once on creation.
+    void Decode();
+
+    /// Return whether the source stream has ended.
+    bool IsFinished() const { return finished_.load(std::memory_order_acquire); }
+    /// Return number of bytes decoded but not consumed yet.
+    unsigned GetNumBufferedBytes() const;
+    /// Return number of times the mixing thread had to wait for the decoder.
+    unsigned GetNumUnderruns() const { return numUnderruns_.load(std::memory_order_relaxed); }
+
+private:
+    SharedPtr<SoundStream> source_;
+    /// Protects the source stream from concurrent decoding and seeking.
+    Mutex decodeMutex_;
+
+    ea::vector<signed char> buffer_;
+    unsigned bufferMask_{};
+    /// Positions in the ring buffer. Always increase and wrap around on overflow.
+    /// @{
+    std::atomic<unsigned> readPosition_{};
+    std::atomic<unsigned> writePosition_{};
+    /// @}
+    std::atomic<bool> finished_{};
+    std::atomic<unsigned> numUnderruns_{};
+};
+
+/// Background thread that decodes prefetched sound streams.
+/// Streams are released when the decoder holds the only reference to them.
+class URHO3D_API SoundStreamDecoder : public Thread
+{
+public:
+    /// Construct with interval between decoding passes.
+    explicit SoundStreamDecoder(unsigned intervalMSec);
+    /// Destruct. Stop the thread.
+    ~SoundStreamDecoder() override;
+
+    /// Add stream to decode.
+    void AddStream(PrefetchedSoundStream* stream);
+    /// Set interval between decoding passes.
+    void SetInterval(unsigned intervalMSec) { intervalMSec_ = intervalMSec; }
+
+    /// Decode streams until stopped.
+    void ThreadFunction() override;
+
+private:
+    void DecodeStreams();
+
+    std::atomic<unsigned> intervalMSec_{};
+
+    Mutex newStreamsMutex_;
+    ea::vector<SharedPtr<PrefetchedSoundStream>> newStreams_;
+    /// Streams owned by the decoder thread.
+    ea::vector<SharedPtr<PrefetchedSoundStream>> streams_;
+};
+
+}
@@ -40,69 +40,105 @@ namespace Urho3D
 {
 
 /// Reminder that channels are in WAV order, FL FR FC LFE RL RR
-static const int SOUND_SOURCE_LOW_FREQ_CHANNEL[] = {
-    0, // SPK_AUTO
-    0, // SPK_MONO
-    0, // SPK_STEREO
-    0, // SPK_QUADROPHONIC
-    3, // SPK_SURROUND_5_1
-};
-
-#define INC_POS_LOOPED() \
-    pos += intAdd; \
-    fractPos += fractAdd; \
-    if (fractPos > 65535) \
-    { \
-        fractPos &= 65535; \
-        ++pos; \
-    } \
-    while (pos >= end) \
-        pos -= (end - repeat); \
-
-#define INC_POS_ONESHOT() \
-    pos += intAdd; \
-    fractPos += fractAdd; \
-    if (fractPos > 65535) \
-    { \
-        fractPos &= 65535; \
-        ++pos; \
-    } \
-    if (pos >= end) \
-    { \
-        pos = 0; \
-        break; \
-    } \
-
-#define INC_POS_STEREO_LOOPED() \
-    pos += ((unsigned)intAdd << 1u); \
-    fractPos += fractAdd; \
-    if (fractPos > 65535) \
-    { \
-        fractPos &= 65535; \
-        pos += 2; \
-    } \
-    while (pos >= end) \
-        pos -= (end - repeat); \
-
-#define INC_POS_STEREO_ONESHOT() \
-    pos += ((unsigned)intAdd << 1u); \
-    fractPos += fractAdd; \
-    if (fractPos > 65535) \
-    { \
-        fractPos &= 65535; \
-        pos += 2; \
-    } \
-    if (pos >= end) \
-    { \
-        pos = 0; \
-        break; \
-    } \
-
-#define GET_IP_SAMPLE() (((((int)pos[1] - (int)pos[0]) * fractPos) / 65536) + (int)pos[0])
-
-#define GET_IP_SAMPLE_LEFT() (((((int)pos[2] - (int)pos[0]) * fractPos) / 65536) + (int)pos[0])
-
-#define GET_IP_SAMPLE_RIGHT() (((((int)pos[3] - (int)pos[1]) * fractPos) / 65536) + (int)pos[1])
+static const unsigned SOUND_SOURCE_LOW_FREQ_CHANNEL = 3;
+
+/// Scale of 8-bit and 16-bit samples in the float mix buffer.
+static const float SAMPLE_SCALE_8BIT = 1.0f / 128.0f;
+static const float SAMPLE_SCALE_16BIT = 1.0f / 32768.0f;
+
+/// Resample sound data to float channels with fixed point step, advancing the play position.
+/// Return number of samples read, which is less than requested if one-shot sound has ended.
+template <class T, unsigned NumChannels, bool Interpolate>
+static unsigned ResampleSamples(const T*& pos, int& fractPos, const T* end, const T* repeat, bool looped,
+    float* const dest[], unsigned numSamples, int intAdd, int fractAdd, float scale)
+{
+    for (unsigned i = 0; i < numSamples; ++i)
+    {
+        for (unsigned channel = 0; channel < NumChannels; ++channel)
+        {
+            const float sample = pos[channel];
+            if constexpr (Interpolate)
+            {
+                const float nextSample = pos[channel + NumChannels];
+                dest[channel][i] = (sample + (nextSample - sample) * (fractPos * (1.0f / 65536.0f))) * scale;
+            }
+            else
+                dest[channel][i] = sample * scale;
+        }
+
+        pos += intAdd * NumChannels;
+        fractPos += fractAdd;
+        if (fractPos > 65535)
+        {
+            fractPos &= 65535;
+            pos += NumChannels;
+        }
+        if (pos >= end)
+        {
+            if (!looped)
+            {
+                pos = nullptr;
+                return i + 1;
+            }
+            while (pos >= end)
+                pos -= (end - repeat);
+        }
+    }
+    return numSamples;
+}
+
+/// Convert 16-bit sound data to float channels when sound frequency matches mix rate.
+template <unsigned NumChannels>
+static unsigned CopySamples(const short*& pos, const short* end, const short* repeat, bool looped,
+    float* const dest[], unsigned numSamples, float scale)
+{
+    unsigned numRead = 0;
+    while (numRead < numSamples)
+    {
+        const auto numAvailable = static_cast<unsigned>((end - pos + NumChannels - 1) / NumChannels);
+        const unsigned count = Min(numSamples - numRead, numAvailable);
+        if constexpr (NumChannels == 1)
+            ConvertSamples(dest[0] + numRead, pos, count, scale);
+        else
+            ConvertSamples(dest[0] + numRead, dest[1] + numRead, pos, count, scale);
+
+        pos += count * NumChannels;
+        numRead += count;
+        if (pos >= end)
+        {
+            if (!looped)
+            {
+                pos = nullptr;
+                break;
+            }
+            while (pos >= end)
+                pos -= (end - repeat);
+        }
+    }
+    return numRead;
+}
+
+template <class T, unsigned NumChannels>
+static unsigned ReadSoundSamples(const T*& pos, int& fractPos, const T* end, const T* repeat, bool looped,
+    float* const dest[], unsigned numSamples, int intAdd, int fractAdd, bool interpolation, float scale)
+{
+    if constexpr (ea::is_same_v<T, short>)
+    {
+        if (intAdd == 1 && fractAdd == 0 && (!interpolation || fractPos == 0))
+            return CopySamples<NumChannels>(pos, end, repeat, looped, dest, numSamples, scale);
+    }
+
+    if (interpolation && fractAdd != 0)
+    {
+        return ResampleSamples<T, NumChannels, true>(
+            pos, fractPos, end, repeat, looped, dest, numSamples, intAdd, fractAdd, scale);
+    }
+    else
+    {
+        return ResampleSamples<T, NumChannels, false>(
+            pos, fractPos, end, repeat, looped, dest, numSamples, intAdd, fractAdd, scale);
+    }
+}
 
 static const int STREAM_SAFETY_SAMPLES = 4;
 
@@ -171,7 +207,8 @@ void SoundSource::Seek(float seekTime)
     }
     else
     {
-        // Ogg format
+        // Ogg format. Stream may not be used by the mixing thread while seeking
+        MutexLock lock(audio_->GetMutex());
         if (soundStream_->Seek((unsigned)(seekTime * soundStream_->GetFrequency())))
         {
             timePosition_ = seekTime;
@@ -188,14 +225,19 @@ void SoundSource::Play(Sound* sound)
     if (frequency_ == 0.0f && sound)
         SetFrequency(sound->GetFrequency());
 
+    // Pre-buffer compressed sound before locking the audio mutex
+    SharedPtr<SoundStream> decoderStream;
+    if (sound && sound->IsCompressed())
+        decoderStream = audio_->PrefetchSoundStream(sound->GetDecoderStream());
+
     // If sound source is currently playing, have to lock the audio mutex
     if (position_)
     {
         MutexLock lock(audio_->GetMutex());
-        PlayLockless(sound);
+        PlayLockless(sound, decoderStream);
     }
     else
-        PlayLockless(sound);
+        PlayLockless(sound, decoderStream);
 }
 
 void SoundSource::Play(Sound* sound, float frequency)
@@ -228,7 +270,8 @@ void SoundSource::Play(SoundStream* stream)
     if (frequency_ == 0.0f && stream)
         SetFrequency(stream->GetFrequency());
 
-    SharedPtr<SoundStream> streamPtr(stream);
+    // Pre-buffer the stream before locking the audio mutex
+    SharedPtr<SoundStream> streamPtr = audio_->PrefetchSoundStream(stream);
 
     // If sound source is currently playing, have to lock the audio mutex. When stream playback is explicitly
     // requested, clear the existing sound if any
@@ -337,7 +380,7 @@ void SoundSource::Update(float timeStep)
         return;
 
     // If there is no actual audio output, perform fake mixing into a nonexistent buffer to check stopping/looping
-    if (!audio_->IsInitialized())
+    if (!audio_->IsInitialized() && !audio_->IsOffline())
         MixNull(timeStep, frequency_ * effectiveTimeScale);
 
     // Free the stream if playback has stopped
@@ -368,7 +411,8 @@ void SoundSource::Update(float timeStep)
     }
 }
 
-void SoundSource::Mix(int dest[], unsigned samples, int mixRate, SpeakerMode mode, bool interpolation)
+void SoundSource::Mix(AudioMixBuffer& dest, AudioMixBuffer& sourceBuffer, unsigned samples, int mixRate,
+    SpeakerMode mode, bool interpolation)
 {
     if (!position_ || (!sound_ && !soundStream_))
         return;
@@ -412,83 +456,50 @@ void SoundSource::Mix(int dest[], unsigned samples, int mixRate, SpeakerMode mod
     if (!sound)
         return;
 
-    // Choose the correct mixing routine
-    if (!sound->IsStereo())
+    // Virtual sound sources ramp down to silence and then only advance the play position.
+    // Gains are ramped up again when the source becomes real.
+    float channelGains[MAX_AUDIO_CHANNELS][2]{};
+    if (!virtual_)
+        CalculateChannelGains(channelGains, sound->IsStereo(), mode);
+
+    bool isSilent = true;
+    for (unsigned channel = 0; channel < MAX_AUDIO_CHANNELS; ++channel)
     {
-        if (interpolation)
-        {
-            switch (mode)
-            {
-            case SPK_AUTO:
-                assert(!"SPK_AUTO");
-                break;
-            case SPK_MONO:
-                if (!lowFrequency_)
-                    MixMonoToMonoIP(sound, dest, samples, mixRate, effectiveFrequency);
-                break;
-            case SPK_STEREO:
-                if (!lowFrequency_)
-                    MixMonoToStereoIP(sound, dest, samples, mixRate, effectiveFrequency);
-                break;
-            case SPK_QUADROPHONIC:
-                if (!lowFrequency_)
-                    MixMonoToSurroundIP(sound, dest, samples, mixRate, effectiveFrequency, mode);
-                break;
-            case SPK_SURROUND_5_1:
-                if (lowFrequency_)
-                    MixMonoToMonoIP(sound, dest, samples, mixRate, SOUND_SOURCE_LOW_FREQ_CHANNEL[mode], 6);
-                else
-                    MixMonoToSurroundIP(sound, dest, samples, mixRate, effectiveFrequency, mode);
-                break;
-            }
-        }
-        else
+        for (unsigned sourceChannel = 0; sourceChannel < 2; ++sourceChannel)
         {
-            switch (mode)
-            {
-            case SPK_AUTO:
-                assert(!"SPK_AUTO");
-                break;
-            case SPK_MONO:
-                if (!lowFrequency_)
-                    MixMonoToStereo(sound, dest, samples, mixRate, effectiveFrequency);
-                break;
-            case SPK_STEREO:
-                if (!lowFrequency_)
-                    MixMonoToMono(sound, dest, samples, mixRate, effectiveFrequency);
-                break;
-            case SPK_QUADROPHONIC:
-                if (!lowFrequency_)
-                    MixMonoToSurround(sound, dest, samples, mixRate, effectiveFrequency, mode);
-                break;
-            case SPK_SURROUND_5_1:
-                if (lowFrequency_)
-                    MixMonoToMono(
-                        sound, dest, samples, mixRate, effectiveFrequency, SOUND_SOURCE_LOW_FREQ_CHANNEL[mode], 6);
-                else
-                    MixMonoToSurround(sound, dest, samples, mixRate, effectiveFrequency, mode);
-                break;
-            }
+            if (channelGains[channel][sourceChannel] != 0.0f
+                || (channelGainsValid_ && channelGains_[channel][sourceChannel] != 0.0f))
+                isSilent = false;
         }
     }
+
+    if (isSilent)
+        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
     else
     {
-        if (interpolation)
-        {
-            if (mode == SPK_MONO)
-                MixStereoToMonoIP(sound, dest, samples, mixRate, effectiveFrequency);
-            else
-                MixStereoToMultiIP(sound, dest, samples, mixRate, effectiveFrequency, mode);
-        }
-        else
+        const unsigned numSamples = ReadSamples(sound, sourceBuffer, samples, mixRate, effectiveFrequency, interpolation);
+        const unsigned numSourceChannels = sound->IsStereo() ? 2 : 1;
+        const unsigned numChannels = dest.GetNumChannels();
+
+        // Ramp gains from the previous mix to avoid clicks
+        for (unsigned channel = 0; channel < numChannels; ++channel)
         {
-            if (mode == SPK_MONO)
-                MixStereoToMono(sound, dest, samples, mixRate, effectiveFrequency);
-            else
-                MixStereoToMulti(sound, dest, samples, mixRate, effectiveFrequency, mode);
+            for (unsigned sourceChannel = 0; sourceChannel < numSourceChannels; ++sourceChannel)
+            {
+                const float gain = channelGains[channel][sourceChannel];
+                const float previousGain = channelGainsValid_ ? channelGains_[channel][sourceChannel] : gain;
+                if (gain == 0.0f && previousGain == 0.0f)
+                    continue;
+
+                const float gainStep = (gain - previousGain) / samples;
+                MixSamples(dest.GetChannel(channel), sourceBuffer.GetChannel(sourceChannel), numSamples, previousGain, gainStep);
+            }
         }
     }
 
+    memcpy(channelGains_, channelGains, sizeof(channelGains_));
+    channelGainsValid_ = true;
+
     // Update the time position. In stream mode, copy unused data back to the beginning of the stream buffer
     if (soundStream_)
     {
@@ -560,7 +571,7 @@ int SoundSource::GetPositionAttr() const
         return 0;
 }
 
-void SoundSource::PlayLockless(Sound* sound)
+void SoundSource::PlayLockless(Sound* sound, SoundStream* decoderStream)
 {
     // Reset the time position in any case
     timePosition_ = 0.0f;
@@ -579,6 +590,8 @@ void SoundSource::PlayLockless(Sound* sound)
                 sound_ = sound;
                 position_ = start;
                 fractPosition_ = 0;
+                channelGainsValid_ = false;
+                virtual_ = false;
                 sendFinishedEvent_ = true;
                 return;
             }
@@ -586,7 +599,7 @@ void SoundSource::PlayLockless(Sound* sound)
         else
         {
             // Compressed sound start
-            PlayLockless(sound->GetDecoderStream());
+            PlayLockless(decoderStream ? SharedPtr<SoundStream>(decoderStream) : sound->GetDecoderStream());
             sound_ = sound;
             return;
         }
@@ -617,6 +630,8 @@ void SoundSource::PlayLockless(const SharedPtr<SoundStream>& stream)
         unusedStreamSize_ = 0;
         position_ = streamBuffer_->GetStart();
         fractPosition_ = 0;
+        channelGainsValid_ = false;
+        virtual_ = false;
         sendFinishedEvent_ = true;
         return;
     }
@@ -654,1185 +669,134 @@ void SoundSource::SetPlayPositionLockless(signed char* pos)
     timePosition_ = ((float)(int)(size_t)(pos - sound_->GetStart())) / (sound_->GetSampleSize() * sound_->GetFrequency());
 }
 
-void SoundSource::MixMonoToMono(
-    Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency, int channel, int channelCount)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
-    float add = effectiveFrequency / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                dest += channel;
-                *dest = *dest + (*pos * vol) / 256;
-                dest += channelCount - channel;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                dest += channel;
-                *dest = *dest + (*pos * vol) / 256;
-                dest += channelCount - channel;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                dest += channel;
-                *dest = *dest + *pos * vol;
-                dest += channelCount - channel;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                dest += channel;
-                *dest = *dest + *pos * vol;
-                dest += channelCount - channel;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
+void SoundSource::CalculateChannelGains(float gains[][2], bool isStereo, SpeakerMode mode) const
+{
+    const float totalGain = masterGain_ * attenuation_ * gain_;
+
+    if (isStereo)
+    {
+        // Stereo sounds are not panned. Front-center and LFE are ommitted.
+        switch (mode)
+        {
+        case SPK_MONO:
+            gains[0][0] = 0.5f * totalGain;
+            gains[0][1] = 0.5f * totalGain;
+            break;
+        case SPK_STEREO:
+            gains[0][0] = totalGain;
+            gains[1][1] = totalGain;
+            break;
+        case SPK_QUADROPHONIC:
+            gains[0][0] = totalGain;
+            gains[1][1] = totalGain;
+            gains[2][0] = totalGain;
+            gains[3][1] = totalGain;
+            break;
+        case SPK_SURROUND_5_1:
+            gains[0][0] = totalGain;
+            gains[1][1] = totalGain;
+            gains[4][0] = totalGain;
+            gains[5][1] = totalGain;
+            break;
+        default:
+            assert(!"SPK_AUTO");
+            break;
         }
-    }
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto leftVol = (int)((-panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    auto rightVol = (int)((panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    if (!leftVol && !rightVol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
         return;
     }
 
-    float add = effectiveFrequency / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (*pos * rightVol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (*pos * rightVol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * leftVol;
-                ++dest;
-                *dest = *dest + *pos * rightVol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * leftVol;
-                ++dest;
-                *dest = *dest + *pos * rightVol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency, int channel, int channelCount)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
+    // Low frequency sources are audible only if there is LFE channel
+    if (lowFrequency_)
     {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
+        if (mode == SPK_SURROUND_5_1)
+            gains[SOUND_SOURCE_LOW_FREQ_CHANNEL][0] = totalGain;
         return;
     }
 
-    float add = effectiveFrequency / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                dest += channel;
-                *dest = *dest + (GET_IP_SAMPLE() * vol) / 256;
-                dest += channelCount - channel;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                dest += channel;
-                *dest = *dest + (GET_IP_SAMPLE() * vol) / 256;
-                dest += channelCount - channel;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                dest += channel;
-                *dest = *dest + GET_IP_SAMPLE() * vol;
-                dest += channelCount - channel;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                dest += channel;
-                *dest = *dest + GET_IP_SAMPLE() * vol;
-                dest += channelCount - channel;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency)
+    const float frontLeft = (-panning_ + 1.0f) * (reach_ + 1.0f) * totalGain;
+    const float frontRight = (panning_ + 1.0f) * (reach_ + 1.0f) * totalGain;
+    const float rearLeft = (-panning_ + 1.0f) * (-reach_ + 1.0f) * totalGain;
+    const float rearRight = (panning_ + 1.0f) * (-reach_ + 1.0f) * totalGain;
+    switch (mode)
+    {
+    case SPK_MONO:
+        gains[0][0] = totalGain;
+        break;
+    case SPK_STEREO:
+        gains[0][0] = (-panning_ + 1.0f) * totalGain;
+        gains[1][0] = (panning_ + 1.0f) * totalGain;
+        break;
+    case SPK_QUADROPHONIC:
+        gains[0][0] = frontLeft;
+        gains[1][0] = frontRight;
+        gains[2][0] = rearLeft;
+        gains[3][0] = rearRight;
+        break;
+    case SPK_SURROUND_5_1:
+        gains[0][0] = frontLeft;
+        gains[1][0] = frontRight;
+        gains[2][0] = Lerp(frontLeft, frontRight, 0.5f) * Clamp(reach_, 0.0f, 1.0f);
+        gains[4][0] = rearLeft;
+        gains[5][0] = rearRight;
+        break;
+    default:
+        assert(!"SPK_AUTO");
+        break;
+    }
+}
+
+unsigned SoundSource::ReadSamples(
+    Sound* sound, AudioMixBuffer& dest, unsigned samples, int mixRate, float effectiveFrequency, bool interpolation)
 {
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto leftVol = (int)((-panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    auto rightVol = (int)((panning_ + 1.0f) * (256.0f * totalGain + 0.5f));
-    if (!leftVol && !rightVol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
     float add = effectiveFrequency / (float)mixRate;
     auto intAdd = (int)add;
     auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
     int fractPos = fractPosition_;
 
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + (s * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (s * rightVol) / 256;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + (s * leftVol) / 256;
-                ++dest;
-                *dest = *dest + (s * rightVol) / 256;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + s * leftVol;
-                ++dest;
-                *dest = *dest + s * rightVol;
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + s * leftVol;
-                ++dest;
-                *dest = *dest + s * rightVol;
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToMono(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
-    float add = effectiveFrequency / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
+    float* const channels[] = {dest.GetChannel(0), dest.GetChannel(1)};
+    const bool isStereo = sound->IsStereo();
+    const bool isLooped = sound->IsLooped();
+    unsigned numSamples = 0;
 
     if (sound->IsSixteenBit())
     {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
+        auto* pos = (const short*)position_;
+        auto* end = (const short*)sound->GetEnd();
+        auto* repeat = (const short*)sound->GetRepeat();
 
-        if (sound->IsLooped())
+        if (isStereo)
         {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
+            numSamples = ReadSoundSamples<short, 2>(pos, fractPos, end, repeat, isLooped, channels, samples,
+                intAdd, fractAdd, interpolation, SAMPLE_SCALE_16BIT);
         }
         else
         {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
+            numSamples = ReadSoundSamples<short, 1>(pos, fractPos, end, repeat, isLooped, channels, samples,
+                intAdd, fractAdd, interpolation, SAMPLE_SCALE_16BIT);
         }
+        position_ = (signed char*)pos;
     }
     else
     {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
+        auto* pos = (const signed char*)position_;
+        const signed char* end = sound->GetEnd();
+        const signed char* repeat = sound->GetRepeat();
 
-        if (sound->IsLooped())
+        if (isStereo)
         {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
+            numSamples = ReadSoundSamples<signed char, 2>(pos, fractPos, end, repeat, isLooped, channels, samples,
+                intAdd, fractAdd, interpolation, SAMPLE_SCALE_8BIT);
         }
         else
         {
-            while (samples--)
-            {
-                int s = ((int)pos[0] + (int)pos[1]) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
-    float add = effectiveFrequency / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (pos[0] * vol) / 256;
-                ++dest;
-                *dest = *dest + (pos[1] * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (pos[0] * vol) / 256;
-                ++dest;
-                *dest = *dest + (pos[1] * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + pos[0] * vol;
-                ++dest;
-                *dest = *dest + pos[1] * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + pos[0] * vol;
-                ++dest;
-                *dest = *dest + pos[1] * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
-    float add = effectiveFrequency / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + (s * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = (GET_IP_SAMPLE_LEFT() + GET_IP_SAMPLE_RIGHT()) / 2;
-                *dest = *dest + s * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    auto vol = RoundToInt(256.0f * totalGain);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
-    float add = effectiveFrequency / (float)mixRate;
-    auto intAdd = (int)add;
-    auto fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        auto* pos = (short*)position_;
-        auto* end = (short*)sound->GetEnd();
-        auto* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256;
-                ++dest;
-                *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256;
-                ++dest;
-                *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        auto* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE_LEFT() * vol;
-                ++dest;
-                *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol;
-                ++dest;
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE_LEFT() * vol;
-                ++dest;
-                *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol;
-                ++dest;
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToSurround(
-    Sound* sound, int* dest, unsigned samples, int mixRate, float effectiveFrequency, SpeakerMode speakerMode)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int frontLeftVol = (int)(((-panning_ + 1.0f) * (reach_ + 1.0f)) * (256.0f * totalGain + 0.5f));
-    int frontRightVol = (int)(((panning_ + 1.0f) * (reach_ + 1.0f)) * (256.0f * totalGain + 0.5f));
-    int rearLeftVol = (int)(((-panning_ + 1.0f) * (-reach_ + 1.0f)) * (256.0f * totalGain + 0.5f));
-    int rearRightVol = (int)(((panning_ + 1.0f) * (-reach_ + 1.0f)) * (256.0f * totalGain + 0.5f));
-    int centerVol = Lerp(frontLeftVol, frontRightVol, 0.5f) * Clamp(reach_, 0.0f, 1.0f);
-
-    if (!frontLeftVol && !frontRightVol && !rearLeftVol && !rearRightVol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
-    float add = effectiveFrequency / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * frontLeftVol) / 256; // FL
-                ++dest;
-                *dest = *dest + (*pos * frontRightVol) / 256; // FR
-                ++dest;
-
-                if (speakerMode == SPK_SURROUND_5_1)
-                {
-                    *dest = *dest + (*pos * centerVol) / 256; // FC
-                    ++dest;
-                    ++dest; // LFE
-                }
-
-                *dest = *dest + (*pos * rearLeftVol) / 256; // RL
-                ++dest;
-                *dest = *dest + (*pos * rearRightVol) / 256; // RR
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (*pos * frontLeftVol) / 256; // FL
-                ++dest;
-                *dest = *dest + (*pos * frontRightVol) / 256; // FR
-                ++dest;
-
-                if (speakerMode == SPK_SURROUND_5_1)
-                {
-                    *dest = *dest + (*pos * centerVol) / 256; // FC
-                    ++dest;
-                    ++dest; // LFE
-                }
-
-                *dest = *dest + (*pos * rearLeftVol) / 256; // RL
-                ++dest;
-                *dest = *dest + (*pos * rearRightVol) / 256; // RR
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * frontLeftVol; // FL
-                ++dest;
-                *dest = *dest + *pos * frontRightVol; // FR
-                ++dest;
-
-                if (speakerMode == SPK_SURROUND_5_1)
-                {
-                    *dest = *dest + *pos * centerVol; // FC
-                    ++dest;
-                    ++dest; // LFE
-                }
-
-                *dest = *dest + *pos * rearLeftVol; // RL
-                ++dest;
-                *dest = *dest + *pos * rearRightVol; // RR
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + *pos * frontLeftVol; // FL
-                ++dest;
-                *dest = *dest + *pos * frontRightVol; // FR
-                ++dest;
-
-                if (speakerMode == SPK_SURROUND_5_1)
-                {
-                    *dest = *dest + *pos * centerVol; // FC
-                    ++dest;
-                    ++dest; // LFE
-                }
-
-                *dest = *dest + *pos * rearLeftVol; // RL
-                ++dest;
-                *dest = *dest + *pos * rearRightVol; // RR
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixMonoToSurroundIP(
-    Sound* sound, int* dest, unsigned samples, int mixRate, float effectiveFrequency, SpeakerMode speakerMode)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int frontLeftVol = (int)(((-panning_ + 1.0f) * (reach_ + 1.0f)) * (256.0f * totalGain + 0.5f));
-    int frontRightVol = (int)(((panning_ + 1.0f) * (reach_ + 1.0f)) * (256.0f * totalGain + 0.5f));
-    int rearLeftVol = (int)(((-panning_ + 1.0f) * (-reach_ + 1.0f)) * (256.0f * totalGain + 0.05f));
-    int rearRightVol = (int)(((panning_ + 1.0f) * (-reach_ + 1.0f)) * (256.0f * totalGain + 0.5f));
-    int centerVol = Lerp(frontLeftVol, frontRightVol, 0.5f) * Clamp(reach_, 0.0f, 1.0f);
-
-    if (!frontLeftVol && !frontRightVol && !rearLeftVol && !rearRightVol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
-    float add = effectiveFrequency / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + (s * frontLeftVol) / 256; // FL
-                ++dest;
-                *dest = *dest + (s * frontRightVol) / 256; // FR
-                ++dest;
-
-                if (speakerMode == SPK_SURROUND_5_1)
-                {
-                    *dest = *dest + (s * centerVol) / 256; // FC
-                    ++dest;
-                    ++dest; // LFE
-                }
-
-                *dest = *dest + (s * rearLeftVol) / 256; // RL
-                ++dest;
-                *dest = *dest + (s * rearRightVol) / 256; // RR
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + (s * frontLeftVol) / 256; // FL
-                ++dest;
-                *dest = *dest + (s * frontRightVol) / 256; // FR
-                ++dest;
-
-                if (speakerMode == SPK_SURROUND_5_1)
-                {
-                    *dest = *dest + (s * centerVol) / 256; // FC
-                    ++dest;
-                    ++dest; // LFE
-                }
-
-                *dest = *dest + (s * rearLeftVol) / 256; // RL
-                ++dest;
-                *dest = *dest + (s * rearRightVol) / 256; // RR
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + s * frontLeftVol; // FL
-                ++dest;
-                *dest = *dest + s * frontRightVol; // FR
-                ++dest;
-
-                if (speakerMode == SPK_SURROUND_5_1)
-                {
-                    *dest = *dest + s * centerVol; // FC
-                    ++dest;
-                    ++dest; // LFE
-                }
-
-                *dest = *dest + s * rearLeftVol; // RL
-                ++dest;
-                *dest = *dest + s * rearRightVol; // RR
-                ++dest;
-                INC_POS_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                int s = GET_IP_SAMPLE();
-                *dest = *dest + s * frontLeftVol; // FL
-                ++dest;
-                *dest = *dest + s * frontRightVol; // FR
-                ++dest;
-
-                if (speakerMode == SPK_SURROUND_5_1)
-                {
-                    *dest = *dest + s * centerVol; // FC
-                    ++dest; // FC
-                    ++dest; // LFE
-                }
-
-                *dest = *dest + s * rearLeftVol; // RL
-                ++dest;
-                *dest = *dest + s * rearRightVol; // RR
-                ++dest;
-                INC_POS_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToMulti(
-    Sound* sound, int* dest, unsigned samples, int mixRate, float effectiveFrequency, SpeakerMode speakers)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int vol = (int)(256.0f * totalGain + 0.5f);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
-    float add = effectiveFrequency / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (pos[0] * vol) / 256; // FL
-                ++dest;
-                *dest = *dest + (pos[1] * vol) / 256; // FR
-                ++dest;
-
-                if (speakers > SPK_STEREO)
-                {
-                    if (speakers == SPK_SURROUND_5_1)
-                    {
-                        ++dest; // FC
-                        ++dest; // LFE
-                    }
-
-                    *dest = *dest + (pos[0] * vol) / 256; // RL
-                    ++dest;
-                    *dest = *dest + (pos[1] * vol) / 256; // RR
-                    ++dest;
-                }
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (pos[0] * vol) / 256; // FL
-                ++dest;
-                *dest = *dest + (pos[1] * vol) / 256; // FR
-                ++dest;
-                if (speakers > SPK_STEREO)
-                {
-                    if (speakers == SPK_SURROUND_5_1)
-                    {
-                        ++dest; // FC
-                        ++dest; // LFE
-                    }
-                    *dest = *dest + (pos[0] * vol) / 256; // RL
-                    ++dest;
-                    *dest = *dest + (pos[1] * vol) / 256; // RR
-                    ++dest;
-                }
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + pos[0] * vol; // FL
-                ++dest;
-                *dest = *dest + pos[1] * vol; // FR
-                ++dest;
-                if (speakers > SPK_STEREO)
-                {
-                    if (speakers == SPK_SURROUND_5_1)
-                    {
-                        ++dest; // FC
-                        ++dest; // LFE
-                    }
-                    *dest = *dest + pos[0] * vol; // RL
-                    ++dest;
-                    *dest = *dest + pos[1] * vol; // RR
-                    ++dest;
-                }
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + pos[0] * vol; // FL
-                ++dest;
-                *dest = *dest + pos[1] * vol; // FR
-                ++dest;
-                if (speakers > SPK_STEREO)
-                {
-                    if (speakers == SPK_SURROUND_5_1)
-                    {
-                        ++dest; // FC
-                        ++dest; // LFE
-                    }
-
-                    *dest = *dest + pos[0] * vol; // RL
-                    ++dest;
-                    *dest = *dest + pos[1] * vol; // RR
-                    ++dest;
-                }
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
-        }
-    }
-
-    fractPosition_ = fractPos;
-}
-
-void SoundSource::MixStereoToMultiIP(
-    Sound* sound, int* dest, unsigned samples, int mixRate, float effectiveFrequency, SpeakerMode speakers)
-{
-    float totalGain = masterGain_ * attenuation_ * gain_;
-    int vol = (int)(256.0f * totalGain + 0.5f);
-    if (!vol)
-    {
-        MixZeroVolume(sound, samples, mixRate, effectiveFrequency);
-        return;
-    }
-
-    float add = effectiveFrequency / (float)mixRate;
-    int intAdd = (int)add;
-    int fractAdd = (int)((add - floorf(add)) * 65536.0f);
-    int fractPos = fractPosition_;
-
-    if (sound->IsSixteenBit())
-    {
-        short* pos = (short*)position_;
-        short* end = (short*)sound->GetEnd();
-        short* repeat = (short*)sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256; // FL
-                ++dest;
-                *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256; // FR
-                ++dest;
-                if (speakers > SPK_STEREO)
-                {
-                    if (speakers == SPK_SURROUND_5_1)
-                    {
-                        *dest = *dest + (((GET_IP_SAMPLE_LEFT() * vol) + GET_IP_SAMPLE_RIGHT() * vol) / 256) / 2;
-                        ++dest; // FC
-                        *dest = *dest + (((GET_IP_SAMPLE_LEFT() * vol) + GET_IP_SAMPLE_RIGHT() * vol) / 256) / 2;
-                        ++dest; // LFE
-                    }
-
-                    *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256; // RL
-                    ++dest;
-                    *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256; // RR
-                    ++dest;
-                }
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = (signed char*)pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256; // FL
-                ++dest;
-                *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256; // FR
-                ++dest;
-                if (speakers > SPK_STEREO)
-                {
-                    if (speakers == SPK_SURROUND_5_1)
-                    {
-                        ++dest; // FC
-                        ++dest; // LFE
-                    }
-
-                    *dest = *dest + (GET_IP_SAMPLE_LEFT() * vol) / 256; // RL
-                    ++dest;
-                    *dest = *dest + (GET_IP_SAMPLE_RIGHT() * vol) / 256; // RR
-                    ++dest;
-                }
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = (signed char*)pos;
-        }
-    }
-    else
-    {
-        signed char* pos = (signed char*)position_;
-        signed char* end = sound->GetEnd();
-        signed char* repeat = sound->GetRepeat();
-
-        if (sound->IsLooped())
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE_LEFT() * vol; // FL
-                ++dest;
-                *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol; // FR
-                ++dest;
-                if (speakers > SPK_STEREO)
-                {
-                    if (speakers == SPK_SURROUND_5_1)
-                    {
-                        ++dest; // FC
-                        ++dest; // LFE
-                    }
-
-                    *dest = *dest + GET_IP_SAMPLE_LEFT() * vol; // RL
-                    ++dest;
-                    *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol; // RR
-                    ++dest;
-                }
-                INC_POS_STEREO_LOOPED();
-            }
-            position_ = pos;
-        }
-        else
-        {
-            while (samples--)
-            {
-                *dest = *dest + GET_IP_SAMPLE_LEFT() * vol; // FL
-                ++dest;
-                *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol; // FR
-                ++dest;
-                if (speakers > SPK_STEREO)
-                {
-                    if (speakers == SPK_SURROUND_5_1)
-                    {
-                        ++dest; // FC
-                        ++dest; // LFE
-                    }
-
-                    *dest = *dest + GET_IP_SAMPLE_LEFT() * vol; // RL
-                    ++dest;
-                    *dest = *dest + GET_IP_SAMPLE_RIGHT() * vol; // RR
-                    ++dest;
-                }
-                INC_POS_STEREO_ONESHOT();
-            }
-            position_ = pos;
+            numSamples = ReadSoundSamples<signed char, 1>(pos, fractPos, end, repeat, isLooped, channels, samples,
+                intAdd, fractAdd, interpolation, SAMPLE_SCALE_8BIT);
         }
+        position_ = (signed char*)pos;
     }
 
     fractPosition_ = fractPos;
+    return numSamples;
 }
 
 void SoundSource::MixZeroVolume(Sound* sound, unsigned samples, int mixRate, float effectiveFrequency)
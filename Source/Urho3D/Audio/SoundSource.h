@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Audio/AudioDefs.h"
+#include "../Audio/AudioMixing.h"
 #include "../Scene/Component.h"
 
 namespace Urho3D
@@ -140,11 +141,20 @@ public:
     /// Return whether is playing.
     /// @property
     bool IsPlaying() const;
+    /// Return whether the sound source is virtual, i.e. play position is advanced without mixing.
+    bool IsVirtual() const { return virtual_; }
+    /// Return effective gain used to prioritize sound sources.
+    float GetAudibility() const { return masterGain_ * attenuation_ * gain_; }
+    /// Return effective time scale, or 0 if the scene is not set or paused. Paused sound sources are not mixed.
+    float GetEffectiveTimeScale() const;
 
     /// Update the sound source. Perform subclass specific operations. Called by Audio.
     virtual void Update(float timeStep);
-    /// Mix sound source output to a 32-bit clipping buffer. Called by Audio.
-    void Mix(int dest[], unsigned samples, int mixRate, SpeakerMode mode, bool interpolation);
+    /// Mix sound source output to the float mix buffer. Source buffer is used as scratch space for resampled sound data. Called by Audio.
+    void Mix(AudioMixBuffer& dest, AudioMixBuffer& sourceBuffer, unsigned samples, int mixRate, SpeakerMode mode,
+        bool interpolation);
+    /// Set whether the sound source is virtual. Called by Audio.
+    void SetVirtual(bool isVirtual) { virtual_ = isVirtual; }
     /// Update the effective master gain. Called internally and by Audio when the master gain changes.
     void UpdateMasterGain();
 
@@ -186,50 +196,23 @@ protected:
     AutoRemoveMode autoRemove_;
 
 private:
-    /// Play a sound without locking the audio mutex. Called internally.
-    void PlayLockless(Sound* sound);
+    /// Play a sound without locking the audio mutex. Decoder stream of compressed sound is created if not provided. Called internally.
+    void PlayLockless(Sound* sound, SoundStream* decoderStream = nullptr);
     /// Play a sound stream without locking the audio mutex. Called internally.
     void PlayLockless(const SharedPtr<SoundStream>& stream);
     /// Stop sound without locking the audio mutex. Called internally.
     void StopLockless();
     /// Set new playback position without locking the audio mutex. Called internally.
     void SetPlayPositionLockless(signed char* pos);
-    /// Mix mono sample to mono buffer.
-    void MixMonoToMono(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency,
-        int channel = 0, int channelCount = 1);
-    /// Mix mono sample to stereo buffer.
-    void MixMonoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency);
-    /// Mix mono sample to mono buffer interpolated.
-    void MixMonoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency,
-        int channel = 0, int channelCount = 1);
-    /// Mix mono sample to stereo buffer interpolated.
-    void MixMonoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency);
-    /// Mix stereo sample to mono buffer.
-    void MixStereoToMono(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency);
-    /// Mix stereo sample to stereo buffer.
-    void MixStereoToStereo(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency);
-    /// Mix stereo sample to mono buffer interpolated.
-    void MixStereoToMonoIP(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency);
-    /// Mix stereo sample to stereo buffer interpolated.
-    void MixStereoToStereoIP(Sound* sound, int dest[], unsigned samples, int mixRate, float effectiveFrequency);
-    /// Mix a mono track to surround buffer.
-    void MixMonoToSurround(
-        Sound* sound, int* dest, unsigned samples, int mixRate, float effectiveFrequency, SpeakerMode speakers);
-    /// Mix a mono track into a surround buffer.
-    void MixMonoToSurroundIP(
-        Sound* sound, int* dest, unsigned samples, int mixRate, float effectiveFrequency, SpeakerMode speakers);
-    /// Mix stereo sample into multichannel. Front-center and LFE are ommitted.
-    void MixStereoToMulti(
-        Sound* sound, int* dest, unsigned samples, int mixRate, float effectiveFrequency, SpeakerMode speakers);
-    /// Mix stereo sample into multichannel. Front-center and LFE are ommitted.
-    void MixStereoToMultiIP(
-        Sound* sound, int* dest, unsigned samples, int mixRate, float effectiveFrequency, SpeakerMode speakers);
+    /// Calculate gains from each sound channel to each output channel.
+    void CalculateChannelGains(float gains[][2], bool isStereo, SpeakerMode mode) const;
+    /// Resample sound data into float buffer and advance playback pointer. Return number of samples read.
+    unsigned ReadSamples(
+        Sound* sound, AudioMixBuffer& dest, unsigned samples, int mixRate, float effectiveFrequency, bool interpolation);
     /// Advance playback pointer without producing audible output.
     void MixZeroVolume(Sound* sound, unsigned samples, int mixRate, float effectiveFrequency);
     /// Advance playback pointer to simulate audio playback in headless mode.
     void MixNull(float timeStep, float effectiveFrequency);
-    /// Get effective time scale or 0.0 if scene is not set or paused.
-    float GetEffectiveTimeScale() const;
 
     /// Sound that is being played.
     SharedPtr<Sound> sound_;
@@ -245,6 +228,12 @@ private:
     SharedPtr<Sound> streamBuffer_;
     /// Unused stream bytes from previous frame.
     int unusedStreamSize_;
+    /// Gains from each sound channel to each output channel used in previous mix.
+    float channelGains_[MAX_AUDIO_CHANNELS][2]{};
+    /// Whether previous gains are valid and should be ramped from.
+    bool channelGainsValid_{};
+    /// Whether the sound source is virtual.
+    bool virtual_{};
     /// Ignore scene time scale and play sound even if scene is paused.
     bool ignoreSceneTimeScale_{false};
 };
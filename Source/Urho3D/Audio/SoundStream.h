@@ -41,6 +41,8 @@ public:
 
     /// Produce sound data into destination. Return number of bytes produced. Called by SoundSource from the mixing thread.
     virtual unsigned GetData(signed char* dest, unsigned numBytes) = 0;
+    /// Return whether producing data is expensive and the stream should be decoded ahead of playback on a background thread.
+    virtual bool IsPrefetchable() const { return false; }
 
     /// Set sound data format.
     void SetFormat(unsigned frequency, bool sixteenBit, bool stereo);
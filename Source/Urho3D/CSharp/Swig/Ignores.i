@@ -36,6 +36,15 @@
 %ignore Urho3D::RmlUIComponent::FromDocument;
 // %ignore Urho3D::Scene::Load;
 %ignore Urho3D::ServerReplicator::GetSetting;
+%ignore Urho3D::ServerReplicator::SetSetting;
+%ignore Urho3D::TransformQuantizer::WritePosition;
+%ignore Urho3D::TransformQuantizer::ReadPosition;
+%ignore Urho3D::TransformQuantizer::WriteVelocity;
+%ignore Urho3D::TransformQuantizer::ReadVelocity;
+%ignore Urho3D::TransformQuantizer::WriteRotation;
+%ignore Urho3D::TransformQuantizer::ReadRotation;
+%ignore Urho3D::TransformQuantizer::WriteAngularVelocity;
+%ignore Urho3D::TransformQuantizer::ReadAngularVelocity;
 %ignore Urho3D::UIBatchStateCacheCallback::CreateUIBatchPipelineState;
 %ignore Urho3D::XMLFile::SaveObjectCallback;
 %ignore Urho3D::XMLFile::LoadObjectCallback;
@@ -564,6 +564,7 @@ public:
 %ignore Urho3D::BufferedSoundStream::AddData(const ea::shared_array<signed char>& data, unsigned numBytes);
 %ignore Urho3D::BufferedSoundStream::AddData(const ea::shared_array<signed short>& data, unsigned numBytes);
 %ignore Urho3D::Sound::GetData;
+%ignore Urho3D::SoundSource::Mix;
 
 %include "generated/Urho3D/_pre_audio.i"
 %include "Urho3D/Audio/AudioDefs.h"
@@ -830,6 +831,7 @@ public:
 %include "Urho3D/Replica/NetworkId.h"
 %include "Urho3D/Replica/PredictedKinematicController.h"
 %include "Urho3D/Replica/ReplicatedAnimation.h"
+%include "Urho3D/Replica/TransformQuantizer.h"
 %include "Urho3D/Replica/ReplicatedTransform.h"
 %include "Urho3D/Replica/ServerReplicator.h"
 %include "Urho3D/Replica/TickSynchronizer.h"
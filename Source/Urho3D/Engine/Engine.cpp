@@ -526,6 +526,7 @@ bool Engine::Initialize(const StringVariantMap& applicationParameters, const Str
             graphics->Maximize();
 
         graphics->InitializePipelineStateCache(FileIdentifier::FromUri(GetParameter(EP_PSO_CACHE).GetString()));
+        graphics->WarmupShaders(FileIdentifier::FromUri(GetParameter(EP_SHADER_WARMUP_LIST).GetString()));
 
         renderer->SetTextureQuality((MaterialQuality)GetParameter(EP_TEXTURE_QUALITY).GetInt());
         renderer->SetTextureFilterMode((TextureFilterMode)GetParameter(EP_TEXTURE_FILTER_MODE).GetInt());
@@ -1324,6 +1325,7 @@ void Engine::PopulateDefaultParameters()
     engineParameters_->DefineVariable(EP_WINDOW_WIDTH, 0); //.Overridable();
     engineParameters_->DefineVariable(EP_WORKER_THREADS, true);
     engineParameters_->DefineVariable(EP_PSO_CACHE, "conf://psocache.bin");
+    engineParameters_->DefineVariable(EP_SHADER_WARMUP_LIST, EMPTY_STRING);
     engineParameters_->DefineVariable(EP_RENDER_BACKEND).SetOptional<int>();
     engineParameters_->DefineVariable(EP_XR, defaultXR);
 }
@@ -1352,6 +1354,7 @@ void Engine::DoExit()
     if (graphics)
     {
         graphics->SavePipelineStateCache(FileIdentifier::FromUri(GetParameter(EP_PSO_CACHE).GetString()));
+        graphics->SaveShaderWarmupList(FileIdentifier::FromUri(GetParameter(EP_SHADER_WARMUP_LIST).GetString()));
         graphics->Close();
     }
 
@@ -91,6 +91,7 @@ URHO3D_GLOBAL_CONSTANT(ConstString EP_WINDOW_TITLE{"WindowTitle"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_WINDOW_WIDTH{"WindowWidth"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_WORKER_THREADS{"WorkerThreads"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_PSO_CACHE{"PsoCacheDir"});
+URHO3D_GLOBAL_CONSTANT(ConstString EP_SHADER_WARMUP_LIST{"ShaderWarmupList"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_RENDER_BACKEND{"RenderBackend"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_RENDER_ADAPTER_ID{"RenderAdapterId"});
 URHO3D_GLOBAL_CONSTANT(ConstString EP_XR{"XR"});
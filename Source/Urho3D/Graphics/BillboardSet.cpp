@@ -107,6 +107,9 @@ BillboardSet::BillboardSet(Context* context) :
     batches_[0].geometry_ = geometry_;
     batches_[0].geometryType_ = GEOM_BILLBOARD;
     batches_[0].worldTransform_ = &transforms_[0];
+
+    // Bounding box depends on camera in fixed screen size mode
+    volatileBoundingBox_ = true;
 }
 
 BillboardSet::~BillboardSet() = default;
@@ -199,6 +199,8 @@ void Drawable::SetLodBias(float bias)
 void Drawable::SetViewMask(unsigned mask)
 {
     viewMask_ = mask;
+    if (octant_)
+        octant_->UpdateDrawableBounds(this);
 }
 
 void Drawable::SetLightMask(unsigned mask)
@@ -290,6 +290,9 @@ public:
     /// @property
     const BoundingBox& GetWorldBoundingBox();
 
+    /// Return whether world-space bounding box may change outside of octree update.
+    bool HasVolatileBoundingBox() const { return volatileBoundingBox_; }
+
     /// Return drawable flags.
     DrawableFlags GetDrawableFlags() const { return drawableFlags_; }
 
@@ -453,10 +456,15 @@ protected:
     bool occludee_;
     /// Octree update queued flag.
     bool updateQueued_;
+    /// Whether the world bounding box may change outside of octree update, e.g. when the drawable faces the camera.
+    /// Copy of the bounding box kept by the octree is not used for culling such drawables.
+    bool volatileBoundingBox_{};
     /// Zone inconclusive or dirtied flag.
     bool zoneDirty_;
     /// Octree octant.
     Octant* octant_;
+    /// Index in the drawable list of the octant, maintained by the octant.
+    unsigned octantIndex_{};
     /// Index of Drawable in Scene. May be updated.
     unsigned drawableIndex_{ M_MAX_UNSIGNED };
     /// Current zone.
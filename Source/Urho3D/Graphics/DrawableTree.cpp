@@ -0,0 +1,501 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Graphics/DrawableTree.h"
+
+#include "../Graphics/DebugRenderer.h"
+#include "../Graphics/Drawable.h"
+#include "../Graphics/OctreeQuery.h"
+
+#include <EASTL/fixed_vector.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Traversal stack. Tree is balanced, so the stack rarely needs heap allocation.
+template <class T> using TraversalStack = ea::fixed_vector<T, 64>;
+
+BoundingBox MergeBoxes(const BoundingBox& lhs, const BoundingBox& rhs)
+{
+    BoundingBox result = lhs;
+    result.Merge(rhs);
+    return result;
+}
+
+float GetSurfaceArea(const BoundingBox& box)
+{
+    const Vector3 size = box.Size();
+    return 2.0f * (size.x_ * size.y_ + size.y_ * size.z_ + size.z_ * size.x_);
+}
+
+/// Collects drawables into batches and forwards them to TestDrawables.
+class DrawableTreeBatchCollector
+{
+public:
+    explicit DrawableTreeBatchCollector(OctreeQuery& query) : query_(query) {}
+    ~DrawableTreeBatchCollector()
+    {
+        Flush(false);
+        Flush(true);
+    }
+
+    void Add(Drawable* drawable, bool inside)
+    {
+        unsigned& size = batchSizes_[inside];
+        batches_[inside][size++] = drawable;
+        if (size == MaxBatchSize)
+            Flush(inside);
+    }
+
+    void Flush(bool inside)
+    {
+        unsigned& size = batchSizes_[inside];
+        if (size > 0)
+        {
+            query_.TestDrawables(batches_[inside], batches_[inside] + size, inside);
+            size = 0;
+        }
+    }
+
+private:
+    static constexpr unsigned MaxBatchSize = 64;
+
+    OctreeQuery& query_;
+    Drawable* batches_[2][MaxBatchSize];
+    unsigned batchSizes_[2]{};
+};
+
+}
+
+unsigned DrawableTree::AddDrawable(Drawable* drawable, const BoundingBox& box)
+{
+    const unsigned leaf = AllocateNode();
+    TreeNode& node = nodes_[leaf];
+    node.box_ = GetEnlargedBox(box);
+    node.drawable_ = drawable;
+    node.height_ = 0;
+
+    InsertLeaf(leaf);
+    ++numDrawables_;
+    return leaf;
+}
+
+void DrawableTree::RemoveDrawable(unsigned leaf)
+{
+    assert(leaf < nodes_.size() && nodes_[leaf].IsLeaf());
+
+    RemoveLeaf(leaf);
+    FreeNode(leaf);
+    --numDrawables_;
+}
+
+unsigned DrawableTree::MoveDrawable(unsigned leaf, const BoundingBox& box)
+{
+    assert(leaf < nodes_.size() && nodes_[leaf].IsLeaf());
+
+    RemoveLeaf(leaf);
+    nodes_[leaf].box_ = GetEnlargedBox(box);
+    InsertLeaf(leaf);
+    return leaf;
+}
+
+bool DrawableTree::IsMoveNeeded(unsigned leaf, const BoundingBox& box) const
+{
+    const BoundingBox& leafBox = nodes_[leaf].box_;
+    const BoundingBox enlargedBox = GetEnlargedBox(box);
+    const BoundingBox& tightBox = box.Defined() ? box : enlargedBox;
+    if (leafBox.IsInside(tightBox) != INSIDE)
+        return true;
+
+    // Reinsert if the leaf box is too loose, e.g. the drawable has shrunk
+    const Vector3 maxMargin = Vector3::ONE * (3.0f * margin_);
+    const BoundingBox maxLeafBox{enlargedBox.min_ - maxMargin, enlargedBox.max_ + maxMargin};
+    return maxLeafBox.IsInside(leafBox) != INSIDE;
+}
+
+void DrawableTree::Clear()
+{
+    nodes_.clear();
+    root_ = InvalidNode;
+    freeList_ = InvalidNode;
+    numDrawables_ = 0;
+}
+
+void DrawableTree::GetDrawables(OctreeQuery& query) const
+{
+    if (root_ == InvalidNode)
+        return;
+
+    DrawableTreeBatchCollector collector(query);
+    TraversalStack<ea::pair<unsigned, bool>> stack;
+    stack.emplace_back(root_, false);
+    while (!stack.empty())
+    {
+        auto [index, inside] = stack.back();
+        stack.pop_back();
+
+        const TreeNode& node = nodes_[index];
+        const Intersection res = query.TestOctant(node.box_, inside);
+        if (res == OUTSIDE)
+            continue;
+        inside = res == INSIDE;
+
+        if (node.IsLeaf())
+            collector.Add(node.drawable_, inside);
+        else
+        {
+            stack.emplace_back(node.child2_, inside);
+            stack.emplace_back(node.child1_, inside);
+        }
+    }
+}
+
+void DrawableTree::Raycast(RayOctreeQuery& query) const
+{
+    if (root_ == InvalidNode)
+        return;
+
+    TraversalStack<unsigned> stack;
+    stack.push_back(root_);
+    while (!stack.empty())
+    {
+        const TreeNode& node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (query.ray_.HitDistance(node.box_) >= query.maxDistance_)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            Drawable* drawable = node.drawable_;
+            if ((drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_))
+                drawable->ProcessRayQuery(query, query.result_);
+        }
+        else
+        {
+            stack.push_back(node.child2_);
+            stack.push_back(node.child1_);
+        }
+    }
+}
+
+void DrawableTree::GetRayDrawables(RayOctreeQuery& query, ea::vector<Drawable*>& drawables) const
+{
+    if (root_ == InvalidNode)
+        return;
+
+    TraversalStack<unsigned> stack;
+    stack.push_back(root_);
+    while (!stack.empty())
+    {
+        const TreeNode& node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (query.ray_.HitDistance(node.box_) >= query.maxDistance_)
+            continue;
+
+        if (node.IsLeaf())
+        {
+            Drawable* drawable = node.drawable_;
+            if ((drawable->GetDrawableFlags() & query.drawableFlags_) && (drawable->GetViewMask() & query.viewMask_))
+                drawables.push_back(drawable);
+        }
+        else
+        {
+            stack.push_back(node.child2_);
+            stack.push_back(node.child1_);
+        }
+    }
+}
+
+void DrawableTree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const
+{
+    if (!debug || root_ == InvalidNode)
+        return;
+
+    TraversalStack<unsigned> stack;
+    stack.push_back(root_);
+    while (!stack.empty())
+    {
+        const TreeNode& node = nodes_[stack.back()];
+        stack.pop_back();
+
+        if (!debug->IsInside(node.box_))
+            continue;
+
+        if (node.IsLeaf())
+            debug->AddBoundingBox(node.box_, Color(0.25f, 0.5f, 0.25f), depthTest);
+        else
+        {
+            debug->AddBoundingBox(node.box_, Color(0.25f, 0.25f, 0.25f), depthTest);
+            stack.push_back(node.child2_);
+            stack.push_back(node.child1_);
+        }
+    }
+}
+
+unsigned DrawableTree::AllocateNode()
+{
+    if (freeList_ == InvalidNode)
+    {
+        nodes_.emplace_back();
+        return nodes_.size() - 1;
+    }
+
+    const unsigned index = freeList_;
+    freeList_ = nodes_[index].parent_;
+    nodes_[index] = TreeNode{};
+    return index;
+}
+
+void DrawableTree::FreeNode(unsigned node)
+{
+    nodes_[node] = TreeNode{};
+    nodes_[node].parent_ = freeList_;
+    freeList_ = node;
+}
+
+void DrawableTree::InsertLeaf(unsigned leaf)
+{
+    if (root_ == InvalidNode)
+    {
+        root_ = leaf;
+        nodes_[leaf].parent_ = InvalidNode;
+        return;
+    }
+
+    // Find the best sibling using surface area heuristic
+    const BoundingBox leafBox = nodes_[leaf].box_;
+    unsigned index = root_;
+    while (!nodes_[index].IsLeaf())
+    {
+        const TreeNode& node = nodes_[index];
+        const float area = GetSurfaceArea(node.box_);
+        const float combinedArea = GetSurfaceArea(MergeBoxes(node.box_, leafBox));
+
+        // Cost of creating a new parent for this node and the new leaf
+        const float cost = 2.0f * combinedArea;
+        // Minimum cost of pushing the leaf further down the tree
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        const auto getDescentCost = [&](unsigned childIndex)
+        {
+            const TreeNode& child = nodes_[childIndex];
+            const float mergedArea = GetSurfaceArea(MergeBoxes(child.box_, leafBox));
+            return child.IsLeaf()
+                ? mergedArea + inheritanceCost
+                : mergedArea - GetSurfaceArea(child.box_) + inheritanceCost;
+        };
+
+        const float cost1 = getDescentCost(node.child1_);
+        const float cost2 = getDescentCost(node.child2_);
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? node.child1_ : node.child2_;
+    }
+
+    // Create a new parent for the sibling and the leaf
+    const unsigned sibling = index;
+    const unsigned oldParent = nodes_[sibling].parent_;
+    const unsigned newParent = AllocateNode();
+
+    TreeNode& parentNode = nodes_[newParent];
+    parentNode.parent_ = oldParent;
+    parentNode.box_ = MergeBoxes(leafBox, nodes_[sibling].box_);
+    parentNode.height_ = nodes_[sibling].height_ + 1;
+    parentNode.child1_ = sibling;
+    parentNode.child2_ = leaf;
+
+    ReplaceChild(oldParent, sibling, newParent);
+    nodes_[sibling].parent_ = newParent;
+    nodes_[leaf].parent_ = newParent;
+
+    RefitAncestors(newParent);
+}
+
+void DrawableTree::RemoveLeaf(unsigned leaf)
+{
+    if (leaf == root_)
+    {
+        root_ = InvalidNode;
+        return;
+    }
+
+    const unsigned parent = nodes_[leaf].parent_;
+    const unsigned grandParent = nodes_[parent].parent_;
+    const unsigned sibling = nodes_[parent].child1_ == leaf ? nodes_[parent].child2_ : nodes_[parent].child1_;
+
+    // Replace parent with sibling
+    ReplaceChild(grandParent, parent, sibling);
+    nodes_[sibling].parent_ = grandParent;
+    FreeNode(parent);
+
+    nodes_[leaf].parent_ = InvalidNode;
+    if (grandParent != InvalidNode)
+        RefitAncestors(grandParent);
+}
+
+void DrawableTree::RefitAncestors(unsigned node)
+{
+    unsigned index = node;
+    while (index != InvalidNode)
+    {
+        index = Balance(index);
+
+        TreeNode& current = nodes_[index];
+        const TreeNode& child1 = nodes_[current.child1_];
+        const TreeNode& child2 = nodes_[current.child2_];
+        current.height_ = 1 + ea::max(child1.height_, child2.height_);
+        current.box_ = MergeBoxes(child1.box_, child2.box_);
+
+        index = current.parent_;
+    }
+}
+
+unsigned DrawableTree::Balance(unsigned indexA)
+{
+    TreeNode& nodeA = nodes_[indexA];
+    if (nodeA.IsLeaf() || nodeA.height_ < 2)
+        return indexA;
+
+    const unsigned indexB = nodeA.child1_;
+    const unsigned indexC = nodeA.child2_;
+    TreeNode& nodeB = nodes_[indexB];
+    TreeNode& nodeC = nodes_[indexC];
+
+    const int balance = static_cast<int>(nodeC.height_) - static_cast<int>(nodeB.height_);
+
+    // Rotate C up
+    if (balance > 1)
+    {
+        const unsigned indexF = nodeC.child1_;
+        const unsigned indexG = nodeC.child2_;
+        TreeNode& nodeF = nodes_[indexF];
+        TreeNode& nodeG = nodes_[indexG];
+
+        // Swap A and C
+        nodeC.child1_ = indexA;
+        nodeC.parent_ = nodeA.parent_;
+        nodeA.parent_ = indexC;
+        ReplaceChild(nodeC.parent_, indexA, indexC);
+
+        // Move the lower child of C to A
+        if (nodeF.height_ > nodeG.height_)
+        {
+            nodeC.child2_ = indexF;
+            nodeA.child2_ = indexG;
+            nodeG.parent_ = indexA;
+            nodeA.box_ = MergeBoxes(nodeB.box_, nodeG.box_);
+            nodeC.box_ = MergeBoxes(nodeA.box_, nodeF.box_);
+            nodeA.height_ = 1 + ea::max(nodeB.height_, nodeG.height_);
+            nodeC.height_ = 1 + ea::max(nodeA.height_, nodeF.height_);
+        }
+        else
+        {
+            nodeC.child2_ = indexG;
+            nodeA.child2_ = indexF;
+            nodeF.parent_ = indexA;
+            nodeA.box_ = MergeBoxes(nodeB.box_, nodeF.box_);
+            nodeC.box_ = MergeBoxes(nodeA.box_, nodeG.box_);
+            nodeA.height_ = 1 + ea::max(nodeB.height_, nodeF.height_);
+            nodeC.height_ = 1 + ea::max(nodeA.height_, nodeG.height_);
+        }
+
+        return indexC;
+    }
+
+    // Rotate B up
+    if (balance < -1)
+    {
+        const unsigned indexD = nodeB.child1_;
+        const unsigned indexE = nodeB.child2_;
+        TreeNode& nodeD = nodes_[indexD];
+        TreeNode& nodeE = nodes_[indexE];
+
+        // Swap A and B
+        nodeB.child1_ = indexA;
+        nodeB.parent_ = nodeA.parent_;
+        nodeA.parent_ = indexB;
+        ReplaceChild(nodeB.parent_, indexA, indexB);
+
+        // Move the lower child of B to A
+        if (nodeD.height_ > nodeE.height_)
+        {
+            nodeB.child2_ = indexD;
+            nodeA.child1_ = indexE;
+            nodeE.parent_ = indexA;
+            nodeA.box_ = MergeBoxes(nodeC.box_, nodeE.box_);
+            nodeB.box_ = MergeBoxes(nodeA.box_, nodeD.box_);
+            nodeA.height_ = 1 + ea::max(nodeC.height_, nodeE.height_);
+            nodeB.height_ = 1 + ea::max(nodeA.height_, nodeD.height_);
+        }
+        else
+        {
+            nodeB.child2_ = indexE;
+            nodeA.child1_ = indexD;
+            nodeD.parent_ = indexA;
+            nodeA.box_ = MergeBoxes(nodeC.box_, nodeD.box_);
+            nodeB.box_ = MergeBoxes(nodeA.box_, nodeE.box_);
+            nodeA.height_ = 1 + ea::max(nodeC.height_, nodeD.height_);
+            nodeB.height_ = 1 + ea::max(nodeA.height_, nodeE.height_);
+        }
+
+        return indexB;
+    }
+
+    return indexA;
+}
+
+void DrawableTree::ReplaceChild(unsigned parent, unsigned oldChild, unsigned newChild)
+{
+    if (parent == InvalidNode)
+    {
+        root_ = newChild;
+        return;
+    }
+
+    TreeNode& parentNode = nodes_[parent];
+    if (parentNode.child1_ == oldChild)
+        parentNode.child1_ = newChild;
+    else
+        parentNode.child2_ = newChild;
+}
+
+BoundingBox DrawableTree::GetEnlargedBox(const BoundingBox& box) const
+{
+    // Undefined box is treated as unbounded, finite values keep surface area heuristic well-defined
+    if (!box.Defined())
+        return BoundingBox(-M_LARGE_VALUE, M_LARGE_VALUE);
+
+    const Vector3 margin = Vector3::ONE * margin_;
+    return BoundingBox(box.min_ - margin, box.max_ + margin);
+}
+
+}
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Math/BoundingBox.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class DebugRenderer;
+class Drawable;
+class OctreeQuery;
+class RayOctreeQuery;
+
+/// Dynamic bounding volume hierarchy of drawables. Leaves store enlarged bounding boxes,
+/// so drawables moving within the margin don't need reinsertion.
+/// Used by Octree as alternative spatial index.
+/// @nobind
+class URHO3D_API DrawableTree
+{
+public:
+    /// Index of invalid node.
+    static constexpr unsigned InvalidNode = M_MAX_UNSIGNED;
+    /// Default margin of leaf bounding boxes.
+    static constexpr float DefaultMargin = 0.2f;
+
+    /// Add drawable with given bounding box. Return leaf index.
+    unsigned AddDrawable(Drawable* drawable, const BoundingBox& box);
+    /// Remove drawable by leaf index.
+    void RemoveDrawable(unsigned leaf);
+    /// Update bounding box of the drawable. Return new leaf index.
+    unsigned MoveDrawable(unsigned leaf, const BoundingBox& box);
+    /// Return whether the drawable should be moved, i.e. the box left enlarged leaf box or the leaf box is too large.
+    /// Tree is not modified, so it is safe to call from multiple threads.
+    bool IsMoveNeeded(unsigned leaf, const BoundingBox& box) const;
+    /// Remove all drawables.
+    void Clear();
+
+    /// Set margin of leaf bounding boxes. Applied to drawables added or moved later.
+    void SetMargin(float margin) { margin_ = ea::max(0.0f, margin); }
+    /// Return margin of leaf bounding boxes.
+    float GetMargin() const { return margin_; }
+
+    /// Return drawable objects by a query.
+    void GetDrawables(OctreeQuery& query) const;
+    /// Return drawable objects by a ray query.
+    void Raycast(RayOctreeQuery& query) const;
+    /// Return drawable objects whose leaf boxes are hit by a ray, without testing the drawables themselves.
+    void GetRayDrawables(RayOctreeQuery& query, ea::vector<Drawable*>& drawables) const;
+
+    /// Draw bounds of tree nodes to the debug graphics.
+    void DrawDebugGeometry(DebugRenderer* debug, bool depthTest) const;
+
+    /// Return number of drawables.
+    unsigned GetNumDrawables() const { return numDrawables_; }
+    /// Return height of the tree. Empty tree and tree with single leaf both have zero height.
+    unsigned GetHeight() const { return root_ != InvalidNode ? nodes_[root_].height_ : 0; }
+    /// Return enlarged bounding box of the leaf.
+    const BoundingBox& GetLeafBoundingBox(unsigned leaf) const { return nodes_[leaf].box_; }
+
+private:
+    /// Tree node.
+    struct TreeNode
+    {
+        /// Return whether the node is leaf.
+        bool IsLeaf() const { return child1_ == InvalidNode; }
+
+        /// Bounding box of the node, enlarged for leaves.
+        BoundingBox box_;
+        /// Drawable for leaves.
+        Drawable* drawable_{};
+        /// Parent node, or next free node for free nodes.
+        unsigned parent_{InvalidNode};
+        /// First child node.
+        unsigned child1_{InvalidNode};
+        /// Second child node.
+        unsigned child2_{InvalidNode};
+        /// Height of the subtree, zero for leaves.
+        unsigned height_{};
+    };
+
+    /// Allocate node.
+    unsigned AllocateNode();
+    /// Free node.
+    void FreeNode(unsigned node);
+    /// Insert leaf into the tree.
+    void InsertLeaf(unsigned leaf);
+    /// Remove leaf from the tree.
+    void RemoveLeaf(unsigned leaf);
+    /// Rebalance and refit nodes starting from the given one up to the root.
+    void RefitAncestors(unsigned node);
+    /// Perform rotation of the subtree if it is unbalanced. Return new subtree root.
+    unsigned Balance(unsigned node);
+    /// Replace child of the node, or root if parent is invalid.
+    void ReplaceChild(unsigned parent, unsigned oldChild, unsigned newChild);
+    /// Return enlarged bounding box for the drawable.
+    BoundingBox GetEnlargedBox(const BoundingBox& box) const;
+
+    /// Nodes.
+    ea::vector<TreeNode> nodes_;
+    /// Root node.
+    unsigned root_{InvalidNode};
+    /// First free node.
+    unsigned freeList_{InvalidNode};
+    /// Number of drawables.
+    unsigned numDrawables_{};
+    /// Margin of leaf bounding boxes.
+    float margin_{DefaultMargin};
+};
+
+}
@@ -24,6 +24,7 @@
 
 #include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationController.h"
@@ -67,6 +68,7 @@
 #include "Urho3D/RenderAPI/RenderAPIUtils.h"
 #include "Urho3D/RenderAPI/RenderContext.h"
 #include "Urho3D/RenderAPI/RenderDevice.h"
+#include "Urho3D/Resource/JSONFile.h"
 #include "Urho3D/Resource/ResourceCache.h"
 
 #include <SDL.h>
@@ -359,6 +361,101 @@ void Graphics::SavePipelineStateCache(const FileIdentifier& fileName)
         file->Write(cachedData.data(), cachedData.size());
 }
 
+void Graphics::RecordShaderVariation(const ShaderVariationDesc& desc)
+{
+    if (recordedShaderVariationsSet_.insert(desc).second)
+        recordedShaderVariations_.push_back(desc);
+}
+
+void Graphics::SaveShaderWarmupList(const FileIdentifier& fileName) const
+{
+    if (!fileName)
+        return;
+
+    auto jsonFile = MakeShared<JSONFile>(context_);
+    if (!jsonFile->SaveObject("shaders", recordedShaderVariations_))
+        return;
+
+    jsonFile->SaveFile(fileName);
+}
+
+void Graphics::WarmupShaders(const FileIdentifier& fileName)
+{
+    auto vfs = GetSubsystem<VirtualFileSystem>();
+    if (!fileName || !vfs->Exists(fileName))
+        return;
+
+    auto jsonFile = MakeShared<JSONFile>(context_);
+    ea::vector<ShaderVariationDesc> shaders;
+    if (!jsonFile->LoadFile(fileName) || !jsonFile->LoadObject("shaders", shaders))
+    {
+        URHO3D_LOGERROR("Failed to load shader warmup list '{}'", fileName.ToUri());
+        return;
+    }
+
+    WarmupShaders(shaders);
+}
+
+void Graphics::WarmupShaders(ea::span<const ShaderVariationDesc> shaders)
+{
+    URHO3D_PROFILE("WarmupShaders");
+
+    auto cache = GetSubsystem<ResourceCache>();
+    auto vfs = GetSubsystem<VirtualFileSystem>();
+    auto workQueue = GetSubsystem<WorkQueue>();
+    const ShaderVariationCompiler compiler = GetShaderVariationCompiler();
+
+    struct CompileTask
+    {
+        const ShaderVariationDesc* desc_{};
+        ea::string sourceCode_;
+        FileIdentifier binaryShaderName_;
+    };
+
+    // Resources are loaded in main thread, bytecode is compiled in worker threads and stored in the cache
+    ea::vector<CompileTask> tasks;
+    if (settings_.cacheShaders_ && GetPlatform() != PlatformId::Web)
+    {
+        for (const ShaderVariationDesc& desc : shaders)
+        {
+            auto shader = cache->GetResource<Shader>(desc.shaderName_);
+            if (!shader)
+                continue;
+
+            ea::string sourceCode = compiler.PrepareSource(desc.type_, desc.defines_, shader->GetSourceCode());
+            const unsigned long long contentHash = compiler.GetContentHash(sourceCode);
+            const FileIdentifier binaryShaderName = settings_.shaderCacheDir_
+                + compiler.GetCachedFileName(shader->GetShaderName(), desc.type_, contentHash, "bytecode");
+            if (!vfs->Exists(binaryShaderName))
+                tasks.push_back(CompileTask{&desc, ea::move(sourceCode), binaryShaderName});
+        }
+    }
+
+    ForEachParallel(workQueue, tasks,
+        [&](unsigned /*index*/, const CompileTask& task)
+    {
+        const ShaderVariationDesc& desc = *task.desc_;
+        const ea::string debugName = Format("{}({})", desc.shaderName_, desc.defines_);
+
+        ShaderBytecode bytecode;
+        ea::string translatedSource;
+        if (!compiler.Compile(bytecode, translatedSource, desc.type_, task.sourceCode_, debugName))
+            return;
+
+        if (const AbstractFilePtr file = vfs->OpenFile(task.binaryShaderName_, FILE_WRITE))
+            bytecode.SaveToFile(*file);
+    });
+
+    // Create variations, cached bytecode is used where available
+    for (const ShaderVariationDesc& desc : shaders)
+    {
+        if (auto shader = cache->GetResource<Shader>(desc.shaderName_))
+            shader->GetVariation(desc.type_, desc.defines_);
+    }
+
+    URHO3D_LOGINFO("{} shader variations are warmed up, {} compiled", shaders.size(), tasks.size());
+}
+
 bool Graphics::ToggleFullscreen()
 {
     ea::swap(primaryWindowSettings_, secondaryWindowSettings_);
@@ -684,6 +781,11 @@ RenderBackend Graphics::GetRenderBackend() const
     return renderDevice_ ? renderDevice_->GetBackend() : RenderBackend::OpenGL;
 }
 
+ShaderVariationCompiler Graphics::GetShaderVariationCompiler() const
+{
+    return ShaderVariationCompiler{GetRenderBackend(), settings_.shaderTranslationPolicy_};
+}
+
 unsigned Graphics::GetMaxBones()
 {
     /// User-specified number of bones
@@ -24,11 +24,13 @@
 
 #include <EASTL/unique_ptr.h>
 #include <EASTL/span.h>
+#include <EASTL/unordered_set.h>
 
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 #include "../Graphics/GraphicsDefs.h"
 #include "../Graphics/ShaderVariation.h"
+#include "../Graphics/ShaderVariationCompiler.h"
 #include "../IO/FileIdentifier.h"
 #include "../Math/Color.h"
 #include "../Math/Plane.h"
@@ -123,6 +125,19 @@ public:
     /// Save pipeline state cache.
     void SavePipelineStateCache(const FileIdentifier& fileName);
 
+    /// Shader warmup.
+    /// @{
+    /// Record shader variation. Recorded variations are saved to the warmup list.
+    void RecordShaderVariation(const ShaderVariationDesc& desc);
+    /// Save all shader variations recorded so far to the warmup list.
+    void SaveShaderWarmupList(const FileIdentifier& fileName) const;
+    /// Load shader variations from the warmup list and warm them up.
+    void WarmupShaders(const FileIdentifier& fileName);
+    /// Compile shader variations missing from the shader cache on worker threads, then create all variations.
+    /// Shader cache should be enabled, otherwise variations are compiled in main thread on creation.
+    void WarmupShaders(ea::span<const ShaderVariationDesc> shaders);
+    /// @}
+
     /// Toggle between full screen and windowed mode. Return true if successful.
     bool ToggleFullscreen();
     /// Close the window.
@@ -285,6 +300,8 @@ public:
     /// @{
     RenderBackend GetRenderBackend() const;
     const GraphicsSettings& GetSettings() const { return settings_; }
+    ShaderVariationCompiler GetShaderVariationCompiler() const;
+    const ea::vector<ShaderVariationDesc>& GetRecordedShaderVariations() const { return recordedShaderVariations_; }
     /// @}
 
 private:
@@ -331,6 +348,12 @@ private:
 
     SharedPtr<RenderDevice> renderDevice_;
 
+    /// Shader variations recorded for the warmup list.
+    /// @{
+    ea::vector<ShaderVariationDesc> recordedShaderVariations_;
+    ea::unordered_set<ShaderVariationDesc> recordedShaderVariationsSet_;
+    /// @}
+
     /// Max number of bones which can be skinned on GPU. Zero means default value.
     static unsigned maxBonesHWSkinned;
 };
@@ -50,11 +50,22 @@ namespace Urho3D
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
 
+static const ea::vector<ea::string> spatialIndexTypeNames = {
+    "Octree",
+    "DynamicTree",
+};
+
 inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
 }
 
+/// Return bounding box of the drawable for dynamic tree. Volatile bounding boxes are treated as unbounded.
+static BoundingBox GetTreeBoundingBox(Drawable* drawable)
+{
+    return drawable->HasVolatileBoundingBox() ? BoundingBox{} : drawable->GetWorldBoundingBox();
+}
+
 Octant::Octant(const BoundingBox& box, unsigned level, Octant* parent, Octree* octree, unsigned index) :
     level_(level),
     parent_(parent),
@@ -74,7 +85,9 @@ Octant::~Octant()
         for (auto i = drawables_.begin(); i != drawables_.end(); ++i)
         {
             (*i)->SetOctant(rootOctant);
+            (*i)->octantIndex_ = rootOctant->drawables_.size();
             rootOctant->drawables_.push_back(*i);
+            rootOctant->drawableBounds_.Add(*i);
             octree_->QueueUpdate(*i);
         }
         drawables_.clear();
@@ -122,36 +135,90 @@ void Octant::DeleteChild(unsigned index)
 
 void Octant::InsertDrawable(Drawable* drawable)
 {
-    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    Octant* octant = GetOrCreateInsertionOctant(drawable, drawable->GetWorldBoundingBox());
+    Octant* oldOctant = drawable->octant_;
+    if (oldOctant != octant)
+    {
+        // Add first, then remove, because drawable count going to zero deletes the octree branch in question
+        octant->AddDrawable(drawable);
+        if (oldOctant)
+            oldOctant->RemoveDrawable(drawable, false);
+    }
+}
+
+Octant* Octant::FindInsertionOctant(const Drawable* drawable, const BoundingBox& box, bool& isFinal)
+{
+    const Vector3 boxCenter = box.Center();
+    Octant* octant = this;
+    while (!octant->IsInsertionOctant(drawable, box))
+    {
+        Octant* child = octant->children_[octant->GetChildIndex(boxCenter)];
+        if (!child)
+        {
+            isFinal = false;
+            return octant;
+        }
+        octant = child;
+    }
+
+    isFinal = true;
+    return octant;
+}
+
+Octant* Octant::GetOrCreateInsertionOctant(const Drawable* drawable, const BoundingBox& box)
+{
+    const Vector3 boxCenter = box.Center();
+    Octant* octant = this;
+    while (!octant->IsInsertionOctant(drawable, box))
+        octant = octant->GetOrCreateChild(octant->GetChildIndex(boxCenter));
+    return octant;
+}
 
+bool Octant::IsInsertionOctant(const Drawable* drawable, const BoundingBox& box) const
+{
     // If root octant, insert all non-occludees here, so that octant occlusion does not hide the drawable.
     // Also if drawable is outside the root octant bounds, insert to root
-    bool insertHere;
     if (this == octree_->GetRootOctant())
-        insertHere = !drawable->IsOccludee() || cullingBox_.IsInside(box) != INSIDE || CheckDrawableFit(box);
+        return !drawable->IsOccludee() || cullingBox_.IsInside(box) != INSIDE || CheckDrawableFit(box);
     else
-        insertHere = CheckDrawableFit(box);
+        return CheckDrawableFit(box);
+}
 
-    if (insertHere)
+void Octant::RemoveMovedDrawables()
+{
+    // Compact manually to keep drawable bounds in sync
+    const unsigned oldNumDrawables = drawables_.size();
+    unsigned numKept = 0;
+    for (unsigned i = 0; i < oldNumDrawables; ++i)
     {
-        Octant* oldOctant = drawable->octant_;
-        if (oldOctant != this)
+        Drawable* drawable = drawables_[i];
+        if (drawable->octant_ != this)
+            continue;
+
+        if (numKept != i)
         {
-            // Add first, then remove, because drawable count going to zero deletes the octree branch in question
-            AddDrawable(drawable);
-            if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
+            drawables_[numKept] = drawable;
+            drawable->octantIndex_ = numKept;
+            drawableBounds_.Copy(numKept, i);
         }
+        ++numKept;
     }
-    else
-    {
-        Vector3 boxCenter = box.Center();
-        unsigned x = boxCenter.x_ < center_.x_ ? 0 : 1;
-        unsigned y = boxCenter.y_ < center_.y_ ? 0 : 2;
-        unsigned z = boxCenter.z_ < center_.z_ ? 0 : 4;
 
-        GetOrCreateChild(x + y + z)->InsertDrawable(drawable);
-    }
+    drawables_.resize(numKept);
+    drawableBounds_.Resize(numKept);
+
+    const unsigned numRemoved = oldNumDrawables - numKept;
+    if (numRemoved > 0)
+        DecDrawableCount(numRemoved);
+}
+
+void Octant::DetachDrawables()
+{
+    assert(!parent_);
+
+    numDrawables_ -= drawables_.size();
+    drawables_.clear();
+    drawableBounds_.Resize(0);
 }
 
 bool Octant::CheckDrawableFit(const BoundingBox& box) const
@@ -245,8 +312,11 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     if (drawables_.size())
     {
         auto** start = const_cast<Drawable**>(&drawables_[0]);
-        Drawable** end = start + drawables_.size();
-        query.TestDrawables(start, end, inside);
+        // Copy of bounds is refreshed only in Octree::Update, test actual bounds while updates are pending
+        if (octree_->HasPendingUpdates())
+            query.TestDrawables(start, start + drawables_.size(), inside);
+        else
+            query.TestDrawableBounds(start, drawableBounds_, inside);
     }
 
     for (auto child : children_)
@@ -420,6 +490,16 @@ Octree::~Octree()
     // Reset root pointer from all child octants now so that they do not move their drawables to root
     drawableUpdates_.clear();
     rootOctant_.ResetOctree();
+
+    // Drawables in dynamic tree are not stored in octants
+    if (spatialIndexType_ == SpatialIndexType::DynamicTree)
+    {
+        for (Drawable* drawable : drawables_)
+        {
+            drawable->SetOctant(nullptr);
+            drawable->SetDrawableIndex(M_MAX_UNSIGNED);
+        }
+    }
 }
 
 void Octree::RegisterObject(Context* context)
@@ -432,6 +512,9 @@ void Octree::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE_EX("Bounding Box Min", Vector3, worldBoundingBox_.min_, UpdateOctreeSize, defaultBoundsMin, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Bounding Box Max", Vector3, worldBoundingBox_.max_, UpdateOctreeSize, defaultBoundsMax, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Number of Levels", int, numLevels_, UpdateOctreeSize, DEFAULT_OCTREE_LEVELS, AM_DEFAULT);
+    URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Spatial Index", GetSpatialIndexType, SetSpatialIndexType, SpatialIndexType,
+        spatialIndexTypeNames, SpatialIndexType::Octree, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Tree Margin", GetTreeMargin, SetTreeMargin, float, DrawableTree::DefaultMargin, AM_DEFAULT);
 }
 
 void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -440,7 +523,10 @@ void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     {
         URHO3D_PROFILE("OctreeDrawDebug");
 
-        rootOctant_.DrawDebugGeometry(debug, depthTest);
+        if (spatialIndexType_ == SpatialIndexType::DynamicTree)
+            drawableTree_.DrawDebugGeometry(debug, depthTest);
+        else
+            rootOctant_.DrawDebugGeometry(debug, depthTest);
     }
 }
 
@@ -453,6 +539,37 @@ void Octree::SetSize(const BoundingBox& box, unsigned numLevels)
     numLevels_ = Max(numLevels, 1U);
 }
 
+void Octree::SetSpatialIndexType(SpatialIndexType type)
+{
+    if (type == spatialIndexType_)
+        return;
+
+    URHO3D_PROFILE("ChangeSpatialIndex");
+
+    // Move all drawables to the root octant
+    rootOctant_.SetRootSize(worldBoundingBox_);
+    drawableTree_.Clear();
+    ea::fill(drawableTreeLeaves_.begin(), drawableTreeLeaves_.end(), DrawableTree::InvalidNode);
+
+    spatialIndexType_ = type;
+    if (spatialIndexType_ == SpatialIndexType::DynamicTree)
+    {
+        rootOctant_.DetachDrawables();
+        for (unsigned i = 0; i < drawables_.size(); ++i)
+            drawableTreeLeaves_[i] = drawableTree_.AddDrawable(drawables_[i], GetTreeBoundingBox(drawables_[i]));
+    }
+    else
+    {
+        // Drawables will be inserted into proper octants on next update
+        for (Drawable* drawable : drawables_)
+        {
+            rootOctant_.AddDrawable(drawable);
+            if (!drawable->updateQueued_)
+                QueueUpdate(drawable);
+        }
+    }
+}
+
 void Octree::Update(const FrameInfo& frame)
 {
     if (!Thread::IsMainThread())
@@ -527,32 +644,21 @@ void Octree::Update(const FrameInfo& frame)
     {
         URHO3D_PROFILE("ReinsertToOctree");
 
-        for (auto i = drawableUpdates_.begin(); i != drawableUpdates_.end(); ++i)
+        // Bounding box may be recalculated on demand, which is not safe in worker threads outside of threaded update.
+        // Calculate boxes here, so reinsertion in worker threads only reads them.
+        // Refresh the copy of bounds used for batch culling too, it is never updated from other threads.
+        for (Drawable* drawable : drawableUpdates_)
         {
-            Drawable* drawable = *i;
-            drawable->updateQueued_ = false;
+            drawable->GetWorldBoundingBox();
             Octant* octant = drawable->GetOctant();
-            const BoundingBox& box = drawable->GetWorldBoundingBox();
-
-            // Skip if no octant or does not belong to this octree anymore
-            if (!octant || octant->GetOctree() != this)
-                continue;
-            // Skip if still fits the current octant
-            if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
-                continue;
-
-            rootOctant_.InsertDrawable(drawable);
-
-#ifdef _DEBUG
-            // Verify that the drawable will be culled correctly
-            octant = drawable->GetOctant();
-            if (octant != GetRootOctant() && octant->GetCullingBox().IsInside(box) != INSIDE)
-            {
-                URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
-                         " octant box " + octant->GetCullingBox().ToString());
-            }
-#endif
+            if (octant && octant->GetOctree() == this)
+                octant->UpdateDrawableBounds(drawable);
         }
+
+        if (spatialIndexType_ == SpatialIndexType::DynamicTree)
+            ReinsertDrawablesToTree();
+        else
+            ReinsertDrawables();
     }
 
     drawableUpdates_.clear();
@@ -568,6 +674,105 @@ void Octree::Update(const FrameInfo& frame)
     }
 }
 
+void Octree::ReinsertDrawables()
+{
+    // Find new octants in worker threads, octree is not modified at this point
+    auto* queue = GetSubsystem<WorkQueue>();
+    pendingReinsertions_.resize(drawableUpdates_.size());
+    ForEachParallel(queue, ReinsertionBucketSize, drawableUpdates_, [this](unsigned index, Drawable* drawable)
+    {
+        PendingReinsertion& reinsertion = pendingReinsertions_[index];
+        reinsertion = {};
+
+        drawable->updateQueued_ = false;
+        Octant* octant = drawable->GetOctant();
+        const BoundingBox& box = drawable->GetWorldBoundingBox();
+
+        // Skip if no octant or does not belong to this octree anymore
+        if (!octant || octant->GetOctree() != this)
+            return;
+        // Skip if still fits the current octant
+        if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
+            return;
+
+        reinsertion.drawable_ = drawable;
+        reinsertion.octant_ = rootOctant_.FindInsertionOctant(drawable, box, reinsertion.isFinal_);
+    });
+
+    // Add drawables to new octants first, because drawable count going to zero deletes the octree branch in question
+    reinsertionSourceOctants_.clear();
+    for (const PendingReinsertion& reinsertion : pendingReinsertions_)
+    {
+        Drawable* drawable = reinsertion.drawable_;
+        if (!drawable)
+            continue;
+
+        Octant* oldOctant = drawable->GetOctant();
+        Octant* newOctant = reinsertion.isFinal_
+            ? reinsertion.octant_
+            : reinsertion.octant_->GetOrCreateInsertionOctant(drawable, drawable->GetWorldBoundingBox());
+        if (newOctant == oldOctant)
+            continue;
+
+        newOctant->AddDrawable(drawable);
+        reinsertionSourceOctants_.push_back(oldOctant);
+
+#ifdef _DEBUG
+        // Verify that the drawable will be culled correctly
+        const BoundingBox& box = drawable->GetWorldBoundingBox();
+        if (newOctant != GetRootOctant() && newOctant->GetCullingBox().IsInside(box) != INSIDE)
+        {
+            URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
+                     " octant box " + newOctant->GetCullingBox().ToString());
+        }
+#endif
+    }
+
+    // Remove moved drawables from old octants, once per octant
+    ea::sort(reinsertionSourceOctants_.begin(), reinsertionSourceOctants_.end());
+    reinsertionSourceOctants_.erase(
+        ea::unique(reinsertionSourceOctants_.begin(), reinsertionSourceOctants_.end()), reinsertionSourceOctants_.end());
+    for (Octant* octant : reinsertionSourceOctants_)
+        octant->RemoveMovedDrawables();
+
+    pendingReinsertions_.clear();
+    reinsertionSourceOctants_.clear();
+}
+
+void Octree::ReinsertDrawablesToTree()
+{
+    // Check leaves in worker threads, tree is not modified at this point
+    auto* queue = GetSubsystem<WorkQueue>();
+    pendingReinsertions_.resize(drawableUpdates_.size());
+    ForEachParallel(queue, ReinsertionBucketSize, drawableUpdates_, [this](unsigned index, Drawable* drawable)
+    {
+        PendingReinsertion& reinsertion = pendingReinsertions_[index];
+        reinsertion = {};
+
+        drawable->updateQueued_ = false;
+        Octant* octant = drawable->GetOctant();
+
+        // Skip if no octant or does not belong to this octree anymore
+        if (!octant || octant->GetOctree() != this)
+            return;
+
+        const unsigned leaf = drawableTreeLeaves_[drawable->GetDrawableIndex()];
+        if (drawableTree_.IsMoveNeeded(leaf, GetTreeBoundingBox(drawable)))
+            reinsertion.drawable_ = drawable;
+    });
+
+    for (const PendingReinsertion& reinsertion : pendingReinsertions_)
+    {
+        if (Drawable* drawable = reinsertion.drawable_)
+        {
+            unsigned& leaf = drawableTreeLeaves_[drawable->GetDrawableIndex()];
+            leaf = drawableTree_.MoveDrawable(leaf, GetTreeBoundingBox(drawable));
+        }
+    }
+
+    pendingReinsertions_.clear();
+}
+
 void Octree::AddManualDrawable(Drawable* drawable)
 {
     if (!drawable || drawable->GetOctant())
@@ -601,10 +806,17 @@ void Octree::AddDrawable(Drawable* drawable)
     // Add drawable to index
     const unsigned index = drawables_.size();
     drawables_.push_back(drawable);
+    drawableTreeLeaves_.push_back(DrawableTree::InvalidNode);
     drawable->SetDrawableIndex(index);
 
-    // Insert drawable to common Octree
-    rootOctant_.InsertDrawable(drawable);
+    // Insert drawable to common Octree. Root octant is only used as a reference to Octree in case of dynamic tree
+    if (spatialIndexType_ == SpatialIndexType::DynamicTree)
+    {
+        drawable->SetOctant(&rootOctant_);
+        drawableTreeLeaves_[index] = drawableTree_.AddDrawable(drawable, GetTreeBoundingBox(drawable));
+    }
+    else
+        rootOctant_.InsertDrawable(drawable);
 
     // Insert drawable to zone index
     if (drawable->GetDrawableFlags().Test(DRAWABLE_ZONE))
@@ -631,7 +843,13 @@ void Octree::RemoveDrawable(Drawable* drawable, Octant* octant)
     }
 
     // Remove drawable from Octree
-    octant->RemoveDrawable(drawable);
+    if (spatialIndexType_ == SpatialIndexType::DynamicTree)
+    {
+        drawableTree_.RemoveDrawable(drawableTreeLeaves_[index]);
+        drawable->SetOctant(nullptr);
+    }
+    else
+        octant->RemoveDrawable(drawable);
 
     // Remove drawable from Zone index
     if (drawable->GetDrawableFlags().Test(DRAWABLE_ZONE))
@@ -646,9 +864,11 @@ void Octree::RemoveDrawable(Drawable* drawable, Octant* octant)
     {
         Drawable* replacement = drawables_.back();
         drawables_[index] = replacement;
+        drawableTreeLeaves_[index] = drawableTreeLeaves_.back();
         replacement->SetDrawableIndex(index);
     }
     drawables_.pop_back();
+    drawableTreeLeaves_.pop_back();
     drawable->SetDrawableIndex(M_MAX_UNSIGNED);
     drawable->updateQueued_ = false;
 
@@ -664,7 +884,10 @@ void Octree::MarkZoneDirty(Zone* zone)
 void Octree::GetDrawables(OctreeQuery& query) const
 {
     query.result_.clear();
-    rootOctant_.GetDrawablesInternal(query, false);
+    if (spatialIndexType_ == SpatialIndexType::DynamicTree)
+        drawableTree_.GetDrawables(query);
+    else
+        rootOctant_.GetDrawablesInternal(query, false);
 }
 
 void Octree::Raycast(RayOctreeQuery& query) const
@@ -672,7 +895,10 @@ void Octree::Raycast(RayOctreeQuery& query) const
     URHO3D_PROFILE("Raycast");
 
     query.result_.clear();
-    rootOctant_.GetDrawablesInternal(query);
+    if (spatialIndexType_ == SpatialIndexType::DynamicTree)
+        drawableTree_.Raycast(query);
+    else
+        rootOctant_.GetDrawablesInternal(query);
     ea::quick_sort(query.result_.begin(), query.result_.end(), CompareRayQueryResults);
 }
 
@@ -682,7 +908,10 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
 
     query.result_.clear();
     rayQueryDrawables_.clear();
-    rootOctant_.GetDrawablesOnlyInternal(query, rayQueryDrawables_);
+    if (spatialIndexType_ == SpatialIndexType::DynamicTree)
+        drawableTree_.GetRayDrawables(query, rayQueryDrawables_);
+    else
+        rootOctant_.GetDrawablesOnlyInternal(query, rayQueryDrawables_);
 
     // Sort by increasing hit distance to AABB
     for (auto i = rayQueryDrawables_.begin(); i != rayQueryDrawables_.end(); ++i)
@@ -26,6 +26,7 @@
 #include "../Core/Mutex.h"
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Drawable.h"
+#include "../Graphics/DrawableTree.h"
 #include "../Graphics/OctreeQuery.h"
 #include "../Math/Transform.h"
 
@@ -38,6 +39,16 @@ class Zone;
 static const int NUM_OCTANTS = 8;
 static const unsigned ROOT_INDEX = M_MAX_UNSIGNED;
 
+/// Spatial index used by Octree component to store and cull drawables.
+enum class SpatialIndexType
+{
+    /// Fixed-depth octree. Drawables are reinserted when they cross octant boundaries.
+    Octree,
+    /// Dynamic bounding box tree. Drawables are reinserted when they leave enlarged leaf boxes.
+    /// Better suited for scenes with many small moving objects.
+    DynamicTree,
+};
+
 /// %Octree octant.
 /// @nobind
 class URHO3D_API Octant
@@ -56,28 +67,60 @@ public:
     void InsertDrawable(Drawable* drawable);
     /// Check if a drawable object fits.
     bool CheckDrawableFit(const BoundingBox& box) const;
+    /// Return deepest existing octant where the drawable object should be inserted.
+    /// isFinal is set to false if the drawable should be inserted into child octant that doesn't exist yet.
+    /// Octree is not modified, so it is safe to call from multiple threads.
+    Octant* FindInsertionOctant(const Drawable* drawable, const BoundingBox& box, bool& isFinal);
+    /// Return octant where the drawable object should be inserted, creating child octants if needed.
+    Octant* GetOrCreateInsertionOctant(const Drawable* drawable, const BoundingBox& box);
 
     /// Add a drawable object to this octant.
     void AddDrawable(Drawable* drawable)
     {
         drawable->SetOctant(this);
+        drawable->octantIndex_ = drawables_.size();
         drawables_.push_back(drawable);
+        drawableBounds_.Add(drawable);
         IncDrawableCount();
     }
 
-    /// Remove a drawable object from this octant.
+    /// Remove a drawable object from this octant. Order of remaining drawable objects is not preserved.
     void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
     {
-        auto it = drawables_.find(drawable);
-        if (it != drawables_.end())
+        const unsigned index = drawable->octantIndex_;
+        if (!HasDrawableAt(drawable, index))
+            return;
+
+        // Move the last drawable into the freed slot instead of shifting all arrays
+        const unsigned lastIndex = drawables_.size() - 1;
+        if (index != lastIndex)
         {
-            drawables_.erase(it);
-            if (resetOctant)
-                drawable->SetOctant(nullptr);
-            DecDrawableCount();
+            Drawable* lastDrawable = drawables_[lastIndex];
+            drawables_[index] = lastDrawable;
+            lastDrawable->octantIndex_ = index;
+            drawableBounds_.Copy(index, lastIndex);
         }
+        drawables_.pop_back();
+        drawableBounds_.Resize(lastIndex);
+
+        if (resetOctant)
+            drawable->SetOctant(nullptr);
+        DecDrawableCount();
     }
 
+    /// Remove all drawable objects that were added to other octants. Octant may be deleted if it becomes empty.
+    void RemoveMovedDrawables();
+    /// Update the copy of bounds and masks of the drawable object used for batch culling.
+    /// Called from the main thread by Octree::Update for updated drawable objects.
+    void UpdateDrawableBounds(Drawable* drawable)
+    {
+        const unsigned index = drawable->octantIndex_;
+        if (HasDrawableAt(drawable, index))
+            drawableBounds_.Set(index, drawable);
+    }
+    /// Remove all drawable objects from this octant without resetting their octant. Should be called only for root octant without children.
+    void DetachDrawables();
+
     /// Return world-space bounding box.
     /// @property
     const BoundingBox& GetWorldBoundingBox() const { return worldBoundingBox_; }
@@ -118,6 +161,21 @@ public:
 protected:
     /// Initialize bounding box.
     void Initialize(const BoundingBox& box);
+    /// Return whether the drawable object should be inserted into this octant rather than into a child octant.
+    bool IsInsertionOctant(const Drawable* drawable, const BoundingBox& box) const;
+    /// Return whether the drawable object is stored in this octant at given index.
+    bool HasDrawableAt(const Drawable* drawable, unsigned index) const
+    {
+        return index < drawables_.size() && drawables_[index] == drawable;
+    }
+    /// Return index of child octant containing given position.
+    unsigned GetChildIndex(const Vector3& position) const
+    {
+        const unsigned x = position.x_ < center_.x_ ? 0 : 1;
+        const unsigned y = position.y_ < center_.y_ ? 0 : 2;
+        const unsigned z = position.z_ < center_.z_ ? 0 : 4;
+        return x + y + z;
+    }
 
     /// Increase drawable object count recursively.
     void IncDrawableCount()
@@ -128,11 +186,11 @@ protected:
     }
 
     /// Decrease drawable object count recursively and remove octant if it becomes empty.
-    void DecDrawableCount()
+    void DecDrawableCount(unsigned count = 1)
     {
         Octant* parent = parent_;
 
-        --numDrawables_;
+        numDrawables_ -= count;
         if (!numDrawables_)
         {
             if (parent)
@@ -140,7 +198,7 @@ protected:
         }
 
         if (parent)
-            parent->DecDrawableCount();
+            parent->DecDrawableCount(count);
     }
 
     /// World bounding box.
@@ -149,6 +207,8 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     ea::vector<Drawable*> drawables_;
+    /// Copy of drawable object bounds and masks, index-synchronized with drawables_.
+    DrawableBoundsArray drawableBounds_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS]{};
     /// World bounding box center.
@@ -229,6 +289,10 @@ public:
 
     /// Set size and maximum subdivision levels. If octree is not empty, drawable objects will be temporarily moved to the root.
     void SetSize(const BoundingBox& box, unsigned numLevels);
+    /// Set spatial index type. Drawable objects are moved to the new index.
+    void SetSpatialIndexType(SpatialIndexType type);
+    /// Set margin of leaf bounding boxes of dynamic tree spatial index.
+    void SetTreeMargin(float margin) { drawableTree_.SetMargin(margin); }
     /// Update and reinsert drawable objects.
     void Update(const FrameInfo& frame);
     /// Add a drawable manually.
@@ -267,6 +331,15 @@ public:
     /// @property
     unsigned GetNumLevels() const { return numLevels_; }
 
+    /// Return spatial index type.
+    SpatialIndexType GetSpatialIndexType() const { return spatialIndexType_; }
+
+    /// Return margin of leaf bounding boxes of dynamic tree spatial index.
+    float GetTreeMargin() const { return drawableTree_.GetMargin(); }
+
+    /// Return dynamic tree spatial index. Empty unless used.
+    const DrawableTree& GetDrawableTree() const { return drawableTree_; }
+
     /// Return all drawables in all octants.
     const ea::vector<Drawable*>& GetAllDrawables() const { return drawables_; }
 
@@ -274,6 +347,8 @@ public:
     void QueueUpdate(Drawable* drawable);
     /// Cancel drawable object's update.
     void CancelUpdate(Drawable* drawable);
+    /// Return whether any drawable object is waiting for update and reinsertion.
+    bool HasPendingUpdates() const { return !drawableUpdates_.empty(); }
     /// Queue Node transform update to be applied after threaded update.
     /// Should be called only during Drawable::Update.
     void QueueNodeTransformUpdate(Node* node, const Transform& transform);
@@ -281,6 +356,24 @@ public:
     void DrawDebugGeometry(bool depthTest);
 
 private:
+    /// Drawable object waiting for reinsertion.
+    struct PendingReinsertion
+    {
+        /// Drawable object. Null if the drawable object doesn't need reinsertion.
+        Drawable* drawable_{};
+        /// Octant to insert into.
+        Octant* octant_{};
+        /// Whether the octant is final or the drawable should be inserted into child octant not created yet.
+        bool isFinal_{};
+    };
+
+    /// Number of drawables processed by one task during reinsertion.
+    static constexpr unsigned ReinsertionBucketSize = 256;
+
+    /// Reinsert updated drawables. New octants are found in worker threads, then drawables are moved in main thread.
+    void ReinsertDrawables();
+    /// Reinsert updated drawables that left their leaves in dynamic tree spatial index.
+    void ReinsertDrawablesToTree();
     /// Handle render update in case of headless execution.
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
     /// Update octree size.
@@ -294,6 +387,10 @@ private:
     ea::vector<Drawable*> threadedDrawableUpdates_;
     /// Node transforms to be applied before reinsertion.
     WorkQueueVector<ea::pair<Node*, Transform>> pendingNodeTransforms_;
+    /// Drawable objects waiting for reinsertion.
+    ea::vector<PendingReinsertion> pendingReinsertions_;
+    /// Octants that lost drawable objects during reinsertion.
+    ea::vector<Octant*> reinsertionSourceOctants_;
     /// All Drawable objects.
     ea::vector<Drawable*> drawables_;
     /// Mutex for octree reinsertions.
@@ -304,6 +401,12 @@ private:
     unsigned numLevels_;
     /// World bounding box.
     BoundingBox worldBoundingBox_;
+    /// Spatial index type.
+    SpatialIndexType spatialIndexType_{SpatialIndexType::Octree};
+    /// Dynamic tree spatial index.
+    DrawableTree drawableTree_;
+    /// Leaves of dynamic tree spatial index, index-synchronized with drawables_.
+    ea::vector<unsigned> drawableTreeLeaves_;
     /// Zones.
     ZoneLookupIndex zones_;
 };
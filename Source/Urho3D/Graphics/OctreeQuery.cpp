@@ -24,11 +24,143 @@
 
 #include "../Graphics/OctreeQuery.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+namespace
+{
+
+/// Collects drawables that passed batch culling and forwards them to TestDrawables in chunks.
+class DrawableBatchCollector
+{
+public:
+    DrawableBatchCollector(OctreeQuery& query, Drawable** drawables, const DrawableBoundsArray& bounds)
+        : query_(query)
+        , drawables_(drawables)
+        , bounds_(bounds)
+        , flags_(query.drawableFlags_.AsInteger())
+        , viewMask_(query.viewMask_)
+    {
+    }
+
+    ~DrawableBatchCollector() { Flush(); }
+
+    /// Accept drawable that passed bounding box test.
+    void Accept(unsigned index)
+    {
+        const unsigned flags = bounds_.flags_[index];
+        if (!(flags & flags_) || !(bounds_.viewMasks_[index] & viewMask_))
+            return;
+
+        if (flags & DrawableBoundsArray::PreciseTestFlag)
+        {
+            // Keep the order of drawables, test actual bounding box
+            Flush();
+            query_.TestDrawables(&drawables_[index], &drawables_[index] + 1, false);
+            return;
+        }
+
+        candidates_[numCandidates_++] = drawables_[index];
+        if (numCandidates_ == MaxCandidates)
+            Flush();
+    }
+
+    /// Accept drawables by bit mask of 4 consecutive elements.
+    void AcceptMask(unsigned baseIndex, unsigned mask)
+    {
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            if (mask & (1u << i))
+                Accept(baseIndex + i);
+        }
+    }
+
+    /// Pass collected drawables to TestDrawables.
+    void Flush()
+    {
+        if (numCandidates_ > 0)
+        {
+            query_.TestDrawables(candidates_, candidates_ + numCandidates_, true);
+            numCandidates_ = 0;
+        }
+    }
+
+private:
+    static constexpr unsigned MaxCandidates = 64;
+
+    OctreeQuery& query_;
+    Drawable** drawables_{};
+    const DrawableBoundsArray& bounds_;
+    const unsigned flags_{};
+    const unsigned viewMask_{};
+
+    Drawable* candidates_[MaxCandidates];
+    unsigned numCandidates_{};
+};
+
+}
+
+void DrawableBoundsArray::Add(Drawable* drawable)
+{
+    Resize(Size() + 1);
+    Set(Size() - 1, drawable);
+}
+
+void DrawableBoundsArray::Set(unsigned index, Drawable* drawable)
+{
+    unsigned flags = drawable->GetDrawableFlags().AsInteger();
+    if (drawable->HasVolatileBoundingBox())
+    {
+        // Large finite box always passes batch test, actual box is tested later
+        minX_[index] = minY_[index] = minZ_[index] = -M_LARGE_VALUE;
+        maxX_[index] = maxY_[index] = maxZ_[index] = M_LARGE_VALUE;
+        flags |= PreciseTestFlag;
+    }
+    else
+    {
+        const BoundingBox& box = drawable->GetWorldBoundingBox();
+        minX_[index] = box.min_.x_;
+        minY_[index] = box.min_.y_;
+        minZ_[index] = box.min_.z_;
+        maxX_[index] = box.max_.x_;
+        maxY_[index] = box.max_.y_;
+        maxZ_[index] = box.max_.z_;
+    }
+
+    viewMasks_[index] = drawable->GetViewMask();
+    flags_[index] = flags;
+}
+
+void DrawableBoundsArray::Copy(unsigned destIndex, unsigned sourceIndex)
+{
+    minX_[destIndex] = minX_[sourceIndex];
+    minY_[destIndex] = minY_[sourceIndex];
+    minZ_[destIndex] = minZ_[sourceIndex];
+    maxX_[destIndex] = maxX_[sourceIndex];
+    maxY_[destIndex] = maxY_[sourceIndex];
+    maxZ_[destIndex] = maxZ_[sourceIndex];
+    viewMasks_[destIndex] = viewMasks_[sourceIndex];
+    flags_[destIndex] = flags_[sourceIndex];
+}
+
+void DrawableBoundsArray::Resize(unsigned size)
+{
+    minX_.resize(size);
+    minY_.resize(size);
+    minZ_.resize(size);
+    maxX_.resize(size);
+    maxY_.resize(size);
+    maxZ_.resize(size);
+    viewMasks_.resize(size);
+    flags_.resize(size);
+}
+
 Intersection PointOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
     if (inside)
@@ -95,6 +227,53 @@ void BoxOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool inside
     }
 }
 
+void BoxOctreeQuery::TestDrawableBounds(Drawable** start, const DrawableBoundsArray& bounds, bool inside)
+{
+    const unsigned numDrawables = bounds.Size();
+    if (inside)
+    {
+        TestDrawables(start, start + numDrawables, true);
+        return;
+    }
+
+    DrawableBatchCollector collector(*this, start, bounds);
+    unsigned index = 0;
+
+#ifdef URHO3D_SSE
+    const __m128 boxMinX = _mm_set1_ps(box_.min_.x_);
+    const __m128 boxMinY = _mm_set1_ps(box_.min_.y_);
+    const __m128 boxMinZ = _mm_set1_ps(box_.min_.z_);
+    const __m128 boxMaxX = _mm_set1_ps(box_.max_.x_);
+    const __m128 boxMaxY = _mm_set1_ps(box_.max_.y_);
+    const __m128 boxMaxZ = _mm_set1_ps(box_.max_.z_);
+
+    for (; index + 4 <= numDrawables; index += 4)
+    {
+        const __m128 minX = _mm_loadu_ps(&bounds.minX_[index]);
+        const __m128 minY = _mm_loadu_ps(&bounds.minY_[index]);
+        const __m128 minZ = _mm_loadu_ps(&bounds.minZ_[index]);
+        const __m128 maxX = _mm_loadu_ps(&bounds.maxX_[index]);
+        const __m128 maxY = _mm_loadu_ps(&bounds.maxY_[index]);
+        const __m128 maxZ = _mm_loadu_ps(&bounds.maxZ_[index]);
+
+        const __m128 outsideX = _mm_or_ps(_mm_cmplt_ps(maxX, boxMinX), _mm_cmpgt_ps(minX, boxMaxX));
+        const __m128 outsideY = _mm_or_ps(_mm_cmplt_ps(maxY, boxMinY), _mm_cmpgt_ps(minY, boxMaxY));
+        const __m128 outsideZ = _mm_or_ps(_mm_cmplt_ps(maxZ, boxMinZ), _mm_cmpgt_ps(minZ, boxMaxZ));
+        const __m128 outside = _mm_or_ps(_mm_or_ps(outsideX, outsideY), outsideZ);
+
+        const unsigned insideMask = ~static_cast<unsigned>(_mm_movemask_ps(outside)) & 0xf;
+        if (insideMask)
+            collector.AcceptMask(index, insideMask);
+    }
+#endif
+
+    for (; index < numDrawables; ++index)
+    {
+        if (box_.IsInsideFast(bounds.GetBoundingBox(index)) != OUTSIDE)
+            collector.Accept(index);
+    }
+}
+
 Intersection FrustumOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
     if (inside)
@@ -117,6 +296,88 @@ void FrustumOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool in
     }
 }
 
+void FrustumOctreeQuery::TestDrawableBounds(Drawable** start, const DrawableBoundsArray& bounds, bool inside)
+{
+    const unsigned numDrawables = bounds.Size();
+    if (inside)
+    {
+        TestDrawables(start, start + numDrawables, true);
+        return;
+    }
+
+    DrawableBatchCollector collector(*this, start, bounds);
+    unsigned index = 0;
+
+#ifdef URHO3D_SSE
+    struct PlaneSIMD
+    {
+        __m128 normalX_;
+        __m128 normalY_;
+        __m128 normalZ_;
+        __m128 absNormalX_;
+        __m128 absNormalY_;
+        __m128 absNormalZ_;
+        __m128 d_;
+    };
+
+    PlaneSIMD planes[NUM_FRUSTUM_PLANES];
+    for (unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    {
+        const Plane& plane = frustum_.planes_[i];
+        planes[i].normalX_ = _mm_set1_ps(plane.normal_.x_);
+        planes[i].normalY_ = _mm_set1_ps(plane.normal_.y_);
+        planes[i].normalZ_ = _mm_set1_ps(plane.normal_.z_);
+        planes[i].absNormalX_ = _mm_set1_ps(plane.absNormal_.x_);
+        planes[i].absNormalY_ = _mm_set1_ps(plane.absNormal_.y_);
+        planes[i].absNormalZ_ = _mm_set1_ps(plane.absNormal_.z_);
+        planes[i].d_ = _mm_set1_ps(plane.d_);
+    }
+
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (; index + 4 <= numDrawables; index += 4)
+    {
+        const __m128 minX = _mm_loadu_ps(&bounds.minX_[index]);
+        const __m128 minY = _mm_loadu_ps(&bounds.minY_[index]);
+        const __m128 minZ = _mm_loadu_ps(&bounds.minZ_[index]);
+        const __m128 maxX = _mm_loadu_ps(&bounds.maxX_[index]);
+        const __m128 maxY = _mm_loadu_ps(&bounds.maxY_[index]);
+        const __m128 maxZ = _mm_loadu_ps(&bounds.maxZ_[index]);
+
+        const __m128 centerX = _mm_mul_ps(_mm_add_ps(maxX, minX), half);
+        const __m128 centerY = _mm_mul_ps(_mm_add_ps(maxY, minY), half);
+        const __m128 centerZ = _mm_mul_ps(_mm_add_ps(maxZ, minZ), half);
+        const __m128 edgeX = _mm_sub_ps(centerX, minX);
+        const __m128 edgeY = _mm_sub_ps(centerY, minY);
+        const __m128 edgeZ = _mm_sub_ps(centerZ, minZ);
+
+        // Same math as Frustum::IsInsideFast, box is outside if it is behind any plane
+        __m128 outside = _mm_setzero_ps();
+        for (const PlaneSIMD& plane : planes)
+        {
+            const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(plane.normalX_, centerX), _mm_mul_ps(plane.normalY_, centerY)),
+                _mm_mul_ps(plane.normalZ_, centerZ)), plane.d_);
+            const __m128 absDist = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(plane.absNormalX_, edgeX), _mm_mul_ps(plane.absNormalY_, edgeY)),
+                _mm_mul_ps(plane.absNormalZ_, edgeZ));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_sub_ps(zero, absDist)));
+        }
+
+        const unsigned insideMask = ~static_cast<unsigned>(_mm_movemask_ps(outside)) & 0xf;
+        if (insideMask)
+            collector.AcceptMask(index, insideMask);
+    }
+#endif
+
+    for (; index < numDrawables; ++index)
+    {
+        if (frustum_.IsInsideFast(bounds.GetBoundingBox(index)) != OUTSIDE)
+            collector.Accept(index);
+    }
+}
+
 
 Intersection AllContentOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
@@ -37,6 +37,44 @@ namespace Urho3D
 class Drawable;
 class Node;
 
+/// Structure-of-arrays copy of drawable bounds and masks kept by octant for batch culling.
+/// @nobind
+struct URHO3D_API DrawableBoundsArray
+{
+    /// Flag set for drawables that should be tested using actual bounding box.
+    static constexpr unsigned PreciseTestFlag = 0x100;
+
+    /// Append drawable.
+    void Add(Drawable* drawable);
+    /// Update drawable at index.
+    void Set(unsigned index, Drawable* drawable);
+    /// Copy element to another index.
+    void Copy(unsigned destIndex, unsigned sourceIndex);
+    /// Resize arrays.
+    void Resize(unsigned size);
+    /// Return number of elements.
+    unsigned Size() const { return minX_.size(); }
+    /// Return bounding box at index.
+    BoundingBox GetBoundingBox(unsigned index) const
+    {
+        return BoundingBox(Vector3(minX_[index], minY_[index], minZ_[index]), Vector3(maxX_[index], maxY_[index], maxZ_[index]));
+    }
+
+    /// Bounding box coordinates.
+    /// @{
+    ea::vector<float> minX_;
+    ea::vector<float> minY_;
+    ea::vector<float> minZ_;
+    ea::vector<float> maxX_;
+    ea::vector<float> maxY_;
+    ea::vector<float> maxZ_;
+    /// @}
+    /// View masks.
+    ea::vector<unsigned> viewMasks_;
+    /// Drawable flags combined with PreciseTestFlag.
+    ea::vector<unsigned> flags_;
+};
+
 /// Base class for octree queries.
 class URHO3D_API OctreeQuery : private NonCopyable
 {
@@ -56,6 +94,11 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Intersection test for drawables with a copy of their bounds kept by octant. Falls back to TestDrawables by default.
+    virtual void TestDrawableBounds(Drawable** start, const DrawableBoundsArray& bounds, bool inside)
+    {
+        TestDrawables(start, start + bounds.Size(), inside);
+    }
 
     /// Result vector reference.
     ea::vector<Drawable*>& result_;
@@ -126,6 +169,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables with a copy of bounds. Passes drawables inside the box to TestDrawables.
+    void TestDrawableBounds(Drawable** start, const DrawableBoundsArray& bounds, bool inside) override;
 
     /// Bounding box.
     BoundingBox box_;
@@ -148,6 +193,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for drawables with a copy of bounds. Passes drawables inside the frustum to TestDrawables.
+    void TestDrawableBounds(Drawable** start, const DrawableBoundsArray& bounds, bool inside) override;
 
     /// Frustum.
     Frustum frustum_;
@@ -138,9 +138,8 @@ void Shader::RegisterObject(Context* context)
 
 bool Shader::BeginLoad(Deserializer& source)
 {
+    // Graphics is optional, shaders may be loaded to be compiled offline
     auto* graphics = GetSubsystem<Graphics>();
-    if (!graphics)
-        return false;
 
     // Load the shader source code and resolve any includes
     ea::string shaderCode;
@@ -148,7 +147,7 @@ bool Shader::BeginLoad(Deserializer& source)
     ProcessSource(shaderCode, timeStamp, source);
 
     // Validate shader code
-    if (graphics->GetSettings().validateShaders_)
+    if (graphics && graphics->GetSettings().validateShaders_)
     {
         static const auto characterMask = GenerateAllowedCharacterMask();
         static const unsigned maxSnippetSize = 5;
@@ -226,16 +225,15 @@ void Shader::ProcessSource(ea::string& code, FileTime& timeStamp, Deserializer&
 {
     auto* cache = GetSubsystem<ResourceCache>();
     auto* vfs = GetSubsystem<VirtualFileSystem>();
-    auto* graphics = GetSubsystem<Graphics>();
 
     const ea::string& fileName = source.GetName();
     // TODO: Support HLSL and MSL shaders.
     const bool isGLSL = true;
 
-    // Add file to index
-    unsigned& fileIndex = fileToIndexMapping[fileName];
-    if (!fileIndex)
-        fileIndex = fileToIndexMapping.size();
+    // Add file to index. Index is derived from the file name so that source code and cached bytecode hashes
+    // don't depend on the order in which shaders are loaded.
+    const unsigned fileIndex = StringHash{fileName}.Value() & 0x7fffffffu;
+    fileToIndexMapping[fileName] = fileIndex;
 
     // If the source if a non-packaged file, store the timestamp
     const FileTime sourceTimeStamp = vfs->GetLastModifiedTime(FileIdentifier::FromUri(source.GetName()), false);
@@ -271,8 +269,10 @@ void Shader::ProcessSource(ea::string& code, FileTime& timeStamp, Deserializer&
             if (isLineContinuation)
                 line.erase(line.end() - 1);
 
-            // If shader validation is enabled, trim comments manually to avoid validating comment contents
-            if (!graphics->GetSettings().validateShaders_ || !line.trimmed().starts_with("//"))
+            // Trim comment lines so that shader validation doesn't check comment contents.
+            // Do it unconditionally so that source code doesn't depend on Graphics settings and matches offline
+            // compilation by ShaderCacheTool.
+            if (!line.trimmed().starts_with("//"))
                 code += line;
 
             ++numNewLines;
@@ -27,71 +27,16 @@
 #include "Urho3D/Core/ProcessUtils.h"
 #include "Urho3D/Graphics/Graphics.h"
 #include "Urho3D/Graphics/Shader.h"
+#include "Urho3D/Graphics/ShaderVariationCompiler.h"
 #include "Urho3D/IO/Log.h"
 #include "Urho3D/IO/VirtualFileSystem.h"
-#include "Urho3D/RenderAPI/RenderAPIUtils.h"
-#include "Urho3D/Shader/ShaderCompiler.h"
-#include "Urho3D/Shader/ShaderOptimizer.h"
 #include "Urho3D/Shader/ShaderSourceLogger.h"
-#include "Urho3D/Shader/ShaderTranslator.h"
-
-#include <EASTL/span.h>
 
 #include "Urho3D/DebugNew.h"
 
 namespace Urho3D
 {
 
-namespace
-{
-
-TargetShaderLanguage GetTargetShaderLanguage(RenderBackend renderBackend)
-{
-    switch (renderBackend)
-    {
-    case RenderBackend::D3D11:
-    case RenderBackend::D3D12: //
-        return TargetShaderLanguage::HLSL_5_0;
-    case RenderBackend::Vulkan: //
-        return TargetShaderLanguage::VULKAN_1_0;
-    case RenderBackend::OpenGL:
-#if GLES_SUPPORTED
-        return TargetShaderLanguage::GLSL_ES_3_0;
-#else
-        return TargetShaderLanguage::GLSL_4_1;
-#endif
-    default: //
-        URHO3D_ASSERT(0);
-        return TargetShaderLanguage::VULKAN_1_0;
-    };
-}
-
-ea::string GetCompiledShaderMIME(RenderBackend renderBackend)
-{
-    switch (renderBackend)
-    {
-    case RenderBackend::D3D11:
-    case RenderBackend::D3D12: //
-        return "application/hlsl-bin";
-    case RenderBackend::Vulkan: //
-        return "application/spirv";
-    case RenderBackend::OpenGL: return "application/glsl";
-    default: //
-        URHO3D_ASSERT(0);
-        return "";
-    };
-}
-
-template <class T> ConstByteSpan ToByteSpan(const T& value)
-{
-    using ElementType = decltype(value[0]);
-    const auto sizeInBytes = static_cast<unsigned>(value.size() * sizeof(ElementType));
-    const auto dataBytes = reinterpret_cast<const unsigned char*>(value.data());
-    return {dataBytes, sizeInBytes};
-}
-
-} // namespace
-
 ShaderVariation::ShaderVariation(Shader* owner, ShaderType type, const ea::string& defines)
     : RawShader(owner->GetContext(), type)
     , graphics_(GetSubsystem<Graphics>())
@@ -101,6 +46,9 @@ ShaderVariation::ShaderVariation(Shader* owner, ShaderType type, const ea::strin
     SetDebugName(GetShaderVariationName());
     Create();
 
+    if (graphics_)
+        graphics_->RecordShaderVariation({type, owner->GetName(), defines_});
+
     owner->OnReloaded.Subscribe(this, &ShaderVariation::OnReloaded);
 }
 
@@ -133,57 +81,51 @@ bool ShaderVariation::Create()
     }
 
     const GraphicsSettings& settings = graphics_->GetSettings();
-    const FileIdentifier& cacheDir = settings.shaderCacheDir_;
-    const FileIdentifier binaryShaderName = cacheDir + GetCachedVariationName("bytecode");
+    const ShaderVariationCompiler compiler = graphics_->GetShaderVariationCompiler();
+
+    // Cached bytecode is addressed by the content of the prepared source, so it's never outdated
+    const ea::string sourceCode = compiler.PrepareSource(GetShaderType(), defines_, owner_->GetSourceCode());
+    const unsigned long long contentHash = compiler.GetContentHash(sourceCode);
+    const FileIdentifier binaryShaderName =
+        settings.shaderCacheDir_ + compiler.GetCachedFileName(GetShaderName(), GetShaderType(), contentHash, "bytecode");
 
-    if (!LoadByteCode(binaryShaderName))
+    if (!LoadByteCode(compiler, binaryShaderName))
     {
         // Compile shader if don't have valid bytecode
-        if (!CompileFromSource())
+        if (!CompileFromSource(compiler, sourceCode, contentHash))
         {
             // Notify everyone if compilation failed
             CreateFromBinary({GetShaderType()});
             return false;
         }
 
-        // Save the bytecode after successful compile, but not if the source is from a package
-        if (settings.cacheShaders_ && owner_->GetTimeStamp())
+        if (settings.cacheShaders_)
             SaveByteCode(binaryShaderName);
     }
 
     return true;
 }
 
-bool ShaderVariation::CompileFromSource()
+bool ShaderVariation::CompileFromSource(
+    const ShaderVariationCompiler& compiler, const ea::string& sourceCode, unsigned long long contentHash)
 {
-    const ea::string& originalShaderCode = owner_->GetSourceCode();
-    const ea::string sourceCode = PrepareGLSLShaderCode(originalShaderCode);
-
-    ea::string_view translatedSource;
-    const SpirVShader* translatedSpirv{};
-    ConstByteSpan translatedBytecode;
-    const bool processed = ProcessShaderSource(translatedSource, translatedSpirv, translatedBytecode, sourceCode);
+    ShaderBytecode bytecode;
+    ea::string translatedSource;
+    const bool compiled =
+        compiler.Compile(bytecode, translatedSource, GetShaderType(), sourceCode, GetShaderVariationName());
 
     const FileIdentifier& cacheDir = graphics_->GetSettings().shaderCacheDir_;
-    const FileIdentifier loggedSourceShaderName = cacheDir + GetCachedVariationName("glsl");
+    const FileIdentifier loggedSourceShaderName =
+        cacheDir + compiler.GetCachedFileName(GetShaderName(), GetShaderType(), contentHash, "glsl");
     LogShaderSource(loggedSourceShaderName, defines_, translatedSource);
 
-    if (!processed)
+    if (!compiled)
         return false;
 
-    const RenderBackend renderBackend = graphics_->GetRenderBackend();
-
-    ShaderBytecode bytecode;
-    bytecode.type_ = GetShaderType();
-    bytecode.mime_ = GetCompiledShaderMIME(renderBackend);
-    bytecode.bytecode_.assign(translatedBytecode.begin(), translatedBytecode.end());
-    if (translatedSpirv && GetShaderType() == VS)
-        bytecode.vertexAttributes_ = GetVertexAttributesFromSpirV(*translatedSpirv);
-
     CreateFromBinary(bytecode);
     if (!GetHandle())
     {
-        if (renderBackend == RenderBackend::OpenGL)
+        if (compiler.backend_ == RenderBackend::OpenGL)
             URHO3D_LOGINFO("Shader files:\n{}", Shader::GetShaderFileList());
         return false;
     }
@@ -191,22 +133,13 @@ bool ShaderVariation::CompileFromSource()
     return true;
 }
 
-bool ShaderVariation::LoadByteCode(const FileIdentifier& binaryShaderName)
+bool ShaderVariation::LoadByteCode(const ShaderVariationCompiler& compiler, const FileIdentifier& binaryShaderName)
 {
     Context* context = Context::GetInstance();
     auto vfs = context->GetSubsystem<VirtualFileSystem>();
     if (!vfs->Exists(binaryShaderName))
         return false;
 
-    // Check timestamps if available
-    const FileTime sourceTimeStamp = owner_->GetTimeStamp();
-    if (sourceTimeStamp)
-    {
-        const FileTime bytecodeTimeStamp = vfs->GetLastModifiedTime(binaryShaderName, false);
-        if (bytecodeTimeStamp && bytecodeTimeStamp < sourceTimeStamp)
-            return false;
-    }
-
     const AbstractFilePtr file = vfs->OpenFile(binaryShaderName, FILE_READ);
     if (!file)
         return false;
@@ -215,8 +148,7 @@ bool ShaderVariation::LoadByteCode(const FileIdentifier& binaryShaderName)
     if (!bytecode.LoadFromFile(*file))
         return false;
 
-    const RenderBackend renderBackend = graphics_->GetRenderBackend();
-    if (bytecode.mime_ != GetCompiledShaderMIME(renderBackend))
+    if (bytecode.mime_ != compiler.GetBytecodeMIME())
         return false;
 
     CreateFromBinary(bytecode);
@@ -242,172 +174,4 @@ void ShaderVariation::SaveByteCode(const FileIdentifier& binaryShaderName)
     GetBytecode().SaveToFile(*file);
 }
 
-ea::string ShaderVariation::GetCachedVariationName(ea::string_view extension) const
-{
-    const ea::string backendName = ToString(graphics_->GetRenderBackend()).to_lower();
-    const ea::string shortName = owner_->GetShaderName();
-    const ea::string shaderTypeName = ToString(GetShaderType()).to_lower();
-    const StringHash definesHash{defines_};
-    return Format("{}_{}_{}_{}.{}", shortName, shaderTypeName, definesHash.ToString(), backendName, extension);
-}
-
-bool ShaderVariation::NeedShaderTranslation() const
-{
-    const ShaderTranslationPolicy policy = graphics_->GetSettings().shaderTranslationPolicy_;
-    return policy != ShaderTranslationPolicy::Verbatim;
-}
-
-bool ShaderVariation::NeedShaderOptimization() const
-{
-    const ShaderTranslationPolicy policy = graphics_->GetSettings().shaderTranslationPolicy_;
-    return policy == ShaderTranslationPolicy::Optimize;
-}
-
-ea::string ShaderVariation::PrepareGLSLShaderCode(const ea::string& originalShaderCode) const
-{
-    ea::string shaderCode;
-
-    const RenderBackend renderBackend = graphics_->GetRenderBackend();
-    const bool skipVersionTag = NeedShaderTranslation();
-
-    // Check if the shader code contains a version define
-    const auto versionTag = FindVersionTag(originalShaderCode);
-    if (!skipVersionTag)
-    {
-        if (versionTag)
-        {
-            // If version define found, insert it first
-            const ea::string versionDefine =
-                originalShaderCode.substr(versionTag->first, versionTag->second - versionTag->first);
-            shaderCode += versionDefine + "\n";
-        }
-        else
-        {
-            const bool isOpenGLES = IsOpenGLESBackend(renderBackend);
-            const bool isCompute = GetShaderType() == CS;
-
-            static const char* versions[2][2] = {
-                {"#version 410\n", "#version 430\n"},
-                {"#version 300 es\n", "#version 310 es\n"},
-            };
-
-            shaderCode += versions[isOpenGLES][isCompute];
-        }
-    }
-
-    static const char* shaderTypeDefines[] = {
-        "#define COMPILEVS\n", // VS
-        "#define COMPILEPS\n", // PS
-        "#define COMPILEGS\n", // GS
-        "#define COMPILEHS\n", // HS
-        "#define COMPILEDS\n", // DS
-        "#define COMPILECS\n", // CS
-    };
-    shaderCode += shaderTypeDefines[GetShaderType()];
-
-    shaderCode += Format("#define URHO3D_{}\n", ToString(renderBackend).to_upper());
-
-    // Prepend the defines to the shader code
-    const StringVector defineVec = defines_.split(' ');
-    for (const ea::string& define : defineVec)
-    {
-        const ea::string defineString = "#define " + define.replaced('=', ' ') + " \n";
-        shaderCode += defineString;
-    }
-
-    // When version define found, do not insert it a second time
-    if (!versionTag)
-        shaderCode += originalShaderCode;
-    else
-    {
-        shaderCode += originalShaderCode.substr(0, versionTag->first);
-        shaderCode += "//";
-        shaderCode += originalShaderCode.substr(versionTag->first);
-    }
-
-    return shaderCode;
-}
-
-bool ShaderVariation::ProcessShaderSource(ea::string_view& translatedSource, const SpirVShader*& translatedSpirv,
-    ConstByteSpan& translatedBytecode, ea::string_view originalShaderCode)
-{
-    translatedSource = originalShaderCode;
-    translatedSpirv = nullptr;
-    translatedBytecode = ToByteSpan(originalShaderCode);
-
-    const RenderBackend renderBackend = graphics_->GetRenderBackend();
-    const TargetShaderLanguage targetShaderLanguage = GetTargetShaderLanguage(renderBackend);
-    const bool needShaderTranslation = NeedShaderTranslation();
-    const bool needShaderOptimization = NeedShaderOptimization();
-
-#ifdef URHO3D_SHADER_TRANSLATOR
-    if (needShaderTranslation)
-    {
-        static thread_local SpirVShader spirvShader;
-        ParseUniversalShader(spirvShader, GetShaderType(), originalShaderCode, {}, targetShaderLanguage);
-        if (!spirvShader)
-        {
-            URHO3D_LOGERROR("Failed to convert shader {} from GLSL to SPIR-V:\n{}{}", GetShaderVariationName(),
-                Shader::GetShaderFileList(), spirvShader.compilerOutput_);
-            return false;
-        }
-
-        translatedSpirv = &spirvShader;
-
-    #ifdef URHO3D_SHADER_OPTIMIZER
-        if (needShaderOptimization)
-        {
-            ea::string optimizerOutput;
-            if (!OptimizeSpirVShader(spirvShader, optimizerOutput, targetShaderLanguage))
-            {
-                URHO3D_LOGERROR("Failed to optimize SPIR-V shader {}:\n{}", GetShaderVariationName(), optimizerOutput);
-                return false;
-            }
-        }
-    #endif
-
-        // Vulkan uses SPIRV directly
-        if (targetShaderLanguage == TargetShaderLanguage::VULKAN_1_0)
-        {
-            translatedBytecode = ToByteSpan(spirvShader.bytecode_);
-        }
-        else
-        {
-            // Translate to target language
-            static thread_local TargetShader targetShader;
-            TranslateSpirVShader(targetShader, spirvShader, targetShaderLanguage);
-            if (!targetShader)
-            {
-                URHO3D_LOGERROR("Failed to convert shader {} from SPIR-V to HLSL:\n{}{}", GetShaderVariationName(),
-                    Shader::GetShaderFileList(), targetShader.compilerOutput_);
-                return false;
-            }
-
-            translatedSource = targetShader.sourceCode_;
-            if (renderBackend == RenderBackend::D3D11 || renderBackend == RenderBackend::D3D12)
-            {
-                // On D3D backends, compile the translated source code
-                static thread_local ByteVector hlslBytecode;
-                ea::string compilerOutput;
-                if (!CompileHLSLToBinary(hlslBytecode, compilerOutput, targetShader.sourceCode_, GetShaderType()))
-                {
-                    URHO3D_LOGERROR("Failed to compile HLSL shader {}:\n{}{}", GetShaderVariationName(),
-                        Shader::GetShaderFileList(), compilerOutput);
-                    return false;
-                }
-
-                translatedBytecode = hlslBytecode;
-            }
-            else
-            {
-                // On OpenGL backends, just store the translated source code
-                translatedBytecode = ToByteSpan(targetShader.sourceCode_);
-            }
-        }
-    }
-#endif
-
-    return true;
-}
-
 } // namespace Urho3D
@@ -38,7 +38,7 @@ namespace Urho3D
 
 class Shader;
 struct FileIdentifier;
-struct SpirVShader;
+struct ShaderVariationCompiler;
 
 /// Vertex or pixel shader on the GPU.
 class URHO3D_API ShaderVariation
@@ -55,18 +55,11 @@ public:
     const ea::string& GetDefines() const { return defines_; }
 
 private:
-    ea::string GetCachedVariationName(ea::string_view extension) const;
-    bool NeedShaderTranslation() const;
-    bool NeedShaderOptimization() const;
-
-    ea::string PrepareGLSLShaderCode(const ea::string& originalShaderCode) const;
-    bool ProcessShaderSource(ea::string_view& translatedSource, const SpirVShader*& translatedSpirv,
-        ConstByteSpan& translatedBytecode, ea::string_view originalShaderCode);
-
     void OnReloaded();
     bool Create();
-    bool CompileFromSource();
-    bool LoadByteCode(const FileIdentifier& binaryShaderName);
+    bool CompileFromSource(const ShaderVariationCompiler& compiler, const ea::string& sourceCode,
+        unsigned long long contentHash);
+    bool LoadByteCode(const ShaderVariationCompiler& compiler, const FileIdentifier& binaryShaderName);
     void SaveByteCode(const FileIdentifier& binaryShaderName);
 
     /// Cached pointer to Graphics subsystem.
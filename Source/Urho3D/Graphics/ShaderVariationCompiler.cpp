@@ -0,0 +1,276 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "Urho3D/Precompiled.h"
+
+#include "Urho3D/Graphics/ShaderVariationCompiler.h"
+
+#include "Urho3D/Graphics/Shader.h"
+#include "Urho3D/IO/Archive.h"
+#include "Urho3D/IO/ArchiveSerialization.h"
+#include "Urho3D/IO/Log.h"
+#include "Urho3D/RenderAPI/RenderAPIUtils.h"
+#include "Urho3D/Shader/ShaderCompiler.h"
+#include "Urho3D/Shader/ShaderOptimizer.h"
+#include "Urho3D/Shader/ShaderTranslator.h"
+
+#include "Urho3D/DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+TargetShaderLanguage GetTargetShaderLanguage(RenderBackend renderBackend)
+{
+    switch (renderBackend)
+    {
+    case RenderBackend::D3D11:
+    case RenderBackend::D3D12: //
+        return TargetShaderLanguage::HLSL_5_0;
+    case RenderBackend::Vulkan: //
+        return TargetShaderLanguage::VULKAN_1_0;
+    case RenderBackend::OpenGL:
+#if GLES_SUPPORTED
+        return TargetShaderLanguage::GLSL_ES_3_0;
+#else
+        return TargetShaderLanguage::GLSL_4_1;
+#endif
+    default: //
+        URHO3D_ASSERT(0);
+        return TargetShaderLanguage::VULKAN_1_0;
+    };
+}
+
+template <class T> ConstByteSpan ToByteSpan(const T& value)
+{
+    using ElementType = decltype(value[0]);
+    const auto sizeInBytes = static_cast<unsigned>(value.size() * sizeof(ElementType));
+    const auto dataBytes = reinterpret_cast<const unsigned char*>(value.data());
+    return {dataBytes, sizeInBytes};
+}
+
+/// 64-bit FNV-1a hash, 32-bit hash is too weak for content addressing.
+unsigned long long HashBytes(unsigned long long hash, ConstByteSpan bytes)
+{
+    for (const unsigned char byte : bytes)
+    {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+void ShaderVariationDesc::SerializeInBlock(Archive& archive)
+{
+    SerializeValue(archive, "type", type_);
+    SerializeValue(archive, "name", shaderName_);
+    SerializeValue(archive, "defines", defines_);
+}
+
+ea::string ShaderVariationCompiler::PrepareSource(
+    ShaderType type, const ea::string& defines, const ea::string& originalSource) const
+{
+    ea::string shaderCode;
+
+    const bool skipVersionTag = translationPolicy_ != ShaderTranslationPolicy::Verbatim;
+
+    // Check if the shader code contains a version define
+    const auto versionTag = FindVersionTag(originalSource);
+    if (!skipVersionTag)
+    {
+        if (versionTag)
+        {
+            // If version define found, insert it first
+            const ea::string versionDefine = originalSource.substr(versionTag->first, versionTag->second - versionTag->first);
+            shaderCode += versionDefine + "\n";
+        }
+        else
+        {
+            const bool isOpenGLES = IsOpenGLESBackend(backend_);
+            const bool isCompute = type == CS;
+
+            static const char* versions[2][2] = {
+                {"#version 410\n", "#version 430\n"},
+                {"#version 300 es\n", "#version 310 es\n"},
+            };
+
+            shaderCode += versions[isOpenGLES][isCompute];
+        }
+    }
+
+    static const char* shaderTypeDefines[] = {
+        "#define COMPILEVS\n", // VS
+        "#define COMPILEPS\n", // PS
+        "#define COMPILEGS\n", // GS
+        "#define COMPILEHS\n", // HS
+        "#define COMPILEDS\n", // DS
+        "#define COMPILECS\n", // CS
+    };
+    shaderCode += shaderTypeDefines[type];
+
+    shaderCode += Format("#define URHO3D_{}\n", ToString(backend_).to_upper());
+
+    // Prepend the defines to the shader code
+    const StringVector defineVec = defines.split(' ');
+    for (const ea::string& define : defineVec)
+    {
+        const ea::string defineString = "#define " + define.replaced('=', ' ') + " \n";
+        shaderCode += defineString;
+    }
+
+    // When version define found, do not insert it a second time
+    if (!versionTag)
+        shaderCode += originalSource;
+    else
+    {
+        shaderCode += originalSource.substr(0, versionTag->first);
+        shaderCode += "//";
+        shaderCode += originalSource.substr(versionTag->first);
+    }
+
+    return shaderCode;
+}
+
+unsigned long long ShaderVariationCompiler::GetContentHash(ea::string_view preparedSource) const
+{
+    const unsigned settings[] = {static_cast<unsigned>(backend_), static_cast<unsigned>(translationPolicy_),
+        static_cast<unsigned>(GetTargetShaderLanguage(backend_))};
+
+    unsigned long long hash = 14695981039346656037ull;
+    hash = HashBytes(hash, ToByteSpan(ea::span<const unsigned>(settings)));
+    hash = HashBytes(hash, ToByteSpan(preparedSource));
+    return hash;
+}
+
+ea::string ShaderVariationCompiler::GetCachedFileName(ea::string_view shortShaderName, ShaderType type,
+    unsigned long long contentHash, ea::string_view extension) const
+{
+    const ea::string backendName = ToString(backend_).to_lower();
+    const ea::string shaderTypeName = ToString(type).to_lower();
+    return Format("{}_{}_{:016x}_{}.{}", shortShaderName, shaderTypeName, contentHash, backendName, extension);
+}
+
+ea::string ShaderVariationCompiler::GetBytecodeMIME() const
+{
+    switch (backend_)
+    {
+    case RenderBackend::D3D11:
+    case RenderBackend::D3D12: //
+        return "application/hlsl-bin";
+    case RenderBackend::Vulkan: //
+        return "application/spirv";
+    case RenderBackend::OpenGL: return "application/glsl";
+    default: //
+        URHO3D_ASSERT(0);
+        return "";
+    };
+}
+
+bool ShaderVariationCompiler::Compile(ShaderBytecode& bytecode, ea::string& translatedSource, ShaderType type,
+    ea::string_view preparedSource, ea::string_view debugName) const
+{
+    translatedSource = preparedSource;
+    ConstByteSpan translatedBytecode = ToByteSpan(preparedSource);
+    const SpirVShader* translatedSpirv{};
+
+#ifdef URHO3D_SHADER_TRANSLATOR
+    const TargetShaderLanguage targetShaderLanguage = GetTargetShaderLanguage(backend_);
+    if (translationPolicy_ != ShaderTranslationPolicy::Verbatim)
+    {
+        static thread_local SpirVShader spirvShader;
+        ParseUniversalShader(spirvShader, type, preparedSource, {}, targetShaderLanguage);
+        if (!spirvShader)
+        {
+            URHO3D_LOGERROR("Failed to convert shader {} from GLSL to SPIR-V:\n{}{}", debugName,
+                Shader::GetShaderFileList(), spirvShader.compilerOutput_);
+            return false;
+        }
+
+        translatedSpirv = &spirvShader;
+
+    #ifdef URHO3D_SHADER_OPTIMIZER
+        if (translationPolicy_ == ShaderTranslationPolicy::Optimize)
+        {
+            ea::string optimizerOutput;
+            if (!OptimizeSpirVShader(spirvShader, optimizerOutput, targetShaderLanguage))
+            {
+                URHO3D_LOGERROR("Failed to optimize SPIR-V shader {}:\n{}", debugName, optimizerOutput);
+                return false;
+            }
+        }
+    #endif
+
+        // Vulkan uses SPIRV directly
+        if (targetShaderLanguage == TargetShaderLanguage::VULKAN_1_0)
+        {
+            translatedBytecode = ToByteSpan(spirvShader.bytecode_);
+        }
+        else
+        {
+            // Translate to target language
+            static thread_local TargetShader targetShader;
+            TranslateSpirVShader(targetShader, spirvShader, targetShaderLanguage);
+            if (!targetShader)
+            {
+                URHO3D_LOGERROR("Failed to convert shader {} from SPIR-V to HLSL:\n{}{}", debugName,
+                    Shader::GetShaderFileList(), targetShader.compilerOutput_);
+                return false;
+            }
+
+            translatedSource = targetShader.sourceCode_;
+            if (backend_ == RenderBackend::D3D11 || backend_ == RenderBackend::D3D12)
+            {
+                // On D3D backends, compile the translated source code
+                static thread_local ByteVector hlslBytecode;
+                ea::string compilerOutput;
+                if (!CompileHLSLToBinary(hlslBytecode, compilerOutput, targetShader.sourceCode_, type))
+                {
+                    URHO3D_LOGERROR("Failed to compile HLSL shader {}:\n{}{}", debugName,
+                        Shader::GetShaderFileList(), compilerOutput);
+                    return false;
+                }
+
+                translatedBytecode = hlslBytecode;
+            }
+            else
+            {
+                // On OpenGL backends, just store the translated source code
+                translatedBytecode = ToByteSpan(targetShader.sourceCode_);
+            }
+        }
+    }
+#endif
+
+    bytecode.type_ = type;
+    bytecode.mime_ = GetBytecodeMIME();
+    bytecode.bytecode_.assign(translatedBytecode.begin(), translatedBytecode.end());
+    bytecode.vertexAttributes_.clear();
+    if (translatedSpirv && type == VS)
+        bytecode.vertexAttributes_ = GetVertexAttributesFromSpirV(*translatedSpirv);
+    return true;
+}
+
+} // namespace Urho3D
@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "Urho3D/Container/Hash.h"
+#include "Urho3D/Graphics/GraphicsDefs.h"
+#include "Urho3D/RenderAPI/RenderAPIDefs.h"
+#include "Urho3D/RenderAPI/ShaderBytecode.h"
+
+#include <EASTL/string.h>
+
+namespace Urho3D
+{
+
+class Archive;
+
+/// Description of shader variation used to record and warm up shaders.
+struct URHO3D_API ShaderVariationDesc
+{
+    /// Shader type.
+    ShaderType type_{};
+    /// Resource name of the shader.
+    ea::string shaderName_;
+    /// Normalized defines of the variation.
+    ea::string defines_;
+
+    void SerializeInBlock(Archive& archive);
+
+    /// Operators.
+    /// @{
+    auto Tie() const { return ea::tie(type_, shaderName_, defines_); }
+
+    bool operator==(const ShaderVariationDesc& rhs) const { return Tie() == rhs.Tie(); }
+    bool operator!=(const ShaderVariationDesc& rhs) const { return Tie() != rhs.Tie(); }
+    unsigned ToHash() const { return MakeHash(Tie()); }
+    /// @}
+};
+
+/// Compiles shader variations to bytecode for specific render backend.
+/// Doesn't depend on render device and may be used from any thread.
+struct URHO3D_API ShaderVariationCompiler
+{
+    RenderBackend backend_{};
+    ShaderTranslationPolicy translationPolicy_{};
+
+    /// Prepare shader source code for compilation: add version tag, shader type and defines.
+    ea::string PrepareSource(ShaderType type, const ea::string& defines, const ea::string& originalSource) const;
+    /// Return hash of prepared source code and compilation settings. Used as the key of cached bytecode.
+    unsigned long long GetContentHash(ea::string_view preparedSource) const;
+    /// Return name of the cached file for prepared source with given content hash.
+    ea::string GetCachedFileName(ea::string_view shortShaderName, ShaderType type, unsigned long long contentHash,
+        ea::string_view extension) const;
+    /// Return MIME type of compiled bytecode.
+    ea::string GetBytecodeMIME() const;
+
+    /// Compile prepared source code to bytecode. Translated source code is returned for logging, if any.
+    bool Compile(ShaderBytecode& bytecode, ea::string& translatedSource, ShaderType type,
+        ea::string_view preparedSource, ea::string_view debugName) const;
+};
+
+} // namespace Urho3D
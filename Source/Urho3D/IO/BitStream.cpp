@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/BitStream.h"
+
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+BitWriter::BitWriter(Serializer& dest)
+    : dest_(dest)
+{
+}
+
+BitWriter::~BitWriter()
+{
+    URHO3D_ASSERT(numBufferedBits_ == 0, "BitWriter should be flushed before destruction");
+}
+
+void BitWriter::WriteBits(unsigned value, unsigned numBits)
+{
+    URHO3D_ASSERT(numBits <= 32);
+    if (numBits == 0)
+        return;
+
+    const unsigned long long mask = (1ull << numBits) - 1;
+    buffer_ |= (value & mask) << numBufferedBits_;
+    numBufferedBits_ += numBits;
+    numBitsWritten_ += numBits;
+
+    while (numBufferedBits_ >= 8)
+    {
+        dest_.WriteUByte(static_cast<unsigned char>(buffer_ & 0xff));
+        buffer_ >>= 8;
+        numBufferedBits_ -= 8;
+    }
+}
+
+void BitWriter::WriteVarBits(unsigned value)
+{
+    const unsigned numBits = GetNumBitsForRange(value);
+    // Width is in range [0, 32], zero width is also used for value 1 to fit into 5 bits
+    if (numBits <= 1)
+    {
+        WriteBits(0, 5);
+        WriteBits(value, 1);
+    }
+    else
+    {
+        WriteBits(numBits - 1, 5);
+        // The most significant bit is implied
+        WriteBits(value, numBits - 1);
+    }
+}
+
+void BitWriter::Flush()
+{
+    if (numBufferedBits_ > 0)
+    {
+        dest_.WriteUByte(static_cast<unsigned char>(buffer_ & 0xff));
+        numBitsWritten_ += 8 - numBufferedBits_;
+    }
+    buffer_ = 0;
+    numBufferedBits_ = 0;
+}
+
+BitReader::BitReader(Deserializer& src)
+    : src_(src)
+{
+}
+
+unsigned BitReader::ReadBits(unsigned numBits)
+{
+    URHO3D_ASSERT(numBits <= 32);
+    if (numBits == 0)
+        return 0;
+
+    while (numBufferedBits_ < numBits)
+    {
+        const unsigned long long byte = src_.IsEof() ? 0 : src_.ReadUByte();
+        buffer_ |= byte << numBufferedBits_;
+        numBufferedBits_ += 8;
+    }
+
+    const unsigned long long mask = (1ull << numBits) - 1;
+    const auto value = static_cast<unsigned>(buffer_ & mask);
+    buffer_ >>= numBits;
+    numBufferedBits_ -= numBits;
+    return value;
+}
+
+unsigned BitReader::ReadVarBits()
+{
+    const unsigned width = ReadBits(5);
+    if (width == 0)
+        return ReadBits(1);
+
+    const unsigned numBits = width + 1;
+    return (1u << (numBits - 1)) | ReadBits(numBits - 1);
+}
+
+}
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/NonCopyable.h"
+
+#include <Urho3D/Urho3D.h>
+
+namespace Urho3D
+{
+
+class Deserializer;
+class Serializer;
+
+/// Writes values of arbitrary bit width to Serializer. Bits are written starting from the least significant.
+/// Call Flush to write the last incomplete byte.
+/// @nobind
+class URHO3D_API BitWriter : public NonCopyable
+{
+public:
+    explicit BitWriter(Serializer& dest);
+    ~BitWriter();
+
+    /// Write lower bits of the value. Up to 32 bits can be written at once.
+    void WriteBits(unsigned value, unsigned numBits);
+    /// Write a bool as single bit.
+    void WriteBool(bool value) { WriteBits(value ? 1u : 0u, 1); }
+    /// Write signed value as zigzag-encoded lower bits.
+    void WriteSignedBits(int value, unsigned numBits) { WriteBits(EncodeZigZag(value), numBits); }
+    /// Write unsigned value of unknown magnitude using as few bits as possible: 5 bits of width followed by value.
+    void WriteVarBits(unsigned value);
+    /// Write signed value of unknown magnitude using as few bits as possible.
+    void WriteSignedVarBits(int value) { WriteVarBits(EncodeZigZag(value)); }
+    /// Write buffered bits to the destination, padding the last byte with zeros.
+    void Flush();
+
+    /// Return total number of bits written.
+    unsigned GetNumBitsWritten() const { return numBitsWritten_; }
+
+    static unsigned EncodeZigZag(int value) { return (static_cast<unsigned>(value) << 1) ^ static_cast<unsigned>(value >> 31); }
+
+private:
+    Serializer& dest_;
+    unsigned long long buffer_{};
+    unsigned numBufferedBits_{};
+    unsigned numBitsWritten_{};
+};
+
+/// Reads values written by BitWriter from Deserializer.
+/// Bytes are read from the source only when needed, so reader doesn't consume data after the last flushed byte.
+/// @nobind
+class URHO3D_API BitReader : public NonCopyable
+{
+public:
+    explicit BitReader(Deserializer& src);
+
+    /// Read unsigned value of given bit width. Up to 32 bits can be read at once.
+    unsigned ReadBits(unsigned numBits);
+    /// Read a bool stored as single bit.
+    bool ReadBool() { return ReadBits(1) != 0; }
+    /// Read zigzag-encoded signed value.
+    int ReadSignedBits(unsigned numBits) { return DecodeZigZag(ReadBits(numBits)); }
+    /// Read value written by WriteVarBits.
+    unsigned ReadVarBits();
+    /// Read value written by WriteSignedVarBits.
+    int ReadSignedVarBits() { return DecodeZigZag(ReadVarBits()); }
+
+    static int DecodeZigZag(unsigned value) { return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1); }
+
+private:
+    Deserializer& src_;
+    unsigned long long buffer_{};
+    unsigned numBufferedBits_{};
+};
+
+/// Return number of bits needed to store values in range [0, maxValue].
+inline unsigned GetNumBitsForRange(unsigned maxValue)
+{
+    unsigned numBits = 0;
+    while (numBits < 32 && (maxValue >> numBits) != 0)
+        ++numBits;
+    return numBits;
+}
+
+}
@@ -24,10 +24,12 @@
 
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
 #include "../Core/Thread.h"
 #include "../Core/Timer.h"
 #include "../IO/IOEvents.h"
 #include "../IO/Log.h"
+#include "../Math/MathDefs.h"
 
 #include <spdlog/spdlog.h>
 #include <spdlog/logger.h>
@@ -41,6 +43,8 @@
 #endif
 #include <spdlog/details/null_mutex.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <cstdio>
 
@@ -61,6 +65,14 @@ namespace Urho3D
 namespace
 {
 
+/// Max number of messages waiting for the writer thread.
+const unsigned LOG_QUEUE_SIZE = 8192;
+/// Max size of message text stored in the queue. Queue slots keep their capacity, so longer messages are not queued.
+const unsigned LOG_MAX_QUEUED_MESSAGE_SIZE = 4096;
+
+/// Whether the current thread is the log writer thread.
+thread_local bool isLogWriterThread = false;
+
 class DuplicateFilterSink : public spdlog::sinks::dist_sink_mt
 {
 public:
@@ -142,6 +154,248 @@ private:
     ea::vector<MessageInfo> lastMessages_;
 };
 
+/// Sink that passes messages to the writer thread via bounded lock-free queue.
+/// Messages from the main thread are forwarded to events immediately, the rest are forwarded by the writer thread.
+/// If the queue is full, the message is dropped. Messages are written synchronously if the writer thread is not running.
+/// Errors block the caller until they are written and flushed, and are never dropped.
+/// Long messages and messages logged by the writer thread itself are written synchronously.
+class AsyncLogSink : public spdlog::sinks::sink, public Thread
+{
+public:
+    AsyncLogSink(std::shared_ptr<spdlog::sinks::sink> outputSink, std::shared_ptr<spdlog::sinks::sink> eventSink,
+        unsigned queueSize)
+        : Thread("LogWriter")
+        , outputSink_(ea::move(outputSink))
+        , eventSink_(ea::move(eventSink))
+        , slots_(NextPowerOfTwo(queueSize))
+        , queueMask_(slots_.size() - 1)
+    {
+        for (unsigned i = 0; i < slots_.size(); ++i)
+            slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+
+    ~AsyncLogSink() override { Shutdown(); }
+
+    void log(const spdlog::details::log_msg& msg) override
+    {
+        const bool isMainThread = Thread::IsMainThread();
+        if (isMainThread)
+            eventSink_->log(msg);
+
+        if (!IsStarted() || isLogWriterThread)
+        {
+            WriteImmediately(msg, isMainThread);
+            return;
+        }
+
+        // Write messages queued before to keep the order
+        if (msg.payload.size() > LOG_MAX_QUEUED_MESSAGE_SIZE)
+        {
+            WaitForQueue();
+            WriteImmediately(msg, isMainThread);
+            return;
+        }
+
+        // Errors are written before returning, the application may be about to exit
+        const bool isError = msg.level >= spdlog::level::err;
+        if (!Push(msg, isMainThread))
+        {
+            if (isError)
+            {
+                WriteImmediately(msg, isMainThread);
+                return;
+            }
+
+            numDroppedMessages_.fetch_add(1, std::memory_order_relaxed);
+            numDroppedSinceReport_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // Writer thread may have checked the queue before the message was published
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writerSleeping_.load(std::memory_order_relaxed))
+            WakeWriter();
+
+        // Writer thread flushes the output after each batch with errors
+        if (isError)
+            WaitForQueue();
+    }
+
+    void flush() override { outputSink_->flush(); }
+    void set_pattern(const std::string& pattern) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter> sinkFormatter) override {}
+
+    void ThreadFunction() override
+    {
+        URHO3D_PROFILE_THREAD("LogWriter");
+        isLogWriterThread = true;
+
+        while (shouldRun_)
+        {
+            if (WriteMessages())
+                continue;
+
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            writerSleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // Timeout is a safety net, the writer is woken up explicitly
+            if (shouldRun_ && !HasMessages())
+                wakeCondition_.wait_for(lock, std::chrono::milliseconds(100));
+            writerSleeping_.store(false, std::memory_order_relaxed);
+        }
+
+        WriteMessages();
+    }
+
+    /// Write all queued messages and stop the writer thread.
+    void Shutdown()
+    {
+        shouldRun_ = false;
+        WakeWriter();
+        Stop();
+    }
+
+    /// Wait until all messages queued so far are written. Does nothing if called from the writer thread.
+    void WaitForQueue()
+    {
+        if (isLogWriterThread)
+            return;
+
+        const unsigned enqueuePosition = enqueuePosition_.load(std::memory_order_acquire);
+        while (IsStarted() && static_cast<int>(enqueuePosition - writtenPosition_.load(std::memory_order_acquire)) > 0)
+        {
+            WakeWriter();
+            Time::Sleep(1);
+        }
+    }
+
+    unsigned GetNumDroppedMessages() const { return numDroppedMessages_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::atomic<unsigned> sequence_{};
+        spdlog::level::level_enum level_{};
+        spdlog::log_clock::time_point time_{};
+        size_t threadId_{};
+        bool fromMainThread_{};
+        ea::string logger_;
+        ea::string payload_;
+    };
+
+    /// Write message from the calling thread.
+    void WriteImmediately(const spdlog::details::log_msg& msg, bool fromMainThread)
+    {
+        outputSink_->log(msg);
+        if (msg.level >= spdlog::level::err)
+            outputSink_->flush();
+        if (!fromMainThread)
+            eventSink_->log(msg);
+    }
+
+    bool Push(const spdlog::details::log_msg& msg, bool fromMainThread)
+    {
+        unsigned position = enqueuePosition_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true)
+        {
+            slot = &slots_[position & queueMask_];
+            const unsigned sequence = slot->sequence_.load(std::memory_order_acquire);
+            const int delta = static_cast<int>(sequence - position);
+            if (delta == 0)
+            {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (delta < 0)
+                return false;
+            else
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+        }
+
+        // String capacity of the slot is reused by later messages
+        slot->level_ = msg.level;
+        slot->time_ = msg.time;
+        slot->threadId_ = msg.thread_id;
+        slot->fromMainThread_ = fromMainThread;
+        slot->logger_.assign(msg.logger_name.data(), msg.logger_name.size());
+        slot->payload_.assign(msg.payload.data(), msg.payload.size());
+        slot->sequence_.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool HasMessages() const
+    {
+        const Slot& slot = slots_[dequeuePosition_ & queueMask_];
+        return slot.sequence_.load(std::memory_order_acquire) == dequeuePosition_ + 1;
+    }
+
+    /// Write available messages in one batch. Return whether anything was written.
+    bool WriteMessages()
+    {
+        if (const unsigned numDropped = numDroppedSinceReport_.exchange(0, std::memory_order_relaxed))
+        {
+            char buf[64];
+            const auto msgSize = ::snprintf(buf, sizeof(buf), "Dropped %u log messages..", numDropped);
+            const spdlog::details::log_msg droppedMsg{"main", spdlog::level::warn,
+                spdlog::string_view_t{buf, static_cast<size_t>(msgSize)}};
+            outputSink_->log(droppedMsg);
+            eventSink_->log(droppedMsg);
+        }
+
+        bool hasErrors = false;
+        unsigned numMessages = 0;
+        while (HasMessages())
+        {
+            Slot& slot = slots_[dequeuePosition_ & queueMask_];
+
+            spdlog::details::log_msg msg{slot.time_, spdlog::source_loc{},
+                spdlog::string_view_t{slot.logger_.data(), slot.logger_.size()}, slot.level_,
+                spdlog::string_view_t{slot.payload_.data(), slot.payload_.size()}};
+            msg.thread_id = slot.threadId_;
+
+            outputSink_->log(msg);
+            if (!slot.fromMainThread_)
+                eventSink_->log(msg);
+            hasErrors |= slot.level_ >= spdlog::level::err;
+
+            slot.sequence_.store(dequeuePosition_ + slots_.size(), std::memory_order_release);
+            ++dequeuePosition_;
+            ++numMessages;
+        }
+
+        // Errors are flushed immediately in case the application is about to crash
+        if (hasErrors)
+            outputSink_->flush();
+
+        writtenPosition_.store(dequeuePosition_, std::memory_order_release);
+        return numMessages > 0;
+    }
+
+    void WakeWriter()
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeCondition_.notify_one();
+    }
+
+    const std::shared_ptr<spdlog::sinks::sink> outputSink_;
+    const std::shared_ptr<spdlog::sinks::sink> eventSink_;
+
+    ea::vector<Slot> slots_;
+    const unsigned queueMask_{};
+    std::atomic<unsigned> enqueuePosition_{};
+    /// Accessed only by the writer thread.
+    unsigned dequeuePosition_{};
+    std::atomic<unsigned> writtenPosition_{};
+
+    std::atomic<unsigned> numDroppedMessages_{};
+    std::atomic<unsigned> numDroppedSinceReport_{};
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCondition_;
+    std::atomic<bool> writerSleeping_{};
+};
+
 }
 
 static Log* GetLog()
@@ -319,13 +573,19 @@ public:
         platformSink_ = std::make_shared<spdlog::sinks::stdout_sink_mt>();
 #endif
         distributorSink_->add_sink(platformSink_);
-        distributorSink_->add_sink(std::make_shared<MessageForwarderSink_mt>());
 
         dupFilterSink_ = std::make_shared<DuplicateFilterSink>(
             std::chrono::seconds(5), spdlog::level::err, 10);
         dupFilterSink_->add_sink(distributorSink_);
 
-        mainSink_ = dupFilterSink_;
+        eventSink_ = std::make_shared<DuplicateFilterSink>(
+            std::chrono::seconds(5), spdlog::level::err, 10);
+        eventSink_->add_sink(std::make_shared<MessageForwarderSink_mt>());
+
+        asyncSink_ = std::make_shared<AsyncLogSink>(dupFilterSink_, eventSink_, LOG_QUEUE_SIZE);
+        asyncSink_->Run();
+
+        mainSink_ = asyncSink_;
     }
 
 #ifdef __ANDROID__
@@ -351,6 +611,10 @@ public:
     std::shared_ptr<spdlog::sinks::dist_sink_mt> distributorSink_;
     /// Sink that filters out duplicate messages.
     std::shared_ptr<DuplicateFilterSink> dupFilterSink_;
+    /// Sink that sends log message events, filtering out duplicate messages.
+    std::shared_ptr<DuplicateFilterSink> eventSink_;
+    /// Sink that writes messages on the writer thread.
+    std::shared_ptr<AsyncLogSink> asyncSink_;
 
     /// Sink that should be used for logging.
     std::shared_ptr<spdlog::sinks::sink> mainSink_;
@@ -372,6 +636,7 @@ Log::Log(Context* context) :
 
 Log::~Log()
 {
+    impl_->asyncSink_->Shutdown();
     spdlog::shutdown();
 }
 
@@ -384,6 +649,7 @@ void Log::Open(const ea::string& fileName)
     if (fileName == NULL_DEVICE)
         return;
 
+    // Messages queued so far are written to the old file
     Close();
 
     impl_->fileSink_ = std::make_shared<spdlog::sinks::basic_file_sink_mt>(fileName.c_str());
@@ -397,6 +663,7 @@ void Log::Close()
 #if defined(DESKTOP)
     if (impl_->fileSink_)
     {
+        Flush();
         impl_->distributorSink_->remove_sink(impl_->fileSink_);
         impl_->fileSink_ = nullptr;
     }
@@ -435,6 +702,17 @@ void Log::SetLogFormat(const ea::string& format)
 #endif
 }
 
+void Log::Flush()
+{
+    impl_->asyncSink_->WaitForQueue();
+    impl_->asyncSink_->flush();
+}
+
+unsigned Log::GetNumDroppedMessages() const
+{
+    return impl_->asyncSink_->GetNumDroppedMessages();
+}
+
 Logger Log::GetLogger(const ea::string& name)
 {
     // Loggers may be used only after initializing Log subsystem, therefore do not use logging from static initializers.
@@ -533,15 +811,16 @@ void Log::PumpThreadMessages()
         return;
     }
 
-    MutexLock lock(logMutex_);
+    // Don't block the writer thread while event handlers are running
+    ea::list<StoredLogMessage> threadMessages;
+    {
+        MutexLock lock(logMutex_);
+        threadMessages.swap(threadMessages_);
+    }
 
     // Process messages accumulated from other threads (if any)
-    while (!threadMessages_.empty())
-    {
-        const StoredLogMessage& stored = threadMessages_.front();
+    for (const StoredLogMessage& stored : threadMessages)
         SendMessageEvent(stored.level_, stored.timestamp_, stored.logger_, stored.message_);
-        threadMessages_.pop_front();
-    }
 }
 
 }
@@ -151,7 +151,7 @@ public:
 
     /// Open the log file.
     void Open(const ea::string& fileName);
-    /// Close the log file.
+    /// Close the log file. Messages queued so far are written first.
     void Close();
     /// Set logging level.
     /// @property
@@ -163,9 +163,14 @@ public:
     /// @property
     void SetQuiet(bool quiet);
 
+    /// Wait until all queued messages are written and flush the log file.
+    void Flush();
+
     /// Return logging level.
     /// @property
     LogLevel GetLevel() const { return level_; }
+    /// Return number of messages dropped because the writer thread could not keep up.
+    unsigned GetNumDroppedMessages() const;
 
     /// Return whether log is in quiet mode (only errors printed to standard error stream).
     /// @property
@@ -26,6 +26,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
@@ -57,12 +58,7 @@ namespace Urho3D
 
 static const int DEFAULT_MAX_OBSTACLES = 1024;
 static const int DEFAULT_MAX_LAYERS = 16;
-
-struct DynamicNavigationMesh::TileCacheData
-{
-    unsigned char* data;
-    int dataSize;
-};
+static const unsigned DEFAULT_ALLOCATOR_SIZE = 32 * 1024;
 
 struct TileCompressor : public dtTileCacheCompressor
 {
@@ -216,7 +212,7 @@ DynamicNavigationMesh::DynamicNavigationMesh(Context* context) :
     maxLayers_(DEFAULT_MAX_LAYERS)
 {
     partitionType_ = NAVMESH_PARTITION_MONOTONE;
-    allocator_ = ea::make_unique<LinearAllocator>(32 * 1024);
+    allocator_ = ea::make_unique<LinearAllocator>(DEFAULT_ALLOCATOR_SIZE);
     compressor_ = ea::make_unique<TileCompressor>();
     meshProcessor_ = ea::make_unique<MeshProcess>(this);
 }
@@ -234,6 +230,7 @@ void DynamicNavigationMesh::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Max Obstacles", GetMaxObstacles, SetMaxObstacles, unsigned, DEFAULT_MAX_OBSTACLES, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Max Layers", GetMaxLayers, SetMaxLayers, unsigned, DEFAULT_MAX_LAYERS, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Draw Obstacles", GetDrawObstacles, SetDrawObstacles, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Obstacle Update Budget", GetObstacleUpdateBudget, SetObstacleUpdateBudget, float, 0.0f, AM_DEFAULT);
 }
 
 bool DynamicNavigationMesh::AllocateMesh(unsigned maxTiles)
@@ -561,21 +558,17 @@ bool DynamicNavigationMesh::ReadTiles(Deserializer& source, bool silent)
     return true;
 }
 
-int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles)
+bool DynamicNavigationMesh::BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, PendingTile& tile)
 {
     URHO3D_PROFILE("BuildNavigationMeshTile");
 
-    const dtMeshTile* tilesToRemove[MaxLayers];
-    const int numTilesToRemove = navMesh_->getTilesAt(x, z, tilesToRemove, MaxLayers);
-    for (int i = 0; i < numTilesToRemove; ++i)
-    {
-        const dtTileRef tileRef = navMesh_->getTileRefAt(x, z, tilesToRemove[i]->header->layer);
-        tileCache_->removeTile(tileRef, nullptr, nullptr);
-    }
+    const int x = tile.index_.x_;
+    const int z = tile.index_.y_;
 
-    const BoundingBox tileColumn = GetTileBoundingBoxColumn(IntVector2{x, z});
+    const BoundingBox tileColumn = GetTileBoundingBoxColumn(tile.index_);
     const BoundingBox tileBoundingBox =
         IsHeightRangeValid() ? tileColumn : CalculateTileBoundingBox(geometryList, tileColumn);
+    tile.boundingBox_ = tileBoundingBox;
 
     DynamicNavBuildData build(allocator_.get());
 
@@ -612,20 +605,20 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
     GetTileGeometry(&build, geometryList, expandedBox);
 
     if (build.vertices_.empty() || build.indices_.empty())
-        return 0; // Nothing to do
+        return false; // Nothing to do
 
     build.heightField_ = rcAllocHeightfield();
     if (!build.heightField_)
     {
         URHO3D_LOGERROR("Could not allocate heightfield");
-        return 0;
+        return false;
     }
 
     if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
         cfg.ch))
     {
         URHO3D_LOGERROR("Could not create heightfield");
-        return 0;
+        return false;
     }
 
     unsigned numTriangles = build.indices_.size() / 3;
@@ -645,18 +638,18 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
     if (!build.compactHeightField_)
     {
         URHO3D_LOGERROR("Could not allocate create compact heightfield");
-        return 0;
+        return false;
     }
     if (!rcBuildCompactHeightfield(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_,
         *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not build compact heightfield");
-        return 0;
+        return false;
     }
     if (!rcErodeWalkableArea(build.ctx_, cfg.walkableRadius, *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not erode compact heightfield");
-        return 0;
+        return false;
     }
 
     // area volumes
@@ -669,13 +662,13 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
         if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
         {
             URHO3D_LOGERROR("Could not build distance field");
-            return 0;
+            return false;
         }
         if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea,
             cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build regions");
-            return 0;
+            return false;
         }
     }
     else
@@ -683,7 +676,7 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
         if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build monotone regions");
-            return 0;
+            return false;
         }
     }
 
@@ -691,17 +684,16 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
     if (!build.heightFieldLayers_)
     {
         URHO3D_LOGERROR("Could not allocate height field layer set");
-        return 0;
+        return false;
     }
 
     if (!rcBuildHeightfieldLayers(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.walkableHeight,
         *build.heightFieldLayers_))
     {
         URHO3D_LOGERROR("Could not build height field layers");
-        return 0;
+        return false;
     }
 
-    int retCt = 0;
     for (int i = 0; i < build.heightFieldLayers_->nlayers; ++i)
     {
         dtTileCacheLayerHeader header;      // NOLINT(hicpp-member-init)
@@ -725,68 +717,75 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
         header.hmin = (unsigned short)layer->hmin;
         header.hmax = (unsigned short)layer->hmax;
 
+        unsigned char* data = nullptr;
+        int dataSize = 0;
         if (dtStatusFailed(
             dtBuildTileCacheLayer(compressor_.get()/*compressor*/, &header, layer->heights, layer->areas/*areas*/, layer->cons,
-                &(tiles[retCt].data), &tiles[retCt].dataSize)))
+                &data, &dataSize)))
         {
             URHO3D_LOGERROR("Failed to build tile cache layers");
-            return 0;
+            for (const auto& [layerData, _] : tile.data_)
+                dtFree(layerData);
+            tile.data_.clear();
+            return false;
         }
         else
-            ++retCt;
+            tile.data_.emplace_back(data, dataSize);
     }
 
-    // Send a notification of the rebuild of this tile to anyone interested
+    return true;
+}
+
+unsigned DynamicNavigationMesh::AddPendingTile(PendingTile& tile)
+{
+    const int x = tile.index_.x_;
+    const int z = tile.index_.y_;
+
+    dtCompressedTileRef existing[MaxLayers];
+    const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
+    for (int i = 0; i < existingCt; ++i)
     {
-        using namespace NavigationAreaRebuilt;
-        VariantMap& eventData = GetContext()->GetEventDataMap();
-        eventData[P_NODE] = GetNode();
-        eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
-        SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
+        unsigned char* data = nullptr;
+        if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, nullptr)) && data != nullptr)
+            dtFree(data);
     }
 
-    return retCt;
-}
+    const dtMeshTile* tilesToRemove[MaxLayers];
+    const int numTilesToRemove = navMesh_->getTilesAt(x, z, tilesToRemove, MaxLayers);
+    for (int i = 0; i < numTilesToRemove; ++i)
+    {
+        const dtTileRef tileRef = navMesh_->getTileRefAt(x, z, tilesToRemove[i]->header->layer);
+        tileCache_->removeTile(tileRef, nullptr, nullptr);
+    }
 
-unsigned DynamicNavigationMesh::BuildTilesFromGeometry(
-    ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
-{
-    unsigned numTiles = 0;
+    if (!tile.success_)
+        return 0;
 
-    for (int z = from.y_; z <= to.y_; ++z)
+    unsigned numTiles = 0;
+    for (auto& [data, dataSize] : tile.data_)
     {
-        for (int x = from.x_; x <= to.x_; ++x)
+        dtCompressedTileRef tileRef;
+        int status = tileCache_->addTile(data, dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
+        if (dtStatusFailed((dtStatus)status))
+            dtFree(data);
+        else
         {
-            dtCompressedTileRef existing[MaxLayers];
-            const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
-            for (int i = 0; i < existingCt; ++i)
-            {
-                unsigned char* data = nullptr;
-                if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, nullptr)) && data != nullptr)
-                    dtFree(data);
-            }
-
-            TileCacheData tiles[MaxLayers];
-            int layerCt = BuildTile(geometryList, x, z, tiles);
-            for (int i = 0; i < layerCt; ++i)
-            {
-                dtCompressedTileRef tileRef;
-                int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                if (dtStatusFailed((dtStatus)status))
-                {
-                    dtFree(tiles[i].data);
-                    tiles[i].data = nullptr;
-                }
-                else
-                {
-                    tileCache_->buildNavMeshTile(tileRef, navMesh_);
-                    ++numTiles;
-                }
-            }
+            tileCache_->buildNavMeshTile(tileRef, navMesh_);
+            ++numTiles;
         }
     }
+    tile.data_.clear();
+
+    // Send a notification of the rebuild of this tile to anyone interested
+    {
+        using namespace NavigationAreaRebuilt;
+        VariantMap& eventData = GetContext()->GetEventDataMap();
+        eventData[P_NODE] = GetNode();
+        eventData[P_MESH] = this;
+        eventData[P_BOUNDSMIN] = Variant(tile.boundingBox_.min_);
+        eventData[P_BOUNDSMAX] = Variant(tile.boundingBox_.max_);
+        SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
+    }
 
     return numTiles;
 }
@@ -821,17 +820,78 @@ void DynamicNavigationMesh::ReleaseTileCache()
     tileCache_ = nullptr;
 }
 
-void DynamicNavigationMesh::UpdateTileCache()
+bool DynamicNavigationMesh::IsObstacleUpdateComplete() const
+{
+    return !tileCache_ || tileCache_->isUpToDate();
+}
+
+void DynamicNavigationMesh::UpdateTileCache(float maxTime)
 {
-    bool upToDate = false;
+    if (tileCache_->isUpToDate())
+        return;
+
+    URHO3D_PROFILE("UpdateTileCache");
+
+    auto workQueue = GetSubsystem<WorkQueue>();
+    const unsigned batchSize = workQueue->GetNumProcessingThreads();
+    while (workerAllocators_.size() < batchSize)
+        workerAllocators_.push_back(ea::make_unique<LinearAllocator>(DEFAULT_ALLOCATOR_SIZE));
+
+    ea::vector<dtCompressedTileRef> tiles(batchSize);
+    ea::vector<dtTileCachePolyMesh*> meshes(batchSize);
+
+    // Positive budget is never rounded down to zero, which would mean unlimited
+    const bool isUnlimited = maxTime <= 0.0f;
+    const long long maxTimeUSec = isUnlimited ? 0 : ea::max(1LL, static_cast<long long>(ceilf(maxTime * 1000.0f)));
+
+    HiresTimer timer;
     do
     {
-        tileCache_->update(0, navMesh_, &upToDate);
-    } while (!upToDate);
+        const int numTiles = tileCache_->getPendingTiles(tiles.data(), batchSize);
+        if (numTiles == 0)
+            break;
+
+        // Build tiles in worker threads, navigation mesh and tile cache are not modified at this point
+        ForEachParallel(workQueue, 1u, static_cast<unsigned>(numTiles),
+            [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                workerAllocators_[i]->reset();
+                tileCache_->buildTilePolyMesh(tiles[i], workerAllocators_[i].get(), &meshes[i]);
+            }
+        });
+
+        // Commit tiles in the main thread in the same order as they would be updated by the tile cache
+        for (int i = 0; i < numTiles; ++i)
+        {
+            tileCache_->commitTilePolyMesh(tiles[i], meshes[i], navMesh_);
+            dtFreeTileCachePolyMesh(workerAllocators_[i].get(), meshes[i]);
+        }
+        numRebuiltTilesInFrame_ += numTiles;
+    } while (isUnlimited || timer.GetUSec(false) < maxTimeUSec);
+    updateTimeInFrame_ += timer.GetUSec(false);
+
+    if (latencyPending_ && tileCache_->isUpToDate())
+    {
+        latencyPending_ = false;
+        updateStats_.rebuildLatency_ = latencyTimer_.GetUSec(false) / 1000.0f;
+    }
+}
+
+void DynamicNavigationMesh::MarkObstacleChanged()
+{
+    if (!latencyPending_)
+    {
+        latencyPending_ = true;
+        latencyTimer_.Reset();
+    }
 }
 
 void DynamicNavigationMesh::OnSceneSet(Scene* scene)
 {
+    NavigationMesh::OnSceneSet(scene);
+
     // Subscribe to the scene subsystem update, which will trigger the tile cache to update the nav mesh
     if (scene)
         SubscribeToEvent(scene, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(DynamicNavigationMesh, HandleSceneSubsystemUpdate));
@@ -849,8 +909,10 @@ void DynamicNavigationMesh::AddObstacle(Obstacle* obstacle, bool silent)
         dtObstacleRef refHolder;
 
         // Because dtTileCache doesn't process obstacle requests while updating tiles
-        // it's necessary update until sufficient request space is available
-        UpdateTileCache();
+        // it's necessary update until sufficient request space is available.
+        // Without update budget, apply previous changes immediately
+        if (obstacleUpdateBudget_ <= 0.0f || tileCache_->isObstacleQueueFull())
+            UpdateTileCache();
 
         if (dtStatusFailed(tileCache_->addObstacle(pos, obstacle->GetRadius(), obstacle->GetHeight(), &refHolder)))
         {
@@ -859,6 +921,7 @@ void DynamicNavigationMesh::AddObstacle(Obstacle* obstacle, bool silent)
         }
         obstacle->obstacleId_ = refHolder;
         assert(refHolder > 0);
+        MarkObstacleChanged();
 
         if (!silent)
         {
@@ -888,8 +951,10 @@ void DynamicNavigationMesh::RemoveObstacle(Obstacle* obstacle, bool silent)
     if (tileCache_ && obstacle->obstacleId_ > 0)
     {
         // Because dtTileCache doesn't process obstacle requests while updating tiles
-        // it's necessary update until sufficient request space is available
-        UpdateTileCache();
+        // it's necessary update until sufficient request space is available.
+        // Without update budget, apply previous changes immediately
+        if (obstacleUpdateBudget_ <= 0.0f || tileCache_->isObstacleQueueFull())
+            UpdateTileCache();
 
         if (dtStatusFailed(tileCache_->removeObstacle(obstacle->obstacleId_)))
         {
@@ -897,6 +962,7 @@ void DynamicNavigationMesh::RemoveObstacle(Obstacle* obstacle, bool silent)
             return;
         }
         obstacle->obstacleId_ = 0;
+        MarkObstacleChanged();
         // Require a node in order to send an event
         if (!silent && obstacle->GetNode())
         {
@@ -917,7 +983,19 @@ void DynamicNavigationMesh::HandleSceneSubsystemUpdate(StringHash eventType, Var
     using namespace SceneSubsystemUpdate;
 
     if (tileCache_ && navMesh_ && IsEnabledEffective())
-        UpdateTileCache();
+    {
+        UpdateTileCache(obstacleUpdateBudget_);
+
+        updateStats_.numPendingTiles_ = tileCache_->getPendingTileCount();
+        updateStats_.numRebuiltTiles_ = numRebuiltTilesInFrame_;
+        updateStats_.updateTime_ = updateTimeInFrame_ / 1000.0f;
+        numRebuiltTilesInFrame_ = 0;
+        updateTimeInFrame_ = 0;
+
+        URHO3D_PROFILE_VALUE("NavMesh Pending Tiles", static_cast<int64_t>(updateStats_.numPendingTiles_));
+        URHO3D_PROFILE_VALUE("NavMesh Rebuilt Tiles", static_cast<int64_t>(updateStats_.numRebuiltTiles_));
+        URHO3D_PROFILE_VALUE("NavMesh Rebuild Latency", updateStats_.rebuildLatency_);
+    }
 }
 
 }
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "Urho3D/Core/Timer.h"
 #include "Urho3D/Navigation/NavigationMesh.h"
 
 #include <EASTL/unique_ptr.h>
@@ -40,6 +41,20 @@ namespace Urho3D
 class OffMeshConnection;
 class Obstacle;
 
+/// Statistics of tile cache updates caused by obstacles.
+struct TileCacheUpdateStats
+{
+    /// Number of tiles waiting to be rebuilt.
+    unsigned numPendingTiles_{};
+    /// Number of tiles rebuilt during the last frame.
+    unsigned numRebuiltTiles_{};
+    /// Time spent rebuilding tiles during the last frame, in milliseconds.
+    float updateTime_{};
+    /// Time between the first obstacle change and the navigation mesh being up to date, in milliseconds.
+    /// Measured for the last completed update.
+    float rebuildLatency_{};
+};
+
 class URHO3D_API DynamicNavigationMesh : public NavigationMesh
 {
     URHO3D_OBJECT(DynamicNavigationMesh, NavigationMesh);
@@ -102,15 +117,27 @@ public:
     /// @property
     bool GetDrawObstacles() const { return drawObstacles_; }
 
-protected:
-    struct TileCacheData;
+    /// Set maximum time in milliseconds spent per frame on rebuilding tiles touched by obstacles. 0 means unlimited.
+    /// At least one batch of tiles is rebuilt per frame, so small budgets still make progress.
+    /// With non-zero budget, obstacle changes are not applied to the navigation mesh immediately,
+    /// unless the tile cache request queue is full.
+    /// @property
+    void SetObstacleUpdateBudget(float budget) { obstacleUpdateBudget_ = Max(budget, 0.0f); }
+    /// Return maximum time in milliseconds spent per frame on rebuilding tiles touched by obstacles.
+    /// @property
+    float GetObstacleUpdateBudget() const { return obstacleUpdateBudget_; }
+    /// Return statistics of tile cache updates.
+    const TileCacheUpdateStats& GetObstacleUpdateStats() const { return updateStats_; }
+    /// Return whether all obstacle changes are applied to the navigation mesh.
+    bool IsObstacleUpdateComplete() const;
 
+protected:
     /// Override NavigationMesh.
     /// @{
     bool AllocateMesh(unsigned maxTiles) override;
     bool RebuildMesh() override;
-    unsigned BuildTilesFromGeometry(
-        ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to) override;
+    bool BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, PendingTile& tile) override;
+    unsigned AddPendingTile(PendingTile& tile) override;
     /// @}
 
     /// Subscribe to events when assigned to a scene.
@@ -119,14 +146,16 @@ protected:
     void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
 
     /// Used by Obstacle class to add itself to the tile cache, if 'silent' an event will not be raised.
+    /// Changes queued before are applied immediately if obstacle update budget is zero.
+    /// Otherwise affected tiles are rebuilt later within the budget, see IsObstacleUpdateComplete.
     void AddObstacle(Obstacle* obstacle, bool silent = false);
     /// Used by Obstacle class to update itself.
     void ObstacleChanged(Obstacle* obstacle);
     /// Used by Obstacle class to remove itself from the tile cache, if 'silent' an event will not be raised.
+    /// Changes queued before are applied immediately if obstacle update budget is zero.
+    /// Otherwise affected tiles are rebuilt later within the budget, see IsObstacleUpdateComplete.
     void RemoveObstacle(Obstacle* obstacle, bool silent = false);
 
-    /// Build one tile of the navigation mesh. Return true if successful.
-    int BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
     /// Off-mesh connections to be rebuilt in the mesh processor.
     ea::vector<OffMeshConnection*> CollectOffMeshConnections(const BoundingBox& bounds);
     /// Release the navigation mesh, query, and tile cache.
@@ -139,9 +168,12 @@ private:
     bool ReadTiles(Deserializer& source, bool silent);
     /// Free the tile cache.
     void ReleaseTileCache();
-    /// Ensure the tile cache is fully updated.
-    /// It is suboptimal when multiple obstacles added at once, but it is the most stable solution.
-    void UpdateTileCache();
+    /// Rebuild tiles touched by obstacles until the tile cache is up to date or time limit in milliseconds is exceeded.
+    /// Zero or negative limit means unlimited. At least one batch of tiles is rebuilt.
+    /// Tiles are built in worker threads and committed to the navigation mesh in the main thread.
+    void UpdateTileCache(float maxTime = 0.0f);
+    /// Mark obstacle change for latency statistics.
+    void MarkObstacleChanged();
 
     /// Detour tile cache instance that works with the nav mesh.
     dtTileCache* tileCache_{};
@@ -159,6 +191,21 @@ private:
     bool drawObstacles_{};
     /// Queue of tiles to be built.
     ea::vector<IntVector2> tileQueue_;
+
+    /// Maximum time in milliseconds spent per frame on rebuilding tiles touched by obstacles.
+    float obstacleUpdateBudget_{};
+    /// Allocators used to rebuild tiles in worker threads, one per tile in batch.
+    ea::vector<ea::unique_ptr<dtTileCacheAlloc>> workerAllocators_;
+    /// Statistics of tile cache updates.
+    TileCacheUpdateStats updateStats_;
+    /// Number of tiles rebuilt during current frame.
+    unsigned numRebuiltTilesInFrame_{};
+    /// Time spent rebuilding tiles during current frame, in microseconds.
+    long long updateTimeInFrame_{};
+    /// Timer used to measure update latency.
+    HiresTimer latencyTimer_;
+    /// Whether there are obstacle changes not applied to the navigation mesh yet.
+    bool latencyPending_{};
 };
 
 }
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -47,6 +48,7 @@
 #include "../Physics/CollisionShape.h"
 #endif
 #include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
 
 #include <cfloat>
 #include <Detour/DetourNavMesh.h>
@@ -55,6 +57,7 @@
 #include <Recast/Recast.h>
 
 #include <EASTL/numeric.h>
+#include <EASTL/sort.h>
 
 #include "../DebugNew.h"
 
@@ -97,6 +100,40 @@ struct FindPathData
     unsigned char pathFlags_[MAX_POLYS]{};
 };
 
+/// Asynchronous path request.
+struct NavigationMesh::PathRequest
+{
+    /// Request ID.
+    unsigned id_{};
+    /// Priority. Requests with higher priority are processed first.
+    int priority_{};
+    /// Start point in local space.
+    Vector3 localStart_;
+    /// End point in local space.
+    Vector3 localEnd_;
+    /// Search extents.
+    Vector3 extents_;
+    /// Query filter.
+    dtQueryFilter filter_;
+    /// Callback.
+    NavigationPathCallback callback_;
+
+    /// Query used for sliced path search. Sliced search state is stored in the query itself.
+    dtNavMeshQuery* query_{};
+    /// End polygon.
+    dtPolyRef endRef_{};
+    /// Maximum number of iterations in current step.
+    int numIterations_{};
+    /// Whether the sliced search is initialized.
+    bool started_{};
+    /// Whether the request is finished, successfully or not.
+    bool finished_{};
+    /// Found path points in local space.
+    ea::vector<Vector3> pathPoints_;
+    /// Found path flags.
+    ea::vector<unsigned char> pathFlags_;
+};
+
 namespace
 {
 
@@ -156,6 +193,14 @@ NavigationMesh::~NavigationMesh()
     ReleaseNavigationMesh();
 }
 
+void NavigationMesh::OnSceneSet(Scene* scene)
+{
+    if (scene)
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(NavigationMesh, HandleScenePostUpdate));
+    else
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+}
+
 void NavigationMesh::RegisterObject(Context* context)
 {
     context->AddFactoryReflection<NavigationMesh>(Category_Navigation);
@@ -685,11 +730,235 @@ void NavigationMesh::FindPath(ea::vector<NavigationPathPoint>& dest, const Vecto
         &pathData_->pathPoints_[0].x_, pathData_->pathFlags_, pathData_->pathPolys_, &numPathPoints, MAX_POLYS);
 
     // Transform path result back to world space
-    for (int i = 0; i < numPathPoints; ++i)
+    AppendPathPoints(dest, pathData_->pathPoints_, pathData_->pathFlags_, numPathPoints);
+}
+
+unsigned NavigationMesh::FindPathAsync(const Vector3& start, const Vector3& end, NavigationPathCallback callback,
+    int priority, const Vector3& extents, const dtQueryFilter* filter)
+{
+    if (!navMesh_ || !node_ || !callback)
+        return 0;
+
+    // Navigation data is in local space. Transform path points from world to local
+    const Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
+
+    auto request = ea::make_unique<PathRequest>();
+    request->id_ = nextPathRequestId_++;
+    request->priority_ = priority;
+    request->localStart_ = inverse * start;
+    request->localEnd_ = inverse * end;
+    request->extents_ = extents;
+    request->filter_ = filter ? *filter : *queryFilter_;
+    request->callback_ = ea::move(callback);
+
+    // Skip 0 which is reserved for failure
+    if (!nextPathRequestId_)
+        nextPathRequestId_ = 1;
+
+    const unsigned requestId = request->id_;
+    pathRequests_.push_back(ea::move(request));
+    return requestId;
+}
+
+void NavigationMesh::CancelPathRequest(unsigned requestId)
+{
+    const auto iter = ea::find_if(pathRequests_.begin(), pathRequests_.end(),
+        [requestId](const ea::unique_ptr<PathRequest>& request) { return request->id_ == requestId; });
+    if (iter == pathRequests_.end())
+        return;
+
+    ReleasePathQuery((*iter)->query_);
+    pathRequests_.erase(iter);
+}
+
+void NavigationMesh::CancelAllPathRequests()
+{
+    for (const auto& request : pathRequests_)
+        ReleasePathQuery(request->query_);
+    pathRequests_.clear();
+}
+
+void NavigationMesh::UpdatePathRequests()
+{
+    if (pathRequests_.empty())
+        return;
+
+    URHO3D_PROFILE("UpdatePathRequests");
+
+    // Complete all requests with empty path if there is no navigation data
+    const bool hasMesh = navMesh_ && node_;
+    if (hasMesh)
+    {
+        // Pick requests with highest priority, keeping submission order for equal priorities
+        activePathRequests_.clear();
+        for (const auto& request : pathRequests_)
+            activePathRequests_.push_back(request.get());
+        ea::stable_sort(activePathRequests_.begin(), activePathRequests_.end(),
+            [](const PathRequest* lhs, const PathRequest* rhs) { return lhs->priority_ > rhs->priority_; });
+        if (activePathRequests_.size() > maxActivePathRequests_)
+            activePathRequests_.resize(maxActivePathRequests_);
+
+        // Distribute iteration budget evenly
+        const unsigned numActive = activePathRequests_.size();
+        const int numIterations = static_cast<int>(Max(pathIterationBudget_ / numActive, 1u));
+        for (PathRequest* request : activePathRequests_)
+        {
+            if (!request->query_)
+                request->query_ = AllocatePathQuery();
+            request->numIterations_ = numIterations;
+            // Fail request if query cannot be allocated
+            if (!request->query_)
+                request->finished_ = true;
+        }
+
+        auto workQueue = GetSubsystem<WorkQueue>();
+        ForEachParallel(workQueue, activePathRequests_,
+            [this](unsigned /*index*/, PathRequest* request)
+        {
+            if (!request->finished_)
+                StepPathRequest(*request);
+        });
+    }
+
+    // Extract finished requests before invoking callbacks, callbacks may post new requests
+    ea::vector<ea::unique_ptr<PathRequest>> finishedRequests;
+    for (auto& request : pathRequests_)
+    {
+        if (!hasMesh || request->finished_)
+        {
+            ReleasePathQuery(request->query_);
+            request->query_ = nullptr;
+            finishedRequests.push_back(ea::move(request));
+        }
+    }
+    ea::erase_if(pathRequests_, [](const ea::unique_ptr<PathRequest>& request) { return !request; });
+
+    ea::vector<NavigationPathPoint> path;
+    for (const auto& request : finishedRequests)
+    {
+        path.clear();
+        if (hasMesh)
+        {
+            AppendPathPoints(path, request->pathPoints_.data(), request->pathFlags_.data(),
+                request->pathPoints_.size());
+        }
+        request->callback_(request->id_, path);
+    }
+}
+
+void NavigationMesh::StepPathRequest(PathRequest& request) const
+{
+    dtNavMeshQuery* query = request.query_;
+    const dtQueryFilter* filter = &request.filter_;
+
+    if (!request.started_)
+    {
+        request.started_ = true;
+
+        dtPolyRef startRef;
+        query->findNearestPoly(&request.localStart_.x_, &request.extents_.x_, filter, &startRef, nullptr);
+        query->findNearestPoly(&request.localEnd_.x_, &request.extents_.x_, filter, &request.endRef_, nullptr);
+        if (!startRef || !request.endRef_)
+        {
+            request.finished_ = true;
+            return;
+        }
+
+        const dtStatus status = query->initSlicedFindPath(
+            startRef, request.endRef_, &request.localStart_.x_, &request.localEnd_.x_, filter);
+        if (dtStatusFailed(status))
+        {
+            request.finished_ = true;
+            return;
+        }
+    }
+
+    const dtStatus status = query->updateSlicedFindPath(request.numIterations_, nullptr);
+    if (dtStatusInProgress(status))
+        return;
+
+    request.finished_ = true;
+    if (dtStatusFailed(status))
+        return;
+
+    ea::vector<dtPolyRef> polys(MAX_POLYS);
+    int numPolys = 0;
+    query->finalizeSlicedFindPath(polys.data(), &numPolys, MAX_POLYS);
+    if (!numPolys)
+        return;
+
+    Vector3 actualLocalEnd = request.localEnd_;
+
+    // If full path was not found, clamp end point to the end polygon
+    if (polys[numPolys - 1] != request.endRef_)
+        query->closestPointOnPoly(polys[numPolys - 1], &request.localEnd_.x_, &actualLocalEnd.x_, nullptr);
+
+    int numPathPoints = 0;
+    request.pathPoints_.resize(MAX_POLYS);
+    request.pathFlags_.resize(MAX_POLYS);
+    query->findStraightPath(&request.localStart_.x_, &actualLocalEnd.x_, polys.data(), numPolys,
+        &request.pathPoints_[0].x_, request.pathFlags_.data(), nullptr, &numPathPoints, MAX_POLYS);
+    request.pathPoints_.resize(numPathPoints);
+    request.pathFlags_.resize(numPathPoints);
+}
+
+dtNavMeshQuery* NavigationMesh::AllocatePathQuery()
+{
+    if (!freePathQueries_.empty())
+    {
+        dtNavMeshQuery* query = freePathQueries_.back();
+        freePathQueries_.pop_back();
+        return query;
+    }
+
+    dtNavMeshQuery* query = dtAllocNavMeshQuery();
+    if (!query)
+    {
+        URHO3D_LOGERROR("Could not create navigation mesh query");
+        return nullptr;
+    }
+
+    if (dtStatusFailed(query->init(navMesh_, MAX_POLYS)))
+    {
+        URHO3D_LOGERROR("Could not init navigation mesh query");
+        dtFreeNavMeshQuery(query);
+        return nullptr;
+    }
+
+    pathQueries_.push_back(query);
+    return query;
+}
+
+void NavigationMesh::ReleasePathQuery(dtNavMeshQuery* query)
+{
+    if (query)
+        freePathQueries_.push_back(query);
+}
+
+void NavigationMesh::ReleasePathQueries()
+{
+    for (const auto& request : pathRequests_)
+    {
+        request->query_ = nullptr;
+        request->started_ = false;
+        request->finished_ = false;
+    }
+
+    for (dtNavMeshQuery* query : pathQueries_)
+        dtFreeNavMeshQuery(query);
+    pathQueries_.clear();
+    freePathQueries_.clear();
+}
+
+void NavigationMesh::AppendPathPoints(ea::vector<NavigationPathPoint>& dest, const Vector3* localPoints,
+    const unsigned char* flags, unsigned numPoints) const
+{
+    const Matrix3x4& transform = node_->GetWorldTransform();
+    for (unsigned i = 0; i < numPoints; ++i)
     {
         NavigationPathPoint pt;
-        pt.position_ = transform * pathData_->pathPoints_[i];
-        pt.flag_ = (NavigationPathPointFlag)pathData_->pathFlags_[i];
+        pt.position_ = transform * localPoints[i];
+        pt.flag_ = (NavigationPathPointFlag)flags[i];
 
         // Walk through all NavAreas and find nearest
         unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
@@ -718,6 +987,11 @@ void NavigationMesh::FindPath(ea::vector<NavigationPathPoint>& dest, const Vecto
     }
 }
 
+void NavigationMesh::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    UpdatePathRequests();
+}
+
 Vector3 NavigationMesh::GetRandomPoint(const dtQueryFilter* filter, dtPolyRef* randomRef)
 {
     if (!InitializeQuery())
@@ -1069,6 +1343,25 @@ void NavigationMesh::CollectGeometries(ea::vector<NavigationGeometryInfo>& geome
     }
 }
 
+void NavigationMesh::PrepareTileGeometry(ea::vector<NavigationGeometryInfo>& geometryList)
+{
+    // World transforms are evaluated on demand and cannot be safely updated from worker threads
+    node_->GetWorldTransform();
+
+    for (const NavigationGeometryInfo& info : geometryList)
+    {
+        if (info.component_->GetType() == OffMeshConnection::GetTypeStatic())
+        {
+            auto* connection = static_cast<OffMeshConnection*>(info.component_);
+            connection->GetNode()->GetWorldTransform();
+            if (Node* endPoint = connection->GetEndPoint())
+                endPoint->GetWorldTransform();
+        }
+        else if (info.component_->GetType() == NavArea::GetTypeStatic())
+            info.component_->GetNode()->GetWorldTransform();
+    }
+}
+
 void NavigationMesh::GetTileGeometry(NavBuildData* build, ea::vector<NavigationGeometryInfo>& geometryList, BoundingBox& box)
 {
     Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
@@ -1274,16 +1567,17 @@ void NavigationMesh::SendTileAddedEvent(const IntVector2& tileIndex)
     SendEvent(E_NAVIGATION_TILE_ADDED, eventData);
 }
 
-bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z)
+bool NavigationMesh::BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, PendingTile& tile)
 {
     URHO3D_PROFILE("BuildNavigationMeshTile");
 
-    // Remove previous tile (if any)
-    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+    const int x = tile.index_.x_;
+    const int z = tile.index_.y_;
 
-    const BoundingBox tileColumn = GetTileBoundingBoxColumn(IntVector2{x, z});
+    const BoundingBox tileColumn = GetTileBoundingBoxColumn(tile.index_);
     const BoundingBox tileBoundingBox =
         IsHeightRangeValid() ? tileColumn : CalculateTileBoundingBox(geometryList, tileColumn);
+    tile.boundingBox_ = tileBoundingBox;
 
     SimpleNavBuildData build;
 
@@ -1486,12 +1780,33 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         return false;
     }
 
+    tile.data_.emplace_back(navData, navDataSize);
+    return true;
+}
+
+unsigned NavigationMesh::AddPendingTile(PendingTile& tile)
+{
+    const int x = tile.index_.x_;
+    const int z = tile.index_.y_;
+
+    // Remove previous tile (if any)
+    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+
+    if (!tile.success_)
+        return 0;
+
+    if (tile.data_.empty())
+        return 1; // Nothing to do
+
+    auto& [navData, navDataSize] = tile.data_.front();
     if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
     {
         URHO3D_LOGERROR("Failed to add navigation mesh tile");
         dtFree(navData);
-        return false;
+        tile.data_.clear();
+        return 0;
     }
+    tile.data_.clear();
 
     // Send a notification of the rebuild of this tile to anyone interested
     {
@@ -1499,26 +1814,33 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
         eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
+        eventData[P_BOUNDSMIN] = Variant(tile.boundingBox_.min_);
+        eventData[P_BOUNDSMAX] = Variant(tile.boundingBox_.max_);
         SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
     }
-    return true;
+    return 1;
 }
 
 unsigned NavigationMesh::BuildTilesFromGeometry(
     ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
-    unsigned numTiles = 0;
-
+    ea::vector<PendingTile> tiles;
     for (int z = from.y_; z <= to.y_; ++z)
     {
         for (int x = from.x_; x <= to.x_; ++x)
-        {
-            if (BuildTile(geometryList, x, z))
-                ++numTiles;
-        }
+            tiles.emplace_back().index_ = IntVector2{x, z};
     }
+
+    // Build tiles in worker threads, each tile uses its own Recast context and scratch buffers
+    PrepareTileGeometry(geometryList);
+    auto workQueue = GetSubsystem<WorkQueue>();
+    ForEachParallel(workQueue, tiles,
+        [&](unsigned /*index*/, PendingTile& tile) { tile.success_ = BuildTileData(geometryList, tile); });
+
+    // Add tiles in the same order as serial build would do
+    unsigned numTiles = 0;
+    for (PendingTile& tile : tiles)
+        numTiles += AddPendingTile(tile);
     return numTiles;
 }
 
@@ -1548,6 +1870,8 @@ bool NavigationMesh::InitializeQuery()
 
 void NavigationMesh::ReleaseNavigationMesh()
 {
+    ReleasePathQueries();
+
     dtFreeNavMesh(navMesh_);
     navMesh_ = nullptr;
 
@@ -28,6 +28,7 @@
 #include "Urho3D/Navigation/NavigationDefs.h"
 #include "Urho3D/Scene/Component.h"
 
+#include <EASTL/functional.h>
 #include <EASTL/unique_ptr.h>
 #include <EASTL/unordered_set.h>
 
@@ -70,6 +71,9 @@ struct URHO3D_API NavigationPathPoint
     unsigned char areaID_;
 };
 
+/// Callback of asynchronous path request. Path is empty if not found.
+using NavigationPathCallback = ea::function<void(unsigned requestId, const ea::vector<NavigationPathPoint>& path)>;
+
 /// Navigation mesh component. Collects the navigation geometry from child nodes with the Navigable component and responds to path queries.
 class URHO3D_API NavigationMesh : public Component
 {
@@ -84,6 +88,10 @@ public:
     static constexpr int DefaultMaxTiles = 256;
     /// Maximum number of layers in the single tile.
     static constexpr unsigned MaxLayers = 255;
+    /// Default number of path search iterations per frame for asynchronous path requests.
+    static constexpr unsigned DefaultPathIterationBudget = 4096;
+    /// Default maximum number of asynchronous path requests processed in one frame.
+    static constexpr unsigned DefaultMaxActivePathRequests = 32;
 
     /// Construct.
     explicit NavigationMesh(Context* context);
@@ -185,6 +193,22 @@ public:
     void FindPath
         (ea::vector<NavigationPathPoint>& dest, const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
             const dtQueryFilter* filter = nullptr);
+    /// Queue asynchronous search of a path between world space points. Return request ID, or 0 on failure.
+    /// Path is searched in worker threads within per-frame iteration budget, requests with higher priority are processed first.
+    /// Callback is invoked from the main thread on scene post-update.
+    /// @nobind
+    unsigned FindPathAsync(const Vector3& start, const Vector3& end, NavigationPathCallback callback, int priority = 0,
+        const Vector3& extents = Vector3::ONE, const dtQueryFilter* filter = nullptr);
+    /// Cancel asynchronous path request. Callback is not invoked for cancelled requests.
+    void CancelPathRequest(unsigned requestId);
+    /// Cancel all asynchronous path requests.
+    void CancelAllPathRequests();
+    /// Process asynchronous path requests. Called automatically on scene post-update.
+    void UpdatePathRequests();
+    /// Set maximum total number of path search iterations per frame for asynchronous path requests.
+    void SetPathIterationBudget(unsigned budget) { pathIterationBudget_ = Max(budget, 1u); }
+    /// Set maximum number of asynchronous path requests processed in one frame.
+    void SetMaxActivePathRequests(unsigned count) { maxActivePathRequests_ = Max(count, 1u); }
     /// Return a random point on the navigation mesh.
     Vector3 GetRandomPoint(const dtQueryFilter* filter = nullptr, dtPolyRef* randomRef = nullptr);
     /// Return a random point on the navigation mesh within a circle. The circle radius is only a guideline and in practice the returned point may be further away.
@@ -211,6 +235,13 @@ public:
     /// Return maximum number of tiles.
     int GetMaxTiles() const { return maxTiles_; }
 
+    /// Return maximum total number of path search iterations per frame for asynchronous path requests.
+    unsigned GetPathIterationBudget() const { return pathIterationBudget_; }
+    /// Return maximum number of asynchronous path requests processed in one frame.
+    unsigned GetMaxActivePathRequests() const { return maxActivePathRequests_; }
+    /// Return number of asynchronous path requests that are not completed yet.
+    unsigned GetNumPathRequests() const { return pathRequests_.size(); }
+
     /// Return tile size.
     /// @property
     int GetTileSize() const { return tileSize_; }
@@ -310,18 +341,68 @@ public:
     bool GetDrawNavAreas() const { return drawNavAreas_; }
 
 private:
+    struct PathRequest;
+
     /// Read tile data to the navigation mesh.
     bool ReadTile(Deserializer& source, bool silent);
+    /// Convert path from local space to world space and assign area IDs.
+    void AppendPathPoints(ea::vector<NavigationPathPoint>& dest, const Vector3* localPoints, const unsigned char* flags,
+        unsigned numPoints) const;
+    /// Step path search of asynchronous request. Called from worker threads.
+    void StepPathRequest(PathRequest& request) const;
+    /// Return query for asynchronous path request.
+    dtNavMeshQuery* AllocatePathQuery();
+    /// Return query back to the pool.
+    void ReleasePathQuery(dtNavMeshQuery* query);
+    /// Release all queries of asynchronous path requests. Searches in progress are restarted on next update.
+    void ReleasePathQueries();
+    /// Handle scene post-update.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+
+    /// Asynchronous path requests in order of submission.
+    ea::vector<ea::unique_ptr<PathRequest>> pathRequests_;
+    /// Asynchronous path requests processed in current frame.
+    ea::vector<PathRequest*> activePathRequests_;
+    /// All queries allocated for asynchronous path requests.
+    ea::vector<dtNavMeshQuery*> pathQueries_;
+    /// Queries that are not used by any asynchronous path request.
+    ea::vector<dtNavMeshQuery*> freePathQueries_;
+    /// Next asynchronous path request ID.
+    unsigned nextPathRequestId_{1};
+    /// Maximum total number of path search iterations per frame.
+    unsigned pathIterationBudget_{DefaultPathIterationBudget};
+    /// Maximum number of asynchronous path requests processed in one frame.
+    unsigned maxActivePathRequests_{DefaultMaxActivePathRequests};
 
 protected:
+    /// Tile of the navigation mesh that is built from geometry but not added to the mesh yet.
+    struct PendingTile
+    {
+        /// Index of the tile.
+        IntVector2 index_;
+        /// Bounding box of the tile geometry.
+        BoundingBox boundingBox_;
+        /// Tile data blobs allocated via dtAlloc, one per layer. Ownership is passed to the mesh when the tile is added.
+        ea::vector<ea::pair<unsigned char*, int>> data_;
+        /// Whether the tile is successfully built.
+        bool success_{};
+    };
+
     /// Allocate the navigation mesh without building any tiles. Return true if successful.
     virtual bool AllocateMesh(unsigned maxTiles);
     /// Rebuild the navigation mesh allocating sufficient maximum number of tiles. Return true if successful.
     virtual bool RebuildMesh();
     /// Build mesh tiles from the geometry data. Return true if successful.
-    virtual unsigned BuildTilesFromGeometry(
+    /// Tiles are built in worker threads and added to the mesh in the main thread in deterministic order.
+    unsigned BuildTilesFromGeometry(
         ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Build data of one tile. Should not modify the navigation mesh or the scene, may be called from worker threads.
+    virtual bool BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, PendingTile& tile);
+    /// Replace tile in the navigation mesh with built data. Return number of added tiles.
+    virtual unsigned AddPendingTile(PendingTile& tile);
 
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
     /// Send rebuild event.
     void SendRebuildEvent();
     /// Send tile added event.
@@ -330,12 +411,12 @@ protected:
     void CollectGeometries(ea::vector<NavigationGeometryInfo>& geometryList);
     /// Visit nodes and collect navigable geometry.
     void CollectGeometries(ea::vector<NavigationGeometryInfo>& geometryList, Node* node, ea::hash_set<Node*>& processedNodes, bool recursive);
+    /// Update lazily evaluated scene data used by GetTileGeometry, so it can be called from worker threads.
+    void PrepareTileGeometry(ea::vector<NavigationGeometryInfo>& geometryList);
     /// Get geometry data within a bounding box.
     void GetTileGeometry(NavBuildData* build, ea::vector<NavigationGeometryInfo>& geometryList, BoundingBox& box);
     /// Add a triangle mesh to the geometry data.
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
-    /// Build one tile of the navigation mesh. Return true if successful.
-    bool BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z);
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
     /// Release the navigation mesh and the query.
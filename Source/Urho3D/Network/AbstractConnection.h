@@ -63,6 +63,8 @@ public:
     virtual unsigned GetLocalTimeOfLatestRoundtrip() const = 0;
     /// Return ping of the connection.
     virtual unsigned GetPing() const = 0;
+    /// Return max size of the message that can be sent at once.
+    virtual unsigned GetMaxMessageSize() const { return M_MAX_UNSIGNED; }
 
     /// Syntax sugar for SendBuffer
     /// @{
@@ -73,12 +73,23 @@ Connection::Connection(Context* context, NetworkConnection* connection)
     : AbstractConnection(context)
     , transportConnection_(connection)
 {
+    auto network = GetSubsystem<Network>();
+    packetPool_ = network ? network->GetPacketPool() : nullptr;
+    if (!packetPool_)
+        packetPool_ = MakeShared<NetworkPacketPool>(packedMessageLimit_);
+
     if (connection)
     {
         connection->onMessage_ = [this](ea::string_view msg)
+        {
+            SharedPtr<NetworkPacket> packet = packetPool_->Acquire(msg);
+            MutexLock lock(packetQueueLock_);
+            incomingPackets_.push_back(ea::move(packet));
+        };
+        connection->onPacket_ = [this](NetworkPacket* packet)
         {
             MutexLock lock(packetQueueLock_);
-            incomingPackets_.emplace_back(VectorBuffer(msg.data(), msg.size()));
+            incomingPackets_.emplace_back(packet);
         };
     }
 }
@@ -108,11 +119,13 @@ void Connection::SendMessageInternal(NetworkMessageId messageId, const unsigned
     URHO3D_ASSERT(numBytes <= packedMessageLimit_);
     URHO3D_ASSERT((data == nullptr && numBytes == 0) || (data != nullptr && numBytes > 0));
 
-    VectorBuffer& buffer = outgoingBuffer_[packetType];
-
-    if (buffer.GetSize() + numBytes >= packedMessageLimit_)
+    SharedPtr<NetworkPacket>& packet = outgoingPackets_[packetType.AsInteger()];
+    if (packet && packet->GetSize() + numBytes >= packedMessageLimit_)
         SendBuffer(packetType);
+    if (!packet)
+        packet = packetPool_->Acquire();
 
+    VectorBuffer& buffer = packet->GetBuffer();
     buffer.WriteUShort(messageId);
     buffer.WriteUShort(numBytes);
     if (numBytes)
@@ -273,7 +286,16 @@ void Connection::SendBuffer(PacketTypeFlags type, VectorBuffer& buffer)
 
 void Connection::SendBuffer(PacketTypeFlags type)
 {
-    SendBuffer(type, outgoingBuffer_[type]);
+    SharedPtr<NetworkPacket> packet = ea::move(outgoingPackets_[type.AsInteger()]);
+    if (!packet || packet->GetSize() < 1)
+        return;
+
+    if (transportConnection_)
+    {
+        packetCounterOutgoing_.AddSample(1);
+        bytesCounterOutgoing_.AddSample(packet->GetSize());
+        transportConnection_->SendPacket(packet, type);
+    }
 }
 
 void Connection::SendAllBuffers()
@@ -281,7 +303,6 @@ void Connection::SendAllBuffers()
     // Send clock messages at the last time to have better precision
     if (clock_)
     {
-        auto& buffer = outgoingBuffer_[PacketType::UnreliableUnordered];
         while (const auto clockMessage = clock_->PollMessage())
         {
             SendGeneratedMessage(MSG_CLOCK_SYNC, PacketType::UnreliableUnordered,
@@ -774,6 +795,13 @@ void Connection::SetPacketSizeLimit(int limit)
     packedMessageLimit_ = limit;
 }
 
+unsigned Connection::GetMaxMessageSize() const
+{
+    // Message ID and size are written before each message
+    static constexpr unsigned messageHeaderSize = 2 * sizeof(unsigned short);
+    return static_cast<unsigned>(ea::max(packedMessageLimit_, static_cast<int>(messageHeaderSize + 1))) - messageHeaderSize;
+}
+
 void Connection::HandleAsyncLoadFinished()
 {
     replicationManager_ = scene_->GetOrCreateComponent<ReplicationManager>();
@@ -992,9 +1020,9 @@ unsigned short Connection::GetPort() const
 void Connection::ProcessPackets()
 {
     MutexLock lock(packetQueueLock_);
-    for (auto& packet : incomingPackets_)
+    for (const SharedPtr<NetworkPacket>& packet : incomingPackets_)
     {
-        MemoryBuffer msg(packet);
+        MemoryBuffer msg(packet->GetData(), packet->GetSize());
         if (!ProcessMessage(msg))
         {
             Disconnect();
@@ -31,6 +31,7 @@
 #include "../Core/Timer.h"
 #include "../IO/VectorBuffer.h"
 #include "../Network/AbstractConnection.h"
+#include "../Network/NetworkPacket.h"
 
 namespace Urho3D
 {
@@ -121,6 +122,7 @@ public:
     unsigned GetLocalTime() const override;
     unsigned GetLocalTimeOfLatestRoundtrip() const override;
     unsigned GetPing() const override;
+    unsigned GetMaxMessageSize() const override;
     /// @}
 
     /// Send a remote event.
@@ -143,10 +145,12 @@ public:
     void SendPackages();
     /// Send out buffered messages by their type
     void SendBuffer(PacketTypeFlags type);
-    /// Send out buffered messages by their type
+    /// Send out messages from the external buffer. Data is copied by the transport.
     void SendBuffer(PacketTypeFlags type, VectorBuffer& buffer);
     /// Send out all buffered messages
     void SendAllBuffers();
+    /// Handles queued packets. Called by Network. Should only be called from main thread.
+    void ProcessPackets();
     /// Process a message from the server or client. Called by Network.
     bool ProcessMessage(MemoryBuffer& buffer);
     /// Return client identity.
@@ -250,8 +254,6 @@ private:
     void OnPackageDownloadFailed(const ea::string& name);
     /// Handle all packages loaded successfully. Also called directly on MSG_LOADSCENE if there are none.
     void OnPackagesReady();
-    /// Handles queued packets. Should only be called from main thread.
-    void ProcessPackets();
 
     /// Packet handling.
     /// @{
@@ -262,8 +264,9 @@ private:
     mutable TimedCounter bytesCounterOutgoing_{10, 1000};
     /// Statistics timer.
     Timer statsTimer_;
-    /// Outgoing packet buffer which can contain multiple messages.
-    ea::unordered_map<int, VectorBuffer> outgoingBuffer_;
+    /// Outgoing packets by packet type, each packet may contain multiple messages.
+    /// Packets are passed to the transport as is and replaced with new ones from the pool.
+    SharedPtr<NetworkPacket> outgoingPackets_[4];
     /// Outgoing packet size limit.
     int packedMessageLimit_ = 1024;
     /// Queued remote events.
@@ -300,8 +303,9 @@ private:
     /// @}
 
     SharedPtr<NetworkConnection> transportConnection_;
+    SharedPtr<NetworkPacketPool> packetPool_;
     Mutex packetQueueLock_;
-    ea::vector<VectorBuffer> incomingPackets_;
+    ea::vector<SharedPtr<NetworkPacket>> incomingPackets_;
 
 };
 
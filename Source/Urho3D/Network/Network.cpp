@@ -38,6 +38,8 @@
 #include "../Network/Protocol.h"
 #include "../Network/Transport/DataChannel/DataChannelConnection.h"
 #include "../Network/Transport/DataChannel/DataChannelServer.h"
+#include "../Network/Transport/Loopback/LoopbackConnection.h"
+#include "../Network/Transport/Loopback/LoopbackServer.h"
 #include "../Replica/BehaviorNetworkObject.h"
 #include "../Replica/FilteredByDistance.h"
 #include "../Replica/NetworkObject.h"
@@ -58,8 +60,33 @@
 namespace Urho3D
 {
 
+namespace
+{
+
+bool IsLoopbackURL(const URL& url)
+{
+    return url.scheme_ == "loopback";
+}
+
+NetworkConnection* CreateTransportConnection(Context* context, const URL& url)
+{
+    if (IsLoopbackURL(url))
+        return new LoopbackConnection(context);
+    return new DataChannelConnection(context);
+}
+
+SharedPtr<NetworkServer> CreateTransportServer(Context* context, const URL& url)
+{
+    if (IsLoopbackURL(url))
+        return MakeShared<LoopbackServer>(context);
+    return MakeShared<DataChannelServer>(context);
+}
+
+}
+
 Network::Network(Context* context)
     : Object(context)
+    , packetPool_(MakeShared<NetworkPacketPool>())
 {
     // Register Network library object factories
     RegisterNetworkLibrary(context_);
@@ -90,7 +117,7 @@ void Network::OnClientConnected(Connection* connection)
     eventData[P_CONNECTION] = connection;
     connection->SendEvent(E_CLIENTCONNECTED, eventData);
 
-    if (serverMaxConnections_ <= clientConnections_.size())
+    if (clientConnections_.size() > serverMaxConnections_)
     {
         connection->SendMessage(MSG_CONNECTION_LIMIT_EXCEEDED);
         connection->Disconnect();
@@ -118,7 +145,7 @@ bool Network::Connect(const URL& url, Scene* scene, const VariantMap& identity)
     if (!connectionToServer_)
     {
         URHO3D_LOGINFO("Connecting to server {}", url.ToString());
-        DataChannelConnection* transportConnection = new DataChannelConnection(context_);
+        NetworkConnection* transportConnection = CreateTransportConnection(context_, url);
         connectionToServer_ = new Connection(context_, transportConnection);
         connectionToServer_->SetScene(scene);
         connectionToServer_->SetIdentity(identity);
@@ -219,7 +246,7 @@ bool Network::StartServer(const URL& url, unsigned int maxConnections)
     URHO3D_PROFILE("StartServer");
 
     WorkQueue* queue = GetSubsystem<WorkQueue>();
-    transportServer_ = MakeShared<DataChannelServer>(context_);
+    transportServer_ = CreateTransportServer(context_, url);
     transportServer_->onConnected_ = [this, queue](NetworkConnection* connection)
     {
         // Hold on to DataChannelConnection reference until callback executes.
@@ -240,7 +267,12 @@ bool Network::StartServer(const URL& url, unsigned int maxConnections)
                 OnClientDisconnected(it->second);
         });
     };
-    transportServer_->Listen(url);
+    if (!transportServer_->Listen(url))
+    {
+        URHO3D_LOGERROR("Failed to start server on {}.", url.ToString());
+        transportServer_ = nullptr;
+        return false;
+    }
     URHO3D_LOGINFO("Server is listening on {}.", url.ToString());
     serverMaxConnections_ = maxConnections;
     return true;
@@ -419,6 +451,7 @@ ea::string Network::GetDebugInfo() const
 
     const unsigned localTime = Time::GetSystemTime();
     result += Format("Local Time {}\n", localTime);
+    result += Format("Packets: {} pooled, {} allocated in last frame\n", packetPool_->GetNumPackets(), numPacketAllocations_);
 
     if (Connection* connection = GetServerConnection())
     {
@@ -503,6 +536,10 @@ void Network::PostUpdate(float timeStep)
         connectionToServer_->ProcessPackets();
     }
     SendNetworkUpdateEvent(E_NETWORKUPDATESENT, false);
+
+    const unsigned numPacketAllocations = packetPool_->GetNumAllocations();
+    numPacketAllocations_ = numPacketAllocations - lastNumPacketAllocations_;
+    lastNumPacketAllocations_ = numPacketAllocations;
 }
 
 void Network::HandleApplicationExit()
@@ -566,6 +603,8 @@ void RegisterNetworkLibrary(Context* context)
     Connection::RegisterObject(context);
     DataChannelConnection::RegisterObject(context);
     DataChannelServer::RegisterObject(context);
+    LoopbackConnection::RegisterObject(context);
+    LoopbackServer::RegisterObject(context);
 }
 
 }
@@ -27,6 +27,7 @@
 #include <Urho3D/Core/Object.h>
 #include <Urho3D/IO/VectorBuffer.h>
 #include <Urho3D/Network/Connection.h>
+#include <Urho3D/Network/NetworkPacket.h>
 #include <Urho3D/Network/URL.h>
 
 namespace Urho3D
@@ -49,10 +50,12 @@ public:
     ~Network() override;
 
     /// Connect to a server using UDP protocol. Return true if connection process successfully started.
+    /// URL with "loopback" scheme connects to the server started in the same process, see LoopbackConnection.
     bool Connect(const URL& url, Scene* scene, const VariantMap& identity = Variant::emptyVariantMap);
     /// Disconnect the connection to the server. If wait time is non-zero, will block while waiting for disconnect to finish.
     void Disconnect(int waitMSec = 0);
     /// Start a server on a port using UDP protocol. Return true if successful.
+    /// URL with "loopback" scheme starts the server that accepts connections only from the same process.
     bool StartServer(const URL& url, unsigned int maxConnections = 128);
     /// Stop the server.
     void StopServer();
@@ -119,6 +122,11 @@ public:
     bool CheckRemoteEvent(StringHash eventType) const;
     /// Return aggregated debug info.
     ea::string GetDebugInfo() const;
+    /// Return pool of packets shared by all connections.
+    NetworkPacketPool* GetPacketPool() const { return packetPool_; }
+    /// Return number of heap allocations of network packets during the last frame.
+    /// Expected to be zero when the number of connections and the traffic are stable.
+    unsigned GetNumPacketAllocations() const { return numPacketAllocations_; }
 
     /// Return the package download cache directory.
     /// @property
@@ -175,6 +183,13 @@ private:
     int serverMaxConnections_ = 0;
     /// Actual server, which accepts connections.
     SharedPtr<NetworkServer> transportServer_;
+    /// Pool of packets shared by all connections.
+    SharedPtr<NetworkPacketPool> packetPool_;
+    /// Number of packet allocations, total and during the last frame.
+    /// @{
+    unsigned lastNumPacketAllocations_{};
+    unsigned numPacketAllocations_{};
+    /// @}
 };
 
 /// Register Network library objects.
@@ -0,0 +1,95 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Network/NetworkPacket.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+NetworkPacketPool::NetworkPacketPool(unsigned packetCapacity)
+    : packetCapacity_(packetCapacity)
+{
+}
+
+SharedPtr<NetworkPacket> NetworkPacketPool::Acquire()
+{
+    MutexLock lock(mutex_);
+
+    const unsigned oldCapacity = acquiredPackets_.capacity() + freePackets_.capacity();
+    if (freePackets_.empty())
+        CollectFreePackets();
+
+    SharedPtr<NetworkPacket> packet;
+    if (!freePackets_.empty())
+    {
+        packet = ea::move(freePackets_.back());
+        freePackets_.pop_back();
+
+        ByteVector& data = packet->buffer_.GetBuffer();
+        if (data.capacity() > packet->acquiredCapacity_)
+            numAllocations_.fetch_add(1, std::memory_order_relaxed);
+        packet->buffer_.Clear();
+    }
+    else
+    {
+        packet = MakeShared<NetworkPacket>();
+        packet->buffer_.GetBuffer().reserve(packetCapacity_);
+        numAllocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    packet->acquiredCapacity_ = packet->buffer_.GetBuffer().capacity();
+    acquiredPackets_.push_back(packet);
+
+    if (acquiredPackets_.capacity() + freePackets_.capacity() != oldCapacity)
+        numAllocations_.fetch_add(1, std::memory_order_relaxed);
+    return packet;
+}
+
+void NetworkPacketPool::CollectFreePackets()
+{
+    // Each pass over acquired packets is paid off by all the packets released since the previous pass
+    for (SharedPtr<NetworkPacket>& packet : acquiredPackets_)
+    {
+        if (packet->Refs() == 1)
+            freePackets_.push_back(ea::move(packet));
+    }
+    ea::erase_if(acquiredPackets_, [](const SharedPtr<NetworkPacket>& packet) { return !packet; });
+}
+
+SharedPtr<NetworkPacket> NetworkPacketPool::Acquire(ea::string_view data)
+{
+    SharedPtr<NetworkPacket> packet = Acquire();
+    packet->GetBuffer().Write(data.data(), data.size());
+    return packet;
+}
+
+unsigned NetworkPacketPool::GetNumPackets() const
+{
+    MutexLock lock(mutex_);
+    return acquiredPackets_.size() + freePackets_.size();
+}
+
+}
@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../Core/Mutex.h"
+#include "../IO/VectorBuffer.h"
+
+#include <EASTL/string_view.h>
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+/// Reference-counted buffer of a network packet.
+/// Packets are shared between connections and transports instead of copying,
+/// and are recycled by NetworkPacketPool when no longer referenced.
+class URHO3D_API NetworkPacket : public RefCounted
+{
+public:
+    /// Return buffer for writing.
+    VectorBuffer& GetBuffer() { return buffer_; }
+    /// Return packet data.
+    /// @{
+    const unsigned char* GetData() const { return buffer_.GetData(); }
+    unsigned GetSize() const { return buffer_.GetSize(); }
+    ea::string_view GetView() const { return {reinterpret_cast<const char*>(buffer_.GetData()), buffer_.GetSize()}; }
+    /// @}
+
+private:
+    friend class NetworkPacketPool;
+
+    VectorBuffer buffer_;
+    /// Capacity of the buffer when the packet was acquired, used to detect reallocations.
+    unsigned acquiredCapacity_{};
+};
+
+/// Thread-safe pool of network packets.
+/// Packet is considered free when the pool holds the only reference to it.
+/// Free packets are collected in one pass over acquired packets when the free list runs out.
+class URHO3D_API NetworkPacketPool : public RefCounted
+{
+public:
+    /// Construct with initial capacity of each packet.
+    explicit NetworkPacketPool(unsigned packetCapacity = 1024);
+
+    /// Return empty packet, recycled if possible.
+    SharedPtr<NetworkPacket> Acquire();
+    /// Return packet with a copy of the data, recycled if possible.
+    SharedPtr<NetworkPacket> Acquire(ea::string_view data);
+
+    /// Return total number of heap allocations done by the pool and its packets.
+    /// Reallocations of the packet are accounted when the packet is recycled.
+    unsigned GetNumAllocations() const { return numAllocations_.load(std::memory_order_relaxed); }
+    /// Return total number of packets owned by the pool.
+    unsigned GetNumPackets() const;
+
+private:
+    const unsigned packetCapacity_{};
+
+    /// Move packets that are no longer referenced outside of the pool to the free list.
+    void CollectFreePackets();
+
+    mutable Mutex mutex_;
+    /// Packets that were acquired and may still be in use.
+    ea::vector<SharedPtr<NetworkPacket>> acquiredPackets_;
+    ea::vector<SharedPtr<NetworkPacket>> freePackets_;
+    std::atomic<unsigned> numAllocations_{};
+};
+
+}
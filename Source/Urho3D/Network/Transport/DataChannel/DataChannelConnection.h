@@ -41,6 +41,9 @@ namespace Urho3D
 
 class DataChannelServer;
 
+/// Connection over WebRTC data channels.
+/// libdatachannel owns the messages it sends and receives, so packets are copied on send
+/// and received messages are copied into pooled packets by the Connection.
 class URHO3D_API DataChannelConnection : public NetworkConnection
 {
     friend class DataChannelServer;
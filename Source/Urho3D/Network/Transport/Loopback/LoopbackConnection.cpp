@@ -0,0 +1,255 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/Transport/Loopback/LoopbackConnection.h>
+#include <Urho3D/Network/Transport/Loopback/LoopbackServer.h>
+
+#include <EASTL/sort.h>
+
+namespace Urho3D
+{
+
+LoopbackLinkParameters LoopbackLinkParameters::FromQuery(ea::string_view query)
+{
+    LoopbackLinkParameters result;
+    for (const ea::string& parameter : ea::string::split(query, '&'))
+    {
+        const auto separator = parameter.find('=');
+        if (separator == ea::string::npos)
+            continue;
+
+        const ea::string name = parameter.substr(0, separator);
+        const ea::string value = parameter.substr(separator + 1);
+        if (name == "latency")
+            result.latency_ = ToUInt(value);
+        else if (name == "jitter")
+            result.jitter_ = ToUInt(value);
+        else if (name == "loss")
+            result.loss_ = Clamp(ToFloat(value), 0.0f, 1.0f);
+        else if (name == "bandwidth")
+            result.bandwidth_ = ToUInt(value);
+        else if (name == "seed")
+            result.seed_ = ToUInt(value);
+        else
+            URHO3D_LOGWARNING("Unknown loopback link parameter '{}'", name);
+    }
+    return result;
+}
+
+LoopbackConnection::LoopbackConnection(Context* context)
+    : NetworkConnection(context)
+{
+    auto network = GetSubsystem<Network>();
+    packetPool_ = network ? network->GetPacketPool() : nullptr;
+    if (!packetPool_)
+        packetPool_ = MakeShared<NetworkPacketPool>();
+}
+
+LoopbackConnection::~LoopbackConnection()
+{
+    URHO3D_ASSERT(state_ == NetworkConnection::State::Disconnected);
+}
+
+void LoopbackConnection::RegisterObject(Context* context)
+{
+    context->AddAbstractReflection<LoopbackConnection>(Category_Network);
+}
+
+bool LoopbackConnection::Connect(const URL& url)
+{
+    LoopbackServer* server = LoopbackServer::FindServer(url);
+    if (!server)
+    {
+        URHO3D_LOGERROR("Loopback server {} is not found", url.ToString());
+        if (onError_)
+            onError_();
+        return false;
+    }
+
+    const LoopbackLinkParameters linkParameters = LoopbackLinkParameters::FromQuery(url.query_);
+    LoopbackConnection* remote = server->AcceptConnection(this, linkParameters);
+    InitializeLink(nullptr, remote, linkParameters);
+    address_ = url.host_;
+    port_ = url.port_;
+
+    // Server is notified first so it is ready to receive the first message from the client.
+    remote->OnConnected();
+    OnConnected();
+    return true;
+}
+
+void LoopbackConnection::Disconnect()
+{
+    if (state_ == State::Disconnected)
+        return;
+
+    // Ensure that both connections are alive until all callbacks are done executing.
+    SharedPtr<LoopbackConnection> self(this);
+    SharedPtr<LoopbackConnection> remote = remote_.Lock();
+
+    OnDisconnected();
+    if (remote)
+        remote->OnDisconnected();
+}
+
+void LoopbackConnection::SendMessage(ea::string_view data, PacketTypeFlags type)
+{
+    SendPacket(packetPool_->Acquire(data), type);
+}
+
+void LoopbackConnection::SendPacket(NetworkPacket* packet, PacketTypeFlags type)
+{
+    MutexLock lock(mutex_);
+
+    if (state_ != NetworkConnection::State::Connected)
+    {
+        URHO3D_LOGDEBUG("Network message was not sent: connection is not connected.");
+        return;
+    }
+
+    ++numMessagesSent_;
+    numBytesSent_ += packet->GetSize();
+
+    if (!(type & PacketType::Reliable) && random_.GetBool(linkParameters_.loss_))
+    {
+        ++numMessagesLost_;
+        return;
+    }
+
+    // Messages are serialized one by one, so each message waits until the link is free
+    const unsigned currentTime = Time::GetSystemTime();
+    double sendTime = currentTime;
+    if (linkParameters_.bandwidth_ != 0)
+    {
+        linkBusyUntil_ = ea::max(linkBusyUntil_, sendTime) + packet->GetSize() * 1000.0 / linkParameters_.bandwidth_;
+        sendTime = linkBusyUntil_;
+    }
+
+    const unsigned jitter = linkParameters_.jitter_ != 0 ? random_.GetUInt(linkParameters_.jitter_ + 1) : 0;
+    unsigned deliveryTime = static_cast<unsigned>(CeilToInt(sendTime)) + linkParameters_.latency_ + jitter;
+
+    // Ordered messages cannot overtake earlier messages of the same type
+    unsigned& lastDeliveryTime = lastDeliveryTime_[type.AsInteger()];
+    if (type & PacketType::Ordered)
+        deliveryTime = ea::max(deliveryTime, lastDeliveryTime);
+    lastDeliveryTime = deliveryTime;
+
+    pendingMessages_.push_back(PendingMessage{deliveryTime, nextSequence_++, SharedPtr<NetworkPacket>(packet)});
+}
+
+void LoopbackConnection::DeliverMessages()
+{
+    SharedPtr<LoopbackConnection> remote = remote_.Lock();
+    if (!remote || (!remote->onMessage_ && !remote->onPacket_))
+        return;
+
+    {
+        MutexLock lock(mutex_);
+
+        const unsigned currentTime = Time::GetSystemTime();
+        const auto isPending = [&](const PendingMessage& message) { return message.deliveryTime_ > currentTime; };
+        const auto dueBegin = ea::stable_partition(pendingMessages_.begin(), pendingMessages_.end(), isPending);
+
+        dueMessages_.clear();
+        ea::move(dueBegin, pendingMessages_.end(), ea::back_inserter(dueMessages_));
+        pendingMessages_.erase(dueBegin, pendingMessages_.end());
+    }
+
+    const auto isEarlier = [](const PendingMessage& lhs, const PendingMessage& rhs)
+    { return ea::tie(lhs.deliveryTime_, lhs.sequence_) < ea::tie(rhs.deliveryTime_, rhs.sequence_); };
+    ea::sort(dueMessages_.begin(), dueMessages_.end(), isEarlier);
+
+    for (const PendingMessage& message : dueMessages_)
+    {
+        if (remote->GetState() != State::Connected)
+            break;
+
+        if (remote->onPacket_)
+            remote->onPacket_(message.packet_);
+        else
+            remote->onMessage_(message.packet_->GetView());
+    }
+    dueMessages_.clear();
+}
+
+unsigned LoopbackConnection::GetNumMessagesPending() const
+{
+    MutexLock lock(mutex_);
+    return pendingMessages_.size();
+}
+
+void LoopbackConnection::InitializeLink(
+    LoopbackServer* server, LoopbackConnection* remote, const LoopbackLinkParameters& linkParameters)
+{
+    server_ = server;
+    remote_ = remote;
+    linkParameters_ = linkParameters;
+    random_ = RandomEngine{linkParameters.seed_};
+    state_ = State::Connecting;
+}
+
+void LoopbackConnection::OnConnected()
+{
+    state_ = State::Connected;
+    SubscribeToEvent(E_BEGINFRAME, [this] { DeliverMessages(); });
+
+    if (server_ && server_->onConnected_)
+        server_->onConnected_(this);
+    if (onConnected_)
+        onConnected_();
+}
+
+void LoopbackConnection::OnDisconnected()
+{
+    if (state_ == State::Disconnected)
+        return;
+
+    const bool wasConnected = state_ == State::Connected;
+    {
+        MutexLock lock(mutex_);
+        state_ = State::Disconnected;
+        pendingMessages_.clear();
+    }
+    UnsubscribeFromEvent(E_BEGINFRAME);
+
+    if (wasConnected)
+    {
+        if (onDisconnected_)
+            onDisconnected_();
+    }
+    else
+    {
+        if (onError_)
+            onError_();
+    }
+
+    if (server_)
+        server_->OnDisconnected(this);
+}
+
+}   // namespace Urho3D
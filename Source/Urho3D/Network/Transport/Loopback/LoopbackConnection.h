@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Mutex.h>
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Network/AbstractConnection.h>
+#include <Urho3D/Network/Transport/NetworkConnection.h>
+#include <Urho3D/Network/URL.h>
+
+namespace Urho3D
+{
+
+class LoopbackServer;
+
+/// Properties of simulated link between loopback connections.
+/// Parsed from URL query, e.g. "loopback://localhost:2345?latency=50&jitter=10&loss=0.05&bandwidth=65536".
+struct URHO3D_API LoopbackLinkParameters
+{
+    /// One-way delay of each message, in milliseconds.
+    unsigned latency_{};
+    /// Max random addition to the delay, in milliseconds. Unordered messages may be reordered.
+    unsigned jitter_{};
+    /// Probability of unreliable message loss, from 0 to 1.
+    float loss_{};
+    /// Max number of bytes per second in each direction. Unlimited if zero.
+    unsigned bandwidth_{};
+    /// Seed of random generator used for jitter and loss.
+    unsigned seed_{};
+
+    static LoopbackLinkParameters FromQuery(ea::string_view query);
+};
+
+/// Connection to LoopbackServer in the same process. Messages are passed via in-memory queues.
+/// Packets sent via %SendPacket are passed to the remote connection without copying.
+/// Queues are flushed on the main thread at the beginning of each frame or via %DeliverMessages.
+class URHO3D_API LoopbackConnection : public NetworkConnection
+{
+    friend class LoopbackServer;
+    URHO3D_OBJECT(LoopbackConnection, NetworkConnection);
+
+public:
+    explicit LoopbackConnection(Context* context);
+    ~LoopbackConnection() override;
+    static void RegisterObject(Context* context);
+    /// Supports "loopback" scheme. Host and port should match URL passed to %LoopbackServer::Listen.
+    bool Connect(const URL& url) override;
+    void Disconnect() override;
+    void SendMessage(ea::string_view data, PacketTypeFlags type = PacketType::ReliableOrdered) override;
+    void SendPacket(NetworkPacket* packet, PacketTypeFlags type = PacketType::ReliableOrdered) override;
+
+    /// Pass all due messages to the remote connection. Should be called from main thread.
+    void DeliverMessages();
+
+    /// Return statistics of outgoing messages.
+    /// @{
+    unsigned long long GetNumBytesSent() const { return numBytesSent_; }
+    unsigned GetNumMessagesSent() const { return numMessagesSent_; }
+    unsigned GetNumMessagesLost() const { return numMessagesLost_; }
+    unsigned GetNumMessagesPending() const;
+    /// @}
+
+    const LoopbackLinkParameters& GetLinkParameters() const { return linkParameters_; }
+
+protected:
+    struct PendingMessage
+    {
+        unsigned deliveryTime_{};
+        unsigned sequence_{};
+        SharedPtr<NetworkPacket> packet_;
+    };
+
+    void InitializeLink(LoopbackServer* server, LoopbackConnection* remote, const LoopbackLinkParameters& linkParameters);
+    void OnConnected();
+    void OnDisconnected();
+
+    mutable Mutex mutex_;
+    SharedPtr<NetworkPacketPool> packetPool_;
+    WeakPtr<LoopbackServer> server_;
+    WeakPtr<LoopbackConnection> remote_;
+    LoopbackLinkParameters linkParameters_;
+    RandomEngine random_;
+
+    ea::vector<PendingMessage> pendingMessages_;
+    ea::vector<PendingMessage> dueMessages_;
+    unsigned nextSequence_{};
+    double linkBusyUntil_{};
+    unsigned lastDeliveryTime_[4]{};
+
+    unsigned long long numBytesSent_{};
+    unsigned numMessagesSent_{};
+    unsigned numMessagesLost_{};
+};
+
+}   // namespace Urho3D
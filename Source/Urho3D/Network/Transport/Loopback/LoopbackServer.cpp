@@ -0,0 +1,138 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/Mutex.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Network/Transport/Loopback/LoopbackConnection.h>
+#include <Urho3D/Network/Transport/Loopback/LoopbackServer.h>
+
+#include <EASTL/unordered_map.h>
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Registry of all listening servers in the process.
+struct LoopbackServerRegistry
+{
+    Mutex mutex_;
+    ea::unordered_map<ea::string, WeakPtr<LoopbackServer>> servers_;
+};
+
+LoopbackServerRegistry& GetRegistry()
+{
+    static LoopbackServerRegistry registry;
+    return registry;
+}
+
+ea::string GetServerAddress(const URL& url)
+{
+    return Format("{}:{}", url.host_, url.port_);
+}
+
+}
+
+LoopbackServer::LoopbackServer(Context* context)
+    : NetworkServer(context)
+{
+}
+
+LoopbackServer::~LoopbackServer()
+{
+    Stop();
+}
+
+void LoopbackServer::RegisterObject(Context* context)
+{
+    context->AddAbstractReflection<LoopbackServer>(Category_Network);
+}
+
+bool LoopbackServer::Listen(const URL& url)
+{
+    LoopbackServerRegistry& registry = GetRegistry();
+    MutexLock lock(registry.mutex_);
+
+    const ea::string address = GetServerAddress(url);
+    WeakPtr<LoopbackServer>& server = registry.servers_[address];
+    if (server && server != this)
+    {
+        URHO3D_LOGERROR("Loopback server is already listening on {}", address);
+        return false;
+    }
+
+    server = this;
+    address_ = address;
+    return true;
+}
+
+void LoopbackServer::Stop()
+{
+    if (!address_.empty())
+    {
+        LoopbackServerRegistry& registry = GetRegistry();
+        MutexLock lock(registry.mutex_);
+
+        const auto iter = registry.servers_.find(address_);
+        if (iter != registry.servers_.end() && (!iter->second || iter->second == this))
+            registry.servers_.erase(iter);
+        address_.clear();
+    }
+
+    const auto connections = connections_;
+    for (LoopbackConnection* connection : connections)
+        connection->Disconnect();
+    connections_.clear();
+}
+
+LoopbackServer* LoopbackServer::FindServer(const URL& url)
+{
+    LoopbackServerRegistry& registry = GetRegistry();
+    MutexLock lock(registry.mutex_);
+
+    const auto iter = registry.servers_.find(GetServerAddress(url));
+    return iter != registry.servers_.end() ? iter->second.Get() : nullptr;
+}
+
+LoopbackConnection* LoopbackServer::AcceptConnection(
+    LoopbackConnection* remote, const LoopbackLinkParameters& linkParameters)
+{
+    // Use different random sequence for each direction
+    LoopbackLinkParameters serverLinkParameters = linkParameters;
+    serverLinkParameters.seed_ = linkParameters.seed_ + 1;
+
+    auto connection = MakeShared<LoopbackConnection>(context_);
+    connection->InitializeLink(this, remote, serverLinkParameters);
+    connections_.push_back(connection);
+    return connection;
+}
+
+void LoopbackServer::OnDisconnected(LoopbackConnection* connection)
+{
+    if (onDisconnected_)
+        onDisconnected_(connection);
+    connections_.erase_first(SharedPtr<LoopbackConnection>(connection));
+}
+
+}   // namespace Urho3D
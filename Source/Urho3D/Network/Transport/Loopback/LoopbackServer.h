@@ -0,0 +1,62 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Network/Transport/NetworkServer.h>
+
+namespace Urho3D
+{
+
+class LoopbackConnection;
+struct LoopbackLinkParameters;
+
+/// Server that accepts LoopbackConnection-s from the same process.
+/// Useful to test and profile networking of multiple clients without real network.
+class URHO3D_API LoopbackServer : public NetworkServer
+{
+    friend class LoopbackConnection;
+    URHO3D_OBJECT(LoopbackServer, NetworkServer);
+
+public:
+    explicit LoopbackServer(Context* context);
+    ~LoopbackServer() override;
+    static void RegisterObject(Context* context);
+    /// Supports "loopback" scheme. Only one server may listen on the same host and port.
+    bool Listen(const URL& url) override;
+    void Stop() override;
+
+    /// Return server listening on the host and port of the URL, if any.
+    static LoopbackServer* FindServer(const URL& url);
+
+    const ea::vector<SharedPtr<LoopbackConnection>>& GetConnections() const { return connections_; }
+
+protected:
+    LoopbackConnection* AcceptConnection(LoopbackConnection* remote, const LoopbackLinkParameters& linkParameters);
+    void OnDisconnected(LoopbackConnection* connection);
+
+    ea::string address_;
+    ea::vector<SharedPtr<LoopbackConnection>> connections_;
+};
+
+}   // namespace Urho3D
@@ -24,6 +24,8 @@
 
 #include <Urho3D/Core/Object.h>
 #include <Urho3D/Network/AbstractConnection.h>
+#include <Urho3D/Network/NetworkPacket.h>
+#include <Urho3D/Network/URL.h>
 
 namespace Urho3D
 {
@@ -51,6 +53,9 @@ public:
     virtual void Disconnect() = 0;
     /// Copies data and queues it for sending.
     virtual void SendMessage(ea::string_view data, PacketTypeFlags type = PacketType::ReliableOrdered) = 0;
+    /// Queues packet for sending. Transport may keep the reference to the packet instead of copying the data.
+    /// Packet must not be modified after this call.
+    virtual void SendPacket(NetworkPacket* packet, PacketTypeFlags type = PacketType::ReliableOrdered) { SendMessage(packet->GetView(), type); }
     /// Result may be empty, when connection is not %State::Connected.
     ea::string GetAddress() const { return address_; }
     /// Result may be 0, when connection is not %State::Connected or when result is not applicable to the underlying transport.
@@ -65,6 +70,8 @@ public:
     ea::function<void()> onError_;
     /// Called when a new network message is received. May be called from non-main thread.
     ea::function<void(ea::string_view)> onMessage_;
+    /// Called instead of onMessage_ if set and if transport receives ref-counted packets. May be called from non-main thread.
+    ea::function<void(NetworkPacket*)> onPacket_;
 
 protected:
     State state_ = State::Disconnected;
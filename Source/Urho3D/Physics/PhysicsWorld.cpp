@@ -27,6 +27,7 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
@@ -44,6 +45,7 @@
 #include "../Scene/SceneEvents.h"
 
 #include <Bullet/BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <Bullet/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
 #include <Bullet/BulletCollision/CollisionShapes/btBoxShape.h>
@@ -51,52 +53,109 @@
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 #include <BulletCollision/CollisionDispatch/btGhostObject.h>
 
 extern ContactAddedCallback gContactAddedCallback;
 
+/// Custom simulation step, implemented by both single-threaded and multi-threaded worlds.
+class btCustomStepSimulation
+{
+public:
+    virtual void customStepSimulation(unsigned clampedSimulationSteps, btScalar fixedTimeStep, btScalar overtime) = 0;
+    virtual btScalar getLocalTime() const = 0;
+};
+
+template <class T>
 ATTRIBUTE_ALIGNED16(class)
-btCustomDiscreteDynamicsWorld : public btDiscreteDynamicsWorld
+btCustomDynamicsWorld : public T, public btCustomStepSimulation
 {
 public:
-    using btDiscreteDynamicsWorld::btDiscreteDynamicsWorld;
+    using T::T;
 
-    void customStepSimulation(unsigned clampedSimulationSteps, btScalar fixedTimeStep, btScalar overtime)
+    void customStepSimulation(unsigned clampedSimulationSteps, btScalar fixedTimeStep, btScalar overtime) override
     {
-        m_fixedTimeStep = fixedTimeStep;
-        m_localTime = overtime;
+        this->m_fixedTimeStep = fixedTimeStep;
+        this->m_localTime = overtime;
 
-        if (getDebugDrawer())
+        if (this->getDebugDrawer())
         {
-            btIDebugDraw* debugDrawer = getDebugDrawer();
+            btIDebugDraw* debugDrawer = this->getDebugDrawer();
             gDisableDeactivation = (debugDrawer->getDebugMode() & btIDebugDraw::DBG_NoDeactivation) != 0;
         }
 
         if (clampedSimulationSteps > 0)
         {
-            saveKinematicState(fixedTimeStep * clampedSimulationSteps);
+            this->saveKinematicState(fixedTimeStep * clampedSimulationSteps);
 
             for (int i = 0; i < clampedSimulationSteps; i++)
             {
                 // Urho3D: apply gravity on each substep
-                applyGravity();
+                this->applyGravity();
 
-                internalSingleStepSimulation(fixedTimeStep);
-                synchronizeMotionStates();
+                this->internalSingleStepSimulation(fixedTimeStep);
+                this->synchronizeMotionStates();
 
                 // Urho3D: clear forces on each substep
-                clearForces();
+                this->clearForces();
             }
         }
         else
         {
-            synchronizeMotionStates();
+            this->synchronizeMotionStates();
         }
 
-        clearForces();
+        this->clearForces();
     }
 
-    btScalar getLocalTime() const { return m_localTime; }
+    btScalar getLocalTime() const override { return this->m_localTime; }
+};
+
+using btCustomDiscreteDynamicsWorld = btCustomDynamicsWorld<btDiscreteDynamicsWorld>;
+
+/// Multi-threaded world that creates predictive contacts for continuous collision detection in the calling thread.
+/// Parallel creation would add new manifolds to the dispatcher concurrently and in order that depends on scheduling.
+ATTRIBUTE_ALIGNED16(class)
+btCustomDiscreteDynamicsWorldMt : public btCustomDynamicsWorld<btDiscreteDynamicsWorldMt>
+{
+public:
+    using btCustomDynamicsWorld<btDiscreteDynamicsWorldMt>::btCustomDynamicsWorld;
+
+protected:
+    void createPredictiveContacts(btScalar timeStep) override
+    {
+        btDiscreteDynamicsWorld::createPredictiveContacts(timeStep);
+    }
+};
+
+/// Multi-threaded collision dispatcher that keeps the order of contact manifolds independent of thread scheduling.
+class btDeterministicCollisionDispatcherMt : public btCollisionDispatcherMt
+{
+public:
+    using btCollisionDispatcherMt::btCollisionDispatcherMt;
+
+    void dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& info, btDispatcher* dispatcher) override
+    {
+        const int numOldManifolds = m_manifoldsPtr.size();
+        btCollisionDispatcherMt::dispatchAllCollisionPairs(pairCache, info, dispatcher);
+
+        // New manifolds are appended in groups by thread that created them
+        const int numManifolds = m_manifoldsPtr.size();
+        if (numManifolds - numOldManifolds <= 1)
+            return;
+
+        const auto getUniqueId = [](const btCollisionObject* body) { return body->getBroadphaseHandle()->m_uniqueId; };
+        ea::sort(&m_manifoldsPtr[numOldManifolds], &m_manifoldsPtr[0] + numManifolds,
+            [&](const btPersistentManifold* lhs, const btPersistentManifold* rhs)
+        {
+            const auto lhsKey = ea::make_pair(getUniqueId(lhs->getBody0()), getUniqueId(lhs->getBody1()));
+            const auto rhsKey = ea::make_pair(getUniqueId(rhs->getBody0()), getUniqueId(rhs->getBody1()));
+            return lhsKey < rhsKey;
+        });
+
+        for (int i = numOldManifolds; i < numManifolds; ++i)
+            m_manifoldsPtr[i]->m_index1a = i;
+    }
 };
 
 namespace Urho3D
@@ -107,11 +166,183 @@ static const Vector3 DEFAULT_GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
 
 PhysicsWorldConfig PhysicsWorld::config;
 
+#if BT_THREADSAFE
+/// Bullet task scheduler that executes tasks on WorkQueue threads.
+/// The scheduler is global for Bullet, so each world configures it before simulation.
+class WorkQueueTaskScheduler : public btITaskScheduler
+{
+public:
+    WorkQueueTaskScheduler() : btITaskScheduler("WorkQueue") {}
+
+    /// Set work queue and max number of parallel tasks.
+    void Configure(WorkQueue* workQueue, unsigned numThreads)
+    {
+        workQueue_ = workQueue;
+        numTasks_ = workQueue ? Clamp(numThreads, 1u, workQueue->GetNumProcessingThreads()) : 1;
+    }
+
+    int getMaxNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+    // Bullet indexes per-thread data with global thread index, which may exceed the number of used threads
+    int getNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+    void setNumThreads(int numThreads) override {}
+
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+    {
+        if (numTasks_ <= 1 || iEnd - iBegin <= grainSize)
+        {
+            body.forLoop(iBegin, iEnd);
+            return;
+        }
+
+        std::atomic<int> offset{iBegin};
+        for (unsigned i = 0; i < numTasks_; ++i)
+        {
+            workQueue_->PostTask([&]()
+            {
+                while (true)
+                {
+                    const int beginIndex = offset.fetch_add(grainSize, std::memory_order_relaxed);
+                    if (beginIndex >= iEnd)
+                        break;
+                    body.forLoop(beginIndex, Min(beginIndex + grainSize, iEnd));
+                }
+            }, TaskPriority::Immediate);
+        }
+        workQueue_->CompleteImmediateForThisThread();
+    }
+
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+    {
+        // Sum up chunks in fixed order so the result doesn't depend on scheduling
+        struct SumChunks : public btIParallelForBody
+        {
+            void forLoop(int iBegin, int iEnd) const override
+            {
+                for (int i = iBegin; i < iEnd; ++i)
+                {
+                    const int chunkBegin = begin_ + i * grainSize_;
+                    (*sums_)[i] = body_->sumLoop(chunkBegin, Min(chunkBegin + grainSize_, end_));
+                }
+            }
+
+            const btIParallelSumBody* body_{};
+            int begin_{};
+            int end_{};
+            int grainSize_{};
+            ea::vector<btScalar>* sums_{};
+        };
+
+        grainSize = Max(grainSize, 1);
+        ea::vector<btScalar> sums((iEnd - iBegin + grainSize - 1) / grainSize);
+
+        SumChunks sumChunks;
+        sumChunks.body_ = &body;
+        sumChunks.begin_ = iBegin;
+        sumChunks.end_ = iEnd;
+        sumChunks.grainSize_ = grainSize;
+        sumChunks.sums_ = &sums;
+        parallelFor(0, sums.size(), 1, sumChunks);
+
+        btScalar sum = 0;
+        for (btScalar chunkSum : sums)
+            sum += chunkSum;
+        return sum;
+    }
+
+private:
+    WorkQueue* workQueue_{};
+    unsigned numTasks_{1};
+};
+
+static WorkQueueTaskScheduler* GetTaskScheduler()
+{
+    static WorkQueueTaskScheduler taskScheduler;
+    if (btGetTaskScheduler() != &taskScheduler)
+        btSetTaskScheduler(&taskScheduler);
+    return &taskScheduler;
+}
+#endif
+
 static bool CompareRaycastResults(const PhysicsRaycastResult& lhs, const PhysicsRaycastResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
 }
 
+static void ResetRaycastResult(PhysicsRaycastResult& result)
+{
+    result.position_ = Vector3::ZERO;
+    result.normal_ = Vector3::ZERO;
+    result.distance_ = M_INFINITY;
+    result.hitFraction_ = 0.0f;
+    result.body_ = nullptr;
+}
+
+static void RaycastSingleImpl(const btCollisionWorld* world, PhysicsRaycastResult& result, const Ray& ray,
+    float maxDistance, unsigned collisionMask)
+{
+    btCollisionWorld::ClosestRayResultCallback
+        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
+    rayCallback.m_collisionFilterGroup = (short)0xffff;
+    rayCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+
+    if (rayCallback.hasHit())
+    {
+        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+        result.distance_ = (result.position_ - ray.origin_).Length();
+        result.hitFraction_ = rayCallback.m_closestHitFraction;
+        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+    }
+    else
+        ResetRaycastResult(result);
+}
+
+static void ConvexCastImpl(const btCollisionWorld* world, PhysicsRaycastResult& result, const btConvexShape* shape,
+    const Vector3& startPos, const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
+{
+    btCollisionWorld::ClosestConvexResultCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
+    convexCallback.m_collisionFilterGroup = (short)0xffff;
+    convexCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->convexSweepTest(shape, btTransform(ToBtQuaternion(startRot), convexCallback.m_convexFromWorld),
+        btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld), convexCallback);
+
+    if (convexCallback.hasHit())
+    {
+        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
+        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
+        result.hitFraction_ = convexCallback.m_closestHitFraction;
+    }
+    else
+        ResetRaycastResult(result);
+}
+
+/// Execute queries on WorkQueue threads. Bullet queries are thread-safe only if Bullet is built with BT_THREADSAFE.
+template <class Callback>
+static void ForEachQuery(WorkQueue* workQueue, unsigned numQueries, const Callback& callback)
+{
+    static const unsigned batchSize = 16;
+
+#if BT_THREADSAFE
+    if (workQueue)
+    {
+        ForEachParallel(workQueue, batchSize, numQueries, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+                callback(i);
+        });
+        return;
+    }
+#endif
+
+    for (unsigned i = 0; i < numQueries; ++i)
+        callback(i);
+}
+
 void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep)
 {
     static_cast<PhysicsWorld*>(world->getWorldUserInfo())->PreStep(timeStep);
@@ -202,12 +433,42 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     else
         collisionConfiguration_ = new btDefaultCollisionConfiguration();
 
-    collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
-    btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
+    workQueue_ = GetSubsystem<WorkQueue>();
+#if BT_THREADSAFE
+    multiThreaded_ = PhysicsWorld::config.multiThreaded_ && workQueue_;
+#endif
 
     broadphase_ = ea::make_unique<btDbvtBroadphase>();
-    solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
-    world_ = ea::make_unique<btCustomDiscreteDynamicsWorld>(collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+    if (!multiThreaded_)
+    {
+        collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
+        btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
+
+        solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
+        auto world = ea::make_unique<btCustomDiscreteDynamicsWorld>(collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+        worldStep_ = world.get();
+        world_ = ea::move(world);
+    }
+#if BT_THREADSAFE
+    else
+    {
+        GetTaskScheduler()->Configure(workQueue_, numThreads_);
+
+        collisionDispatcher_ = ea::make_unique<btDeterministicCollisionDispatcherMt>(collisionConfiguration_);
+        btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
+
+        // Every island is solved by single solver, parallel solver of large islands is not deterministic
+        ea::vector<btConstraintSolver*> solvers(workQueue_->GetNumProcessingThreads());
+        for (btConstraintSolver*& solver : solvers)
+            solver = new btSequentialImpulseConstraintSolver();
+        solver_ = ea::make_unique<btConstraintSolverPoolMt>(solvers.data(), solvers.size());
+
+        auto world = ea::make_unique<btCustomDiscreteDynamicsWorldMt>(collisionDispatcher_.get(), broadphase_.get(),
+            static_cast<btConstraintSolverPoolMt*>(solver_.get()), nullptr, collisionConfiguration_);
+        worldStep_ = world.get();
+        world_ = ea::move(world);
+    }
+#endif
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -326,8 +587,10 @@ void PhysicsWorld::Update(float timeStep)
         maxSubSteps = Min(maxSubSteps, maxSubSteps_);
 
     delayedWorldTransforms_.clear();
+    numSyncedBodies_ = 0;
     simulating_ = true;
     PreUpdate(timeStep);
+    ConfigureTaskScheduler();
 
     if (interpolation_)
         world_->stepSimulation(timeStep, maxSubSteps, internalTimeStep);
@@ -342,31 +605,42 @@ void PhysicsWorld::Update(float timeStep)
         }
     }
 
-    PostUpdate(timeStep, world_->getLocalTime());
-    simulating_ = false;
     ApplyDelayedWorldTransforms();
+    PostUpdate(timeStep, worldStep_->getLocalTime());
+    simulating_ = false;
 }
 
 void PhysicsWorld::ApplyDelayedWorldTransforms()
 {
-    // Apply delayed (parented) world transforms now
-    while (!delayedWorldTransforms_.empty())
+    if (delayedWorldTransforms_.empty())
+        return;
+
+    URHO3D_PROFILE("ApplyWorldTransforms");
+
+    // Parent transforms should be assigned before child transforms
+    const bool hasParentedBodies = ea::any_of(delayedWorldTransforms_.begin(), delayedWorldTransforms_.end(),
+        [](const DelayedWorldTransform& transform) { return transform.parentRigidBody_ != nullptr; });
+    if (hasParentedBodies)
     {
-        for (auto i = delayedWorldTransforms_.begin();
-             i != delayedWorldTransforms_.end();)
+        for (DelayedWorldTransform& transform : delayedWorldTransforms_)
         {
-            const DelayedWorldTransform& transform = i->second;
-
-            // If parent's transform has already been assigned, can proceed
-            if (!delayedWorldTransforms_.contains(transform.parentRigidBody_))
+            transform.depth_ = 0;
+            if (transform.parentRigidBody_)
             {
-                transform.rigidBody_->ApplyWorldTransform(transform.worldPosition_, transform.worldRotation_);
-                i = delayedWorldTransforms_.erase(i);
+                for (Node* node = transform.rigidBody_->GetNode(); node; node = node->GetParent())
+                    ++transform.depth_;
             }
-            else
-                ++i;
         }
+
+        ea::stable_sort(delayedWorldTransforms_.begin(), delayedWorldTransforms_.end(),
+            [](const DelayedWorldTransform& lhs, const DelayedWorldTransform& rhs) { return lhs.depth_ < rhs.depth_; });
     }
+
+    for (const DelayedWorldTransform& transform : delayedWorldTransforms_)
+        transform.rigidBody_->ApplyWorldTransform(transform.worldPosition_, transform.worldRotation_);
+
+    numSyncedBodies_ += delayedWorldTransforms_.size();
+    delayedWorldTransforms_.clear();
 }
 
 void PhysicsWorld::CustomUpdate(unsigned numSteps, float fixedTimeStep, float overtime, ea::optional<SynchronizedPhysicsStep> sync)
@@ -375,23 +649,39 @@ void PhysicsWorld::CustomUpdate(unsigned numSteps, float fixedTimeStep, float ov
     const float timeStep = numSteps * fixedTimeStep + overtime;
 
     delayedWorldTransforms_.clear();
+    numSyncedBodies_ = 0;
     simulating_ = true;
     PreUpdate(timeStep);
 
     timeAcc_ = overtime;
     synchronizedStep_ = sync;
-    world_->customStepSimulation(numSteps, fixedTimeStep, overtime);
+    ConfigureTaskScheduler();
+    worldStep_->customStepSimulation(numSteps, fixedTimeStep, overtime);
 
+    ApplyDelayedWorldTransforms();
     PostUpdate(timeStep, overtime);
     simulating_ = false;
-    ApplyDelayedWorldTransforms();
 }
 
 void PhysicsWorld::UpdateCollisions()
 {
+    ConfigureTaskScheduler();
     world_->performDiscreteCollisionDetection();
 }
 
+void PhysicsWorld::ConfigureTaskScheduler()
+{
+#if BT_THREADSAFE
+    if (multiThreaded_)
+        GetTaskScheduler()->Configure(workQueue_, numThreads_);
+#endif
+}
+
+void PhysicsWorld::SetNumThreads(unsigned numThreads)
+{
+    numThreads_ = Max(numThreads, 1u);
+}
+
 void PhysicsWorld::SetFps(int fps)
 {
     fps_ = (unsigned)Clamp(fps, 1, 1000);
@@ -473,29 +763,19 @@ void PhysicsWorld::RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, f
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
-    btCollisionWorld::ClosestRayResultCallback
-        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
-    rayCallback.m_collisionFilterGroup = (short)0xffff;
-    rayCallback.m_collisionFilterMask = (short)collisionMask;
+    RaycastSingleImpl(world_.get(), result, ray, maxDistance, collisionMask);
+}
 
-    world_->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+void PhysicsWorld::RaycastSingleBatch(ea::vector<PhysicsRaycastResult>& results, ea::span<const PhysicsRaycastQuery> queries)
+{
+    URHO3D_PROFILE("PhysicsRaycastSingleBatch");
 
-    if (rayCallback.hasHit())
+    results.resize(queries.size());
+    ForEachQuery(workQueue_, queries.size(), [&](unsigned index)
     {
-        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
-        result.distance_ = (result.position_ - ray.origin_).Length();
-        result.hitFraction_ = rayCallback.m_closestHitFraction;
-        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
-    }
-    else
-    {
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-        result.body_ = nullptr;
-    }
+        const PhysicsRaycastQuery& query = queries[index];
+        RaycastSingleImpl(world_.get(), results[index], query.ray_, query.maxDistance_, query.collisionMask_);
+    });
 }
 
 void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, float segmentDistance, unsigned collisionMask, float overlapDistance)
@@ -558,32 +838,23 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
         URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
 
     btSphereShape shape(radius);
-    Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
-
-    btCollisionWorld::ClosestConvexResultCallback
-        convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
+    const Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
+    ConvexCastImpl(world_.get(), result, &shape, ray.origin_, Quaternion::IDENTITY, endPos, Quaternion::IDENTITY, collisionMask);
+}
 
-    world_->convexSweepTest(&shape, btTransform(btQuaternion::getIdentity(), convexCallback.m_convexFromWorld),
-        btTransform(btQuaternion::getIdentity(), convexCallback.m_convexToWorld), convexCallback);
+void PhysicsWorld::SphereCastBatch(ea::vector<PhysicsRaycastResult>& results, ea::span<const PhysicsSphereCastQuery> queries)
+{
+    URHO3D_PROFILE("PhysicsSphereCastBatch");
 
-    if (convexCallback.hasHit())
-    {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
-    }
-    else
+    results.resize(queries.size());
+    ForEachQuery(workQueue_, queries.size(), [&](unsigned index)
     {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-    }
+        const PhysicsSphereCastQuery& query = queries[index];
+        const btSphereShape shape(query.radius_);
+        const Vector3 endPos = query.ray_.origin_ + query.maxDistance_ * query.ray_.direction_;
+        ConvexCastImpl(world_.get(), results[index], &shape, query.ray_.origin_, Quaternion::IDENTITY, endPos,
+            Quaternion::IDENTITY, query.collisionMask_);
+    });
 }
 
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos,
@@ -654,30 +925,35 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, btCollisionShape* sh
 
     URHO3D_PROFILE("PhysicsConvexCast");
 
-    btCollisionWorld::ClosestConvexResultCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
+    ConvexCastImpl(world_.get(), result, static_cast<btConvexShape*>(shape), startPos, startRot, endPos, endRot, collisionMask);
+}
 
-    world_->convexSweepTest(static_cast<btConvexShape*>(shape), btTransform(ToBtQuaternion(startRot),
-            convexCallback.m_convexFromWorld), btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld),
-        convexCallback);
+void PhysicsWorld::ConvexCastBatch(ea::vector<PhysicsRaycastResult>& results, ea::span<const PhysicsConvexCastQuery> queries)
+{
+    URHO3D_PROFILE("PhysicsConvexCastBatch");
 
-    if (convexCallback.hasHit())
+    for (const PhysicsConvexCastQuery& query : queries)
     {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
+        if (!query.shape_ || !query.shape_->isConvex())
+        {
+            URHO3D_LOGERROR("Can not use null or non-convex collision shape for convex cast");
+            break;
+        }
     }
-    else
+
+    results.resize(queries.size());
+    ForEachQuery(workQueue_, queries.size(), [&](unsigned index)
     {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-    }
+        const PhysicsConvexCastQuery& query = queries[index];
+        if (!query.shape_ || !query.shape_->isConvex())
+        {
+            ResetRaycastResult(results[index]);
+            return;
+        }
+
+        ConvexCastImpl(world_.get(), results[index], static_cast<const btConvexShape*>(query.shape_), query.startPos_,
+            query.startRot_, query.endPos_, query.endRot_, query.collisionMask_);
+    });
 }
 
 void PhysicsWorld::RemoveCachedGeometry(Model* model)
@@ -793,7 +1069,11 @@ void PhysicsWorld::RemoveRigidBody(RigidBody* body)
 {
     rigidBodies_.erase_first(body);
     // Remove possible dangling pointer from the delayedWorldTransforms structure
-    delayedWorldTransforms_.erase(body);
+    if (!delayedWorldTransforms_.empty())
+    {
+        ea::erase_if(delayedWorldTransforms_,
+            [body](const DelayedWorldTransform& transform) { return transform.rigidBody_ == body; });
+    }
 }
 
 void PhysicsWorld::AddCollisionShape(CollisionShape* shape)
@@ -818,7 +1098,7 @@ void PhysicsWorld::RemoveConstraint(Constraint* constraint)
 
 void PhysicsWorld::AddDelayedWorldTransform(const DelayedWorldTransform& transform)
 {
-    delayedWorldTransforms_[transform.rigidBody_] = transform;
+    delayedWorldTransforms_.push_back(transform);
 }
 
 void PhysicsWorld::DrawDebugGeometry(bool depthTest)
@@ -894,6 +1174,9 @@ void PhysicsWorld::PostUpdate(float timeStep, float overtime)
 
 void PhysicsWorld::PreStep(float timeStep)
 {
+    // Apply transforms from the previous substep so the scene is up to date in event handlers
+    ApplyDelayedWorldTransforms();
+
     // Send pre-step event
     using namespace PhysicsPreStep;
 
@@ -26,6 +26,8 @@
 
 #include "../IO/VectorBuffer.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Quaternion.h"
+#include "../Math/Ray.h"
 #include "../Math/Sphere.h"
 #include "../Math/Vector3.h"
 #include "../Replica/NetworkId.h"
@@ -41,13 +43,14 @@
 #endif
 
 #include <EASTL/optional.h>
+#include <EASTL/span.h>
 
 class btCollisionConfiguration;
 class btCollisionShape;
 class btBroadphaseInterface;
 class btConstraintSolver;
 class btDiscreteDynamicsWorld;
-class btCustomDiscreteDynamicsWorld;
+class btCustomStepSimulation;
 class btDispatcher;
 class btDynamicsWorld;
 class btPersistentManifold;
@@ -58,10 +61,10 @@ namespace Urho3D
 
 class CollisionShape;
 class Deserializer;
+class WorkQueue;
 class Constraint;
 class Model;
 class Node;
-class Ray;
 class RigidBody;
 class Scene;
 class Serializer;
@@ -96,17 +99,60 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_{};
 };
 
-/// Delayed world transform assignment for parented rigidbodies.
+/// Physics raycast query for batched raycasts.
+struct PhysicsRaycastQuery
+{
+    /// Ray in world space.
+    Ray ray_;
+    /// Max distance along the ray.
+    float maxDistance_{};
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Physics swept sphere query for batched sphere casts.
+struct PhysicsSphereCastQuery
+{
+    /// Ray along which the sphere is swept.
+    Ray ray_;
+    /// Sphere radius.
+    float radius_{};
+    /// Max distance along the ray.
+    float maxDistance_{};
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Physics swept convex shape query for batched convex casts.
+struct PhysicsConvexCastQuery
+{
+    /// Convex Bullet collision shape.
+    btCollisionShape* shape_{};
+    /// Start position.
+    Vector3 startPos_;
+    /// Start rotation.
+    Quaternion startRot_;
+    /// End position.
+    Vector3 endPos_;
+    /// End rotation.
+    Quaternion endRot_;
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Delayed world transform assignment for rigidbodies. Applied in one pass after the simulation step.
 struct DelayedWorldTransform
 {
     /// Rigid body.
     RigidBody* rigidBody_;
-    /// Parent rigid body.
+    /// Parent rigid body, if any.
     RigidBody* parentRigidBody_;
     /// New world position.
     Vector3 worldPosition_;
     /// New world rotation.
     Quaternion worldRotation_;
+    /// Depth of the node in the scene hierarchy. Used to apply parent transforms first.
+    unsigned depth_{};
 };
 
 /// Manifold pointers stored during collision processing.
@@ -129,12 +175,16 @@ struct ManifoldPair
 struct PhysicsWorldConfig
 {
     PhysicsWorldConfig() :
-        collisionConfig_(nullptr)
+        collisionConfig_(nullptr),
+        multiThreaded_(false)
     {
     }
 
     /// Override for the collision configuration (default btDefaultCollisionConfiguration).
     btCollisionConfiguration* collisionConfig_;
+    /// Whether to create multi-threaded world that runs simulation tasks on WorkQueue threads.
+    /// Ignored if the engine is built without threading.
+    bool multiThreaded_;
 };
 
 static const int DEFAULT_FPS = 60;
@@ -213,6 +263,8 @@ public:
     void SetSplitImpulse(bool enable);
     /// Set maximum angular velocity for network replication.
     void SetMaxNetworkAngularVelocity(float velocity);
+    /// Set max number of threads used by multi-threaded world, including main thread. Simulation results don't depend on it.
+    void SetNumThreads(unsigned numThreads);
     /// Perform a physics world raycast and return all hits.
     void Raycast
         (ea::vector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -230,6 +282,15 @@ public:
     /// Perform a physics world swept convex test using a user-supplied Bullet collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, btCollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform multiple physics world raycasts and return the closest hit for each.
+    /// Queries are executed in parallel if possible. Must not be called during simulation step.
+    void RaycastSingleBatch(ea::vector<PhysicsRaycastResult>& results, ea::span<const PhysicsRaycastQuery> queries);
+    /// Perform multiple physics world swept sphere tests and return the closest hit for each.
+    /// Queries are executed in parallel if possible. Must not be called during simulation step.
+    void SphereCastBatch(ea::vector<PhysicsRaycastResult>& results, ea::span<const PhysicsSphereCastQuery> queries);
+    /// Perform multiple physics world swept convex tests and return the closest hit for each.
+    /// Queries are executed in parallel if possible. Must not be called during simulation step.
+    void ConvexCastBatch(ea::vector<PhysicsRaycastResult>& results, ea::span<const PhysicsConvexCastQuery> queries);
     /// Invalidate cached collision geometry for a model.
     void RemoveCachedGeometry(Model* model);
     /// Return rigid bodies by a sphere query.
@@ -275,6 +336,10 @@ public:
 
     /// Return maximum angular velocity for network replication.
     float GetMaxNetworkAngularVelocity() const { return maxNetworkAngularVelocity_; }
+    /// Return whether the world is multi-threaded. See PhysicsWorldConfig.
+    bool IsMultiThreaded() const { return multiThreaded_; }
+    /// Return max number of threads used by multi-threaded world.
+    unsigned GetNumThreads() const { return numThreads_; }
 
     /// Add a rigid body to keep track of. Called by RigidBody.
     void AddRigidBody(RigidBody* body);
@@ -320,6 +385,8 @@ public:
 
     /// Return whether is currently inside the Bullet substep loop.
     bool IsSimulating() const { return simulating_; }
+    /// Return number of rigid body transforms applied to scene nodes during last update. Sleeping bodies are not synchronized.
+    unsigned GetNumSyncedBodies() const { return numSyncedBodies_; }
 
     /// Overrides of the internal configuration.
     static struct PhysicsWorldConfig config;
@@ -342,6 +409,8 @@ private:
     /// Send accumulated collision events.
     void SendCollisionEvents();
     void ApplyDelayedWorldTransforms();
+    /// Configure Bullet task scheduler for multi-threaded world.
+    void ConfigureTaskScheduler();
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -352,7 +421,15 @@ private:
     /// Bullet constraint solver.
     ea::unique_ptr<btConstraintSolver> solver_;
     /// Bullet physics world.
-    ea::unique_ptr<btCustomDiscreteDynamicsWorld> world_;
+    ea::unique_ptr<btDiscreteDynamicsWorld> world_;
+    /// Custom simulation step of Bullet physics world.
+    btCustomStepSimulation* worldStep_{};
+    /// Work queue used by multi-threaded world.
+    WeakPtr<WorkQueue> workQueue_;
+    /// Whether the world is multi-threaded.
+    bool multiThreaded_{};
+    /// Max number of threads used by multi-threaded world.
+    unsigned numThreads_{M_MAX_UNSIGNED};
     /// Extra weak pointer to scene to allow for cleanup in case the world is destroyed before other components.
     WeakPtr<Scene> scene_;
     /// Rigid bodies in the world.
@@ -365,8 +442,10 @@ private:
     ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> currentCollisions_;
     /// Collision pairs on the previous frame. Used to check if a collision is "new." Manifolds are not guaranteed to exist anymore.
     ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> previousCollisions_;
-    /// Delayed (parented) world transform assignments.
-    ea::unordered_map<RigidBody*, DelayedWorldTransform> delayedWorldTransforms_;
+    /// Delayed world transform assignments.
+    ea::vector<DelayedWorldTransform> delayedWorldTransforms_;
+    /// Number of rigid body transforms applied during last update.
+    unsigned numSyncedBodies_{};
     /// Cache for trimesh geometry data by model and LOD level.
     CollisionGeometryDataCache triMeshCache_;
     /// Cache for convex geometry data by model and LOD level.
@@ -167,23 +167,17 @@ void RigidBody::setWorldTransform(const btTransform& worldTrans)
     // while its scene node has already been destroyed
     if (node_)
     {
-        // If the rigid body is parented to another rigid body, can not set the transform immediately.
-        // In that case store it to PhysicsWorld for delayed assignment
+        // Transforms of all bodies are applied by PhysicsWorld in one pass, parent rigid bodies first
         Node* parent = node_->GetParent();
         if (parent != GetScene() && parent)
             parentRigidBody = parent->GetComponent<RigidBody>();
 
-        if (!parentRigidBody)
-            ApplyWorldTransform(newWorldPosition, newWorldRotation);
-        else
-        {
-            DelayedWorldTransform delayed;
-            delayed.rigidBody_ = this;
-            delayed.parentRigidBody_ = parentRigidBody;
-            delayed.worldPosition_ = newWorldPosition;
-            delayed.worldRotation_ = newWorldRotation;
-            physicsWorld_->AddDelayedWorldTransform(delayed);
-        }
+        DelayedWorldTransform delayed;
+        delayed.rigidBody_ = this;
+        delayed.parentRigidBody_ = parentRigidBody;
+        delayed.worldPosition_ = newWorldPosition;
+        delayed.worldRotation_ = newWorldRotation;
+        physicsWorld_->AddDelayedWorldTransform(delayed);
     }
 
     hasSimulated_ = true;
@@ -683,8 +677,7 @@ void RigidBody::ApplyWorldTransform(const Vector3& newWorldPosition, const Quate
 
     physicsWorld_->SetApplyingTransforms(true);
 
-    node_->SetWorldPosition(newWorldPosition);
-    node_->SetWorldRotation(newWorldRotation);
+    node_->SetWorldTransform(newWorldPosition, newWorldRotation);
     lastPosition_ = node_->GetWorldPosition();
     lastRotation_ = node_->GetWorldRotation();
 
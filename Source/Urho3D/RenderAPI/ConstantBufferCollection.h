@@ -64,11 +64,7 @@ public:
         const unsigned alignedSize = (size + alignment_ - 1) / alignment_ * alignment_;
 
         if (bufferSize_ - buffers_[currentBufferIndex_].second < alignedSize)
-        {
-            ++currentBufferIndex_;
-            if (buffers_.size() <= currentBufferIndex_)
-                AllocateBuffer();
-        }
+            NextBuffer();
 
         auto& currentBuffer = buffers_[currentBufferIndex_];
         const unsigned offset = currentBuffer.second;
@@ -78,6 +74,29 @@ public:
         return {{ currentBufferIndex_, offset, size }, data };
     }
 
+    /// Append all blocks of another collection. Blocks keep their offsets, buffer indices are shifted.
+    /// Return index of the first appended buffer.
+    unsigned AppendBuffers(const ConstantBufferCollection& other)
+    {
+        assert(alignment_ == other.alignment_ && bufferSize_ == other.bufferSize_);
+
+        if (buffers_[currentBufferIndex_].second != 0)
+            NextBuffer();
+
+        const unsigned baseIndex = currentBufferIndex_;
+        for (unsigned i = 0; i < other.GetNumBuffers(); ++i)
+        {
+            if (i != 0)
+                NextBuffer();
+
+            auto& currentBuffer = buffers_[currentBufferIndex_];
+            const auto& otherBuffer = other.buffers_[i];
+            memcpy(currentBuffer.first.data(), otherBuffer.first.data(), otherBuffer.second);
+            currentBuffer.second = otherBuffer.second;
+        }
+        return baseIndex;
+    }
+
     /// Return number of buffers.
     unsigned GetNumBuffers() const { return currentBufferIndex_ + 1; }
 
@@ -200,6 +219,14 @@ public:
     }
 
 private:
+    /// Switch to the next buffer, allocate it if necessary.
+    void NextBuffer()
+    {
+        ++currentBufferIndex_;
+        if (buffers_.size() <= currentBufferIndex_)
+            AllocateBuffer();
+    }
+
     /// Allocate one more buffer.
     void AllocateBuffer()
     {
@@ -70,6 +70,48 @@ void DrawCommandQueue::Reset()
     scissorRects_.push_back(IntRect::ZERO);
 }
 
+void DrawCommandQueue::Append(const DrawCommandQueue& other)
+{
+    URHO3D_ASSERT(renderDevice_ == other.renderDevice_);
+
+    const unsigned constantBufferOffset = constantBuffers_.collection_.AppendBuffers(other.constantBuffers_.collection_);
+    const unsigned shaderResourceOffset = shaderResources_.size();
+    const unsigned unorderedAccessViewOffset = unorderedAccessViews_.size();
+    const unsigned scissorRectOffset = scissorRects_.size();
+
+    const auto rebaseCommand = [&](DrawCommandDescription cmd)
+    {
+        for (ConstantBufferCollectionRef& ref : cmd.constantBuffers_)
+            ref.index_ += constantBufferOffset;
+        cmd.shaderResources_.first += shaderResourceOffset;
+        cmd.shaderResources_.second += shaderResourceOffset;
+        cmd.unorderedAccessViews_.first += unorderedAccessViewOffset;
+        cmd.unorderedAccessViews_.second += unorderedAccessViewOffset;
+        cmd.scissorRect_ += scissorRectOffset;
+        return cmd;
+    };
+
+    shaderResources_.insert(shaderResources_.end(), other.shaderResources_.begin(), other.shaderResources_.end());
+    unorderedAccessViews_.insert(
+        unorderedAccessViews_.end(), other.unorderedAccessViews_.begin(), other.unorderedAccessViews_.end());
+    scissorRects_.insert(scissorRects_.end(), other.scissorRects_.begin(), other.scissorRects_.end());
+
+    drawCommands_.reserve(drawCommands_.size() + other.drawCommands_.size());
+    for (const DrawCommandDescription& cmd : other.drawCommands_)
+        drawCommands_.push_back(rebaseCommand(cmd));
+
+    // Inherit current state
+    currentDrawCommand_ = rebaseCommand(other.currentDrawCommand_);
+    currentShaderProgramReflection_ = other.currentShaderProgramReflection_;
+    constantBuffers_.currentHashes_ = other.constantBuffers_.currentHashes_;
+    constantBuffers_.currentGroup_ = MAX_SHADER_PARAMETER_GROUPS;
+    constantBuffers_.currentData_ = nullptr;
+    currentShaderResourceGroup_.first = other.currentShaderResourceGroup_.first + shaderResourceOffset;
+    currentShaderResourceGroup_.second = other.currentShaderResourceGroup_.second + shaderResourceOffset;
+    currentUnorderedAccessViewGroup_.first = other.currentUnorderedAccessViewGroup_.first + unorderedAccessViewOffset;
+    currentUnorderedAccessViewGroup_.second = other.currentUnorderedAccessViewGroup_.second + unorderedAccessViewOffset;
+}
+
 void DrawCommandQueue::ExecuteInContext(RenderContext* renderContext)
 {
     if (drawCommands_.empty())
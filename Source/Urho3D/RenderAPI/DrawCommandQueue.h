@@ -307,6 +307,15 @@ public:
         drawCommands_.push_back(currentDrawCommand_);
     }
 
+    /// Append commands recorded in another queue. The other queue should be recorded for the same render device.
+    /// Current state of the other queue is inherited, so recording may continue as if it was one queue.
+    void Append(const DrawCommandQueue& other);
+
+    /// Return current scissor rect.
+    const IntRect& GetCurrentScissorRect() const { return scissorRects_[currentDrawCommand_.scissorRect_]; }
+    /// Return number of draw commands in the queue.
+    unsigned GetNumDrawCommands() const { return drawCommands_.size(); }
+
     /// Execute commands in the queue.
     void ExecuteInContext(RenderContext* renderContext);
 
@@ -333,7 +333,7 @@ void BatchCompositor::ComposeLightVolumeBatches()
     }
 
     FillSortKeys(sortedLightVolumeBatches_, lightVolumeBatches_);
-    ea::sort(sortedLightVolumeBatches_.begin(), sortedLightVolumeBatches_.end());
+    lightVolumeBatchSorter_.Sort(sortedLightVolumeBatches_, workQueue_);
 }
 
 void BatchCompositor::OnUpdateBegin(const CommonFrameInfo& frameInfo)
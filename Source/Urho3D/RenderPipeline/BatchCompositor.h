@@ -26,6 +26,7 @@
 #include "../RenderPipeline/BatchStateCache.h"
 #include "../RenderPipeline/DrawableProcessor.h"
 #include "../RenderPipeline/InstancingBuffer.h"
+#include "../RenderPipeline/PipelineBatchSorter.h"
 
 #include <EASTL/sort.h>
 
@@ -306,6 +307,7 @@ private:
     WorkQueueVector<ea::pair<ShadowSplitProcessor*, PipelineBatchDesc>> delayedShadowBatches_;
     ea::vector<PipelineBatch> lightVolumeBatches_;
     ea::vector<PipelineBatchByState> sortedLightVolumeBatches_;
+    PipelineBatchSorter<PipelineBatchByState> lightVolumeBatchSorter_;
 };
 
 }
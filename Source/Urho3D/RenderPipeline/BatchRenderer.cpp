@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../RenderAPI/DrawCommandQueue.h"
 #include "../Graphics/Drawable.h"
@@ -945,6 +946,17 @@ BatchRenderingContext::BatchRenderingContext(DrawCommandQueue& drawQueue, const
 {
 }
 
+BatchRenderingContext::BatchRenderingContext(DrawCommandQueue& drawQueue, const BatchRenderingContext& other)
+    : drawQueue_(drawQueue)
+    , camera_(other.camera_)
+    , outputShadowSplit_(other.outputShadowSplit_)
+    , instanceMultiplier_(other.instanceMultiplier_)
+    , globalResources_(other.globalResources_)
+    , frameParameters_(other.frameParameters_)
+    , cameraParameters_(other.cameraParameters_)
+{
+}
+
 BatchRenderer::BatchRenderer(RenderPipelineInterface* renderPipeline, const DrawableProcessor* drawableProcessor,
     InstancingBuffer* instancingBuffer)
     : Object(renderPipeline->GetContext())
@@ -952,6 +964,11 @@ BatchRenderer::BatchRenderer(RenderPipelineInterface* renderPipeline, const Draw
     , debugger_(renderPipeline->GetDebugger())
     , drawableProcessor_(drawableProcessor)
     , instancingBuffer_(instancingBuffer)
+    , workQueue_(context_->GetSubsystem<WorkQueue>())
+{
+}
+
+BatchRenderer::~BatchRenderer()
 {
 }
 
@@ -962,27 +979,47 @@ void BatchRenderer::SetSettings(const BatchRendererSettings& settings)
 
 void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatchGroup<PipelineBatchByState> batchGroup)
 {
-    batchGroup.flags_ = AdjustRenderFlags(batchGroup.flags_);
+    RenderBatchesImpl(ctx, batchGroup);
+}
+
+void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatchGroup<PipelineBatchBackToFront> batchGroup)
+{
+    RenderBatchesImpl(ctx, batchGroup);
+}
 
+void BatchRenderer::RenderLightVolumeBatches(const BatchRenderingContext& ctx,
+    ea::span<const PipelineBatchByState> batches)
+{
     if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
     {
         DrawCommandCompositor<true> compositor(ctx, settings_, debugger_,
-            *drawableProcessor_, *instancingBuffer_, batchGroup.flags_, batchGroup.startInstance_);
-        for (const auto& sortedBatch : batchGroup.batches_)
-            compositor.ProcessSceneBatch(*sortedBatch.pipelineBatch_);
-        compositor.FlushDrawCommands(batchGroup.startInstance_ + batchGroup.numInstances_);
+            *drawableProcessor_, *instancingBuffer_, BatchRenderFlag::EnablePixelLights, 0);
+        for (const auto& sortedBatch : batches)
+            compositor.ProcessLightVolumeBatch(*sortedBatch.pipelineBatch_);
+        compositor.FlushDrawCommands(0);
     }
     else
     {
         DrawCommandCompositor<false> compositor(ctx, settings_, nullptr,
-            *drawableProcessor_, *instancingBuffer_, batchGroup.flags_, batchGroup.startInstance_);
-        for (const auto& sortedBatch : batchGroup.batches_)
-            compositor.ProcessSceneBatch(*sortedBatch.pipelineBatch_);
-        compositor.FlushDrawCommands(batchGroup.startInstance_ + batchGroup.numInstances_);
+            *drawableProcessor_, *instancingBuffer_, BatchRenderFlag::EnablePixelLights, 0);
+        for (const auto& sortedBatch : batches)
+            compositor.ProcessLightVolumeBatch(*sortedBatch.pipelineBatch_);
+        compositor.FlushDrawCommands(0);
     }
 }
 
-void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatchGroup<PipelineBatchBackToFront> batchGroup)
+void BatchRenderer::PrepareInstancingBuffer(PipelineBatchGroup<PipelineBatchByState>& batches)
+{
+    PrepareInstancingBufferImpl(batches);
+}
+
+void BatchRenderer::PrepareInstancingBuffer(PipelineBatchGroup<PipelineBatchBackToFront>& batches)
+{
+    PrepareInstancingBufferImpl(batches);
+}
+
+template <class T>
+void BatchRenderer::RenderBatchesImpl(const BatchRenderingContext& ctx, PipelineBatchGroup<T> batchGroup)
 {
     batchGroup.flags_ = AdjustRenderFlags(batchGroup.flags_);
 
@@ -994,6 +1031,11 @@ void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatc
             compositor.ProcessSceneBatch(*sortedBatch.pipelineBatch_);
         compositor.FlushDrawCommands(batchGroup.startInstance_ + batchGroup.numInstances_);
     }
+    else if (settings_.parallelRecording_ && workQueue_ && workQueue_->GetNumProcessingThreads() > 1
+        && batchGroup.batches_.size() > ParallelRecordingBucketSize)
+    {
+        RenderBatchesInParallel(ctx, batchGroup);
+    }
     else
     {
         DrawCommandCompositor<false> compositor(ctx, settings_, nullptr,
@@ -1004,35 +1046,101 @@ void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatc
     }
 }
 
-void BatchRenderer::RenderLightVolumeBatches(const BatchRenderingContext& ctx,
-    ea::span<const PipelineBatchByState> batches)
+template <class T>
+void BatchRenderer::RenderBatchesInParallel(const BatchRenderingContext& ctx, const PipelineBatchGroup<T>& batchGroup)
 {
-    if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
-    {
-        DrawCommandCompositor<true> compositor(ctx, settings_, debugger_,
-            *drawableProcessor_, *instancingBuffer_, BatchRenderFlag::EnablePixelLights, 0);
-        for (const auto& sortedBatch : batches)
-            compositor.ProcessLightVolumeBatch(*sortedBatch.pipelineBatch_);
-        compositor.FlushDrawCommands(0);
-    }
-    else
+    // Instancing data is already stored, find first instance of each chunk
+    SplitIntoRecordingChunks(batchGroup, ParallelRecordingBucketSize, chunks_);
+    const unsigned numChunks = chunks_.size();
+    const unsigned endInstance = batchGroup.startInstance_ + batchGroup.numInstances_;
+
+    auto renderDevice = GetSubsystem<RenderDevice>();
+    while (chunkDrawQueues_.size() < numChunks)
+        chunkDrawQueues_.push_back(MakeShared<DrawCommandQueue>(renderDevice));
+
+    // Record each chunk into separate queue as if it was the beginning of the batch group
+    const IntRect scissorRect = ctx.drawQueue_.GetCurrentScissorRect();
+    ForEachParallel(workQueue_, 1u, numChunks, [&](unsigned beginChunk, unsigned endChunk)
     {
-        DrawCommandCompositor<false> compositor(ctx, settings_, nullptr,
-            *drawableProcessor_, *instancingBuffer_, BatchRenderFlag::EnablePixelLights, 0);
-        for (const auto& sortedBatch : batches)
-            compositor.ProcessLightVolumeBatch(*sortedBatch.pipelineBatch_);
-        compositor.FlushDrawCommands(0);
-    }
+        for (unsigned chunkIndex = beginChunk; chunkIndex < endChunk; ++chunkIndex)
+        {
+            const BatchRecordingChunk& chunk = chunks_[chunkIndex];
+            DrawCommandQueue& drawQueue = *chunkDrawQueues_[chunkIndex];
+            drawQueue.Reset();
+            if (scissorRect != IntRect::ZERO)
+                drawQueue.SetScissorRect(scissorRect);
+
+            const BatchRenderingContext chunkCtx{drawQueue, ctx};
+            DrawCommandCompositor<false> compositor(chunkCtx, settings_, nullptr,
+                *drawableProcessor_, *instancingBuffer_, batchGroup.flags_, chunk.startInstance_);
+
+            for (unsigned i = chunk.beginBatch_; i < chunk.endBatch_; ++i)
+                compositor.ProcessSceneBatch(*batchGroup.batches_[i].pipelineBatch_);
+            compositor.FlushDrawCommands(
+                chunkIndex + 1 < numChunks ? chunks_[chunkIndex + 1].startInstance_ : endInstance);
+        }
+    });
+
+    for (unsigned chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+        ctx.drawQueue_.Append(*chunkDrawQueues_[chunkIndex]);
 }
 
-void BatchRenderer::PrepareInstancingBuffer(PipelineBatchGroup<PipelineBatchByState>& batches)
+void BatchRenderer::SplitIntoRecordingChunks(const PipelineBatchGroup<PipelineBatchByState>& batchGroup,
+    unsigned minChunkSize, ea::vector<BatchRecordingChunk>& chunks)
 {
-    PrepareInstancingBufferImpl(batches);
+    SplitIntoRecordingChunksImpl(batchGroup, minChunkSize, chunks);
 }
 
-void BatchRenderer::PrepareInstancingBuffer(PipelineBatchGroup<PipelineBatchBackToFront>& batches)
+void BatchRenderer::SplitIntoRecordingChunks(const PipelineBatchGroup<PipelineBatchBackToFront>& batchGroup,
+    unsigned minChunkSize, ea::vector<BatchRecordingChunk>& chunks)
 {
-    PrepareInstancingBufferImpl(batches);
+    SplitIntoRecordingChunksImpl(batchGroup, minChunkSize, chunks);
+}
+
+template <class T>
+void BatchRenderer::SplitIntoRecordingChunksImpl(const PipelineBatchGroup<T>& batchGroup,
+    unsigned minChunkSize, ea::vector<BatchRecordingChunk>& chunks)
+{
+    const ObjectParameterBuilder objectParameterBuilder(BatchRendererSettings{}, batchGroup.flags_);
+    const unsigned numBatches = batchGroup.batches_.size();
+
+    chunks.clear();
+    chunks.push_back(BatchRecordingChunk{0, numBatches, batchGroup.startInstance_});
+
+    // Chunk may begin only where serial recording starts new instancing group anyway:
+    // if state used by instancing group changes or if previous batch is not instanced.
+    // Other state changes (e.g. lighting) may break instancing group too, chunks just don't begin there.
+    const PipelineBatch* previousBatch = nullptr;
+    bool isPreviousBatchInstanced = false;
+    unsigned instanceIndex = batchGroup.startInstance_;
+    for (unsigned i = 0; i < numBatches; ++i)
+    {
+        const PipelineBatch& pipelineBatch = *batchGroup.batches_[i].pipelineBatch_;
+        if (pipelineBatch.geometry_->GetEffectiveIndexCount() == 0)
+            continue;
+
+        const bool isInstanced = objectParameterBuilder.IsBatchInstanced(pipelineBatch);
+        const bool startsInstancingGroup = !previousBatch || !isPreviousBatchInstanced
+            || previousBatch->pipelineState_ != pipelineBatch.pipelineState_
+            || previousBatch->material_ != pipelineBatch.material_
+            || previousBatch->geometry_ != pipelineBatch.geometry_;
+
+        BatchRecordingChunk& lastChunk = chunks.back();
+        if (startsInstancingGroup && i - lastChunk.beginBatch_ >= minChunkSize)
+        {
+            lastChunk.endBatch_ = i;
+            chunks.push_back(BatchRecordingChunk{i, numBatches, instanceIndex});
+        }
+
+        if (isInstanced)
+        {
+            instanceIndex += pipelineBatch.geometryType_ == GEOM_STATIC
+                ? pipelineBatch.GetSourceBatch().numWorldTransforms_ : 1u;
+        }
+
+        previousBatch = &pipelineBatch;
+        isPreviousBatchInstanced = isInstanced;
+    }
 }
 
 template <class T>
@@ -37,6 +37,7 @@ class DrawableProcessor;
 class DrawCommandQueue;
 class InstancingBuffer;
 class ShadowSplitProcessor;
+class WorkQueue;
 
 /// Common parameters of batch rendering
 struct BatchRenderingContext
@@ -52,6 +53,17 @@ struct BatchRenderingContext
 
     BatchRenderingContext(DrawCommandQueue& drawQueue, const Camera& camera);
     BatchRenderingContext(DrawCommandQueue& drawQueue, const ShadowSplitProcessor& outputShadowSplit);
+    /// Construct with the same parameters and another draw queue.
+    BatchRenderingContext(DrawCommandQueue& drawQueue, const BatchRenderingContext& other);
+};
+
+/// Range of batches recorded into separate draw queue when draw commands are recorded in multiple threads.
+struct BatchRecordingChunk
+{
+    unsigned beginBatch_{};
+    unsigned endBatch_{};
+    /// First instance in instancing buffer used by the chunk.
+    unsigned startInstance_{};
 };
 
 /// Utility class to convert pipeline batches into sequence of draw commands.
@@ -60,8 +72,12 @@ class URHO3D_API BatchRenderer : public Object
     URHO3D_OBJECT(BatchRenderer, Object);
 
 public:
+    /// Number of batches recorded by one task when draw commands are recorded in multiple threads.
+    static constexpr unsigned ParallelRecordingBucketSize = 256;
+
     BatchRenderer(RenderPipelineInterface* renderPipeline, const DrawableProcessor* drawableProcessor,
         InstancingBuffer* instancingBuffer);
+    ~BatchRenderer() override;
     void SetSettings(const BatchRendererSettings& settings);
 
     /// Render batches
@@ -78,9 +94,26 @@ public:
     void PrepareInstancingBuffer(PipelineBatchGroup<PipelineBatchBackToFront>& batches);
     /// @}
 
+    /// Split batch group into chunks of at least specified size for parallel recording.
+    /// Chunks are split only at batches that start new instancing group when recorded serially,
+    /// so recorded chunks produce the same draw calls as the whole group.
+    /// @{
+    static void SplitIntoRecordingChunks(const PipelineBatchGroup<PipelineBatchByState>& batchGroup,
+        unsigned minChunkSize, ea::vector<BatchRecordingChunk>& chunks);
+    static void SplitIntoRecordingChunks(const PipelineBatchGroup<PipelineBatchBackToFront>& batchGroup,
+        unsigned minChunkSize, ea::vector<BatchRecordingChunk>& chunks);
+    /// @}
+
 private:
+    template <class T>
+    void RenderBatchesImpl(const BatchRenderingContext& ctx, PipelineBatchGroup<T> batchGroup);
+    template <class T>
+    void RenderBatchesInParallel(const BatchRenderingContext& ctx, const PipelineBatchGroup<T>& batchGroup);
     template <class T>
     void PrepareInstancingBufferImpl(PipelineBatchGroup<T>& batches);
+    template <class T>
+    static void SplitIntoRecordingChunksImpl(const PipelineBatchGroup<T>& batchGroup,
+        unsigned minChunkSize, ea::vector<BatchRecordingChunk>& chunks);
     BatchRenderFlags AdjustRenderFlags(BatchRenderFlags flags) const;
 
     /// External dependencies
@@ -89,9 +122,16 @@ private:
     RenderPipelineDebugger* debugger_{};
     const DrawableProcessor* drawableProcessor_{};
     InstancingBuffer* instancingBuffer_{};
+    WorkQueue* workQueue_{};
     /// @}
 
     BatchRendererSettings settings_;
+
+    /// Draw queues and batch ranges of chunks for parallel recording.
+    /// @{
+    ea::vector<SharedPtr<DrawCommandQueue>> chunkDrawQueues_;
+    ea::vector<BatchRecordingChunk> chunks_;
+    /// @}
 };
 
 }
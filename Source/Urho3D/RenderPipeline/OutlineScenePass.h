@@ -70,6 +70,7 @@ private:
     /// @{
     ShaderProgramDesc shaderProgramDesc_;
     ea::vector<PipelineBatchByState> sortedBatches_;
+    PipelineBatchSorter<PipelineBatchByState> batchSorter_;
     PipelineBatchGroup<PipelineBatchByState> batchGroup_;
     /// @}
 };
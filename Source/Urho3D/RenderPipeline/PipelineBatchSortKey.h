@@ -122,6 +122,12 @@ struct PipelineBatchByState
             return primaryKey_ < rhs.primaryKey_;
         return secondaryKey_ < rhs.secondaryKey_;
     }
+
+    /// Return keys for radix sort.
+    /// @{
+    unsigned long long GetPrimarySortKey() const { return primaryKey_; }
+    unsigned long long GetSecondarySortKey() const { return secondaryKey_; }
+    /// @}
 };
 
 /// Pipeline batch sorted by render order and back to front.
@@ -152,6 +158,19 @@ struct PipelineBatchBackToFront
             return renderOrder_ < rhs.renderOrder_;
         return distance_ > rhs.distance_;
     }
+
+    /// Return keys for radix sort. Render order and distance are packed into single 64-bit key.
+    /// @{
+    unsigned long long GetPrimarySortKey() const
+    {
+        // Map float to unsigned integer preserving the order, then invert it to sort back to front
+        unsigned distanceBits{};
+        memcpy(&distanceBits, &distance_, sizeof(distanceBits));
+        distanceBits = (distanceBits & 0x80000000u) ? ~distanceBits : (distanceBits | 0x80000000u);
+        return (static_cast<unsigned long long>(renderOrder_) << 32) | static_cast<unsigned>(~distanceBits);
+    }
+    unsigned long long GetSecondarySortKey() const { return 0; }
+    /// @}
 };
 
 /// Group of batches to be rendered.
@@ -0,0 +1,292 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../RenderPipeline/PipelineBatchSorter.h"
+
+#include <EASTL/fixed_vector.h>
+#include <EASTL/sort.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Contiguous range of bits copied from the source key into the packed key.
+struct KeyBitRange
+{
+    unsigned sourceOffset_{};
+    unsigned packedOffset_{};
+    unsigned long long mask_{};
+};
+
+using KeyBitRanges = ea::fixed_vector<KeyBitRange, 16>;
+
+/// Append ranges of set bits in the mask. Lower bits go to lower bits of the packed key.
+void AddKeyBitRanges(KeyBitRanges& ranges, unsigned long long mask, unsigned& packedOffset)
+{
+    unsigned offset = 0;
+    while (offset < 64 && (mask >> offset) != 0)
+    {
+        while (((mask >> offset) & 1) == 0)
+            ++offset;
+
+        unsigned length = 0;
+        while (offset + length < 64 && ((mask >> (offset + length)) & 1) != 0)
+            ++length;
+
+        const unsigned long long rangeMask = length < 64 ? (1ull << length) - 1 : ~0ull;
+        ranges.push_back({offset, packedOffset, rangeMask});
+        offset += length;
+        packedOffset += length;
+    }
+}
+
+unsigned long long PackKeyBits(const KeyBitRanges& ranges, unsigned long long key)
+{
+    unsigned long long packedKey = 0;
+    for (const KeyBitRange& range : ranges)
+        packedKey |= ((key >> range.sourceOffset_) & range.mask_) << range.packedOffset_;
+    return packedKey;
+}
+
+unsigned CountBits(unsigned long long value)
+{
+    unsigned count = 0;
+    for (; value != 0; value &= value - 1)
+        ++count;
+    return count;
+}
+
+unsigned GetDigit(unsigned long long key, unsigned digit)
+{
+    return static_cast<unsigned>(key >> (digit * 8)) & 0xff;
+}
+
+}
+
+void PipelineBatchSorterBase::SortKeys(WorkQueue* workQueue)
+{
+    const unsigned numItems = primaryKeys_.size();
+
+    PackKeys();
+
+    previousOrderReused_ = numItems > 0 && numItems == previousOrder_.size() && TryReusePreviousOrder();
+    if (!previousOrderReused_)
+    {
+        if (numItems < MinRadixSortSize)
+        {
+            ea::sort(items_.begin(), items_.end(),
+                [this](const SortItem& lhs, const SortItem& rhs) { return IsItemLess(lhs, rhs); });
+        }
+        else
+        {
+            RadixSort(workQueue);
+            if (!isSecondaryKeyPacked_)
+                SortBySecondaryKeys();
+        }
+    }
+
+    sortedIndices_.resize(numItems);
+    for (unsigned i = 0; i < numItems; ++i)
+        sortedIndices_[i] = items_[i].index_;
+    previousOrder_ = sortedIndices_;
+}
+
+void PipelineBatchSorterBase::PackKeys()
+{
+    const unsigned numItems = primaryKeys_.size();
+    items_.resize(numItems);
+    if (numItems == 0)
+        return;
+
+    // Bits that are the same in all keys don't affect the order
+    unsigned long long primaryMask = 0;
+    unsigned long long secondaryMask = 0;
+    for (unsigned i = 0; i < numItems; ++i)
+    {
+        primaryMask |= primaryKeys_[i] ^ primaryKeys_[0];
+        secondaryMask |= secondaryKeys_[i] ^ secondaryKeys_[0];
+    }
+
+    // If both keys don't fit, pack primary key only and compare secondary keys on ties
+    isSecondaryKeyPacked_ = CountBits(primaryMask) + CountBits(secondaryMask) <= 64;
+
+    KeyBitRanges primaryRanges;
+    KeyBitRanges secondaryRanges;
+    unsigned packedOffset = 0;
+    if (isSecondaryKeyPacked_)
+        AddKeyBitRanges(secondaryRanges, secondaryMask, packedOffset);
+    AddKeyBitRanges(primaryRanges, primaryMask, packedOffset);
+    numPackedBits_ = packedOffset;
+
+    for (unsigned i = 0; i < numItems; ++i)
+    {
+        unsigned long long key = PackKeyBits(primaryRanges, primaryKeys_[i]);
+        if (isSecondaryKeyPacked_)
+            key |= PackKeyBits(secondaryRanges, secondaryKeys_[i]);
+        items_[i] = SortItem{key, i};
+    }
+}
+
+bool PipelineBatchSorterBase::TryReusePreviousOrder()
+{
+    const unsigned numItems = items_.size();
+    const unsigned maxUnsortedItems = ea::max(1u, numItems / MaxUnsortedRatio);
+
+    // Apply previous order and check how many items are out of order
+    tempItems_.resize(numItems);
+    unsigned numUnsortedItems = 0;
+    for (unsigned i = 0; i < numItems; ++i)
+    {
+        tempItems_[i] = items_[previousOrder_[i]];
+        if (i > 0 && IsItemLess(tempItems_[i], tempItems_[i - 1]))
+        {
+            if (++numUnsortedItems > maxUnsortedItems)
+                return false;
+        }
+    }
+
+    // Fix the order by insertion sort, give up if items are moved too far
+    if (numUnsortedItems > 0)
+    {
+        unsigned movesLeft = numItems;
+        for (unsigned i = 1; i < numItems; ++i)
+        {
+            const SortItem item = tempItems_[i];
+            unsigned j = i;
+            while (j > 0 && IsItemLess(item, tempItems_[j - 1]))
+            {
+                if (movesLeft-- == 0)
+                    return false;
+
+                tempItems_[j] = tempItems_[j - 1];
+                --j;
+            }
+            tempItems_[j] = item;
+        }
+    }
+
+    ea::swap(items_, tempItems_);
+    return true;
+}
+
+void PipelineBatchSorterBase::RadixSort(WorkQueue* workQueue)
+{
+    const unsigned numItems = items_.size();
+    const unsigned numDigits = (numPackedBits_ + 7) / 8;
+    const unsigned numChunks = (numItems + ParallelBucketSize - 1) / ParallelBucketSize;
+    const bool isParallel = workQueue && numChunks > 1;
+
+    const auto forEachChunk = [&](const auto& callback)
+    {
+        if (isParallel)
+        {
+            ForEachParallel(workQueue, ParallelBucketSize, numItems,
+                [&](unsigned beginIndex, unsigned endIndex) { callback(beginIndex / ParallelBucketSize, beginIndex, endIndex); });
+        }
+        else
+        {
+            for (unsigned chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+            {
+                const unsigned beginIndex = chunkIndex * ParallelBucketSize;
+                callback(chunkIndex, beginIndex, ea::min(beginIndex + ParallelBucketSize, numItems));
+            }
+        }
+    };
+
+    // Count all digits at once. Items are reordered after each pass, so per-chunk counts are recounted if needed.
+    chunkCounts_.clear();
+    chunkCounts_.resize(numChunks * NumDigits * NumBuckets);
+    forEachChunk([&](unsigned chunkIndex, unsigned beginIndex, unsigned endIndex)
+    {
+        unsigned* counts = &chunkCounts_[chunkIndex * NumDigits * NumBuckets];
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+        {
+            const unsigned long long key = items_[i].key_;
+            for (unsigned digit = 0; digit < numDigits; ++digit)
+                ++counts[digit * NumBuckets + GetDigit(key, digit)];
+        }
+    });
+
+    tempItems_.resize(numItems);
+    for (unsigned digit = 0; digit < numDigits; ++digit)
+    {
+        if (digit != 0 && numChunks > 1)
+        {
+            forEachChunk([&](unsigned chunkIndex, unsigned beginIndex, unsigned endIndex)
+            {
+                unsigned* counts = &chunkCounts_[(chunkIndex * NumDigits + digit) * NumBuckets];
+                ea::fill_n(counts, NumBuckets, 0u);
+                for (unsigned i = beginIndex; i < endIndex; ++i)
+                    ++counts[GetDigit(items_[i].key_, digit)];
+            });
+        }
+
+        // Convert counts to offsets: items from earlier chunks go first within each bucket
+        unsigned offset = 0;
+        for (unsigned bucket = 0; bucket < NumBuckets; ++bucket)
+        {
+            for (unsigned chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+            {
+                unsigned& count = chunkCounts_[(chunkIndex * NumDigits + digit) * NumBuckets + bucket];
+                const unsigned chunkCount = count;
+                count = offset;
+                offset += chunkCount;
+            }
+        }
+
+        forEachChunk([&](unsigned chunkIndex, unsigned beginIndex, unsigned endIndex)
+        {
+            unsigned* offsets = &chunkCounts_[(chunkIndex * NumDigits + digit) * NumBuckets];
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+                tempItems_[offsets[GetDigit(items_[i].key_, digit)]++] = items_[i];
+        });
+
+        ea::swap(items_, tempItems_);
+    }
+}
+
+void PipelineBatchSorterBase::SortBySecondaryKeys()
+{
+    const unsigned numItems = items_.size();
+    unsigned beginIndex = 0;
+    while (beginIndex < numItems)
+    {
+        unsigned endIndex = beginIndex + 1;
+        while (endIndex < numItems && items_[endIndex].key_ == items_[beginIndex].key_)
+            ++endIndex;
+
+        if (endIndex - beginIndex > 1)
+        {
+            ea::sort(items_.begin() + beginIndex, items_.begin() + endIndex,
+                [this](const SortItem& lhs, const SortItem& rhs) { return IsItemLess(lhs, rhs); });
+        }
+        beginIndex = endIndex;
+    }
+}
+
+}
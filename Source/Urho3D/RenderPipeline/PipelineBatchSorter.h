@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Core/WorkQueue.h"
+
+#include <EASTL/span.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Type-independent implementation of PipelineBatchSorter.
+/// @nobind
+class URHO3D_API PipelineBatchSorterBase
+{
+public:
+    /// Minimum number of batches to use radix sort. Smaller arrays are sorted by comparison.
+    static constexpr unsigned MinRadixSortSize = 256;
+    /// Number of batches processed by one task of parallel radix sort.
+    static constexpr unsigned ParallelBucketSize = 16384;
+    /// Maximum ratio of batches out of order when the order of the previous sort is reused.
+    static constexpr unsigned MaxUnsortedRatio = 32;
+
+    /// Forget the order of the previous sort.
+    void Reset() { previousOrder_.clear(); }
+    /// Return whether the order of the previous sort was reused during the last sort.
+    bool IsPreviousOrderReused() const { return previousOrderReused_; }
+    /// Return whether the secondary key was packed together with the primary key during the last sort.
+    bool IsSecondaryKeyPacked() const { return isSecondaryKeyPacked_; }
+
+protected:
+    /// Sort batches by keys stored in primaryKeys_ and secondaryKeys_. Result is stored in sortedIndices_.
+    /// Order of batches with equal keys is preserved.
+    void SortKeys(WorkQueue* workQueue);
+
+    /// Primary sort keys of batches.
+    ea::vector<unsigned long long> primaryKeys_;
+    /// Secondary sort keys of batches.
+    ea::vector<unsigned long long> secondaryKeys_;
+    /// Indices of batches in sorted order.
+    ea::vector<unsigned> sortedIndices_;
+
+private:
+    static constexpr unsigned NumDigits = 8;
+    static constexpr unsigned NumBuckets = 256;
+
+    /// Sorted item with packed key.
+    struct SortItem
+    {
+        unsigned long long key_{};
+        unsigned index_{};
+    };
+
+    /// Pack bits that differ between batches into single 64-bit key.
+    void PackKeys();
+    /// Compare items, using unpacked secondary keys if necessary and index as the last key.
+    bool IsItemLess(const SortItem& lhs, const SortItem& rhs) const
+    {
+        if (lhs.key_ != rhs.key_)
+            return lhs.key_ < rhs.key_;
+        if (!isSecondaryKeyPacked_ && secondaryKeys_[lhs.index_] != secondaryKeys_[rhs.index_])
+            return secondaryKeys_[lhs.index_] < secondaryKeys_[rhs.index_];
+        return lhs.index_ < rhs.index_;
+    }
+    /// Try to sort items by applying the order of the previous sort and fixing a few misplaced items.
+    bool TryReusePreviousOrder();
+    /// Sort items by parallel LSD radix sort.
+    void RadixSort(WorkQueue* workQueue);
+    /// Sort ranges of items with equal packed keys by secondary key.
+    void SortBySecondaryKeys();
+
+    /// Items to sort.
+    ea::vector<SortItem> items_;
+    /// Temporary storage for items.
+    ea::vector<SortItem> tempItems_;
+    /// Bucket counts and offsets per chunk and digit.
+    ea::vector<unsigned> chunkCounts_;
+    /// Order of items after the previous sort.
+    ea::vector<unsigned> previousOrder_;
+    /// Number of meaningful bits in packed keys.
+    unsigned numPackedBits_{};
+    /// Whether the secondary key is packed into the item key.
+    bool isSecondaryKeyPacked_{};
+    /// Whether the order of the previous sort was reused.
+    bool previousOrderReused_{};
+};
+
+/// Sorts pipeline batches by packed sort keys using radix sort.
+/// Remembers the resulting order and reuses it next time if batches still follow this order.
+/// Order of batches with equal keys is preserved.
+/// @nobind
+template <class T>
+class PipelineBatchSorter : public PipelineBatchSorterBase
+{
+public:
+    /// Sort batches. Large arrays are sorted in multiple threads if work queue is provided.
+    /// Work queue should be provided only when called from main thread.
+    void Sort(ea::span<T> batches, WorkQueue* workQueue = nullptr)
+    {
+        const unsigned numBatches = batches.size();
+        primaryKeys_.resize(numBatches);
+        secondaryKeys_.resize(numBatches);
+        for (unsigned i = 0; i < numBatches; ++i)
+        {
+            primaryKeys_[i] = batches[i].GetPrimarySortKey();
+            secondaryKeys_[i] = batches[i].GetSecondarySortKey();
+        }
+
+        SortKeys(workQueue);
+
+        unsortedBatches_.assign(batches.begin(), batches.end());
+        for (unsigned i = 0; i < numBatches; ++i)
+            batches[i] = unsortedBatches_[sortedIndices_[i]];
+    }
+
+private:
+    /// Copy of batches before sorting.
+    ea::vector<T> unsortedBatches_;
+};
+
+}
@@ -429,6 +429,8 @@ struct BatchRendererSettings
     bool cubemapBoxProjection_{};
     DrawableAmbientMode ambientMode_{ DrawableAmbientMode::Directional };
     Vector2 varianceShadowMapParams_{ 0.0000001f, 0.9f };
+    /// Whether to record draw commands for big batch groups in multiple threads.
+    bool parallelRecording_{true};
 
     /// Utility operators
     /// @{
@@ -448,7 +450,8 @@ struct BatchRendererSettings
     {
         return cubemapBoxProjection_ == rhs.cubemapBoxProjection_
             && ambientMode_ == rhs.ambientMode_
-            && varianceShadowMapParams_ == rhs.varianceShadowMapParams_;
+            && varianceShadowMapParams_ == rhs.varianceShadowMapParams_
+            && parallelRecording_ == rhs.parallelRecording_;
     }
 
     bool operator!=(const BatchRendererSettings& rhs) const { return !(*this == rhs); }
@@ -29,8 +29,6 @@
 #include "../RenderPipeline/BatchRenderer.h"
 #include "../RenderPipeline/ScenePass.h"
 
-#include <EASTL/sort.h>
-
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -57,12 +55,14 @@ void UnorderedScenePass::OnBatchesReady()
     BatchCompositor::FillSortKeys(sortedBaseBatches_, baseBatches_);
     BatchCompositor::FillSortKeys(sortedLightBatches_, lightBatches_, negativeLightBatches_);
 
-    ea::sort(sortedDeferredBatches_.begin(), sortedDeferredBatches_.end());
-    ea::sort(sortedBaseBatches_.begin(), sortedBaseBatches_.end());
+    deferredBatchSorter_.Sort(sortedDeferredBatches_, workQueue_);
+    baseBatchSorter_.Sort(sortedBaseBatches_, workQueue_);
 
     const unsigned numNegativeLightBatches = negativeLightBatches_.Size();
-    ea::sort(sortedLightBatches_.begin(), sortedLightBatches_.end() - numNegativeLightBatches);
-    ea::sort(sortedLightBatches_.end() - numNegativeLightBatches, sortedLightBatches_.end());
+    const unsigned numPositiveLightBatches = sortedLightBatches_.size() - numNegativeLightBatches;
+    const auto lightBatches = ea::span<PipelineBatchByState>(sortedLightBatches_);
+    lightBatchSorter_.Sort(lightBatches.first(numPositiveLightBatches), workQueue_);
+    negativeLightBatchSorter_.Sort(lightBatches.last(numNegativeLightBatches), workQueue_);
 
     deferredBatchGroup_ = { sortedDeferredBatches_ };
     baseBatchGroup_ = { sortedBaseBatches_ };
@@ -131,7 +131,7 @@ void BackToFrontScenePass::OnBatchesReady()
     static const float additiveDistanceFactor = 1 - M_EPSILON;
     static const float subtractiveDistanceFactor = 1 - 2 * M_EPSILON;
 
-    // Validate distances before sorting, NaN may corrupt ea::sort
+    // Validate distances before sorting, NaN may corrupt sorting
     for (PipelineBatchBackToFront& sortedBatch : sortedBatches_)
     {
         if (std::isfinite(sortedBatch.distance_))
@@ -149,7 +149,7 @@ void BackToFrontScenePass::OnBatchesReady()
     for (unsigned i = subtractiveLightBatchesBegin; i < subtractiveLightBatchesEnd; ++i)
         sortedBatches_[i].distance_ *= subtractiveDistanceFactor;
 
-    ea::sort(sortedBatches_.begin(), sortedBatches_.end());
+    batchSorter_.Sort(sortedBatches_, workQueue_);
 
     if (GetFlags().Test(DrawableProcessorPassFlag::RefractionPass))
     {
@@ -24,6 +24,7 @@
 
 #include "../Core/Object.h"
 #include "../RenderPipeline/PipelineBatchSortKey.h"
+#include "../RenderPipeline/PipelineBatchSorter.h"
 #include "../RenderPipeline/BatchCompositor.h"
 #include "../RenderPipeline/DrawableProcessor.h"
 
@@ -76,6 +77,11 @@ protected:
     ea::vector<PipelineBatchByState> sortedBaseBatches_;
     ea::vector<PipelineBatchByState> sortedLightBatches_;
 
+    PipelineBatchSorter<PipelineBatchByState> deferredBatchSorter_;
+    PipelineBatchSorter<PipelineBatchByState> baseBatchSorter_;
+    PipelineBatchSorter<PipelineBatchByState> lightBatchSorter_;
+    PipelineBatchSorter<PipelineBatchByState> negativeLightBatchSorter_;
+
     PipelineBatchGroup<PipelineBatchByState> deferredBatchGroup_;
     PipelineBatchGroup<PipelineBatchByState> baseBatchGroup_;
     PipelineBatchGroup<PipelineBatchByState> lightBatchGroup_;
@@ -99,6 +105,7 @@ protected:
     void OnBatchesReady() override;
 
     ea::vector<PipelineBatchBackToFront> sortedBatches_;
+    PipelineBatchSorter<PipelineBatchBackToFront> batchSorter_;
     bool hasRefractionBatches_{};
 
     PipelineBatchGroup<PipelineBatchBackToFront> batchGroup_;
@@ -347,6 +347,42 @@ void BehaviorNetworkObject::WriteUnreliableDelta(NetworkFrame frame, Serializer&
     }
 }
 
+ea::optional<NetworkFrame> BehaviorNetworkObject::GetUnreliableDeltaKeyframe() const
+{
+    if (const auto keyframe = BaseClassName::GetUnreliableDeltaKeyframe())
+        return keyframe;
+
+    // Only one behavior per object is expected to use keyframes
+    if (callbackMask_.Test(NetworkCallbackMask::UnreliableDelta))
+    {
+        for (const auto& connectedBehavior : behaviors_)
+        {
+            if (unreliableUpdateMask_ & connectedBehavior.bit_)
+            {
+                if (const auto keyframe = connectedBehavior.component_->GetUnreliableDeltaKeyframe())
+                    return keyframe;
+            }
+        }
+    }
+    return ea::nullopt;
+}
+
+void BehaviorNetworkObject::WriteSelfContainedUnreliableDelta(NetworkFrame frame, Serializer& dest)
+{
+    // Default implementation of the base class would call WriteUnreliableDelta of this class
+    BaseClassName::WriteUnreliableDelta(frame, dest);
+
+    if (callbackMask_.Test(NetworkCallbackMask::UnreliableDelta))
+    {
+        dest.WriteVLE(unreliableUpdateMask_);
+        for (const auto& connectedBehavior : behaviors_)
+        {
+            if (unreliableUpdateMask_ & connectedBehavior.bit_)
+                connectedBehavior.component_->WriteSelfContainedUnreliableDelta(frame, dest);
+        }
+    }
+}
+
 void BehaviorNetworkObject::ReadUnreliableDelta(NetworkFrame frame, Deserializer& src)
 {
     BaseClassName::ReadUnreliableDelta(frame, src);
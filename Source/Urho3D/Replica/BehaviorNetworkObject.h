@@ -93,6 +93,8 @@ public:
 
     /// Implement NetworkObject.
     /// @{
+    bool IsDeltaUpdateThreadSafe() const override { return !callbackMask_.Test(NetworkCallbackMask::ThreadUnsafeDelta); }
+
     void InitializeStandalone() override;
     void InitializeOnServer() override;
     void WriteSnapshot(NetworkFrame frame, Serializer& dest) override;
@@ -108,6 +110,8 @@ public:
 
     bool PrepareUnreliableDelta(NetworkFrame frame) override;
     void WriteUnreliableDelta(NetworkFrame frame, Serializer& dest) override;
+    ea::optional<NetworkFrame> GetUnreliableDeltaKeyframe() const override;
+    void WriteSelfContainedUnreliableDelta(NetworkFrame frame, Serializer& dest) override;
     void ReadUnreliableDelta(NetworkFrame frame, Deserializer& src) override;
 
     bool PrepareUnreliableFeedback(NetworkFrame frame) override;
@@ -267,6 +267,7 @@ void ClientReplica::ProcessAddObjects(MemoryBuffer& messageData)
 void ClientReplica::ProcessUpdateObjectsReliable(MemoryBuffer& messageData)
 {
     const auto messageFrame = static_cast<NetworkFrame>(messageData.ReadInt64());
+    latestUpdateFrame_ = ea::max(latestUpdateFrame_.value_or(messageFrame), messageFrame);
     while (!messageData.IsEof())
     {
         const auto networkId = static_cast<NetworkId>(messageData.ReadUInt());
@@ -286,6 +287,7 @@ void ClientReplica::ProcessUpdateObjectsReliable(MemoryBuffer& messageData)
 void ClientReplica::ProcessUpdateObjectsUnreliable(MemoryBuffer& messageData)
 {
     const auto messageFrame = static_cast<NetworkFrame>(messageData.ReadInt64());
+    latestUpdateFrame_ = ea::max(latestUpdateFrame_.value_or(messageFrame), messageFrame);
 
     while (!messageData.IsEof())
     {
@@ -136,6 +136,8 @@ public:
     const ea::unordered_set<WeakPtr<NetworkObject>>& GetOwnedNetworkObjects() const { return ownedObjects_; };
     bool HasOwnedNetworkObjects() const { return !ownedObjects_.empty(); }
     NetworkObject* GetOwnedNetworkObject() const { return ownedObjects_.size() == 1 ? *ownedObjects_.begin() : nullptr; }
+    /// Return the latest server frame received in object updates.
+    ea::optional<NetworkFrame> GetLatestUpdateFrame() const { return latestUpdateFrame_; }
 
 private:
     void OnInputReady(float timeStep);
@@ -159,6 +161,7 @@ private:
     ea::unordered_set<WeakPtr<NetworkObject>> ownedObjects_;
 
     VectorBuffer componentBuffer_;
+    ea::optional<NetworkFrame> latestUpdateFrame_;
 };
 
 }
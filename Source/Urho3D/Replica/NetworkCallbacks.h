@@ -64,6 +64,12 @@ enum class NetworkCallbackMask
 
     Update                  = 1 << 7,
     /// @}
+
+    /// Flags
+    /// @{
+    /// Delta callbacks should be called from the main thread only.
+    ThreadUnsafeDelta       = 1 << 8,
+    /// @}
 };
 URHO3D_FLAGSET(NetworkCallbackMask, NetworkCallbackFlags);
 
@@ -92,6 +98,12 @@ public:
     virtual bool PrepareUnreliableDelta(NetworkFrame frame) { return false; }
     /// Write unreliable delta update.
     virtual void WriteUnreliableDelta(NetworkFrame frame, Serializer& dest) {}
+    /// Return the frame of the keyframe that the last written unreliable delta depends on, if any.
+    /// Return the frame of the delta itself if the delta is a keyframe.
+    virtual ea::optional<NetworkFrame> GetUnreliableDeltaKeyframe() const { return ea::nullopt; }
+    /// Write unreliable delta update that doesn't depend on any keyframe.
+    /// It is sent instead of the last written delta to the clients that were not sent the keyframe.
+    virtual void WriteSelfContainedUnreliableDelta(NetworkFrame frame, Serializer& dest) { WriteUnreliableDelta(frame, dest); }
 
     /// Read unreliable feedback from client.
     virtual void ReadUnreliableFeedback(NetworkFrame feedbackFrame, Deserializer& src) {}
@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Replica/NetworkInterestGrid.h"
+
+#include "../Replica/NetworkObject.h"
+#include "../Scene/Node.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+NetworkObject* GetRootNetworkObject(NetworkObject* networkObject)
+{
+    while (NetworkObject* parent = networkObject->GetParentNetworkObject())
+        networkObject = parent;
+    return networkObject;
+}
+
+}
+
+void NetworkInterestGrid::Update(float cellSize, const ea::vector<NetworkObject*>& sortedObjects)
+{
+    cellSize_ = ea::max(0.0f, cellSize);
+
+    objectCells_.clear();
+    unmanagedObjects_.clear();
+
+    if (!IsEnabled())
+    {
+        cells_.clear();
+        return;
+    }
+
+    // Remove cells that were empty during the previous update, keep the rest
+    for (auto iter = cells_.begin(); iter != cells_.end();)
+    {
+        if (iter->second.empty())
+        {
+            iter = cells_.erase(iter);
+        }
+        else
+        {
+            iter->second.clear();
+            ++iter;
+        }
+    }
+
+    const unsigned numObjects = sortedObjects.size();
+    objectCells_.resize(numObjects);
+    for (unsigned sortedIndex = 0; sortedIndex < numObjects; ++sortedIndex)
+    {
+        NetworkObject* rootObject = GetRootNetworkObject(sortedObjects[sortedIndex]);
+        if (rootObject->IsAlwaysRelevant())
+        {
+            unmanagedObjects_.push_back(sortedIndex);
+            continue;
+        }
+
+        const IntVector2 cell = GetCell(rootObject->GetNode()->GetWorldPosition());
+        objectCells_[sortedIndex] = cell;
+        cells_[cell].push_back(sortedIndex);
+    }
+}
+
+void NetworkInterestGrid::QueryObjects(
+    const IntVector2& centerCell, unsigned radius, ea::vector<unsigned>& sortedIndices) const
+{
+    const int r = static_cast<int>(radius);
+    for (int y = centerCell.y_ - r; y <= centerCell.y_ + r; ++y)
+    {
+        for (int x = centerCell.x_ - r; x <= centerCell.x_ + r; ++x)
+        {
+            const auto iter = cells_.find(IntVector2{x, y});
+            if (iter != cells_.end())
+                sortedIndices.insert(sortedIndices.end(), iter->second.begin(), iter->second.end());
+        }
+    }
+}
+
+IntVector2 NetworkInterestGrid::GetCell(const Vector3& position) const
+{
+    return IntVector2{FloorToInt(position.x_ / cellSize_), FloorToInt(position.z_ / cellSize_)};
+}
+
+unsigned NetworkInterestGrid::GetCellDistance(const IntVector2& lhs, const IntVector2& rhs)
+{
+    return static_cast<unsigned>(ea::max(Abs(lhs.x_ - rhs.x_), Abs(lhs.y_ - rhs.y_)));
+}
+
+unsigned NetworkInterestGrid::GetNumOccupiedCells() const
+{
+    unsigned numCells = 0;
+    for (const auto& [cell, objects] : cells_)
+    {
+        if (!objects.empty())
+            ++numCells;
+    }
+    return numCells;
+}
+
+}
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+
+#include <EASTL/optional.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class NetworkObject;
+
+/// Uniform grid in XZ plane used by server to find NetworkObject-s near the objects owned by the client.
+/// Objects are referenced by their index in the list of sorted NetworkObject-s.
+/// Children are placed into the cell of their root object.
+class URHO3D_API NetworkInterestGrid
+{
+public:
+    /// Update cells of all objects. Parents should go before children in the list.
+    /// Grid is disabled if cell size is zero.
+    void Update(float cellSize, const ea::vector<NetworkObject*>& sortedObjects);
+
+    /// Append indices of objects in cells within given distance from the center cell.
+    /// Indices are sorted within each cell, but not between cells.
+    void QueryObjects(const IntVector2& centerCell, unsigned radius, ea::vector<unsigned>& sortedIndices) const;
+
+    /// Return cell containing the position.
+    IntVector2 GetCell(const Vector3& position) const;
+    /// Return Chebyshev distance between cells.
+    static unsigned GetCellDistance(const IntVector2& lhs, const IntVector2& rhs);
+
+    /// Return current state.
+    /// @{
+    bool IsEnabled() const { return cellSize_ > 0.0f; }
+    float GetCellSize() const { return cellSize_; }
+    const ea::optional<IntVector2>& GetObjectCell(unsigned sortedIndex) const { return objectCells_[sortedIndex]; }
+    const ea::vector<unsigned>& GetUnmanagedObjects() const { return unmanagedObjects_; }
+    unsigned GetNumOccupiedCells() const;
+    /// @}
+
+private:
+    float cellSize_{};
+
+    /// Cell of each object, empty for objects not managed by the grid.
+    ea::vector<ea::optional<IntVector2>> objectCells_;
+    /// Objects that are not managed by the grid.
+    ea::vector<unsigned> unmanagedObjects_;
+    /// Objects in each cell. Empty cells are kept for one update to avoid reallocations.
+    ea::unordered_map<IntVector2, ea::vector<unsigned>> cells_;
+};
+
+}
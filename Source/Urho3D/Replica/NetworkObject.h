@@ -72,6 +72,9 @@ public:
 
     /// Server-only: set owner connection which is allowed to send feedback for this object.
     void SetOwner(AbstractConnection* owner);
+    /// Server-only: exclude object and its children from spatial interest management.
+    /// Relevance of such object is checked for all clients regardless of its position.
+    void SetAlwaysRelevant(bool alwaysRelevant) { alwaysRelevant_ = alwaysRelevant; }
 
     static void RegisterObject(Context* context);
 
@@ -90,6 +93,10 @@ public:
     const ea::vector<WeakPtr<NetworkObject>>& GetChildrenNetworkObjects() const { return childrenNetworkObjects_; }
     AbstractConnection* GetOwnerConnection() const { return ownerConnection_; }
     unsigned GetOwnerConnectionId() const { return ownerConnection_ ? ownerConnection_->GetObjectID() : 0; }
+    bool IsAlwaysRelevant() const { return alwaysRelevant_; }
+    /// Server-only: return whether delta update callbacks can be called from worker threads.
+    /// Callbacks of different objects may be called concurrently, callbacks of one object are called sequentially.
+    virtual bool IsDeltaUpdateThreadSafe() const { return true; }
 
     /// Return network mode.
     /// Network mode is configured only *after* InitializeOnServer and InitializeFromSnapshot callbacks.
@@ -124,6 +131,7 @@ private:
     /// ReplicationManager corresponding to the NetworkObject.
     NetworkObjectMode networkMode_{};
     WeakPtr<AbstractConnection> ownerConnection_{};
+    bool alwaysRelevant_{};
 
     /// NetworkObject hierarchy
     /// @{
@@ -81,6 +81,23 @@ URHO3D_NETWORK_SETTING(InterpolationLimit, float, 0.25f);
 URHO3D_NETWORK_SETTING(MaxInputFrames, unsigned, 256);
 /// Maximum number of input frames sent to server including relevant frame.
 URHO3D_NETWORK_SETTING(MaxInputRedundancy, unsigned, 32);
+/// Encoding of ReplicatedTransform updates, see ReplicatedTransformEncoding.
+URHO3D_NETWORK_SETTING(TransformEncoding, unsigned, 0);
+/// Origin of quantized positions.
+URHO3D_NETWORK_SETTING(TransformQuantizationOrigin, Vector3, (Vector3{0.0f, 0.0f, 0.0f}));
+/// Precision of quantized positions and velocities.
+URHO3D_NETWORK_SETTING(TransformPositionStep, float, 0.001f);
+/// Max distance from origin along each axis for quantized positions.
+URHO3D_NETWORK_SETTING(TransformPositionRange, float, 4096.0f);
+/// Max velocity along each axis for quantized velocities, units per network frame.
+URHO3D_NETWORK_SETTING(TransformVelocityRange, float, 16.0f);
+/// Number of bits per component of quantized rotations and angular velocities.
+URHO3D_NETWORK_SETTING(TransformRotationBits, unsigned, 12);
+/// Max angular velocity along each axis for quantized angular velocities, radians per network frame.
+URHO3D_NETWORK_SETTING(TransformAngularVelocityRange, float, 1.0f);
+/// Interval in frames between quantized position keyframes.
+/// Positions between keyframes are delta-encoded against the latest keyframe. Delta encoding is disabled if zero.
+URHO3D_NETWORK_SETTING(TransformKeyframeInterval, unsigned, 0);
 
 /// @}
 
@@ -105,6 +122,20 @@ URHO3D_NETWORK_SETTING(InputBufferingMax, unsigned, 8);
 URHO3D_NETWORK_SETTING(RelevanceTimeout, float, 5.0f);
 /// Duration in seconds of value tracking on server. Used for lag compensation.
 URHO3D_NETWORK_SETTING(ServerTracingDuration, float, 5.0f);
+/// Size of the interest management grid cell in XZ plane. Interest management is disabled if zero.
+/// If enabled, NetworkObject-s are replicated to the client only if they are close to the objects owned by the client.
+URHO3D_NETWORK_SETTING(InterestGridCellSize, float, 0.0f);
+/// Distance in cells from the objects owned by the client within which NetworkObject-s become relevant.
+URHO3D_NETWORK_SETTING(InterestGridRadius, unsigned, 1);
+/// Additional distance in cells within which already relevant NetworkObject-s stay relevant.
+URHO3D_NETWORK_SETTING(InterestGridHysteresis, unsigned, 1);
+/// Increase of update period in frames per each cell of distance. Zero means that all objects are updated every frame.
+URHO3D_NETWORK_SETTING(InterestGridUpdatePeriodPerCell, unsigned, 0);
+/// Max number of bytes per second of unreliable updates sent to each client. Unlimited if zero.
+/// If limited, the most stale, frequently updated and close objects are sent first.
+URHO3D_NETWORK_SETTING(BandwidthLimit, unsigned, 0);
+/// Max number of frames for which unused bandwidth is accumulated.
+URHO3D_NETWORK_SETTING(BandwidthBurstFrames, unsigned, 4);
 
 /// @}
 
@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../IO/BitStream.h"
 #include "../Network/NetworkEvents.h"
 #include "../Replica/ReplicatedTransform.h"
 #include "../Replica/NetworkSettingsConsts.h"
@@ -128,6 +129,18 @@ void ReplicatedTransform::InitializeCommon()
 
     positionTrace_.Resize(traceDuration);
     rotationTrace_.Resize(traceDuration);
+
+    encoding_ = static_cast<ReplicatedTransformEncoding>(
+        replicationManager->GetSetting(NetworkSettings::TransformEncoding).GetUInt());
+    quantizer_.origin_ = replicationManager->GetSetting(NetworkSettings::TransformQuantizationOrigin).GetVector3();
+    quantizer_.positionStep_ = replicationManager->GetSetting(NetworkSettings::TransformPositionStep).GetFloat();
+    quantizer_.positionRange_ = replicationManager->GetSetting(NetworkSettings::TransformPositionRange).GetFloat();
+    quantizer_.velocityRange_ = replicationManager->GetSetting(NetworkSettings::TransformVelocityRange).GetFloat();
+    quantizer_.rotationBits_ = Clamp(replicationManager->GetSetting(NetworkSettings::TransformRotationBits).GetUInt(), 2u, 31u);
+    quantizer_.angularVelocityRange_ =
+        replicationManager->GetSetting(NetworkSettings::TransformAngularVelocityRange).GetFloat();
+    keyframeInterval_ = ea::min(
+        replicationManager->GetSetting(NetworkSettings::TransformKeyframeInterval).GetUInt(), MaxKeyframeInterval);
 }
 
 void ReplicatedTransform::OnServerFrameEnd(NetworkFrame frame)
@@ -196,20 +209,49 @@ bool ReplicatedTransform::PrepareUnreliableDelta(NetworkFrame frame)
 
 void ReplicatedTransform::WriteUnreliableDelta(NetworkFrame frame, Serializer& dest)
 {
+    server_.deltaKeyframe_ = ea::nullopt;
+    if (encoding_ == ReplicatedTransformEncoding::Quantized)
+        WriteQuantizedDelta(frame, dest, false);
+    else
+        WriteRawDelta(dest);
+}
+
+void ReplicatedTransform::WriteSelfContainedUnreliableDelta(NetworkFrame frame, Serializer& dest)
+{
+    if (encoding_ == ReplicatedTransformEncoding::Quantized)
+        WriteQuantizedDelta(frame, dest, true);
+    else
+        WriteRawDelta(dest);
+}
+
+void ReplicatedTransform::ReadUnreliableDelta(NetworkFrame frame, Deserializer& src)
+{
+    if (encoding_ == ReplicatedTransformEncoding::Quantized)
+        ReadQuantizedDelta(frame, src);
+    else
+        ReadRawDelta(frame, src);
+}
+
+void ReplicatedTransform::WriteRawDelta(Serializer& dest)
+{
+    ++server_.numUpdatesWritten_;
+
     if (synchronizePosition_)
     {
         dest.WriteVector3(server_.position_);
         dest.WriteVector3(server_.velocity_);
+        server_.numBytesWritten_ += 2 * sizeof(Vector3);
     }
 
     if (synchronizeRotation_ == ReplicatedRotationMode::XYZ)
     {
         dest.WriteQuaternion(server_.rotation_);
         dest.WriteVector3(server_.angularVelocity_);
+        server_.numBytesWritten_ += sizeof(Quaternion) + sizeof(Vector3);
     }
 }
 
-void ReplicatedTransform::ReadUnreliableDelta(NetworkFrame frame, Deserializer& src)
+void ReplicatedTransform::ReadRawDelta(NetworkFrame frame, Deserializer& src)
 {
     if (synchronizePosition_)
     {
@@ -228,6 +270,118 @@ void ReplicatedTransform::ReadUnreliableDelta(NetworkFrame frame, Deserializer&
     }
 }
 
+void ReplicatedTransform::WriteQuantizedDelta(NetworkFrame frame, Serializer& dest, bool selfContained)
+{
+    BitWriter writer{dest};
+
+    if (synchronizePosition_)
+    {
+        const IntVector3 position = quantizer_.QuantizePosition(server_.position_);
+        const long long keyframeAge = server_.keyframe_ ? frame - *server_.keyframe_ : 0;
+        const bool isDelta =
+            !selfContained && keyframeInterval_ != 0 && server_.keyframe_ && keyframeAge < keyframeInterval_;
+
+        // Unreliable deltas are shared between all clients and are not acknowledged individually,
+        // so positions are encoded relative to periodic keyframes instead of the last acknowledged frame.
+        // ServerReplicator sends self-contained update to the clients that were not sent the keyframe.
+        writer.WriteBool(isDelta);
+        if (isDelta)
+        {
+            const IntVector3 delta = position - server_.keyframePosition_;
+            writer.WriteBits(static_cast<unsigned>(keyframeAge), 8);
+            writer.WriteSignedVarBits(delta.x_);
+            writer.WriteSignedVarBits(delta.y_);
+            writer.WriteSignedVarBits(delta.z_);
+            server_.deltaKeyframe_ = server_.keyframe_;
+        }
+        else
+        {
+            quantizer_.WritePosition(writer, position);
+            if (keyframeInterval_ != 0 && !selfContained)
+            {
+                server_.keyframe_ = frame;
+                server_.keyframePosition_ = position;
+                server_.deltaKeyframe_ = frame;
+            }
+        }
+
+        quantizer_.WriteVelocity(writer, server_.velocity_);
+    }
+
+    if (synchronizeRotation_ == ReplicatedRotationMode::XYZ)
+    {
+        quantizer_.WriteRotation(writer, server_.rotation_);
+        quantizer_.WriteAngularVelocity(writer, server_.angularVelocity_);
+    }
+
+    writer.Flush();
+
+    if (!selfContained)
+    {
+        ++server_.numUpdatesWritten_;
+        server_.numBytesWritten_ += (writer.GetNumBitsWritten() + 7) / 8;
+    }
+}
+
+void ReplicatedTransform::ReadQuantizedDelta(NetworkFrame frame, Deserializer& src)
+{
+    BitReader reader{src};
+
+    if (synchronizePosition_)
+    {
+        ea::optional<IntVector3> position;
+        if (reader.ReadBool())
+        {
+            const unsigned keyframeAge = reader.ReadBits(8);
+            IntVector3 delta;
+            delta.x_ = reader.ReadSignedVarBits();
+            delta.y_ = reader.ReadSignedVarBits();
+            delta.z_ = reader.ReadSignedVarBits();
+
+            // Keyframe may be lost, skip position in this case
+            if (const IntVector3* keyframePosition = FindClientKeyframe(frame - keyframeAge))
+                position = *keyframePosition + delta;
+        }
+        else
+        {
+            position = quantizer_.ReadPosition(reader);
+
+            const unsigned index = client_.nextKeyframeIndex_;
+            client_.keyframes_[index] = frame;
+            client_.keyframePositions_[index] = *position;
+            client_.nextKeyframeIndex_ = (index + 1) % NumClientKeyframes;
+        }
+
+        const Vector3 velocity = quantizer_.ReadVelocity(reader);
+        if (position)
+            positionTrace_.Set(frame, {quantizer_.DequantizePosition(*position), velocity});
+    }
+
+    if (synchronizeRotation_ == ReplicatedRotationMode::XYZ)
+    {
+        const Quaternion rotation = quantizer_.ReadRotation(reader);
+        const Vector3 angularVelocity = quantizer_.ReadAngularVelocity(reader);
+
+        rotationTrace_.Set(frame, {rotation, angularVelocity});
+    }
+}
+
+const IntVector3* ReplicatedTransform::FindClientKeyframe(NetworkFrame frame) const
+{
+    for (unsigned i = 0; i < NumClientKeyframes; ++i)
+    {
+        if (client_.keyframes_[i] == frame)
+            return &client_.keyframePositions_[i];
+    }
+    return nullptr;
+}
+
+float ReplicatedTransform::GetAverageUpdateSize() const
+{
+    return server_.numUpdatesWritten_ != 0
+        ? static_cast<float>(server_.numBytesWritten_) / server_.numUpdatesWritten_ : 0.0f;
+}
+
 PositionAndVelocity ReplicatedTransform::SampleTemporalPosition(const NetworkTime& time) const
 {
     return positionTrace_.SampleValid(time);
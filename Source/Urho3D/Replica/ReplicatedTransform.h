@@ -26,6 +26,9 @@
 
 #include "../Replica/BehaviorNetworkObject.h"
 #include "../Replica/NetworkValue.h"
+#include "../Replica/TransformQuantizer.h"
+
+#include <EASTL/array.h>
 
 namespace Urho3D
 {
@@ -59,6 +62,8 @@ public:
     static constexpr ReplicatedRotationMode DefaultSynchronizeRotation = ReplicatedRotationMode::XYZ;
     static constexpr bool DefaultExtrapolatePosition = true;
     static constexpr bool DefaultExtrapolateRotation = false;
+    static constexpr unsigned MaxKeyframeInterval = 255;
+    static constexpr unsigned NumClientKeyframes = 4;
 
     static constexpr NetworkCallbackFlags CallbackMask =
         NetworkCallbackMask::UpdateTransformOnServer | NetworkCallbackMask::UnreliableDelta | NetworkCallbackMask::InterpolateState;
@@ -103,6 +108,8 @@ public:
 
     bool PrepareUnreliableDelta(NetworkFrame frame) override;
     void WriteUnreliableDelta(NetworkFrame frame, Serializer& dest) override;
+    ea::optional<NetworkFrame> GetUnreliableDeltaKeyframe() const override { return server_.deltaKeyframe_; }
+    void WriteSelfContainedUnreliableDelta(NetworkFrame frame, Serializer& dest) override;
     void ReadUnreliableDelta(NetworkFrame frame, Deserializer& src) override;
     /// @}
 
@@ -115,10 +122,24 @@ public:
     ea::optional<NetworkFrame> GetLatestFrame() const;
     /// @}
 
+    /// Getters for bandwidth statistics on the server.
+    /// @{
+    ReplicatedTransformEncoding GetEncoding() const { return encoding_; }
+    unsigned GetNumUpdatesWritten() const { return server_.numUpdatesWritten_; }
+    unsigned long long GetNumBytesWritten() const { return server_.numBytesWritten_; }
+    float GetAverageUpdateSize() const;
+    /// @}
+
 private:
     void InitializeCommon();
     void OnServerFrameEnd(NetworkFrame frame);
 
+    void WriteRawDelta(Serializer& dest);
+    void ReadRawDelta(NetworkFrame frame, Deserializer& src);
+    void WriteQuantizedDelta(NetworkFrame frame, Serializer& dest, bool selfContained);
+    void ReadQuantizedDelta(NetworkFrame frame, Deserializer& src);
+    const IntVector3* FindClientKeyframe(NetworkFrame frame) const;
+
     /// Attributes independent on the client and the server.
     /// @{
     unsigned numUploadAttempts_{DefaultNumUploadAttempts};
@@ -138,6 +159,13 @@ private:
     bool extrapolateRotation_{DefaultExtrapolateRotation};
     /// @}
 
+    /// Encoding settings from ReplicationManager.
+    /// @{
+    ReplicatedTransformEncoding encoding_{};
+    TransformQuantizer quantizer_;
+    unsigned keyframeInterval_{};
+    /// @}
+
     NetworkValue<PositionAndVelocity> positionTrace_;
     NetworkValue<RotationAndVelocity> rotationTrace_;
 
@@ -156,12 +184,24 @@ private:
         bool movedDuringFrame_{};
         Vector3 latestSentPosition_;
         Quaternion latestSentRotation_;
+
+        ea::optional<NetworkFrame> keyframe_;
+        IntVector3 keyframePosition_;
+        /// Keyframe referenced by the last written delta.
+        ea::optional<NetworkFrame> deltaKeyframe_;
+
+        unsigned numUpdatesWritten_{};
+        unsigned long long numBytesWritten_{};
     } server_;
 
     struct ClientData
     {
         NetworkValueSampler<PositionAndVelocity> positionSampler_;
         NetworkValueSampler<RotationAndVelocity> rotationSampler_;
+
+        ea::array<ea::optional<NetworkFrame>, NumClientKeyframes> keyframes_;
+        ea::array<IntVector3, NumClientKeyframes> keyframePositions_;
+        unsigned nextKeyframeIndex_{};
     } client_;
 };
 
@@ -26,6 +26,7 @@
 #include <Urho3D/Core/CoreEvents.h>
 #include <Urho3D/Core/Exception.h>
 #include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/IO/Log.h>
 #include <Urho3D/Math/RandomEngine.h>
 #include <Urho3D/Network/Connection.h>
@@ -39,6 +40,7 @@
 #include <Urho3D/Scene/SceneEvents.h>
 
 #include <EASTL/numeric.h>
+#include <EASTL/sort.h>
 
 namespace Urho3D
 {
@@ -51,6 +53,13 @@ unsigned GetIndex(NetworkId networkId)
     return DeconstructComponentReference(networkId).first;
 }
 
+/// Return upper bound of the size of unreliable update in the message, including object ID, type and size.
+unsigned GetUnreliableUpdateSize(ConstByteSpan updateSpan)
+{
+    static constexpr unsigned maxHeaderSize = sizeof(unsigned) + sizeof(StringHash) + sizeof(unsigned);
+    return maxHeaderSize + updateSpan.size();
+}
+
 } // namespace
 
 SharedReplicationState::SharedReplicationState(NetworkObjectRegistry* objectRegistry)
@@ -84,13 +93,20 @@ void SharedReplicationState::OnNetworkObjectRemoved(NetworkObject* networkObject
     }
 }
 
-void SharedReplicationState::PrepareForUpdate()
+void SharedReplicationState::PrepareForUpdate(float interestGridCellSize)
 {
     ResetFrameBuffers();
     InitializeNewObjects();
 
     objectRegistry_->UpdateNetworkObjects();
     objectRegistry_->GetSortedNetworkObjects(sortedNetworkObjects_);
+
+    sortedIndices_.clear();
+    sortedIndices_.resize(GetIndexUpperBound(), M_MAX_UNSIGNED);
+    for (unsigned sortedIndex = 0; sortedIndex < sortedNetworkObjects_.size(); ++sortedIndex)
+        sortedIndices_[GetIndex(sortedNetworkObjects_[sortedIndex]->GetNetworkId())] = sortedIndex;
+
+    interestGrid_.Update(interestGridCellSize, sortedNetworkObjects_);
 }
 
 void SharedReplicationState::ResetFrameBuffers()
@@ -107,6 +123,9 @@ void SharedReplicationState::ResetFrameBuffers()
     needUnreliableDeltaUpdate_.clear();
     needUnreliableDeltaUpdate_.resize(indexUppedBound);
     unreliableDeltaUpdateData_.resize(indexUppedBound);
+    unreliableDeltaKeyframes_.clear();
+    unreliableDeltaKeyframes_.resize(indexUppedBound);
+    selfContainedUnreliableDeltaUpdateData_.resize(indexUppedBound);
 
     deltaUpdateBuffer_.Clear();
 }
@@ -137,10 +156,12 @@ void SharedReplicationState::QueueDeltaUpdate(NetworkObject* networkObject)
     isDeltaUpdateQueued_[index] = true;
 }
 
-void SharedReplicationState::CookDeltaUpdates(NetworkFrame currentFrame)
+void SharedReplicationState::CookDeltaUpdates(NetworkFrame currentFrame, WorkQueue* workQueue)
 {
     recentlyRemovedObjects_.clear();
 
+    // Objects that are not thread-safe are cooked in the main thread right away
+    threadSafeDeltaUpdates_.clear();
     for (unsigned i = 0; i < isDeltaUpdateQueued_.size(); ++i)
     {
         if (!isDeltaUpdateQueued_[i])
@@ -149,26 +170,115 @@ void SharedReplicationState::CookDeltaUpdates(NetworkFrame currentFrame)
         NetworkObject* networkObject = objectRegistry_->GetNetworkObjectByIndex(i);
         URHO3D_ASSERT(networkObject);
 
-        if (networkObject->PrepareReliableDelta(currentFrame))
-        {
-            const unsigned beginOffset = deltaUpdateBuffer_.Tell();
-            networkObject->WriteReliableDelta(currentFrame, deltaUpdateBuffer_);
-            const unsigned endOffset = deltaUpdateBuffer_.Tell();
+        if (workQueue && networkObject->IsDeltaUpdateThreadSafe())
+            threadSafeDeltaUpdates_.push_back(i);
+        else
+            CommitDeltaUpdate(CookDeltaUpdate(currentFrame, i, deltaUpdateBuffer_), 0);
+    }
 
-            needReliableDeltaUpdate_[i] = true;
-            reliableDeltaUpdateData_[i] = {beginOffset, endOffset};
-        }
+    if (threadSafeDeltaUpdates_.empty())
+        return;
 
-        if (networkObject->PrepareUnreliableDelta(currentFrame))
+    if (workQueue->IsMultithreaded() && threadSafeDeltaUpdates_.size() > ParallelCookingBucketSize)
+        CookDeltaUpdatesInThreads(currentFrame, workQueue);
+    else
+    {
+        for (unsigned index : threadSafeDeltaUpdates_)
+            CommitDeltaUpdate(CookDeltaUpdate(currentFrame, index, deltaUpdateBuffer_), 0);
+    }
+}
+
+void SharedReplicationState::CookDeltaUpdatesInThreads(NetworkFrame currentFrame, WorkQueue* workQueue)
+{
+    threadDeltaBuffers_.resize(WorkQueue::GetThreadIndexCount());
+    for (ThreadDeltaBuffer& threadBuffer : threadDeltaBuffers_)
+    {
+        threadBuffer.buffer_.Clear();
+        threadBuffer.updates_.clear();
+    }
+
+    ForEachParallel(workQueue, ParallelCookingBucketSize, threadSafeDeltaUpdates_,
+        [&](unsigned /*index*/, unsigned objectIndex)
+    {
+        ThreadDeltaBuffer& threadBuffer = threadDeltaBuffers_[WorkQueue::GetThreadIndex()];
+        threadBuffer.updates_.push_back(CookDeltaUpdate(currentFrame, objectIndex, threadBuffer.buffer_));
+    });
+
+    // Stitch per-thread buffers into the shared buffer
+    for (const ThreadDeltaBuffer& threadBuffer : threadDeltaBuffers_)
+    {
+        if (threadBuffer.updates_.empty())
+            continue;
+
+        const unsigned offset = deltaUpdateBuffer_.Tell();
+        deltaUpdateBuffer_.Write(threadBuffer.buffer_.GetData(), threadBuffer.buffer_.GetSize());
+        for (const CookedDeltaUpdate& update : threadBuffer.updates_)
+            CommitDeltaUpdate(update, offset);
+    }
+}
+
+SharedReplicationState::CookedDeltaUpdate SharedReplicationState::CookDeltaUpdate(
+    NetworkFrame currentFrame, unsigned index, VectorBuffer& dest) const
+{
+    NetworkObject* networkObject = objectRegistry_->GetNetworkObjectByIndex(index);
+
+    CookedDeltaUpdate result;
+    result.index_ = index;
+
+    if (networkObject->PrepareReliableDelta(currentFrame))
+    {
+        const unsigned beginOffset = dest.Tell();
+        networkObject->WriteReliableDelta(currentFrame, dest);
+        const unsigned endOffset = dest.Tell();
+
+        result.reliable_ = DeltaBufferSpan{beginOffset, endOffset};
+    }
+
+    if (networkObject->PrepareUnreliableDelta(currentFrame))
+    {
+        const unsigned beginOffset = dest.Tell();
+        networkObject->WriteUnreliableDelta(currentFrame, dest);
+        const unsigned endOffset = dest.Tell();
+
+        result.unreliable_ = DeltaBufferSpan{beginOffset, endOffset};
+
+        // Clients that were not sent the keyframe cannot decode the delta and need self-contained update instead
+        result.unreliableKeyframe_ = networkObject->GetUnreliableDeltaKeyframe();
+        if (result.unreliableKeyframe_ && *result.unreliableKeyframe_ != currentFrame)
         {
-            const unsigned beginOffset = deltaUpdateBuffer_.Tell();
-            networkObject->WriteUnreliableDelta(currentFrame, deltaUpdateBuffer_);
-            const unsigned endOffset = deltaUpdateBuffer_.Tell();
+            const unsigned selfContainedBeginOffset = dest.Tell();
+            networkObject->WriteSelfContainedUnreliableDelta(currentFrame, dest);
+            const unsigned selfContainedEndOffset = dest.Tell();
 
-            needUnreliableDeltaUpdate_[i] = true;
-            unreliableDeltaUpdateData_[i] = {beginOffset, endOffset};
+            result.selfContainedUnreliable_ = DeltaBufferSpan{selfContainedBeginOffset, selfContainedEndOffset};
         }
     }
+
+    return result;
+}
+
+void SharedReplicationState::CommitDeltaUpdate(const CookedDeltaUpdate& update, unsigned offset)
+{
+    if (update.reliable_)
+    {
+        needReliableDeltaUpdate_[update.index_] = true;
+        reliableDeltaUpdateData_[update.index_] = {
+            update.reliable_->beginOffset_ + offset, update.reliable_->endOffset_ + offset};
+    }
+
+    if (update.unreliable_)
+    {
+        needUnreliableDeltaUpdate_[update.index_] = true;
+        unreliableDeltaUpdateData_[update.index_] = {
+            update.unreliable_->beginOffset_ + offset, update.unreliable_->endOffset_ + offset};
+        unreliableDeltaKeyframes_[update.index_] = update.unreliableKeyframe_;
+    }
+
+    if (update.selfContainedUnreliable_)
+    {
+        selfContainedUnreliableDeltaUpdateData_[update.index_] = {
+            update.selfContainedUnreliable_->beginOffset_ + offset, update.selfContainedUnreliable_->endOffset_ + offset};
+    }
 }
 
 unsigned SharedReplicationState::GetIndexUpperBound() const
@@ -198,6 +308,11 @@ ea::optional<ConstByteSpan> SharedReplicationState::GetUnreliableUpdateByIndex(u
     return GetSpanData(unreliableDeltaUpdateData_[index]);
 }
 
+ConstByteSpan SharedReplicationState::GetSelfContainedUnreliableUpdateByIndex(unsigned index) const
+{
+    return GetSpanData(selfContainedUnreliableDeltaUpdateData_[index]);
+}
+
 ConstByteSpan SharedReplicationState::GetSpanData(const DeltaBufferSpan& span) const
 {
     const auto data = deltaUpdateBuffer_.GetData();
@@ -230,6 +345,11 @@ const Variant& ClientSynchronizationState::GetSetting(const NetworkSetting& sett
     return GetNetworkSetting(settings_, setting);
 }
 
+void ClientSynchronizationState::SetSetting(const NetworkSetting& setting, const Variant& value)
+{
+    SetNetworkSetting(settings_, setting, value);
+}
+
 void ClientSynchronizationState::SendMessages()
 {
     // Send configuration on startup once
@@ -410,6 +530,8 @@ void ClientReplicationState::SendRemoveObjects()
             msg.WriteUInt(static_cast<unsigned>(networkId));
 
         const bool sendMessage = !pendingRemovedObjects_.empty();
+        if (sendMessage)
+            stats_.removeObjectsBytes_ += msg.GetSize();
         return sendMessage;
     });
 }
@@ -443,6 +565,8 @@ void ClientReplicationState::SendAddObjects()
                 debugInfo->append(ToString(networkObject->GetNetworkId()));
             }
         }
+        if (sendMessage)
+            stats_.addObjectsBytes_ += msg.GetSize();
         return sendMessage;
     });
 }
@@ -479,6 +603,8 @@ void ClientReplicationState::SendUpdateObjectsReliable(const SharedReplicationSt
                 debugInfo->append(ToString(networkObject->GetNetworkId()));
             }
         }
+        if (sendMessage)
+            stats_.reliableUpdateBytes_ += msg.GetSize();
         return sendMessage;
     });
 }
@@ -486,48 +612,134 @@ void ClientReplicationState::SendUpdateObjectsReliable(const SharedReplicationSt
 void ClientReplicationState::SendUpdateObjectsUnreliable(
     NetworkFrame currentFrame, const SharedReplicationState& sharedState)
 {
-    connection_->SendGeneratedMessage(MSG_UPDATE_OBJECTS_UNRELIABLE, PacketType::UnreliableUnordered,
-        [&](VectorBuffer& msg, ea::string* debugInfo)
+    ScheduleUpdateObjectsUnreliable(currentFrame, sharedState);
+
+    // Split updates into multiple messages if needed, each message contains at least one update
+    static constexpr unsigned frameSize = sizeof(long long);
+    const unsigned maxMessageSize = connection_->GetMaxMessageSize();
+    const unsigned numUpdates = scheduledUnreliableUpdates_.size();
+    unsigned updateIndex = 0;
+    while (updateIndex < numUpdates)
     {
-        bool sendMessage = false;
+        connection_->SendGeneratedMessage(MSG_UPDATE_OBJECTS_UNRELIABLE, PacketType::UnreliableUnordered,
+            [&](VectorBuffer& msg, ea::string* debugInfo)
+        {
+            msg.WriteInt64(static_cast<long long>(GetCurrentFrame()));
 
-        msg.WriteInt64(static_cast<long long>(GetCurrentFrame()));
+            for (; updateIndex < numUpdates; ++updateIndex)
+            {
+                NetworkObject* networkObject = scheduledUnreliableUpdates_[updateIndex];
+                const unsigned index = GetIndex(networkObject->GetNetworkId());
+                const auto updateSpan = GetUnreliableUpdateForClient(currentFrame, index, sharedState);
 
-        for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
+                if (msg.GetSize() > frameSize && msg.GetSize() + GetUnreliableUpdateSize(updateSpan) > maxMessageSize)
+                    break;
+
+                msg.WriteUInt(static_cast<unsigned>(networkObject->GetNetworkId()));
+                msg.WriteStringHash(networkObject->GetType());
+
+                msg.WriteVLE(updateSpan.size());
+                msg.Write(updateSpan.data(), updateSpan.size());
+
+                if (sharedState.GetUnreliableUpdateKeyframe(index) == currentFrame)
+                    objectsSentKeyframes_[index] = currentFrame;
+
+                if (debugInfo)
+                {
+                    if (!debugInfo->empty())
+                        debugInfo->append(", ");
+                    debugInfo->append(ToString(networkObject->GetNetworkId()));
+                }
+            }
+
+            stats_.unreliableUpdateBytes_ += msg.GetSize();
+            return true;
+        });
+    }
+}
+
+void ClientReplicationState::ScheduleUpdateObjectsUnreliable(
+    NetworkFrame currentFrame, const SharedReplicationState& sharedState)
+{
+    scheduledUnreliableUpdates_.clear();
+    dueUnreliableUpdates_.clear();
+    stats_.maxStarvationFrames_ = 0;
+
+    const bool isBandwidthLimited = bandwidthLimit_ != 0;
+    for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
+    {
+        // Skip redundant updates, both if update is empty or if snapshot was already sent
+        const unsigned index = GetIndex(networkObject->GetNetworkId());
+        if (isSnapshot)
+            continue;
+
+        if (!sharedState.GetUnreliableUpdateByIndex(index))
+            continue;
+
+        const NetworkObjectRelevance relevance = objectsRelevance_[index];
+        URHO3D_ASSERT(relevance != NetworkObjectRelevance::Irrelevant);
+        if (relevance == NetworkObjectRelevance::NoUpdates)
+            continue;
+
+        const auto period = static_cast<unsigned>(relevance);
+        if (!isBandwidthLimited)
         {
-            // Skip redundant updates, both if update is empty or if snapshot was already sent
-            const unsigned index = GetIndex(networkObject->GetNetworkId());
-            if (isSnapshot)
-                continue;
+            if (static_cast<long long>(currentFrame) % period == 0)
+                scheduledUnreliableUpdates_.push_back(networkObject);
+            continue;
+        }
 
-            const auto updateSpan = sharedState.GetUnreliableUpdateByIndex(index);
-            if (!updateSpan)
-                continue;
+        // Priority is accumulated with the rate of relevance and keeps growing while update is deferred.
+        // Object is due when it has waited for its update period, closer objects are sent first.
+        float& priority = objectsPriorities_[index];
+        priority += 1.0f / period;
+        if (priority >= 1.0f - M_EPSILON)
+            dueUnreliableUpdates_.emplace_back(priority / (1 + objectsCellDistances_[index]), networkObject);
+    }
 
-            const NetworkObjectRelevance relevance = objectsRelevance_[index];
-            URHO3D_ASSERT(relevance != NetworkObjectRelevance::Irrelevant);
-            if (relevance == NetworkObjectRelevance::NoUpdates)
-                continue;
+    if (!isBandwidthLimited)
+    {
+        stats_.numUnreliableUpdatesSent_ += scheduledUnreliableUpdates_.size();
+        return;
+    }
 
-            if (static_cast<long long>(currentFrame) % static_cast<unsigned>(relevance) != 0)
-                continue;
+    const float budgetPerFrame = static_cast<float>(bandwidthLimit_) / updateFrequency_;
+    bandwidthBudget_ = ea::min(bandwidthBudget_ + budgetPerFrame, budgetPerFrame * ea::max(1u, bandwidthBurstFrames_));
 
-            sendMessage = true;
-            msg.WriteUInt(static_cast<unsigned>(networkObject->GetNetworkId()));
-            msg.WriteStringHash(networkObject->GetType());
+    ea::sort(dueUnreliableUpdates_.begin(), dueUnreliableUpdates_.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
 
-            msg.WriteVLE(updateSpan->size());
-            msg.Write(updateSpan->data(), updateSpan->size());
+    // Budget may become negative after the last update, the debt is paid in the next frames
+    for (const auto& [rank, networkObject] : dueUnreliableUpdates_)
+    {
+        const unsigned index = GetIndex(networkObject->GetNetworkId());
+        if (bandwidthBudget_ > 0.0f)
+        {
+            const auto updateSpan = GetUnreliableUpdateForClient(currentFrame, index, sharedState);
+            bandwidthBudget_ -= GetUnreliableUpdateSize(updateSpan);
 
-            if (debugInfo)
-            {
-                if (!debugInfo->empty())
-                    debugInfo->append(", ");
-                debugInfo->append(ToString(networkObject->GetNetworkId()));
-            }
+            objectsPriorities_[index] = 0.0f;
+            objectsStarvationFrames_[index] = 0;
+            scheduledUnreliableUpdates_.push_back(networkObject);
+            ++stats_.numUnreliableUpdatesSent_;
         }
-        return sendMessage;
-    });
+        else
+        {
+            ++objectsStarvationFrames_[index];
+            stats_.maxStarvationFrames_ = ea::max(stats_.maxStarvationFrames_, objectsStarvationFrames_[index]);
+            ++stats_.numUnreliableUpdatesDeferred_;
+        }
+    }
+}
+
+ConstByteSpan ClientReplicationState::GetUnreliableUpdateForClient(
+    NetworkFrame currentFrame, unsigned index, const SharedReplicationState& sharedState) const
+{
+    // Delta is relative to the keyframe that may have been skipped for this client due to update period or bandwidth
+    const auto keyframe = sharedState.GetUnreliableUpdateKeyframe(index);
+    if (keyframe && *keyframe != currentFrame && objectsSentKeyframes_[index] != keyframe)
+        return sharedState.GetSelfContainedUnreliableUpdateByIndex(index);
+    return *sharedState.GetUnreliableUpdateByIndex(index);
 }
 
 void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& sharedState)
@@ -535,12 +747,20 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
     if (!IsSynchronized())
         return;
 
-    const float timeStep = 1.0f / updateFrequency_;
-    const float relevanceTimeout = GetSetting(NetworkSettings::RelevanceTimeout).GetFloat();
+    relevanceTimeout_ = GetSetting(NetworkSettings::RelevanceTimeout).GetFloat();
+    interestGridRadius_ = GetSetting(NetworkSettings::InterestGridRadius).GetUInt();
+    interestGridHysteresis_ = GetSetting(NetworkSettings::InterestGridHysteresis).GetUInt();
+    interestGridUpdatePeriodPerCell_ = GetSetting(NetworkSettings::InterestGridUpdatePeriodPerCell).GetUInt();
+    bandwidthLimit_ = GetSetting(NetworkSettings::BandwidthLimit).GetUInt();
+    bandwidthBurstFrames_ = GetSetting(NetworkSettings::BandwidthBurstFrames).GetUInt();
 
     const unsigned indexUpperBound = sharedState.GetIndexUpperBound();
     objectsRelevance_.resize(indexUpperBound, NetworkObjectRelevance::Irrelevant);
     objectsRelevanceTimeouts_.resize(indexUpperBound);
+    objectsCellDistances_.resize(indexUpperBound);
+    objectsPriorities_.resize(indexUpperBound);
+    objectsStarvationFrames_.resize(indexUpperBound);
+    objectsSentKeyframes_.resize(indexUpperBound);
 
     pendingRemovedObjects_.clear();
     pendingUpdatedObjects_.clear();
@@ -556,53 +776,153 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
         }
     }
 
-    // Process active components
-    for (NetworkObject* networkObject : sharedState.GetSortedObjects())
+    // Process active components.
+    // If interest management is enabled, only process objects that are or may become relevant.
+    const auto& sortedObjects = sharedState.GetSortedObjects();
+    if (!sharedState.GetInterestGrid().IsEnabled())
     {
-        const NetworkId networkId = networkObject->GetNetworkId();
-        const NetworkId parentNetworkId = networkObject->GetParentNetworkId();
-        const unsigned index = GetIndex(networkId);
+        for (unsigned sortedIndex = 0; sortedIndex < sortedObjects.size(); ++sortedIndex)
+            UpdateNetworkObject(sharedState, sortedObjects[sortedIndex], sortedIndex);
+    }
+    else
+    {
+        UpdateInterestCells(sharedState);
+        CollectCandidateObjects(sharedState);
+        for (unsigned sortedIndex : candidateObjects_)
+            UpdateNetworkObject(sharedState, sortedObjects[sortedIndex], sortedIndex);
+    }
+
+    // All relevant objects are updated every frame
+    relevantObjects_.clear();
+    for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
+        relevantObjects_.push_back(GetIndex(networkObject->GetNetworkId()));
+}
+
+void ClientReplicationState::UpdateInterestCells(const SharedReplicationState& sharedState)
+{
+    const NetworkInterestGrid& grid = sharedState.GetInterestGrid();
+
+    interestCells_.clear();
+    for (NetworkObject* networkObject : sharedState.GetOwnedObjectsByConnection(connection_))
+    {
+        const IntVector2 cell = grid.GetCell(networkObject->GetNode()->GetWorldPosition());
+        if (!interestCells_.contains(cell))
+            interestCells_.push_back(cell);
+    }
+}
+
+void ClientReplicationState::CollectCandidateObjects(const SharedReplicationState& sharedState)
+{
+    const NetworkInterestGrid& grid = sharedState.GetInterestGrid();
 
-        const bool wasRelevant = objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant;
-        const bool isParentRelevant = parentNetworkId == NetworkId::None
-            || objectsRelevance_[GetIndex(parentNetworkId)] != NetworkObjectRelevance::Irrelevant;
+    candidateObjects_.clear();
 
-        if (!wasRelevant && isParentRelevant)
+    const auto& unmanagedObjects = grid.GetUnmanagedObjects();
+    candidateObjects_.insert(candidateObjects_.end(), unmanagedObjects.begin(), unmanagedObjects.end());
+
+    // Children of objects kept by hysteresis may become relevant too, so hysteresis zone is included
+    const unsigned queryRadius = interestGridRadius_ + interestGridHysteresis_;
+    for (const IntVector2& cell : interestCells_)
+        grid.QueryObjects(cell, queryRadius, candidateObjects_);
+
+    for (unsigned index : relevantObjects_)
+    {
+        const unsigned sortedIndex = sharedState.GetSortedIndex(index);
+        if (sortedIndex != M_MAX_UNSIGNED)
+            candidateObjects_.push_back(sortedIndex);
+    }
+
+    // Keep hierarchical order so parents are processed before children
+    ea::sort(candidateObjects_.begin(), candidateObjects_.end());
+    candidateObjects_.erase(ea::unique(candidateObjects_.begin(), candidateObjects_.end()), candidateObjects_.end());
+}
+
+void ClientReplicationState::UpdateNetworkObject(
+    SharedReplicationState& sharedState, NetworkObject* networkObject, unsigned sortedIndex)
+{
+    const float timeStep = 1.0f / updateFrequency_;
+
+    const NetworkId networkId = networkObject->GetNetworkId();
+    const NetworkId parentNetworkId = networkObject->GetParentNetworkId();
+    const unsigned index = GetIndex(networkId);
+
+    const bool wasRelevant = objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant;
+    const bool isParentRelevant = parentNetworkId == NetworkId::None
+        || objectsRelevance_[GetIndex(parentNetworkId)] != NetworkObjectRelevance::Irrelevant;
+
+    if (!wasRelevant && isParentRelevant)
+    {
+        // Begin replication of the object if both the object and its parent are relevant
+        objectsRelevance_[index] = EvaluateRelevance(sharedState, networkObject, sortedIndex, false);
+        if (objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant)
         {
-            // Begin replication of the object if both the object and its parent are relevant
-            objectsRelevance_[index] =
-                networkObject->GetRelevanceForClient(connection_).value_or(NetworkObjectRelevance::NormalUpdates);
-            if (objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant)
+            objectsRelevanceTimeouts_[index] = relevanceTimeout_;
+            objectsPriorities_[index] = 0.0f;
+            objectsStarvationFrames_[index] = 0;
+            objectsSentKeyframes_[index] = ea::nullopt;
+            pendingUpdatedObjects_.push_back({networkObject, true});
+        }
+    }
+    else if (wasRelevant)
+    {
+        // If replicating, check periodically (abort replication immediately if parent is removed)
+        objectsRelevanceTimeouts_[index] -= timeStep;
+        if (objectsRelevanceTimeouts_[index] < 0.0f || !isParentRelevant)
+        {
+            objectsRelevance_[index] = isParentRelevant
+                ? EvaluateRelevance(sharedState, networkObject, sortedIndex, true)
+                : NetworkObjectRelevance::Irrelevant;
+
+            if (objectsRelevance_[index] == NetworkObjectRelevance::Irrelevant)
             {
-                objectsRelevanceTimeouts_[index] = relevanceTimeout;
-                pendingUpdatedObjects_.push_back({networkObject, true});
+                // Remove irrelevant component
+                pendingRemovedObjects_.push_back(networkId);
+                return;
             }
+
+            objectsRelevanceTimeouts_[index] = relevanceTimeout_;
         }
-        else if (wasRelevant)
+
+        // Queue non-snapshot update
+        sharedState.QueueDeltaUpdate(networkObject);
+        pendingUpdatedObjects_.push_back({networkObject, false});
+    }
+}
+
+NetworkObjectRelevance ClientReplicationState::EvaluateRelevance(
+    const SharedReplicationState& sharedState, NetworkObject* networkObject, unsigned sortedIndex, bool wasRelevant)
+{
+    NetworkObjectRelevance defaultRelevance = NetworkObjectRelevance::NormalUpdates;
+
+    const unsigned index = GetIndex(networkObject->GetNetworkId());
+    objectsCellDistances_[index] = 0;
+
+    const NetworkInterestGrid& grid = sharedState.GetInterestGrid();
+    if (grid.IsEnabled())
+    {
+        if (const auto& objectCell = grid.GetObjectCell(sortedIndex))
         {
-            // If replicating, check periodically (abort replication immediately if parent is removed)
-            objectsRelevanceTimeouts_[index] -= timeStep;
-            if (objectsRelevanceTimeouts_[index] < 0.0f || !isParentRelevant)
-            {
-                objectsRelevance_[index] = isParentRelevant
-                    ? networkObject->GetRelevanceForClient(connection_).value_or(NetworkObjectRelevance::NormalUpdates)
-                    : NetworkObjectRelevance::Irrelevant;
+            unsigned distance = M_MAX_UNSIGNED;
+            for (const IntVector2& cell : interestCells_)
+                distance = ea::min(distance, NetworkInterestGrid::GetCellDistance(cell, *objectCell));
 
-                if (objectsRelevance_[index] == NetworkObjectRelevance::Irrelevant)
-                {
-                    // Remove irrelevant component
-                    pendingRemovedObjects_.push_back(networkId);
-                    continue;
-                }
+            // Hysteresis prevents objects on the border from being added and removed repeatedly
+            const unsigned maxDistance = interestGridRadius_ + (wasRelevant ? interestGridHysteresis_ : 0);
+            if (distance > maxDistance)
+                return NetworkObjectRelevance::Irrelevant;
 
-                objectsRelevanceTimeouts_[index] = relevanceTimeout;
-            }
+            objectsCellDistances_[index] = distance;
 
-            // Queue non-snapshot update
-            sharedState.QueueDeltaUpdate(networkObject);
-            pendingUpdatedObjects_.push_back({networkObject, false});
+            if (interestGridUpdatePeriodPerCell_ != 0)
+            {
+                static constexpr auto maxPeriod = static_cast<unsigned>(NetworkObjectRelevance::MaxPeriod);
+                const unsigned period = 1 + ea::min(distance * interestGridUpdatePeriodPerCell_, maxPeriod - 1);
+                defaultRelevance = static_cast<NetworkObjectRelevance>(period);
+            }
         }
     }
+
+    return networkObject->GetRelevanceForClient(connection_).value_or(defaultRelevance);
 }
 
 ServerReplicator::ServerReplicator(Scene* scene)
@@ -670,10 +990,10 @@ void ServerReplicator::OnNetworkUpdate()
     eventData[P_FRAME] = static_cast<long long>(currentFrame_);
     network_->SendEvent(E_ENDSERVERNETWORKFRAME, eventData);
 
-    sharedState_->PrepareForUpdate();
+    sharedState_->PrepareForUpdate(GetSetting(NetworkSettings::InterestGridCellSize).GetFloat());
     for (auto& [connection, clientState] : connections_)
         clientState->UpdateNetworkObjects(*sharedState_);
-    sharedState_->CookDeltaUpdates(currentFrame_);
+    sharedState_->CookDeltaUpdates(currentFrame_, GetSubsystem<WorkQueue>());
 
     for (auto& [connection, clientState] : connections_)
         clientState->SendMessages(currentFrame_, *sharedState_);
@@ -740,6 +1060,13 @@ void ServerReplicator::SetCurrentFrame(NetworkFrame frame)
     currentFrame_ = frame;
 }
 
+void ServerReplicator::SetSetting(const NetworkSetting& setting, const Variant& value)
+{
+    SetNetworkSetting(settings_, setting, value);
+    for (auto& [connection, clientState] : connections_)
+        clientState->SetSetting(setting, value);
+}
+
 ClientReplicationState* ServerReplicator::GetClientState(AbstractConnection* connection) const
 {
     auto iter = connections_.find(connection);
@@ -774,6 +1101,12 @@ unsigned ServerReplicator::GetFeedbackDelay(AbstractConnection* connection) cons
     return iter != connections_.end() ? iter->second->GetInputDelay() + iter->second->GetInputBufferSize() : 0;
 }
 
+ClientReplicationStats ServerReplicator::GetReplicationStats(AbstractConnection* connection) const
+{
+    const auto iter = connections_.find(connection);
+    return iter != connections_.end() ? iter->second->GetStats() : ClientReplicationStats{};
+}
+
 const ea::unordered_set<NetworkObject*>& ServerReplicator::GetNetworkObjectsOwnedByConnection(
     AbstractConnection* connection) const
 {
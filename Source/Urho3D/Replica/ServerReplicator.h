@@ -31,6 +31,7 @@
 #include "../Network/ClockSynchronizer.h"
 #include "../Replica/ClientInputStatistics.h"
 #include "../Replica/NetworkId.h"
+#include "../Replica/NetworkInterestGrid.h"
 #include "../Replica/TickSynchronizer.h"
 #include "../Replica/ProtocolMessages.h"
 
@@ -47,29 +48,40 @@ class Network;
 class NetworkObject;
 class NetworkObjectRegistry;
 class Scene;
+class WorkQueue;
 struct NetworkSetting;
 
 /// Replication state shared between all clients.
 class SharedReplicationState : public RefCounted
 {
 public:
+    /// Number of objects cooked by one worker thread at once.
+    static constexpr unsigned ParallelCookingBucketSize = 32;
+
     explicit SharedReplicationState(NetworkObjectRegistry* objectRegistry);
 
-    /// Initial preparation for network update.
-    void PrepareForUpdate();
+    /// Initial preparation for network update. Interest grid is disabled if cell size is zero.
+    void PrepareForUpdate(float interestGridCellSize);
     /// Request delta update to be prepared for specified object.
     void QueueDeltaUpdate(NetworkObject* networkObject);
     /// Cook all requested delta updates.
-    void CookDeltaUpdates(NetworkFrame currentFrame);
+    /// If WorkQueue is provided, thread-safe NetworkObject-s are cooked in worker threads.
+    void CookDeltaUpdates(NetworkFrame currentFrame, WorkQueue* workQueue = nullptr);
 
     /// Return state of the current frame.
     /// @{
     const ea::unordered_set<NetworkId>& GetRecentlyRemovedObjects() const { return recentlyRemovedObjects_; }
     const ea::vector<NetworkObject*>& GetSortedObjects() const { return sortedNetworkObjects_; }
+    unsigned GetSortedIndex(unsigned index) const { return sortedIndices_[index]; }
+    const NetworkInterestGrid& GetInterestGrid() const { return interestGrid_; }
     unsigned GetIndexUpperBound() const;
     const ea::unordered_set<NetworkObject*>& GetOwnedObjectsByConnection(AbstractConnection* connection) const;
     ea::optional<ConstByteSpan> GetReliableUpdateByIndex(unsigned index) const;
     ea::optional<ConstByteSpan> GetUnreliableUpdateByIndex(unsigned index) const;
+    /// Return keyframe that unreliable update depends on. Equal to the current frame if the update is a keyframe.
+    ea::optional<NetworkFrame> GetUnreliableUpdateKeyframe(unsigned index) const { return unreliableDeltaKeyframes_[index]; }
+    /// Return unreliable update that doesn't depend on the keyframe, for clients that were not sent the keyframe.
+    ConstByteSpan GetSelfContainedUnreliableUpdateByIndex(unsigned index) const;
     /// @}
 
 private:
@@ -80,12 +92,33 @@ private:
         unsigned endOffset_{};
     };
 
+    /// Delta updates of the individual NetworkObject.
+    struct CookedDeltaUpdate
+    {
+        unsigned index_{};
+        ea::optional<DeltaBufferSpan> reliable_;
+        ea::optional<DeltaBufferSpan> unreliable_;
+        ea::optional<NetworkFrame> unreliableKeyframe_;
+        ea::optional<DeltaBufferSpan> selfContainedUnreliable_;
+    };
+
+    /// Delta updates cooked by the individual thread.
+    struct ThreadDeltaBuffer
+    {
+        VectorBuffer buffer_;
+        ea::vector<CookedDeltaUpdate> updates_;
+    };
+
     void OnNetworkObjectAdded(NetworkObject* networkObject);
     void OnNetworkObjectRemoved(NetworkObject* networkObject);
 
     void ResetFrameBuffers();
     void InitializeNewObjects();
 
+    void CookDeltaUpdatesInThreads(NetworkFrame currentFrame, WorkQueue* workQueue);
+    CookedDeltaUpdate CookDeltaUpdate(NetworkFrame currentFrame, unsigned index, VectorBuffer& dest) const;
+    void CommitDeltaUpdate(const CookedDeltaUpdate& update, unsigned offset);
+
     ConstByteSpan GetSpanData(const DeltaBufferSpan& span) const;
 
     const WeakPtr<NetworkObjectRegistry> objectRegistry_{};
@@ -94,6 +127,9 @@ private:
     ea::unordered_set<NetworkId> recentlyAddedObjects_;
 
     ea::vector<NetworkObject*> sortedNetworkObjects_;
+    /// Index in sortedNetworkObjects_ for each NetworkObject index, M_MAX_UNSIGNED if not present.
+    ea::vector<unsigned> sortedIndices_;
+    NetworkInterestGrid interestGrid_;
 
     ea::vector<bool> isDeltaUpdateQueued_;
     ea::vector<bool> needReliableDeltaUpdate_;
@@ -102,6 +138,11 @@ private:
     VectorBuffer deltaUpdateBuffer_;
     ea::vector<DeltaBufferSpan> reliableDeltaUpdateData_;
     ea::vector<DeltaBufferSpan> unreliableDeltaUpdateData_;
+    ea::vector<ea::optional<NetworkFrame>> unreliableDeltaKeyframes_;
+    ea::vector<DeltaBufferSpan> selfContainedUnreliableDeltaUpdateData_;
+
+    ea::vector<unsigned> threadSafeDeltaUpdates_;
+    ea::vector<ThreadDeltaBuffer> threadDeltaBuffers_;
 
     ea::unordered_map<AbstractConnection*, ea::unordered_set<NetworkObject*>> ownedObjectsByConnection_;
 };
@@ -119,6 +160,7 @@ public:
     /// Return current state and properties
     /// @{
     const Variant& GetSetting(const NetworkSetting& setting) const;
+    void SetSetting(const NetworkSetting& setting, const Variant& value);
     bool IsSynchronized() const { return synchronized_; }
     NetworkFrame GetCurrentFrame() const { return frame_; }
     unsigned GetInputDelay() const { return inputDelay_; };
@@ -163,6 +205,27 @@ private:
     float clockTimeAccumulator_{};
 };
 
+/// Bandwidth and scheduling statistics of individual client connection.
+struct ClientReplicationStats
+{
+    /// Total number of bytes sent, by message category.
+    /// @{
+    unsigned long long removeObjectsBytes_{};
+    unsigned long long addObjectsBytes_{};
+    unsigned long long reliableUpdateBytes_{};
+    unsigned long long unreliableUpdateBytes_{};
+    /// @}
+
+    /// Total number of unreliable updates sent and deferred due to bandwidth limit.
+    /// @{
+    unsigned long long numUnreliableUpdatesSent_{};
+    unsigned long long numUnreliableUpdatesDeferred_{};
+    /// @}
+
+    /// Max number of consecutive frames for which any object update was deferred, as of the last frame.
+    unsigned maxStarvationFrames_{};
+};
+
 /// Scene replication state specific to individual client connection.
 struct ClientReplicationState : public ClientSynchronizationState
 {
@@ -184,12 +247,24 @@ public:
     float GetReportedInputLoss() const { return reportedLoss_;}
     /// @}
 
+    /// Return bandwidth and scheduling statistics.
+    const ClientReplicationStats& GetStats() const { return stats_; }
+
 private:
     void ProcessObjectsFeedbackUnreliable(MemoryBuffer& messageData);
     void SendRemoveObjects();
     void SendAddObjects();
     void SendUpdateObjectsReliable(const SharedReplicationState& sharedState);
     void SendUpdateObjectsUnreliable(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    void ScheduleUpdateObjectsUnreliable(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    ConstByteSpan GetUnreliableUpdateForClient(
+        NetworkFrame currentFrame, unsigned index, const SharedReplicationState& sharedState) const;
+
+    void UpdateInterestCells(const SharedReplicationState& sharedState);
+    void CollectCandidateObjects(const SharedReplicationState& sharedState);
+    void UpdateNetworkObject(SharedReplicationState& sharedState, NetworkObject* networkObject, unsigned sortedIndex);
+    NetworkObjectRelevance EvaluateRelevance(
+        const SharedReplicationState& sharedState, NetworkObject* networkObject, unsigned sortedIndex, bool wasRelevant);
 
     ea::vector<NetworkObjectRelevance> objectsRelevance_;
     ea::vector<float> objectsRelevanceTimeouts_;
@@ -197,6 +272,37 @@ private:
     ea::vector<NetworkId> pendingRemovedObjects_;
     ea::vector<ea::pair<NetworkObject*, bool>> pendingUpdatedObjects_;
 
+    /// Settings cached for the current update.
+    /// @{
+    float relevanceTimeout_{};
+    unsigned interestGridRadius_{};
+    unsigned interestGridHysteresis_{};
+    unsigned interestGridUpdatePeriodPerCell_{};
+    unsigned bandwidthLimit_{};
+    unsigned bandwidthBurstFrames_{};
+    /// @}
+
+    /// Interest management state.
+    /// @{
+    ea::vector<unsigned> relevantObjects_;
+    ea::vector<IntVector2> interestCells_;
+    ea::vector<unsigned> candidateObjects_;
+    ea::vector<unsigned> objectsCellDistances_;
+    /// @}
+
+    /// Unreliable update scheduling state.
+    /// @{
+    ea::vector<float> objectsPriorities_;
+    ea::vector<unsigned> objectsStarvationFrames_;
+    /// Last unreliable keyframe sent to the client for each object.
+    ea::vector<ea::optional<NetworkFrame>> objectsSentKeyframes_;
+    ea::vector<ea::pair<float, NetworkObject*>> dueUnreliableUpdates_;
+    ea::vector<NetworkObject*> scheduledUnreliableUpdates_;
+    float bandwidthBudget_{};
+    /// @}
+
+    ClientReplicationStats stats_;
+
     VectorBuffer componentBuffer_;
 
     float reportedLoss_{};
@@ -218,12 +324,15 @@ public:
     void ReportInputLoss(AbstractConnection* connection, float percentLoss);
 
     void SetCurrentFrame(NetworkFrame frame);
+    /// Set server-only setting. Setting is applied to all current and future connections.
+    void SetSetting(const NetworkSetting& setting, const Variant& value);
 
     /// Return current state of the replicator.
     /// @{
     ea::string GetDebugInfo() const;
     const Variant& GetSetting(const NetworkSetting& setting) const;
     unsigned GetFeedbackDelay(AbstractConnection* connection) const;
+    ClientReplicationStats GetReplicationStats(AbstractConnection* connection) const;
     const ea::unordered_set<NetworkObject*>& GetNetworkObjectsOwnedByConnection(AbstractConnection* connection) const;
     NetworkObject* GetNetworkObjectOwnedByConnection(AbstractConnection* connection) const;
     NetworkTime GetServerTime() const { return NetworkTime{currentFrame_}; }
@@ -0,0 +1,189 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Replica/TransformQuantizer.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Max absolute value of quaternion component that is not the largest one.
+const float smallestThreeRange = 1.0f / M_SQRT2;
+
+float GetMaxAbsComponent(const Vector3& value)
+{
+    return ea::max({Abs(value.x_), Abs(value.y_), Abs(value.z_)});
+}
+
+int QuantizeValue(float value, float range, float step)
+{
+    return RoundToInt(Clamp(value, -range, range) / step);
+}
+
+void WriteQuantizedVector(BitWriter& dest, const Vector3& value, float range, float step, unsigned numBits)
+{
+    dest.WriteSignedBits(QuantizeValue(value.x_, range, step), numBits);
+    dest.WriteSignedBits(QuantizeValue(value.y_, range, step), numBits);
+    dest.WriteSignedBits(QuantizeValue(value.z_, range, step), numBits);
+}
+
+Vector3 ReadQuantizedVector(BitReader& src, float step, unsigned numBits)
+{
+    const int x = src.ReadSignedBits(numBits);
+    const int y = src.ReadSignedBits(numBits);
+    const int z = src.ReadSignedBits(numBits);
+    return Vector3{x * step, y * step, z * step};
+}
+
+/// Return step of the value quantized with given number of bits, including sign.
+float GetStepForBits(float range, unsigned numBits)
+{
+    const unsigned maxValue = (1u << (numBits - 1)) - 1;
+    return range / ea::max(1u, maxValue);
+}
+
+}
+
+unsigned TransformQuantizer::GetMaxQuantizedValue(float range, float step)
+{
+    // Limit the range so zigzag-encoded value always fits into 32 bits
+    static const float maxValue = static_cast<float>(1u << 30);
+    return static_cast<unsigned>(ea::min(Ceil(range / step), maxValue));
+}
+
+IntVector3 TransformQuantizer::QuantizePosition(const Vector3& position) const
+{
+    const Vector3 offset = position - origin_;
+    return IntVector3{
+        QuantizeValue(offset.x_, positionRange_, positionStep_),
+        QuantizeValue(offset.y_, positionRange_, positionStep_),
+        QuantizeValue(offset.z_, positionRange_, positionStep_),
+    };
+}
+
+Vector3 TransformQuantizer::DequantizePosition(const IntVector3& position) const
+{
+    return origin_ + Vector3{position.x_ * positionStep_, position.y_ * positionStep_, position.z_ * positionStep_};
+}
+
+void TransformQuantizer::WritePosition(BitWriter& dest, const IntVector3& position) const
+{
+    const unsigned numBits = GetPositionBits();
+    dest.WriteSignedBits(position.x_, numBits);
+    dest.WriteSignedBits(position.y_, numBits);
+    dest.WriteSignedBits(position.z_, numBits);
+}
+
+IntVector3 TransformQuantizer::ReadPosition(BitReader& src) const
+{
+    const unsigned numBits = GetPositionBits();
+    const int x = src.ReadSignedBits(numBits);
+    const int y = src.ReadSignedBits(numBits);
+    const int z = src.ReadSignedBits(numBits);
+    return IntVector3{x, y, z};
+}
+
+void TransformQuantizer::WriteVelocity(BitWriter& dest, const Vector3& velocity) const
+{
+    // Objects often stand still, so zero velocity is stored as single bit
+    const bool isZero = QuantizeValue(GetMaxAbsComponent(velocity), velocityRange_, positionStep_) == 0;
+    dest.WriteBool(!isZero);
+    if (!isZero)
+        WriteQuantizedVector(dest, velocity, velocityRange_, positionStep_, GetVelocityBits());
+}
+
+Vector3 TransformQuantizer::ReadVelocity(BitReader& src) const
+{
+    if (!src.ReadBool())
+        return Vector3::ZERO;
+    return ReadQuantizedVector(src, positionStep_, GetVelocityBits());
+}
+
+void TransformQuantizer::WriteRotation(BitWriter& dest, const Quaternion& rotation) const
+{
+    const Quaternion normalizedRotation = rotation.Normalized();
+    const float* components = normalizedRotation.Data();
+
+    unsigned largestIndex = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largestIndex]))
+            largestIndex = i;
+    }
+
+    // Q and -Q represent the same rotation, so the largest component is always positive and can be restored
+    const float sign = components[largestIndex] < 0.0f ? -1.0f : 1.0f;
+    const float step = GetStepForBits(smallestThreeRange, rotationBits_);
+
+    dest.WriteBits(largestIndex, 2);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largestIndex)
+            dest.WriteSignedBits(QuantizeValue(components[i] * sign, smallestThreeRange, step), rotationBits_);
+    }
+}
+
+Quaternion TransformQuantizer::ReadRotation(BitReader& src) const
+{
+    const unsigned largestIndex = src.ReadBits(2);
+    const float step = GetStepForBits(smallestThreeRange, rotationBits_);
+
+    float components[4]{};
+    float sumSquares = 0.0f;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largestIndex)
+        {
+            components[i] = src.ReadSignedBits(rotationBits_) * step;
+            sumSquares += components[i] * components[i];
+        }
+    }
+    components[largestIndex] = Sqrt(ea::max(0.0f, 1.0f - sumSquares));
+
+    return Quaternion{components[0], components[1], components[2], components[3]}.Normalized();
+}
+
+void TransformQuantizer::WriteAngularVelocity(BitWriter& dest, const Vector3& angularVelocity) const
+{
+    const float step = GetStepForBits(angularVelocityRange_, rotationBits_);
+    const bool isZero = QuantizeValue(GetMaxAbsComponent(angularVelocity), angularVelocityRange_, step) == 0;
+    dest.WriteBool(!isZero);
+    if (!isZero)
+        WriteQuantizedVector(dest, angularVelocity, angularVelocityRange_, step, rotationBits_);
+}
+
+Vector3 TransformQuantizer::ReadAngularVelocity(BitReader& src) const
+{
+    if (!src.ReadBool())
+        return Vector3::ZERO;
+
+    const float step = GetStepForBits(angularVelocityRange_, rotationBits_);
+    return ReadQuantizedVector(src, step, rotationBits_);
+}
+
+}
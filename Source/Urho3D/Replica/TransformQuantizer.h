@@ -0,0 +1,88 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../IO/BitStream.h"
+#include "../Math/Quaternion.h"
+#include "../Math/Vector3.h"
+
+namespace Urho3D
+{
+
+/// Encoding of ReplicatedTransform updates.
+enum class ReplicatedTransformEncoding
+{
+    /// Positions, rotations and velocities are sent as raw floats.
+    Raw,
+    /// Positions and velocities are sent as fixed-point numbers, rotations are sent as smallest three components.
+    Quantized,
+};
+
+/// Quantization of transforms for network replication. Should be the same on the server and the client.
+/// Velocities are measured per network frame.
+struct URHO3D_API TransformQuantizer
+{
+    /// Origin of fixed-point positions.
+    Vector3 origin_;
+    /// Precision of positions and velocities.
+    float positionStep_{0.001f};
+    /// Max distance from origin along each axis. Positions outside the range are clamped.
+    float positionRange_{4096.0f};
+    /// Max velocity along each axis. Velocities outside the range are clamped.
+    float velocityRange_{16.0f};
+    /// Number of bits per quaternion component and per angular velocity component.
+    unsigned rotationBits_{12};
+    /// Max angular velocity along each axis. Angular velocities outside the range are clamped.
+    float angularVelocityRange_{1.0f};
+
+    /// Return number of bits used to store each coordinate.
+    /// @{
+    unsigned GetPositionBits() const { return GetNumBitsForRange(2 * GetMaxQuantizedValue(positionRange_, positionStep_)); }
+    unsigned GetVelocityBits() const { return GetNumBitsForRange(2 * GetMaxQuantizedValue(velocityRange_, positionStep_)); }
+    /// @}
+
+    /// Convert position to fixed-point numbers and back.
+    /// @{
+    IntVector3 QuantizePosition(const Vector3& position) const;
+    Vector3 DequantizePosition(const IntVector3& position) const;
+    /// @}
+
+    /// Write and read components of the transform.
+    /// @{
+    void WritePosition(BitWriter& dest, const IntVector3& position) const;
+    IntVector3 ReadPosition(BitReader& src) const;
+    void WriteVelocity(BitWriter& dest, const Vector3& velocity) const;
+    Vector3 ReadVelocity(BitReader& src) const;
+    void WriteRotation(BitWriter& dest, const Quaternion& rotation) const;
+    Quaternion ReadRotation(BitReader& src) const;
+    void WriteAngularVelocity(BitWriter& dest, const Vector3& angularVelocity) const;
+    Vector3 ReadAngularVelocity(BitReader& src) const;
+    /// @}
+
+private:
+    static unsigned GetMaxQuantizedValue(float range, float step);
+};
+
+}
@@ -26,6 +26,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/ResourceCache.h"
@@ -46,6 +47,29 @@ BackgroundLoader::~BackgroundLoader()
     MutexLock lock(backgroundLoadMutex_);
 
     backgroundLoadQueue_.clear();
+    loadOrder_.clear();
+    finishOrder_.clear();
+}
+
+void BackgroundLoader::StopLoading()
+{
+    Stop();
+
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        stopped_ = true;
+    }
+
+    // Tasks that are not started yet will exit immediately, wait for the ones that are in BeginLoad() now
+    for (;;)
+    {
+        {
+            MutexLock lock(backgroundLoadMutex_);
+            if (numRunningLoadTasks_ == 0)
+                break;
+        }
+        Time::Sleep(1);
+    }
 }
 
 void BackgroundLoader::ThreadFunction()
@@ -54,60 +78,141 @@ void BackgroundLoader::ThreadFunction()
 
     while (shouldRun_)
     {
-        backgroundLoadMutex_.Acquire();
-
-        // Search for a queued resource that has not been loaded yet
-        auto i = backgroundLoadQueue_.begin();
-        while (i != backgroundLoadQueue_.end())
+        BackgroundLoadItem* item = nullptr;
         {
-            if (i->second.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
+            MutexLock lock(backgroundLoadMutex_);
+            item = PopQueuedItem();
         }
 
-        if (i == backgroundLoadQueue_.end())
+        if (!item)
         {
             // No resources to load found
-            backgroundLoadMutex_.Release();
             Time::Sleep(5);
         }
         else
         {
-            BackgroundLoadItem& item = i->second;
-            Resource* resource = item.resource_;
             // We can be sure that the item is not removed from the queue as long as it is in the
             // "queued" or "loading" state
-            backgroundLoadMutex_.Release();
+            LoadItem(*item);
+        }
+    }
+}
+
+void BackgroundLoader::ProcessQueuedResources()
+{
+    URHO3D_PROFILE("BackgroundLoadResources");
+
+    {
+        MutexLock lock(backgroundLoadMutex_);
+        if (stopped_)
+        {
+            --numLoadTasks_;
+            return;
+        }
+        ++numRunningLoadTasks_;
+    }
 
-            bool success = false;
-            AbstractFilePtr file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
+    for (;;)
+    {
+        BackgroundLoadItem* item = nullptr;
+        {
+            MutexLock lock(backgroundLoadMutex_);
+            item = !stopped_ ? PopQueuedItem() : nullptr;
+            // Task count is decremented under the same lock as queue is checked,
+            // so resources queued after this point will start new task
+            if (!item)
             {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
+                --numLoadTasks_;
+                --numRunningLoadTasks_;
+                return;
             }
+        }
+
+        LoadItem(*item);
+    }
+}
+
+void BackgroundLoader::StartLoading()
+{
+    auto workQueue = owner_->GetSubsystem<WorkQueue>();
+    if (workQueue && workQueue->IsMultithreaded())
+    {
+        if (!stopped_ && numLoadTasks_ < GetMaxLoadTasks())
+        {
+            ++numLoadTasks_;
+            workQueue->PostTask([self = SharedPtr<BackgroundLoader>(this)] { self->ProcessQueuedResources(); },
+                TaskPriority::Low);
+        }
+    }
+    else if (!IsStarted())
+    {
+        // Start the background loader thread now
+        Run();
+    }
+}
+
+BackgroundLoadItem* BackgroundLoader::PopQueuedItem()
+{
+    while (!loadOrder_.empty())
+    {
+        const auto key = loadOrder_.front();
+        loadOrder_.pop_front();
+
+        // Skip resources that were already loaded on demand by WaitForResource
+        const auto i = backgroundLoadQueue_.find(key);
+        if (i != backgroundLoadQueue_.end() && i->second.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
+        {
+            i->second.resource_->SetAsyncLoadState(ASYNC_LOADING);
+            return &i->second;
+        }
+    }
+    return nullptr;
+}
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            ea::pair<StringHash, StringHash> key = ea::make_pair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.size())
+void BackgroundLoader::LoadItem(BackgroundLoadItem& item)
+{
+    Resource* resource = item.resource_;
+
+    bool success = false;
+    AbstractFilePtr file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
+    if (file)
+        success = resource->BeginLoad(*file);
+
+    // Process dependencies now
+    // Need to lock the queue again when manipulating other entries
+    ea::pair<StringHash, StringHash> key = ea::make_pair(resource->GetType(), resource->GetNameHash());
+    MutexLock lock(backgroundLoadMutex_);
+    if (item.dependents_.size())
+    {
+        for (auto i = item.dependents_.begin(); i != item.dependents_.end(); ++i)
+        {
+            auto j = backgroundLoadQueue_.find(*i);
+            if (j != backgroundLoadQueue_.end())
             {
-                for (auto i = item.dependents_.begin(); i != item.dependents_.end(); ++i)
-                {
-                    auto j = backgroundLoadQueue_.find(*i);
-                    if (j != backgroundLoadQueue_.end())
-                        j->second.dependencies_.erase(key);
-                }
+                BackgroundLoadItem& dependentItem = j->second;
+                dependentItem.dependencies_.erase(key);
 
-                item.dependents_.clear();
+                // Dependent resource may have finished BeginLoad() already and wait only for this one
+                const AsyncLoadState dependentState = dependentItem.resource_->GetAsyncLoadState();
+                if (dependentItem.dependencies_.empty() && dependentState != ASYNC_QUEUED && dependentState != ASYNC_LOADING)
+                    finishOrder_.push_back(*i);
             }
-
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
         }
+
+        item.dependents_.clear();
     }
+
+    resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+    if (item.dependencies_.empty())
+        finishOrder_.push_back(key);
+}
+
+unsigned BackgroundLoader::GetMaxLoadTasks() const
+{
+    auto workQueue = owner_->GetSubsystem<WorkQueue>();
+    const unsigned numWorkerThreads = workQueue->GetNumProcessingThreads() - 1;
+    const unsigned maxThreads = owner_->GetMaxBackgroundLoadThreads();
+    return ea::max(1u, maxThreads != 0 ? ea::min(maxThreads, numWorkerThreads) : numWorkerThreads);
 }
 
 bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller)
@@ -165,9 +270,8 @@ bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bo
                        " requested for a background loaded resource but was not in the background load queue");
     }
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
+    loadOrder_.push_back(key);
+    StartLoading();
 
     return true;
 }
@@ -181,16 +285,30 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
     auto i = backgroundLoadQueue_.find(key);
     if (i != backgroundLoadQueue_.end())
     {
+        Resource* resource = i->second.resource_;
+
+        // If nobody started loading the resource yet, it's faster to load it here than to wait
+        const bool loadNow = resource->GetAsyncLoadState() == ASYNC_QUEUED;
+        if (loadNow)
+            resource->SetAsyncLoadState(ASYNC_LOADING);
+
         backgroundLoadMutex_.Release();
 
+        if (loadNow)
+            LoadItem(i->second);
+
         {
-            Resource* resource = i->second.resource_;
             HiresTimer waitTimer;
             bool didWait = false;
 
             for (;;)
             {
-                unsigned numDeps = i->second.dependencies_.size();
+                unsigned numDeps = 0;
+                {
+                    MutexLock lock(backgroundLoadMutex_);
+                    numDeps = i->second.dependencies_.size();
+                }
+
                 AsyncLoadState state = resource->GetAsyncLoadState();
                 if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
                 {
@@ -220,39 +338,40 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
-    {
-        HiresTimer timer;
+    HiresTimer timer;
 
-        backgroundLoadMutex_.Acquire();
+    backgroundLoadMutex_.Acquire();
 
-        for (auto i = backgroundLoadQueue_.begin(); i != backgroundLoadQueue_.end();
-             i = backgroundLoadQueue_.begin())
-        {
-            const auto key = i->first;
-            Resource* resource = i->second.resource_;
-            unsigned numDeps = i->second.dependencies_.size();
-            AsyncLoadState state = resource->GetAsyncLoadState();
-            if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
-                ++i;
-            else
-            {
-                // Finishing a resource may need it to wait for other resources to load, in which case we can not
-                // hold on to the mutex
-                backgroundLoadMutex_.Release();
-                FinishBackgroundLoading(i->second);
-                backgroundLoadMutex_.Acquire();
-                // Erasing by key because the queue may change since last time
-                backgroundLoadQueue_.erase(key);
-            }
+    while (!finishOrder_.empty())
+    {
+        const auto key = finishOrder_.front();
+        finishOrder_.pop_front();
 
-            // Break when the time limit passed so that we keep sufficient FPS
-            if (timer.GetUSec(false) >= maxMs * 1000LL)
-                break;
-        }
+        // Skip resources that were already finished by WaitForResource
+        auto i = backgroundLoadQueue_.find(key);
+        if (i == backgroundLoadQueue_.end())
+            continue;
+
+        Resource* resource = i->second.resource_;
+        unsigned numDeps = i->second.dependencies_.size();
+        AsyncLoadState state = resource->GetAsyncLoadState();
+        if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING || state == ASYNC_DONE)
+            continue;
 
+        // Finishing a resource may need it to wait for other resources to load, in which case we can not
+        // hold on to the mutex
         backgroundLoadMutex_.Release();
+        FinishBackgroundLoading(i->second);
+        backgroundLoadMutex_.Acquire();
+        // Erasing by key because the queue may change since last time
+        backgroundLoadQueue_.erase(key);
+
+        // Break when the time limit passed so that we keep sufficient FPS
+        if (timer.GetUSec(false) >= maxMs * 1000LL)
+            break;
     }
+
+    backgroundLoadMutex_.Release();
 }
 
 unsigned BackgroundLoader::GetNumQueuedResources() const
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <EASTL/deque.h>
 #include <EASTL/hash_set.h>
 #include <EASTL/unordered_map.h>
 
@@ -50,6 +51,7 @@ struct URHO3D_API BackgroundLoadItem
 };
 
 /// Background loader of resources. Owned by the ResourceCache.
+/// BeginLoad() is executed by WorkQueue worker threads if there are any, otherwise by dedicated loader thread.
 /// @nobind
 class URHO3D_API BackgroundLoader : public RefCounted, public Thread
 {
@@ -60,8 +62,10 @@ public:
     /// Destruct. Forcibly clear the load queue.
     ~BackgroundLoader() override;
 
-    /// Resource background loading loop.
+    /// Resource background loading loop. Used only if WorkQueue has no worker threads.
     void ThreadFunction() override;
+    /// Stop loading new resources and wait until resources being loaded are processed. Should be called from main thread.
+    void StopLoading();
 
     /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
     bool QueueResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller);
@@ -74,6 +78,16 @@ public:
     unsigned GetNumQueuedResources() const;
 
 private:
+    /// Start loading queued resources in worker tasks or in loader thread. Should be called under the mutex.
+    void StartLoading();
+    /// Process queued resources until the queue is empty. Executed in WorkQueue tasks.
+    void ProcessQueuedResources();
+    /// Take next queued resource and mark it as being loaded. Should be called under the mutex.
+    BackgroundLoadItem* PopQueuedItem();
+    /// Execute BeginLoad() of the resource and update dependent resources.
+    void LoadItem(BackgroundLoadItem& item);
+    /// Return maximum number of WorkQueue tasks that may be loading resources simultaneously.
+    unsigned GetMaxLoadTasks() const;
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
 
@@ -83,6 +97,16 @@ private:
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     ea::unordered_map<ea::pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Resources in order of queueing. May contain resources that are already loaded or removed from the queue.
+    ea::deque<ea::pair<StringHash, StringHash>> loadOrder_;
+    /// Resources that finished BeginLoad() and have no pending dependencies, in order of completion.
+    ea::deque<ea::pair<StringHash, StringHash>> finishOrder_;
+    /// Number of WorkQueue tasks posted for resource loading and not finished yet.
+    unsigned numLoadTasks_{};
+    /// Number of WorkQueue tasks that are processing resources right now.
+    unsigned numRunningLoadTasks_{};
+    /// Whether the loading is stopped.
+    bool stopped_{};
 };
 
 }
@@ -112,6 +112,7 @@ ResourceCache::~ResourceCache()
 {
 #ifdef URHO3D_THREADING
     // Shut down the background loader first
+    backgroundLoader_->StopLoading();
     backgroundLoader_.Reset();
 #endif
 }
@@ -124,6 +124,9 @@ public:
     /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources.
     /// @property
     void SetFinishBackgroundResourcesMs(int ms) { finishBackgroundResourcesMs_ = Max(ms, 1); }
+    /// Set how many WorkQueue worker threads may execute background loading simultaneously. 0 means all worker threads.
+    /// @property
+    void SetMaxBackgroundLoadThreads(unsigned count) { maxBackgroundLoadThreads_ = count; }
 
     /// Add a resource router object. By default there is none, so the routing process is skipped.
     void AddResourceRouter(ResourceRouter* router, bool addAsFirst = false);
@@ -186,6 +189,9 @@ public:
     /// Return how many milliseconds maximum to spend on finishing background loaded resources.
     /// @property
     int GetFinishBackgroundResourcesMs() const { return finishBackgroundResourcesMs_; }
+    /// Return how many WorkQueue worker threads may execute background loading simultaneously.
+    /// @property
+    unsigned GetMaxBackgroundLoadThreads() const { return maxBackgroundLoadThreads_; }
 
     /// Return a resource router by index.
     ResourceRouter* GetResourceRouter(unsigned index) const;
@@ -251,6 +257,8 @@ private:
     bool searchPackagesFirst_;
     /// How many milliseconds maximum per frame to spend on finishing background loaded resources.
     int finishBackgroundResourcesMs_;
+    /// How many worker threads may execute background loading simultaneously.
+    unsigned maxBackgroundLoadThreads_{};
     /// List of resources that will not be auto-reloaded if reloading event triggers.
     ea::vector<ea::string> ignoreResourceAutoReload_;
 };
@@ -0,0 +1,317 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Precompiled.h>
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ObjectReflection.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Scene/CompiledNodePrefab.h>
+#include <Urho3D/Scene/Component.h>
+#include <Urho3D/Scene/Node.h>
+#include <Urho3D/Scene/PrefabReader.h>
+#include <Urho3D/Scene/SceneResolver.h>
+
+namespace Urho3D
+{
+
+namespace
+{
+
+bool HasIdAttributes(const ObjectReflection* reflection)
+{
+    const auto isIdAttribute = [](const AttributeInfo& attr)
+    { return !!(attr.mode_ & (AM_NODEID | AM_COMPONENTID | AM_NODEIDVECTOR)); };
+    const auto& attributes = reflection->GetAttributes();
+    return ea::any_of(attributes.begin(), attributes.end(), isIdAttribute);
+}
+
+void ApplyAttributes(Serializable* serializable, const ObjectReflection* reflection,
+    const ea::vector<ea::pair<unsigned, Variant>>& attributes)
+{
+    const auto& objectAttributes = reflection->GetAttributes();
+    for (const auto& [attributeIndex, value] : attributes)
+        serializable->OnSetAttribute(objectAttributes[attributeIndex], value);
+}
+
+void ResetAttributes(Serializable* serializable, const ObjectReflection* reflection,
+    const ea::vector<ea::pair<unsigned, Variant>>& attributes, const ea::vector<unsigned>& defaultAttributes)
+{
+    const auto& objectAttributes = reflection->GetAttributes();
+    for (unsigned attributeIndex : defaultAttributes)
+        serializable->OnSetAttribute(objectAttributes[attributeIndex], objectAttributes[attributeIndex].defaultValue_);
+    ApplyAttributes(serializable, reflection, attributes);
+}
+
+} // namespace
+
+CompiledNodePrefab::CompiledNodePrefab(Context* context, const NodePrefab& prefab)
+    : context_(context)
+    , prefab_(prefab)
+{
+    if (prefab.IsEmpty())
+        valid_ = false;
+    else
+        CompileNode(prefab, M_MAX_UNSIGNED);
+
+    if (!valid_)
+    {
+        nodes_.clear();
+        components_.clear();
+    }
+}
+
+void CompiledNodePrefab::CompileNode(const NodePrefab& prefab, unsigned parentIndex)
+{
+    const unsigned index = nodes_.size();
+    nodes_.emplace_back();
+    nodes_[index].parentIndex_ = parentIndex;
+    nodes_[index].numChildren_ = prefab.GetChildren().size();
+    valid_ &= CompileSerializable(nodes_[index].node_, prefab.GetNode(), context_->GetReflection<Node>());
+
+    nodes_[index].componentsBegin_ = components_.size();
+    for (const SerializablePrefab& componentPrefab : prefab.GetComponents())
+    {
+        ObjectReflection* reflection = context_->GetReflection(componentPrefab.GetTypeNameHash());
+        if (!reflection || !reflection->HasObjectFactory() || !reflection->GetTypeInfo()->IsTypeOf<Component>())
+        {
+            valid_ = false;
+            return;
+        }
+
+        needResolve_ |= HasIdAttributes(reflection);
+        valid_ &= CompileSerializable(components_.emplace_back(), componentPrefab, reflection);
+    }
+    nodes_[index].componentsEnd_ = components_.size();
+
+    for (const NodePrefab& childPrefab : prefab.GetChildren())
+        CompileNode(childPrefab, index);
+}
+
+bool CompiledNodePrefab::CompileSerializable(
+    CompiledSerializable& result, const SerializablePrefab& prefab, ObjectReflection* reflection)
+{
+    if (!reflection)
+        return false;
+
+    result.reflection_ = reflection;
+    result.id_ = static_cast<unsigned>(prefab.GetId());
+    result.temporary_ = prefab.IsTemporary();
+
+    // Same filtering as in SerializablePrefab::Export
+    const auto& objectAttributes = reflection->GetAttributes();
+    for (const AttributePrefab& attributePrefab : prefab.GetAttributes())
+    {
+        if (attributePrefab.GetId() != AttributeId::None)
+            continue;
+
+        const unsigned attributeIndex = reflection->GetAttributeIndex(attributePrefab.GetNameHash());
+        if (attributeIndex == M_MAX_UNSIGNED)
+            continue;
+
+        const AttributeInfo& attr = objectAttributes[attributeIndex];
+        const bool shouldLoad = attr.ShouldLoad() || !!(attr.mode_ & AM_TEMPORARY);
+        if (!shouldLoad)
+            continue;
+
+        const Variant& value = attributePrefab.GetValue();
+        if (value.GetType() == VAR_STRING && !attr.enumNames_.empty())
+        {
+            const unsigned enumValue = attr.ConvertEnumToUInt(value.GetString());
+            if (enumValue != M_MAX_UNSIGNED)
+                result.attributes_.emplace_back(attributeIndex, enumValue);
+            else
+            {
+                URHO3D_LOGWARNING("Attribute '{}' of Serializable '{}' has unknown enum value '{}'",
+                    attr.name_, reflection->GetTypeName(), value.GetString());
+            }
+        }
+        else
+            result.attributes_.emplace_back(attributeIndex, value);
+    }
+
+    // Internal attributes are derived from other state and are not reset
+    for (unsigned attributeIndex = 0; attributeIndex < objectAttributes.size(); ++attributeIndex)
+    {
+        const AttributeInfo& attr = objectAttributes[attributeIndex];
+        if (!attr.ShouldLoad() || !!(attr.mode_ & AM_NOEDIT))
+            continue;
+
+        const auto isSameAttribute = [&](const ea::pair<unsigned, Variant>& item) { return item.first == attributeIndex; };
+        if (ea::none_of(result.attributes_.begin(), result.attributes_.end(), isSameAttribute))
+            result.defaultAttributes_.push_back(attributeIndex);
+    }
+    return true;
+}
+
+Node* CompiledNodePrefab::Instantiate(Node* parent, const Vector3& position, const Quaternion& rotation) const
+{
+    ea::vector<Node*> result;
+    InstantiateMany(result, parent, {&position, 1}, {&rotation, 1});
+    return !result.empty() ? result[0] : nullptr;
+}
+
+void CompiledNodePrefab::InstantiateMany(ea::vector<Node*>& result, Node* parent, ea::span<const Vector3> positions,
+    ea::span<const Quaternion> rotations) const
+{
+    URHO3D_PROFILE("InstantiateCompiledPrefab");
+
+    result.clear();
+    result.reserve(positions.size());
+
+    if (!valid_)
+    {
+        for (unsigned i = 0; i < positions.size(); ++i)
+        {
+            const Quaternion& rotation = i < rotations.size() ? rotations[i] : Quaternion::IDENTITY;
+            if (Node* node = parent->InstantiatePrefab(prefab_, positions[i], rotation))
+                result.push_back(node);
+        }
+        return;
+    }
+
+    parent->ReserveChildren(parent->GetNumChildren() + positions.size());
+
+    ea::vector<Node*> nodes(nodes_.size());
+    for (unsigned i = 0; i < positions.size(); ++i)
+    {
+        Node* rootNode = InstantiateNodes(parent, nodes);
+        rootNode->SetTransform(positions[i], i < rotations.size() ? rotations[i] : Quaternion::IDENTITY);
+        result.push_back(rootNode);
+    }
+}
+
+Node* CompiledNodePrefab::InstantiateNodes(Node* parent, ea::vector<Node*>& nodes) const
+{
+    SceneResolver resolver;
+
+    for (unsigned nodeIndex = 0; nodeIndex < nodes_.size(); ++nodeIndex)
+    {
+        const CompiledNode& compiledNode = nodes_[nodeIndex];
+        Node* parentNode = compiledNode.parentIndex_ != M_MAX_UNSIGNED ? nodes[compiledNode.parentIndex_] : parent;
+
+        Node* node = parentNode->CreateChild(0);
+        node->ReserveChildren(compiledNode.numChildren_);
+        node->ReserveComponents(compiledNode.componentsEnd_ - compiledNode.componentsBegin_);
+        nodes[nodeIndex] = node;
+
+        node->SetTemporary(compiledNode.node_.temporary_);
+        ApplyAttributes(node, compiledNode.node_.reflection_, compiledNode.node_.attributes_);
+        if (needResolve_)
+            resolver.AddNode(compiledNode.node_.id_, node);
+
+        for (unsigned componentIndex = compiledNode.componentsBegin_; componentIndex < compiledNode.componentsEnd_;
+             ++componentIndex)
+        {
+            const CompiledSerializable& compiledComponent = components_[componentIndex];
+            const auto component = StaticCast<Component>(compiledComponent.reflection_->CreateObject());
+            node->AddComponent(component, 0);
+
+            component->SetTemporary(compiledComponent.temporary_);
+            ApplyAttributes(component, compiledComponent.reflection_, compiledComponent.attributes_);
+            if (needResolve_)
+                resolver.AddComponent(compiledComponent.id_, component);
+        }
+    }
+
+    if (needResolve_)
+        resolver.Resolve();
+
+    nodes[0]->ApplyAttributes();
+    return nodes[0];
+}
+
+bool CompiledNodePrefab::MatchesInstance(const Node* rootNode) const
+{
+    if (!valid_)
+        return false;
+
+    ea::vector<Node*> nodes;
+    rootNode->GetChildren(nodes, true);
+    if (nodes.size() + 1 != nodes_.size())
+        return false;
+
+    // Nodes are enumerated in the same depth-first order as on compilation
+    for (unsigned nodeIndex = 0; nodeIndex < nodes_.size(); ++nodeIndex)
+    {
+        const CompiledNode& compiledNode = nodes_[nodeIndex];
+        const Node* node = nodeIndex == 0 ? rootNode : nodes[nodeIndex - 1];
+        const auto& components = node->GetComponents();
+        if (node->GetNumChildren() != compiledNode.numChildren_
+            || components.size() != compiledNode.componentsEnd_ - compiledNode.componentsBegin_)
+            return false;
+
+        for (unsigned i = 0; i < components.size(); ++i)
+        {
+            if (components[i]->GetType() != components_[compiledNode.componentsBegin_ + i].reflection_->GetTypeNameHash())
+                return false;
+        }
+    }
+    return true;
+}
+
+bool CompiledNodePrefab::ResetInstance(Node* rootNode) const
+{
+    URHO3D_PROFILE("ResetCompiledPrefabInstance");
+
+    if (!MatchesInstance(rootNode))
+        return false;
+
+    ea::vector<Node*> nodes;
+    rootNode->GetChildren(nodes, true);
+    nodes.insert(nodes.begin(), rootNode);
+
+    SceneResolver resolver;
+    for (unsigned nodeIndex = 0; nodeIndex < nodes_.size(); ++nodeIndex)
+    {
+        const CompiledNode& compiledNode = nodes_[nodeIndex];
+        Node* node = nodes[nodeIndex];
+
+        node->SetTemporary(compiledNode.node_.temporary_);
+        ResetAttributes(node, compiledNode.node_.reflection_, compiledNode.node_.attributes_,
+            compiledNode.node_.defaultAttributes_);
+        if (needResolve_)
+            resolver.AddNode(compiledNode.node_.id_, node);
+
+        const auto& components = node->GetComponents();
+        for (unsigned i = 0; i < components.size(); ++i)
+        {
+            const CompiledSerializable& compiledComponent = components_[compiledNode.componentsBegin_ + i];
+            Component* component = components[i];
+
+            component->SetTemporary(compiledComponent.temporary_);
+            ResetAttributes(component, compiledComponent.reflection_, compiledComponent.attributes_,
+                compiledComponent.defaultAttributes_);
+            if (needResolve_)
+                resolver.AddComponent(compiledComponent.id_, component);
+        }
+    }
+
+    if (needResolve_)
+        resolver.Resolve();
+
+    rootNode->ApplyAttributes();
+    return true;
+}
+
+} // namespace Urho3D
@@ -0,0 +1,105 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Math/Quaternion.h>
+#include <Urho3D/Scene/NodePrefab.h>
+
+#include <EASTL/span.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Context;
+class Node;
+class ObjectReflection;
+
+/// Node prefab compiled for fast instantiation.
+/// Attribute indices, enum values and object factories are resolved once on compilation.
+/// Compiled prefab keeps raw pointers to object reflections and should be discarded when any reflection is removed,
+/// PrefabResource does it automatically. Changes of attributes of existing reflections are not tracked.
+/// Unlike Node::InstantiatePrefab, instantiated nodes and components always get new IDs instead of IDs from prefab.
+class URHO3D_API CompiledNodePrefab
+{
+public:
+    /// Compile prefab. Prefab should not be changed or destroyed while compiled prefab is used.
+    CompiledNodePrefab(Context* context, const NodePrefab& prefab);
+
+    /// Instantiate prefab as a child of the parent node. Return root node. IDs are assigned by the scene.
+    Node* Instantiate(Node* parent, const Vector3& position = Vector3::ZERO,
+        const Quaternion& rotation = Quaternion::IDENTITY) const;
+    /// Instantiate one copy of prefab per position as children of the parent node. Rotations are optional.
+    void InstantiateMany(ea::vector<Node*>& result, Node* parent, ea::span<const Vector3> positions,
+        ea::span<const Quaternion> rotations = {}) const;
+    /// Return whether the hierarchy of nodes and components of existing instance matches the prefab.
+    bool MatchesInstance(const Node* rootNode) const;
+    /// Reset nodes and components of existing prefab instance to prefab state, including attributes omitted in prefab.
+    /// Instance should be attached to the scene, so the references between nodes and components are resolved.
+    /// Return false if the hierarchy of the instance doesn't match the prefab anymore.
+    bool ResetInstance(Node* rootNode) const;
+
+    /// Return whether the prefab is compiled. Prefabs with unknown or abstract component types are not compiled.
+    bool IsValid() const { return valid_; }
+    /// Return number of nodes in the prefab.
+    unsigned GetNumNodes() const { return nodes_.size(); }
+    /// Return number of components in the prefab.
+    unsigned GetNumComponents() const { return components_.size(); }
+
+private:
+    struct CompiledSerializable
+    {
+        ObjectReflection* reflection_{};
+        unsigned id_{};
+        bool temporary_{};
+        ea::vector<ea::pair<unsigned, Variant>> attributes_;
+        /// Attributes omitted in prefab, reset to default values on instance reset.
+        ea::vector<unsigned> defaultAttributes_;
+    };
+
+    struct CompiledNode
+    {
+        CompiledSerializable node_;
+        unsigned parentIndex_{};
+        unsigned numChildren_{};
+        unsigned componentsBegin_{};
+        unsigned componentsEnd_{};
+    };
+
+    void CompileNode(const NodePrefab& prefab, unsigned parentIndex);
+    bool CompileSerializable(CompiledSerializable& result, const SerializablePrefab& prefab, ObjectReflection* reflection);
+    Node* InstantiateNodes(Node* parent, ea::vector<Node*>& nodes) const;
+
+    Context* context_{};
+    bool valid_{true};
+    /// Whether the components reference nodes or components by ID and need to be resolved.
+    bool needResolve_{};
+
+    /// Nodes in depth-first order.
+    ea::vector<CompiledNode> nodes_;
+    ea::vector<CompiledSerializable> components_;
+    /// Original prefab, used as fallback if the prefab cannot be compiled.
+    const NodePrefab& prefab_;
+};
+
+} // namespace Urho3D
@@ -272,6 +272,15 @@ Node* Node::InstantiatePrefab(const NodePrefab& prefab, const Vector3& position,
     return childNode;
 }
 
+ea::vector<Node*> Node::InstantiatePrefabMany(
+    const PrefabResource* prefabResource, ea::span<const Vector3> positions, ea::span<const Quaternion> rotations)
+{
+    ea::vector<Node*> result;
+    if (prefabResource)
+        prefabResource->GetCompiledNodePrefab().InstantiateMany(result, this, positions, rotations);
+    return result;
+}
+
 void Node::GeneratePrefab(NodePrefab& prefab) const
 {
     const PrefabSaveFlags flags = PrefabSaveFlag::EnumsAsStrings | PrefabSaveFlag::Prefab;
@@ -711,8 +720,11 @@ void Node::SetWorldScale(const Vector3& scale)
 
 void Node::SetWorldTransform(const Vector3& position, const Quaternion& rotation)
 {
-    SetWorldPosition(position);
-    SetWorldRotation(rotation);
+    // Mark dirty only once
+    if (IsTransformHierarchyRoot())
+        SetTransform(position, rotation);
+    else
+        SetTransform(parent_->GetWorldTransform().Inverse() * position, parent_->GetWorldRotation().Inverse() * rotation);
 }
 
 void Node::SetWorldTransform(const Vector3& position, const Quaternion& rotation, float scale)
@@ -31,6 +31,7 @@
 #include "../Scene/PrefabTypes.h"
 #include "../Scene/Serializable.h"
 
+#include <EASTL/span.h>
 #include <EASTL/type_traits.h>
 
 #include <atomic>
@@ -128,6 +129,9 @@ public:
     /// Instantiate scene content from prefab. Return root node if successful.
     Node* InstantiatePrefab(const NodePrefab& prefab, const Vector3& position = Vector3::ZERO,
         const Quaternion& rotation = Quaternion::IDENTITY);
+    /// Instantiate one copy of prefab per position using compiled prefab. Rotations are optional. Return root nodes.
+    ea::vector<Node*> InstantiatePrefabMany(const PrefabResource* prefabResource, ea::span<const Vector3> positions,
+        ea::span<const Quaternion> rotations = {});
     /// Generate prefab from scene content.
     void GeneratePrefab(NodePrefab& prefab) const;
     NodePrefab GeneratePrefab() const;
@@ -753,6 +757,10 @@ public:
     Node* CreateChild(unsigned id, bool temporary = false);
     /// Add a pre-created component. Using this function from application code is discouraged, as component operation without an owner node may not be well-defined in all cases. Prefer CreateComponent() instead.
     void AddComponent(Component* component, unsigned id);
+    /// Reserve space for child nodes. Used for bulk creation.
+    void ReserveChildren(unsigned numChildren) { children_.reserve(numChildren); }
+    /// Reserve space for components. Used for bulk creation.
+    void ReserveComponents(unsigned numComponents) { components_.reserve(numComponents); }
     /// Calculate number of non-temporary child nodes.
     unsigned GetNumPersistentChildren() const;
     /// Calculate number of non-temporary components.
@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Precompiled.h>
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/Profiler.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Scene/NodePool.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace Urho3D
+{
+
+NodePool::NodePool(Scene* scene, PrefabResource* prefab)
+    : Object(scene->GetContext())
+    , scene_(scene)
+    , prefab_(prefab)
+{
+    SubscribeToEvent(E_BEGINFRAME, [this] { HandleBeginFrame(); });
+}
+
+NodePool::~NodePool()
+{
+    Clear();
+}
+
+Node* NodePool::Spawn(Node* parent, const Vector3& position, const Quaternion& rotation)
+{
+    URHO3D_PROFILE("SpawnFromNodePool");
+
+    if (parkedNodes_.empty())
+        CollectRemovedNodes();
+
+    const CompiledNodePrefab& compiledPrefab = prefab_->GetCompiledNodePrefab();
+    while (!parkedNodes_.empty())
+    {
+        SharedPtr<Node> node = ea::move(parkedNodes_.back());
+        parkedNodes_.pop_back();
+
+        // Prefab may have been reloaded or the instance may have been modified
+        if (!compiledPrefab.MatchesInstance(node))
+        {
+            node->Remove();
+            continue;
+        }
+
+        // Attach first, so removed instances get their IDs back before references are resolved
+        parent->AddChild(node);
+        compiledPrefab.ResetInstance(node);
+        node->SetTransform(position, rotation);
+
+        ++frameStats_.numSpawned_;
+        ++frameStats_.numReused_;
+        AddActiveNode(node);
+        return node;
+    }
+
+    Node* node = CreateInstance(parent, position, rotation);
+    if (!node)
+        return nullptr;
+
+    ++frameStats_.numSpawned_;
+    AddActiveNode(SharedPtr<Node>(node));
+    return node;
+}
+
+bool NodePool::Recycle(Node* node)
+{
+    const auto iter = activeNodeIndices_.find(node);
+    if (iter == activeNodeIndices_.end())
+    {
+        URHO3D_LOGERROR("Node is not spawned by this NodePool");
+        return false;
+    }
+
+    // Move the last instance into the freed slot
+    const unsigned index = iter->second;
+    activeNodeIndices_.erase(iter);
+    SharedPtr<Node> nodeShared = ea::move(activeNodes_[index]);
+    if (index + 1 != activeNodes_.size())
+    {
+        activeNodes_[index] = ea::move(activeNodes_.back());
+        activeNodeIndices_[activeNodes_[index]] = index;
+    }
+    activeNodes_.pop_back();
+
+    // Keep node in the scene to avoid re-registering IDs
+    nodeShared->SetEnabledRecursive(false);
+    if (Node* parkingNode = GetOrCreateParkingNode())
+        parkingNode->AddChild(nodeShared);
+    else
+        nodeShared->Remove();
+
+    ++frameStats_.numRecycled_;
+    parkedNodes_.push_back(nodeShared);
+    return true;
+}
+
+void NodePool::Reserve(unsigned numInstances)
+{
+    Node* parkingNode = GetOrCreateParkingNode();
+    if (!parkingNode)
+        return;
+
+    parkingNode->ReserveChildren(numInstances);
+    while (parkedNodes_.size() < numInstances)
+    {
+        Node* node = CreateInstance(parkingNode, Vector3::ZERO, Quaternion::IDENTITY);
+        if (!node)
+            return;
+
+        node->SetEnabledRecursive(false);
+        parkedNodes_.emplace_back(node);
+    }
+}
+
+void NodePool::Clear()
+{
+    if (parkingNode_)
+        parkingNode_->Remove();
+
+    parkedNodes_.clear();
+    activeNodes_.clear();
+    activeNodeIndices_.clear();
+}
+
+void NodePool::HandleBeginFrame()
+{
+    CollectRemovedNodes();
+
+    lastFrameStats_ = frameStats_;
+    frameStats_ = {};
+}
+
+void NodePool::CollectRemovedNodes()
+{
+    // Keep removed nodes that are still referenced elsewhere
+    const auto isRemoved = [](const SharedPtr<Node>& node) { return !node->GetParent() && node->Refs() == 1; };
+
+    unsigned numKept = 0;
+    for (SharedPtr<Node>& node : activeNodes_)
+    {
+        if (isRemoved(node))
+        {
+            ++frameStats_.numRecycled_;
+            activeNodeIndices_.erase(node);
+            parkedNodes_.push_back(ea::move(node));
+            continue;
+        }
+
+        if (&node != &activeNodes_[numKept])
+        {
+            activeNodeIndices_[node] = numKept;
+            activeNodes_[numKept] = ea::move(node);
+        }
+        ++numKept;
+    }
+    activeNodes_.resize(numKept);
+}
+
+Node* NodePool::GetOrCreateParkingNode()
+{
+    if (!parkingNode_ && scene_)
+    {
+        parkingNode_ = scene_->CreateTemporaryChild("NodePool");
+        parkingNode_->SetEnabled(false);
+    }
+    return parkingNode_;
+}
+
+void NodePool::AddActiveNode(SharedPtr<Node> node)
+{
+    activeNodeIndices_[node] = activeNodes_.size();
+    activeNodes_.push_back(ea::move(node));
+}
+
+Node* NodePool::CreateInstance(Node* parent, const Vector3& position, const Quaternion& rotation)
+{
+    const CompiledNodePrefab& compiledPrefab = prefab_->GetCompiledNodePrefab();
+    frameStats_.numAllocatedNodes_ += compiledPrefab.GetNumNodes();
+    frameStats_.numAllocatedComponents_ += compiledPrefab.GetNumComponents();
+    return compiledPrefab.Instantiate(parent, position, rotation);
+}
+
+} // namespace Urho3D
@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2024-2024 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Container/Ptr.h>
+#include <Urho3D/Core/Object.h>
+#include <Urho3D/Math/Quaternion.h>
+
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Node;
+class PrefabResource;
+class Scene;
+
+/// Node pool statistics.
+struct NodePoolStats
+{
+    /// Number of spawned prefab instances.
+    unsigned numSpawned_{};
+    /// Number of prefab instances reused from the pool.
+    unsigned numReused_{};
+    /// Number of prefab instances returned to the pool.
+    unsigned numRecycled_{};
+    /// Number of allocated nodes and components.
+    /// @{
+    unsigned numAllocatedNodes_{};
+    unsigned numAllocatedComponents_{};
+    /// @}
+};
+
+/// Pool of prefab instances for entities that are frequently spawned and removed.
+/// Recycled instances are disabled and parked in the scene, so they keep their IDs, components and event subscriptions.
+/// Instances removed from the scene are recycled as well if the pool holds the only reference to them.
+/// Reused instances are reset to the prefab state. Instances with changed hierarchy are discarded.
+class URHO3D_API NodePool : public Object
+{
+    URHO3D_OBJECT(NodePool, Object);
+
+public:
+    NodePool(Scene* scene, PrefabResource* prefab);
+    ~NodePool() override;
+
+    /// Instantiate prefab as a child of the parent node, reusing recycled instance if possible.
+    Node* Spawn(Node* parent, const Vector3& position = Vector3::ZERO,
+        const Quaternion& rotation = Quaternion::IDENTITY);
+    /// Return instance to the pool. Return false if the node is not spawned by this pool.
+    bool Recycle(Node* node);
+    /// Instantiate parked instances in advance.
+    void Reserve(unsigned numInstances);
+    /// Remove all parked instances from the scene and forget about active instances.
+    void Clear();
+
+    /// Return prefab.
+    PrefabResource* GetPrefab() const { return prefab_; }
+    /// Return number of spawned instances that are not recycled yet.
+    unsigned GetNumActive() const { return activeNodes_.size(); }
+    /// Return number of parked instances ready to be reused.
+    unsigned GetNumParked() const { return parkedNodes_.size(); }
+    /// Return statistics of the current frame.
+    const NodePoolStats& GetFrameStats() const { return frameStats_; }
+    /// Return statistics of the previous frame.
+    const NodePoolStats& GetLastFrameStats() const { return lastFrameStats_; }
+
+private:
+    void HandleBeginFrame();
+    /// Move instances removed from the scene to the parked list.
+    void CollectRemovedNodes();
+    Node* GetOrCreateParkingNode();
+    Node* CreateInstance(Node* parent, const Vector3& position, const Quaternion& rotation);
+    void AddActiveNode(SharedPtr<Node> node);
+
+    WeakPtr<Scene> scene_;
+    SharedPtr<PrefabResource> prefab_;
+    /// Disabled temporary node that holds recycled instances.
+    WeakPtr<Node> parkingNode_;
+
+    ea::vector<SharedPtr<Node>> activeNodes_;
+    /// Indices of spawned instances in activeNodes_.
+    ea::unordered_map<Node*, unsigned> activeNodeIndices_;
+    /// Recycled instances. Instances removed from the scene are not attached to the parking node.
+    ea::vector<SharedPtr<Node>> parkedNodes_;
+
+    NodePoolStats frameStats_;
+    NodePoolStats lastFrameStats_;
+};
+
+} // namespace Urho3D
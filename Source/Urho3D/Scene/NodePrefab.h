@@ -103,6 +103,7 @@ public:
     const ea::string& GetTypeName() const { return typeName_; }
     StringHash GetTypeNameHash() const { return typeNameHash_; }
     SerializableId GetId() const { return id_; }
+    bool IsTemporary() const { return temporary_; }
     const ea::vector<AttributePrefab>& GetAttributes() const { return attributes_; }
     ea::vector<AttributePrefab>& GetMutableAttributes() { return attributes_; }
 
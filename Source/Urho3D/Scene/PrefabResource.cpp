@@ -65,6 +65,7 @@ Node* PrefabResource::InstantiateReference(Node* parentNode, bool inplace)
 
 void PrefabResource::NormalizeIds()
 {
+    compiledNodePrefab_ = nullptr;
     prefab_.NormalizeIds(context_);
 
     auto& sceneAttributes = prefab_.GetMutableNode().GetMutableAttributes();
@@ -80,6 +81,8 @@ void PrefabResource::SerializeInBlock(Archive& archive)
     const bool compactSave = false;
     const auto flags = PrefabArchiveFlag::None;
 
+    if (archive.IsInput())
+        compiledNodePrefab_ = nullptr;
     prefab_.SerializeInBlock(archive, flags, compactSave);
 }
 
@@ -94,6 +97,29 @@ const NodePrefab& PrefabResource::GetNodePrefabSlice(ea::string_view path) const
     return nodePrefab.FindChild(path);
 }
 
+const CompiledNodePrefab& PrefabResource::GetCompiledNodePrefab() const
+{
+    if (!compiledNodePrefab_)
+    {
+        // Subscribe lazily: resources may be constructed in worker threads, compiled prefab is used from main thread
+        if (!reflectionRemovedSubscribed_)
+        {
+            auto self = const_cast<PrefabResource*>(this);
+            context_->OnReflectionRemoved.Subscribe(self, &PrefabResource::HandleReflectionRemoved);
+            reflectionRemovedSubscribed_ = true;
+        }
+
+        compiledNodePrefab_ = ea::make_unique<CompiledNodePrefab>(context_, GetNodePrefab());
+    }
+    return *compiledNodePrefab_;
+}
+
+void PrefabResource::HandleReflectionRemoved(ObjectReflection* /*reflection*/)
+{
+    // Compiled prefab may reference removed reflection
+    compiledNodePrefab_ = nullptr;
+}
+
 bool PrefabResource::BeginLoad(Deserializer& source)
 {
     if (!SimpleResource::BeginLoad(source))
@@ -144,6 +170,7 @@ void PrefabResource::BackgroundLoadResources(const NodePrefab& prefab)
 
 NodePrefab& PrefabResource::GetMutableNodePrefab()
 {
+    compiledNodePrefab_ = nullptr;
     auto& children = prefab_.GetMutableChildren();
     if (children.empty())
         children.emplace_back();
@@ -160,6 +187,7 @@ bool PrefabResource::LoadLegacyXML(const XMLElement& source)
     if (!tempScene->LoadXML(source))
         return false;
 
+    compiledNodePrefab_ = nullptr;
     tempScene->GeneratePrefab(prefab_);
 
     static const char* helpMessage =
@@ -23,8 +23,11 @@
 #pragma once
 
 #include <Urho3D/Resource/Resource.h>
+#include <Urho3D/Scene/CompiledNodePrefab.h>
 #include <Urho3D/Scene/NodePrefab.h>
 
+#include <EASTL/unique_ptr.h>
+
 namespace Urho3D
 {
 
@@ -51,13 +54,20 @@ public:
     void SerializeInBlock(Archive& archive) override;
 
     const NodePrefab& GetScenePrefab() const { return prefab_; }
-    NodePrefab& GetMutableScenePrefab() { return prefab_; }
+    NodePrefab& GetMutableScenePrefab()
+    {
+        compiledNodePrefab_ = nullptr;
+        return prefab_;
+    }
 
     const NodePrefab& GetNodePrefab() const;
     NodePrefab& GetMutableNodePrefab();
 
     const NodePrefab& GetNodePrefabSlice(ea::string_view path) const;
 
+    /// Return node prefab compiled for fast instantiation. Compiled on first use, discarded when reflections are removed.
+    const CompiledNodePrefab& GetCompiledNodePrefab() const;
+
      /// Implement Resource.
     /// @{
     bool BeginLoad(Deserializer& source) override;
@@ -68,7 +78,11 @@ private:
 
     bool LoadLegacyXML(const XMLElement& source) override;
 
+    void HandleReflectionRemoved(ObjectReflection* reflection);
+
     NodePrefab prefab_;
+    mutable ea::unique_ptr<CompiledNodePrefab> compiledNodePrefab_;
+    mutable bool reflectionRemovedSubscribed_{};
 };
 
 } // namespace Urho3D
@@ -65,6 +65,9 @@ Text3D::Text3D(Context* context) :
     vertexBuffer_->SetDebugName("Text3D Geometry");
 
     text_.SetEffectDepthBias(DEFAULT_EFFECT_DEPTH_BIAS);
+
+    // Bounding box depends on camera when facing camera
+    volatileBoundingBox_ = true;
 }
 
 Text3D::~Text3D() = default;
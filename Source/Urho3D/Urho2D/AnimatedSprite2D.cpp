@@ -60,6 +60,8 @@ AnimatedSprite2D::AnimatedSprite2D(Context* context) :
     speed_(1.0f),
     loopMode_(LM_DEFAULT)
 {
+    // Bounding box is updated by animation without octree update
+    volatileBoundingBox_ = true;
 }
 
 AnimatedSprite2D::~AnimatedSprite2D()